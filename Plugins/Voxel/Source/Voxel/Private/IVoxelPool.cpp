@@ -2,10 +2,35 @@
 
 #include "IVoxelPool.h"
 #include "VoxelGlobals.h"
+#include "VoxelDefaultPool.h"
+#include "VoxelWorkStealingPool.h"
 #include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarUseWorkStealingPool(
+	TEXT("voxel.threadpool.UseWorkStealingPool"),
+	0,
+	TEXT("If true, the voxel pools created afterwards will use a queue per thread with work stealing. bConstantPriorities is then always true"),
+	ECVF_Default);
 
 TMap<TWeakObjectPtr<UWorld>, IVoxelPool::FPool> IVoxelPool::GlobalMap;
 
+TVoxelSharedRef<IVoxelPool> IVoxelPool::Create(
+	int32 NumberOfThreads,
+	bool bConstantPriorities,
+	const TMap<EVoxelTaskType, int32>& PriorityCategories,
+	const TMap<EVoxelTaskType, int32>& PriorityOffsets)
+{
+	if (CVarUseWorkStealingPool.GetValueOnGameThread() != 0)
+	{
+		return FVoxelWorkStealingPool::Create(NumberOfThreads, PriorityCategories, PriorityOffsets);
+	}
+	else
+	{
+		return FVoxelDefaultPool::Create(NumberOfThreads, bConstantPriorities, PriorityCategories, PriorityOffsets);
+	}
+}
+
 TVoxelSharedPtr<IVoxelPool> IVoxelPool::GetGlobalPool(UWorld* World)
 {
 	GlobalMap.Remove(nullptr);
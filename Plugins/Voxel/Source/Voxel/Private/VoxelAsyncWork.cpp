@@ -2,8 +2,21 @@
 
 #include "VoxelAsyncWork.h"
 #include "VoxelGlobals.h"
+#include "IVoxelPool.h"
+#include "VoxelPoolStats.h"
+#include "VoxelThreadingUtilities.h"
 #include "HAL/Event.h"
 #include "VoxelStatsUtilities.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Works Canceled While Running"), STAT_VoxelWorksCanceledWhileRunning, STATGROUP_Voxel);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Voxel Works Canceled While Running Time (ms)"), STAT_VoxelWorksCanceledWhileRunningTime, STATGROUP_Voxel);
+
+static TAutoConsoleVariable<int32> CVarCooperativeCancel(
+	TEXT("voxel.threadpool.CooperativeCancel"),
+	1,
+	TEXT("If true, works canceled while running (eg meshers of chunks that are no longer needed) will stop early instead of running to completion"),
+	ECVF_Default);
 
 FVoxelAsyncWork::~FVoxelAsyncWork()
 {
@@ -24,14 +37,31 @@ void FVoxelAsyncWork::DoThreadedWork()
 	if (!IsCanceled())
 	{
 		VOXEL_SCOPE_COUNTER_FORMAT("DoWork: %s", *Name.ToString());
+		const double StartTime = FPlatformTime::Seconds();
 		DoWork();
+
+		if (IsCanceled())
+		{
+			// Time wasted on a result no one needs: should go down with voxel.threadpool.CooperativeCancel
+			INC_DWORD_STAT(STAT_VoxelWorksCanceledWhileRunning);
+			INC_FLOAT_STAT_BY(STAT_VoxelWorksCanceledWhileRunningTime, (FPlatformTime::Seconds() - StartTime) * 1000);
+			FVoxelPoolStats::ReportCanceled(*this, true);
+		}
+	}
+	else
+	{
+		FVoxelPoolStats::ReportCanceled(*this, false);
 	}
 
+	// Can't access them once we're done
+	TArray<FContinuation> LocalContinuations = MoveTemp(Continuations);
+
 	DoneSection.Lock();
 
 	IsDoneCounter.Increment();
 
-	if (!IsCanceled())
+	const bool bCanceled = IsCanceled();
+	if (!bCanceled)
 	{
 		VOXEL_SCOPE_COUNTER("PostDoWork");
 		check(IsDone());
@@ -42,11 +72,14 @@ void FVoxelAsyncWork::DoThreadedWork()
 	{
 		DoneSection.Unlock();
 		delete this;
-		return;
+	}
+	else
+	{
+		DoneSection.Unlock();
+		// Might be deleted right after this
 	}
 
-	DoneSection.Unlock();
-	// Might be deleted right after this
+	QueueContinuations(MoveTemp(LocalContinuations), bCanceled);
 }
 
 void FVoxelAsyncWork::Abandon()
@@ -55,11 +88,15 @@ void FVoxelAsyncWork::Abandon()
 
 	check(!IsDone());
 
+	FVoxelPoolStats::ReportAbandoned(*this);
+
 	DoneSection.Lock();
 
 	IsDoneCounter.Increment();
 	WasAbandonedCounter.Increment();
 
+	ensure(Continuations.Num() == 0);
+
 	if (bAutodelete)
 	{
 		DoneSection.Unlock();
@@ -95,6 +132,42 @@ bool FVoxelAsyncWork::CancelAndAutodelete()
 	}
 }
 
+void FVoxelAsyncWork::AddContinuation(const TVoxelWeakPtr<IVoxelPool>& Pool, EVoxelTaskType Type, IVoxelQueuedWork* Work)
+{
+	check(Work);
+	check(!IsDone());
+	Continuations.Add({ Pool, Type, Work });
+}
+
+FVoxelCancelToken FVoxelAsyncWork::GetCancelToken() const
+{
+	if (CVarCooperativeCancel.GetValueOnAnyThread() == 0)
+	{
+		return {};
+	}
+	return FVoxelCancelToken(CanceledCounter);
+}
+
+void FVoxelAsyncWork::QueueContinuations(TArray<FContinuation>&& InContinuations, bool bCanceled)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	for (auto& Continuation : InContinuations)
+	{
+		auto Pool = Continuation.Pool.Pin();
+		if (!bCanceled && Pool.IsValid())
+		{
+			Pool->QueueTask(Continuation.Type, Continuation.Work);
+			// Else we could destroy the pool from one of its own threads
+			FVoxelUtilities::DeleteOnGameThread_AnyThread(Pool);
+		}
+		else
+		{
+			Continuation.Work->Abandon();
+		}
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
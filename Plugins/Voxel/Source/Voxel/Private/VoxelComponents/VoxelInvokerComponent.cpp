@@ -3,6 +3,8 @@
 #include "VoxelComponents/VoxelInvokerComponent.h"
 #include "VoxelWorld.h"
 #include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
 #include "Engine/World.h"
 #include "Kismet/GameplayStatics.h"
 
@@ -19,11 +21,35 @@ FVector UVoxelInvokerComponent::GetPosition() const
 	FVector Position = GetComponentLocation();
 	if (bEnablePrediction)
 	{
-		Position += GetOwner()->GetVelocity() * PredictionTime;
+		Position += GetVelocity() * PredictionTime;
 	}
 	return Position;
 }
 
+FVector UVoxelInvokerComponent::GetVelocity() const
+{
+	return GetOwner()->GetVelocity();
+}
+
+inline bool GetCameraView(const APlayerCameraManager* CameraManager, FVector& OutDirection, float& OutFOV)
+{
+	if (!CameraManager)
+	{
+		return false;
+	}
+
+	OutDirection = CameraManager->GetCameraRotation().Vector();
+	OutFOV = CameraManager->GetFOVAngle();
+	return true;
+}
+
+bool UVoxelInvokerComponent::GetView(FVector& OutDirection, float& OutFOV) const
+{
+	auto* Owner = Cast<APawn>(GetOwner());
+	auto* Controller = Owner ? Cast<APlayerController>(Owner->GetController()) : nullptr;
+	return Controller && GetCameraView(Controller->PlayerCameraManager, OutDirection, OutFOV);
+}
+
 const TArray<TWeakObjectPtr<UVoxelInvokerComponent>>& UVoxelInvokerComponent::GetInvokers(UWorld* World)
 {
 	auto* Result = Components.Find(World);
@@ -100,4 +126,23 @@ FVector UVoxelInvokerAutoCameraComponent::GetPosition() const
 	{
 		return FVector::ZeroVector;
 	}
+}
+
+FVector UVoxelInvokerAutoCameraComponent::GetVelocity() const
+{
+	APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(GetWorld(), 0);
+	AActor* ViewTarget = CameraManager ? CameraManager->GetViewTarget() : nullptr;
+	if (ViewTarget)
+	{
+		return ViewTarget->GetVelocity();
+	}
+	else
+	{
+		return FVector::ZeroVector;
+	}
+}
+
+bool UVoxelInvokerAutoCameraComponent::GetView(FVector& OutDirection, float& OutFOV) const
+{
+	return GetCameraView(UGameplayStatics::GetPlayerCameraManager(GetWorld(), 0), OutDirection, OutFOV);
 }
\ No newline at end of file
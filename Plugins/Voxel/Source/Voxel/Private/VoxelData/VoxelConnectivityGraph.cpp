@@ -0,0 +1,407 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelData/VoxelConnectivityGraph.h"
+#include "VoxelData/VoxelData.h"
+#include "VoxelIntVectorUtilities.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+static TAutoConsoleVariable<int32> CVarConnectivityCacheMaxChunks(
+	TEXT("voxel.data.ConnectivityCacheMaxChunks"),
+	16384,
+	TEXT("Max number of data chunks whose connected components are cached for the floating parts detection, per voxel data. A chunk uses up to 3kB"),
+	ECVF_Default);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Connectivity Chunks Filled"), STAT_VoxelConnectivityChunksFilled, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Connectivity Chunks Reused"), STAT_VoxelConnectivityChunksReused, STATGROUP_Voxel);
+
+static_assert(DATA_CHUNK_SIZE * DATA_CHUNK_SIZE * DATA_CHUNK_SIZE <= MAX_uint16, "Connectivity labels are stored as uint16");
+
+// Labels the solid voxels of Bounds by connected component, starting at 1. 0 for empty voxels
+// Deterministic: the same values always give the same labels
+inline int32 FloodFillConnectivityComponents(const FVoxelData& Data, const FIntBox& Bounds, TArray<uint16>& OutLabels)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const TArray<FVoxelValue> Values = Data.GetValues(Bounds);
+
+	const FIntVector Size = Bounds.Size();
+	const int32 Num = Size.X * Size.Y * Size.Z;
+	check(Values.Num() == Num);
+
+	OutLabels.Reset();
+	OutLabels.SetNumZeroed(Num);
+
+	TArray<int32> Queue;
+	int32 NumComponents = 0;
+	for (int32 StartIndex = 0; StartIndex < Num; StartIndex++)
+	{
+		if (OutLabels[StartIndex] != 0 || Values[StartIndex].IsEmpty())
+		{
+			continue;
+		}
+
+		const uint16 Label = uint16(++NumComponents);
+		OutLabels[StartIndex] = Label;
+		Queue.Add(StartIndex);
+
+		while (Queue.Num() > 0)
+		{
+			const int32 Index = Queue.Pop(false);
+			const int32 X = Index % Size.X;
+			const int32 Y = (Index / Size.X) % Size.Y;
+			const int32 Z = Index / (Size.X * Size.Y);
+
+			const auto Visit = [&](int32 NeighborIndex)
+			{
+				if (OutLabels[NeighborIndex] == 0 && !Values[NeighborIndex].IsEmpty())
+				{
+					OutLabels[NeighborIndex] = Label;
+					Queue.Add(NeighborIndex);
+				}
+			};
+			if (X > 0) Visit(Index - 1);
+			if (X < Size.X - 1) Visit(Index + 1);
+			if (Y > 0) Visit(Index - Size.X);
+			if (Y < Size.Y - 1) Visit(Index + Size.X);
+			if (Z > 0) Visit(Index - Size.X * Size.Y);
+			if (Z < Size.Z - 1) Visit(Index + Size.X * Size.Y);
+		}
+	}
+	return NumComponents;
+}
+
+inline TVoxelSharedRef<FVoxelConnectivityChunk> ComputeConnectivityChunk(const FVoxelData& Data, const FIntBox& Bounds, uint64 EditVersion)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const auto Chunk = MakeVoxelShared<FVoxelConnectivityChunk>();
+	Chunk->Bounds = Bounds;
+	Chunk->EditVersion = EditVersion;
+
+	TArray<uint16> Labels;
+	Chunk->NumComponents = FloodFillConnectivityComponents(Data, Bounds, Labels);
+
+	const FIntVector Size = Bounds.Size();
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		// The two other axes, in increasing order
+		const int32 AxisU = Axis == 0 ? 1 : 0;
+		const int32 AxisV = Axis == 2 ? 1 : 2;
+
+		for (int32 Side = 0; Side < 2; Side++)
+		{
+			TArray<uint16>& FaceLabels = Chunk->FaceLabels[2 * Axis + Side];
+			FaceLabels.SetNumUninitialized(Size[AxisU] * Size[AxisV]);
+
+			FIntVector Position(0);
+			Position[Axis] = Side == 0 ? 0 : Size[Axis] - 1;
+			for (int32 V = 0; V < Size[AxisV]; V++)
+			{
+				for (int32 U = 0; U < Size[AxisU]; U++)
+				{
+					Position[AxisU] = U;
+					Position[AxisV] = V;
+					FaceLabels[U + V * Size[AxisU]] = Labels[Position.X + Position.Y * Size.X + Position.Z * Size.X * Size.Y];
+				}
+			}
+		}
+	}
+
+	return Chunk;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelConnectivityGraph::FindFloatingVoxels(const FVoxelData& Data, const FIntBox& Bounds, TArray<FIntVector>& OutFloatingVoxels)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	struct FQueryChunk
+	{
+		FIntVector Key;
+		// Chunk bounds clipped to the query bounds
+		FIntBox Bounds;
+		bool bCacheable = false;
+		uint64 EditVersion = 0;
+		TVoxelSharedPtr<const FVoxelConnectivityChunk> Chunk;
+	};
+
+	const FIntBox Keys(FVoxelUtilities::DivideFloor(Bounds.Min, DATA_CHUNK_SIZE), FVoxelUtilities::DivideCeil(Bounds.Max, DATA_CHUNK_SIZE));
+	const FIntVector NumKeys = Keys.Size();
+	const auto GetChunkIndex = [&](const FIntVector& Key)
+	{
+		const FIntVector Position = Key - Keys.Min;
+		return Position.X + Position.Y * NumKeys.X + Position.Z * NumKeys.X * NumKeys.Y;
+	};
+
+	TArray<FQueryChunk> QueryChunks;
+	QueryChunks.SetNum(NumKeys.X * NumKeys.Y * NumKeys.Z);
+
+	TArray<int32> ChunksToFill;
+	{
+		VOXEL_SCOPE_COUNTER("Find cached chunks");
+
+		Keys.Iterate([&](int32 X, int32 Y, int32 Z)
+		{
+			const FIntVector Key(X, Y, Z);
+			const FIntBox ChunkBounds(Key * DATA_CHUNK_SIZE, (Key + 1) * DATA_CHUNK_SIZE);
+
+			FQueryChunk& QueryChunk = QueryChunks[GetChunkIndex(Key)];
+			QueryChunk.Key = Key;
+			QueryChunk.Bounds = ChunkBounds.Overlap(Bounds);
+			QueryChunk.bCacheable = QueryChunk.Bounds == ChunkBounds;
+			if (QueryChunk.bCacheable)
+			{
+				// Bounds is read locked, so this can't change until we're done
+				QueryChunk.EditVersion = Data.GetEditVersion(ChunkBounds);
+			}
+		});
+
+		FScopeLock Lock(&Section);
+		NumQueries++;
+
+		for (int32 Index = 0; Index < QueryChunks.Num(); Index++)
+		{
+			FQueryChunk& QueryChunk = QueryChunks[Index];
+			if (QueryChunk.bCacheable)
+			{
+				FCachedChunk* CachedChunk = Chunks.Find(QueryChunk.Key);
+				if (CachedChunk && CachedChunk->Chunk->EditVersion == QueryChunk.EditVersion)
+				{
+					QueryChunk.Chunk = CachedChunk->Chunk;
+					CachedChunk->LastUsed = NumQueries;
+					continue;
+				}
+			}
+			ChunksToFill.Add(Index);
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_VoxelConnectivityChunksFilled, ChunksToFill.Num());
+	INC_DWORD_STAT_BY(STAT_VoxelConnectivityChunksReused, QueryChunks.Num() - ChunksToFill.Num());
+
+	{
+		VOXEL_SCOPE_COUNTER("Flood fill chunks");
+		ParallelFor(ChunksToFill.Num(), [&](int32 Index)
+		{
+			FQueryChunk& QueryChunk = QueryChunks[ChunksToFill[Index]];
+			QueryChunk.Chunk = ComputeConnectivityChunk(Data, QueryChunk.Bounds, QueryChunk.EditVersion);
+		});
+	}
+
+	{
+		VOXEL_SCOPE_COUNTER("Update cache");
+
+		FScopeLock Lock(&Section);
+		for (int32 Index : ChunksToFill)
+		{
+			const FQueryChunk& QueryChunk = QueryChunks[Index];
+			if (QueryChunk.bCacheable)
+			{
+				Chunks.Add(QueryChunk.Key, { QueryChunk.Chunk, NumQueries });
+			}
+		}
+
+		const int32 MaxChunks = FMath::Max(0, CVarConnectivityCacheMaxChunks.GetValueOnAnyThread());
+		if (Chunks.Num() > MaxChunks)
+		{
+			// Remove the least recently used chunks until only half of the max is left
+			// Ties are broken arbitrarily, so that the cap holds even if a single query added more than the max
+			TArray<TPair<uint64, FIntVector>> LastUsed;
+			LastUsed.Reserve(Chunks.Num());
+			for (auto& It : Chunks)
+			{
+				LastUsed.Emplace(It.Value.LastUsed, It.Key);
+			}
+			LastUsed.Sort([](const TPair<uint64, FIntVector>& A, const TPair<uint64, FIntVector>& B) { return A.Key < B.Key; });
+
+			const int32 NumToRemove = Chunks.Num() - MaxChunks / 2;
+			for (int32 Index = 0; Index < NumToRemove; Index++)
+			{
+				Chunks.Remove(LastUsed[Index].Value);
+			}
+			ensure(Chunks.Num() <= MaxChunks);
+		}
+	}
+
+	// Node 0 is connected to the faces of Bounds. The other nodes are the components of the chunks: FirstNodes[ChunkIndex] + Label
+	TArray<int32> FirstNodes;
+	FirstNodes.SetNumUninitialized(QueryChunks.Num());
+	int32 NumNodes = 1;
+	for (int32 Index = 0; Index < QueryChunks.Num(); Index++)
+	{
+		FirstNodes[Index] = NumNodes - 1;
+		NumNodes += QueryChunks[Index].Chunk->NumComponents;
+	}
+
+	TArray<int32> Parents;
+	Parents.SetNumUninitialized(NumNodes);
+	for (int32 Node = 0; Node < NumNodes; Node++)
+	{
+		Parents[Node] = Node;
+	}
+
+	const auto Find = [&](int32 Node)
+	{
+		while (Parents[Node] != Node)
+		{
+			Parents[Node] = Parents[Parents[Node]];
+			Node = Parents[Node];
+		}
+		return Node;
+	};
+	const auto Union = [&](int32 NodeA, int32 NodeB)
+	{
+		NodeA = Find(NodeA);
+		NodeB = Find(NodeB);
+		if (NodeA != NodeB)
+		{
+			// Smallest index as root, so that node 0 stays a root
+			if (NodeB < NodeA)
+			{
+				Swap(NodeA, NodeB);
+			}
+			Parents[NodeB] = NodeA;
+		}
+	};
+
+	{
+		VOXEL_SCOPE_COUNTER("Union find");
+
+		for (int32 Index = 0; Index < QueryChunks.Num(); Index++)
+		{
+			const FQueryChunk& QueryChunk = QueryChunks[Index];
+			const FVoxelConnectivityChunk& Chunk = *QueryChunk.Chunk;
+			const int32 FirstNode = FirstNodes[Index];
+
+			const auto ConnectToBoundsFace = [&](const TArray<uint16>& FaceLabels)
+			{
+				for (uint16 Label : FaceLabels)
+				{
+					if (Label != 0)
+					{
+						Union(0, FirstNode + Label);
+					}
+				}
+			};
+
+			for (int32 Axis = 0; Axis < 3; Axis++)
+			{
+				if (Chunk.Bounds.Min[Axis] == Bounds.Min[Axis])
+				{
+					ConnectToBoundsFace(Chunk.FaceLabels[2 * Axis]);
+				}
+				if (Chunk.Bounds.Max[Axis] == Bounds.Max[Axis])
+				{
+					ConnectToBoundsFace(Chunk.FaceLabels[2 * Axis + 1]);
+				}
+
+				FIntVector NextKey = QueryChunk.Key;
+				NextKey[Axis]++;
+				if (NextKey[Axis] >= Keys.Max[Axis])
+				{
+					continue;
+				}
+
+				const int32 NextIndex = GetChunkIndex(NextKey);
+				const int32 NextFirstNode = FirstNodes[NextIndex];
+				const TArray<uint16>& FaceLabels = Chunk.FaceLabels[2 * Axis + 1];
+				const TArray<uint16>& NextFaceLabels = QueryChunks[NextIndex].Chunk->FaceLabels[2 * Axis];
+				if (!ensure(FaceLabels.Num() == NextFaceLabels.Num()))
+				{
+					continue;
+				}
+
+				for (int32 FaceIndex = 0; FaceIndex < FaceLabels.Num(); FaceIndex++)
+				{
+					if (FaceLabels[FaceIndex] != 0 && NextFaceLabels[FaceIndex] != 0)
+					{
+						Union(FirstNode + FaceLabels[FaceIndex], NextFirstNode + NextFaceLabels[FaceIndex]);
+					}
+				}
+			}
+		}
+	}
+
+	TArray<bool> FloatingNodes;
+	FloatingNodes.SetNumUninitialized(NumNodes);
+	TArray<int32> ChunksWithFloatingVoxels;
+	for (int32 Index = 0; Index < QueryChunks.Num(); Index++)
+	{
+		bool bHasFloatingVoxels = false;
+		for (int32 Label = 1; Label <= QueryChunks[Index].Chunk->NumComponents; Label++)
+		{
+			const int32 Node = FirstNodes[Index] + Label;
+			FloatingNodes[Node] = Find(Node) != 0;
+			bHasFloatingVoxels |= FloatingNodes[Node];
+		}
+		if (bHasFloatingVoxels)
+		{
+			ChunksWithFloatingVoxels.Add(Index);
+		}
+	}
+
+	if (ChunksWithFloatingVoxels.Num() == 0)
+	{
+		return;
+	}
+
+	{
+		VOXEL_SCOPE_COUNTER("Find floating voxels");
+
+		INC_DWORD_STAT_BY(STAT_VoxelConnectivityChunksFilled, ChunksWithFloatingVoxels.Num());
+
+		// Only the chunk faces are cached: flood fill the chunks with floating components again to find their voxels
+		TArray<TArray<FIntVector>> FloatingVoxelsPerChunk;
+		FloatingVoxelsPerChunk.SetNum(ChunksWithFloatingVoxels.Num());
+		ParallelFor(ChunksWithFloatingVoxels.Num(), [&](int32 Index)
+		{
+			const int32 ChunkIndex = ChunksWithFloatingVoxels[Index];
+			const FQueryChunk& QueryChunk = QueryChunks[ChunkIndex];
+			const FIntBox& ChunkBounds = QueryChunk.Bounds;
+			const FIntVector Size = ChunkBounds.Size();
+
+			// The values didn't change, so the labels are the same as the ones used above
+			TArray<uint16> Labels;
+			const int32 NumComponents = FloodFillConnectivityComponents(Data, ChunkBounds, Labels);
+			if (!ensure(NumComponents == QueryChunk.Chunk->NumComponents))
+			{
+				return;
+			}
+
+			TArray<FIntVector>& FloatingVoxels = FloatingVoxelsPerChunk[Index];
+			for (int32 Z = 0; Z < Size.Z; Z++)
+			{
+				for (int32 Y = 0; Y < Size.Y; Y++)
+				{
+					for (int32 X = 0; X < Size.X; X++)
+					{
+						const uint16 Label = Labels[X + Y * Size.X + Z * Size.X * Size.Y];
+						if (Label != 0 && FloatingNodes[FirstNodes[ChunkIndex] + Label])
+						{
+							FloatingVoxels.Emplace(ChunkBounds.Min.X + X, ChunkBounds.Min.Y + Y, ChunkBounds.Min.Z + Z);
+						}
+					}
+				}
+			}
+		});
+
+		for (auto& FloatingVoxels : FloatingVoxelsPerChunk)
+		{
+			OutFloatingVoxels.Append(FloatingVoxels);
+		}
+	}
+}
+
+void FVoxelConnectivityGraph::ClearCache()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	FScopeLock Lock(&Section);
+	Chunks.Empty();
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "VoxelData/VoxelData.h"
 #include "VoxelData/VoxelSaveUtilities.h"
 #include "VoxelData/VoxelDataUtilities.h"
+#include "VoxelData/VoxelConnectivityGraph.h"
 #include "VoxelWorldGeneratorHelpers.h"
 #include "VoxelWorld.h"
 #include "StackArray.h"
@@ -73,9 +74,12 @@ FVoxelData::FVoxelData(const FVoxelDataSettings& Settings)
 	, bEnableUndoRedo(Settings.bEnableUndoRedo)
 	, WorldGenerator(Settings.WorldGenerator)
 	, Octree(MakeUnique<FVoxelDataOctreeParent>(Depth))
+	, ConnectivityGraph(MakeVoxelShared<FVoxelConnectivityGraph>())
 {
 	check(Depth > 0);
 	check(Octree->GetBounds().Contains(WorldBounds));
+
+	EditVersions.SetNum(Depth + 1);
 }
 
 TVoxelSharedRef<FVoxelData> FVoxelData::Create(const FVoxelDataSettings& Settings, int32 DataOctreeInitialSubdivisionDepth)
@@ -237,6 +241,7 @@ TUniquePtr<FVoxelDataLockInfo> FVoxelData::Lock(EVoxelLockType LockType, const F
 	auto LockInfo = TUniquePtr<FVoxelDataLockInfo>(new FVoxelDataLockInfo());
 	LockInfo->Name = Name;
 	LockInfo->LockType = LockType;
+	LockInfo->Bounds = Bounds;
 	LockInfo->LockedOctrees = FVoxelDataOctreeLocker(LockType, Bounds, Name).Lock(GetOctree());
 	return LockInfo;
 }
@@ -247,6 +252,12 @@ void FVoxelData::Unlock(TUniquePtr<FVoxelDataLockInfo> LockInfo) const
 
 	check(LockInfo.IsValid());
 
+	if (LockInfo->LockType == EVoxelLockType::Write)
+	{
+		// Before unlocking: anything locking the data after that must see the new version
+		IncrementEditVersion(LockInfo->Bounds);
+	}
+
 	FVoxelDataOctreeUnlocker(LockInfo->LockType, LockInfo->LockedOctrees).Unlock(GetOctree());
 
 	MainLock.Unlock(EVoxelLockType::Read);
@@ -258,12 +269,96 @@ void FVoxelData::Unlock(TUniquePtr<FVoxelDataLockInfo> LockInfo) const
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+// Above that, edits are recorded at a higher height
+constexpr uint64 EditVersionsMaxCells = 64;
+
+inline FIntBox GetEditVersionsCells(const FIntBox& Bounds, int32 Height)
+{
+	const int32 CellSize = DATA_CHUNK_SIZE << Height;
+	return FIntBox(FVoxelUtilities::DivideFloor(Bounds.Min, CellSize), FVoxelUtilities::DivideCeil(Bounds.Max, CellSize));
+}
+
+inline int32 GetEditVersionsHeight(const FIntBox& Bounds, int32 Depth)
+{
+	for (int32 Height = 0; Height < Depth; Height++)
+	{
+		if (GetEditVersionsCells(Bounds, Height).Count() <= EditVersionsMaxCells)
+		{
+			return Height;
+		}
+	}
+	return Depth;
+}
+
+uint64 FVoxelData::GetEditVersion(const FIntBox& InBounds) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!InBounds.Intersect(WorldBounds))
+	{
+		return 0;
+	}
+	const FIntBox Bounds = InBounds.Overlap(WorldBounds);
+	const int32 QueryHeight = GetEditVersionsHeight(Bounds, Depth);
+
+	FScopeLock Lock(&EditVersionsSection);
+
+	uint64 Version = 0;
+	for (int32 Height = QueryHeight; Height <= Depth; Height++)
+	{
+		const auto& Versions = EditVersions[Height];
+		GetEditVersionsCells(Bounds, Height).Iterate([&](int32 X, int32 Y, int32 Z)
+		{
+			if (const FEditVersion* CellVersion = Versions.Find(FIntVector(X, Y, Z)))
+			{
+				// Edits recorded below are in Subtree. Edits recorded above cover the cells entirely
+				Version = FMath::Max(Version, Height == QueryHeight ? CellVersion->Subtree : CellVersion->Direct);
+			}
+		});
+	}
+	return Version;
+}
+
+void FVoxelData::IncrementEditVersion(const FIntBox& InBounds) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!InBounds.Intersect(WorldBounds))
+	{
+		return;
+	}
+	const FIntBox Bounds = InBounds.Overlap(WorldBounds);
+	const int32 WriteHeight = GetEditVersionsHeight(Bounds, Depth);
+
+	FScopeLock Lock(&EditVersionsSection);
+
+	const uint64 Version = ++EditVersionsCounter;
+	for (int32 Height = WriteHeight; Height <= Depth; Height++)
+	{
+		auto& Versions = EditVersions[Height];
+		GetEditVersionsCells(Bounds, Height).Iterate([&](int32 X, int32 Y, int32 Z)
+		{
+			FEditVersion& CellVersion = Versions.FindOrAdd(FIntVector(X, Y, Z));
+			if (Height == WriteHeight)
+			{
+				CellVersion.Direct = Version;
+			}
+			CellVersion.Subtree = Version;
+		});
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 void FVoxelData::ClearData()
 {
 	VOXEL_FUNCTION_COUNTER();
 
 	MainLock.Lock(EVoxelLockType::Write);
 	Octree = MakeUnique<FVoxelDataOctreeParent>(Depth);
+	IncrementEditVersion(WorldBounds);
 	MainLock.Unlock(EVoxelLockType::Write);
 
 	HistoryPosition = 0;
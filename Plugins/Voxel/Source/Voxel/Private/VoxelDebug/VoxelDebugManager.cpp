@@ -11,6 +11,7 @@
 #include "VoxelMessages.h"
 #include "VoxelWorld.h"
 #include "IVoxelPool.h"
+#include "VoxelPoolStats.h"
 
 #include "Engine/Engine.h"
 #include "EngineUtils.h"
@@ -82,6 +83,21 @@ static TAutoConsoleVariable<int32> CVarShowCollisionAndNavmeshDebug(
 	TEXT("If true, will show chunks used for collisions/navmesh and will color all chunks according to their usage"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<int32> CVarLogTimeToVisible(
+	TEXT("voxel.renderer.LogTimeToVisible"),
+	0,
+	TEXT("If true, will log the time it takes to mesh all the chunks in view after an invoker teleports"),
+	ECVF_Default);
+
+// Invokers moving more than this in a single frame are considered teleported, in cm
+static constexpr float VoxelDebugTeleportDistance = 10000;
+
+static TAutoConsoleVariable<int32> CVarShowPoolStats(
+	TEXT("voxel.debug.ShowPoolStats"),
+	0,
+	TEXT("If true, will show the wait and run times of the voxel pools works per task type. See voxel.threadpool.Stats.Reset"),
+	ECVF_Default);
+
 static TAutoConsoleVariable<int32> CVarShowDirtyVoxels(
 	TEXT("voxel.data.ShowDirtyVoxels"),
 	0,
@@ -127,6 +143,11 @@ static FAutoConsoleCommandWithWorldAndArgs ForceLODsUpdateCmd(
 	TEXT("Update the LODs"),
 	CreateCommandWithVoxelWorldDelegate([](AVoxelWorld& World) { World.GetLODManager().ForceLODsUpdate(); }));
 
+static FAutoConsoleCommandWithWorldAndArgs MeasureTimeToVisibleCmd(
+	TEXT("voxel.renderer.MeasureTimeToVisible"),
+	TEXT("Log the time it takes from now to mesh all the chunks in the invokers view"),
+	CreateCommandWithVoxelWorldDelegate([](AVoxelWorld& World) { World.GetDebugManager().StartTimeToVisibleMeasure(); }));
+
 static FAutoConsoleCommandWithWorldAndArgs CacheAllValuesCmd(
 	TEXT("voxel.data.CacheAllValues"),
 	TEXT("Cache all values"),
@@ -375,6 +396,28 @@ void FVoxelDebugManager::ClearChunksEmptyStates()
 	ChunksEmptyStates.Reset();
 }
 
+void FVoxelDebugManager::StartTimeToVisibleMeasure()
+{
+	TimeToVisibleStartTime = FPlatformTime::Seconds();
+	TimeToVisibleOctreeUpdateTime = 0;
+	InViewMeshTaskCount = -1;
+}
+
+void FVoxelDebugManager::ReportRenderOctreeUpdate(double TaskStartTime)
+{
+	if (IsMeasuringTimeToVisible() && TimeToVisibleOctreeUpdateTime == 0 && TaskStartTime >= TimeToVisibleStartTime)
+	{
+		TimeToVisibleOctreeUpdateTime = FPlatformTime::Seconds();
+		// Wait for the renderer to report the tasks of the new chunks
+		InViewMeshTaskCount = -1;
+	}
+}
+
+void FVoxelDebugManager::ReportInViewMeshTaskCount(int32 Num)
+{
+	InViewMeshTaskCount = Num;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -456,6 +499,30 @@ void FVoxelDebugManager::Tick(float DeltaTime)
 		{
 			GEngine->AddOnScreenDebugMessage(OBJECT_LINE_ID(), DebugDT, FColor::White, FString::Printf(TEXT("Foliage tasks remaining: %d"), FoliageTaskCount.GetValue()));
 		}
+		if (CVarShowPoolStats.GetValueOnGameThread())
+		{
+			float WorkerUtilization;
+			float Duration;
+			const auto AllStats = FVoxelPoolStats::GetStats(WorkerUtilization, Duration);
+			GEngine->AddOnScreenDebugMessage(OBJECT_LINE_ID(), DebugDT, FColor::White, FString::Printf(TEXT("Voxel pools over %.1fs: %.1f%% utilization"), Duration, WorkerUtilization * 100));
+			for (int32 Index = 0; Index < AllStats.Num(); Index++)
+			{
+				const auto& Stats = AllStats[Index];
+				// One key per task type
+				GEngine->AddOnScreenDebugMessage(OBJECT_LINE_ID() + (uint64(Index + 1) << 32), DebugDT, FColor::White, FString::Printf(
+					TEXT("\t%s (category %d): %.1f/s; wait: p50 %.2fms p95 %.2fms; run: p50 %.2fms p95 %.2fms; canceled: %d + %d running; %.1f%% of the threads time"),
+					*GET_STATIC_UENUM(EVoxelTaskType).GetNameStringByValue(int64(Stats.TaskType)),
+					Stats.PriorityCategory,
+					Stats.Throughput,
+					Stats.MedianWaitTime,
+					Stats.P95WaitTime,
+					Stats.MedianRunTime,
+					Stats.P95RunTime,
+					Stats.NumCanceled,
+					Stats.NumCanceledWhileRunning,
+					Stats.Utilization * 100));
+			}
+		}
 	}
 	if (!CVarFreezeDebug.GetValueOnGameThread())
 	{
@@ -463,6 +530,8 @@ void FVoxelDebugManager::Tick(float DeltaTime)
 		MultiplayerSyncedChunks.Reset();
 	}
 
+	UpdateTimeToVisibleMeasure();
+
 	if (CVarShowInvokers.GetValueOnGameThread())
 	{
 		for (auto& Invoker : UVoxelInvokerComponent::GetInvokers(World->GetWorld()))
@@ -557,4 +626,56 @@ void FVoxelDebugManager::Tick(float DeltaTime)
 				DebugDT);
 		});
 	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelDebugManager::UpdateTimeToVisibleMeasure()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (CVarLogTimeToVisible.GetValueOnGameThread())
+	{
+		bool bTeleported = false;
+
+		TMap<TWeakObjectPtr<UVoxelInvokerComponent>, FVector> NewInvokersPositions;
+		for (auto& Invoker : UVoxelInvokerComponent::GetInvokers(Settings.VoxelWorld->GetWorld()))
+		{
+			if (Invoker.IsValid() && Invoker->bUseForLODs)
+			{
+				const FVector Position = Invoker->GetComponentLocation();
+				const FVector* OldPosition = InvokersPositions.Find(Invoker);
+				if (OldPosition && FVector::DistSquared(*OldPosition, Position) > FMath::Square(VoxelDebugTeleportDistance))
+				{
+					bTeleported = true;
+				}
+				NewInvokersPositions.Add(Invoker, Position);
+			}
+		}
+		InvokersPositions = MoveTemp(NewInvokersPositions);
+
+		if (bTeleported)
+		{
+			StartTimeToVisibleMeasure();
+		}
+	}
+	else
+	{
+		InvokersPositions.Reset();
+	}
+
+	if (IsMeasuringTimeToVisible() && TimeToVisibleOctreeUpdateTime > 0 && InViewMeshTaskCount == 0)
+	{
+		const double Time = FPlatformTime::Seconds();
+		const FString Message = FString::Printf(TEXT("Time to visible complete: %fs (render octree update: %fs)"),
+			Time - TimeToVisibleStartTime,
+			TimeToVisibleOctreeUpdateTime - TimeToVisibleStartTime);
+
+		UE_LOG(LogVoxel, Log, TEXT("%s"), *Message);
+		GEngine->AddOnScreenDebugMessage(OBJECT_LINE_ID(), 5, FColor::Green, Message);
+
+		TimeToVisibleStartTime = 0;
+	}
 }
\ No newline at end of file
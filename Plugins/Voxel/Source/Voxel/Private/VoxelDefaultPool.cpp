@@ -3,9 +3,22 @@
 #include "VoxelDefaultPool.h"
 #include "VoxelThreadPool.h"
 #include "VoxelQueuedWork.h"
+#include "VoxelPoolStats.h"
 #include "Misc/QueuedThreadPool.h"
 #include "VoxelGlobals.h"
 
+inline TArray<uint32> GetPriorityCategoriesValues(const TMap<EVoxelTaskType, int32>& PriorityCategories)
+{
+	TArray<uint32> Values;
+	for (auto& It : PriorityCategories)
+	{
+		Values.AddUnique(It.Value);
+	}
+	// Task types not in the map use 0
+	Values.AddUnique(0);
+	return Values;
+}
+
 FVoxelDefaultPool::FVoxelDefaultPool(
 	int32 ThreadCount,
 	bool bConstantPriorities,
@@ -16,17 +29,20 @@ FVoxelDefaultPool::FVoxelDefaultPool(
 		ThreadCount,
 		1024 * 1024,
 		EThreadPriority::TPri_Normal,
-		bConstantPriorities)))
+		bConstantPriorities,
+		GetPriorityCategoriesValues(InPriorityCategories))))
 {
 	for (int32 Index = 0; Index < 256; Index++)
 	{
 		const_cast<TStaticArray<uint32, 256>&>(PriorityCategories)[Index] = InPriorityCategories.FindRef(EVoxelTaskType(Index));
 		const_cast<TStaticArray<uint32, 256>&>(PriorityOffsets)[Index] = InPriorityOffsets.FindRef(EVoxelTaskType(Index));
 	}
+	FVoxelPoolStats::AddThreads(Pool->GetNumThreads());
 }
 
 FVoxelDefaultPool::~FVoxelDefaultPool()
 {
+	FVoxelPoolStats::AddThreads(-Pool->GetNumThreads());
 }
 
 TVoxelSharedRef<FVoxelDefaultPool> FVoxelDefaultPool::Create(
@@ -55,11 +71,13 @@ TVoxelSharedRef<FVoxelDefaultPool> FVoxelDefaultPool::Create(
 
 void FVoxelDefaultPool::QueueTask(EVoxelTaskType Type, IVoxelQueuedWork* Task)
 {
+	FVoxelPoolStats::ReportQueued(Type, PriorityCategories[uint8(Type)], { Task });
 	Pool->AddQueuedWork(Task, PriorityCategories[uint8(Type)], PriorityOffsets[uint8(Type)]);
 }
 
 void FVoxelDefaultPool::QueueTasks(EVoxelTaskType Type, const TArray<IVoxelQueuedWork*>& Tasks)
 {
+	FVoxelPoolStats::ReportQueued(Type, PriorityCategories[uint8(Type)], Tasks);
 	Pool->AddQueuedWorks(Tasks, PriorityCategories[uint8(Type)], PriorityOffsets[uint8(Type)]);
 }
 
@@ -85,6 +103,7 @@ void FVoxelDefaultPool::FixPriorityCategories(TMap<EVoxelTaskType, int32>& Prior
 	FIX(AsyncEditFunctions, 50);
 	FIX(MeshMerge, 100000);
 	FIX(RenderOctree, 1000000);
+	FIX(ChunksPrefetch, 0);
 #undef FIX
 }
 
@@ -101,5 +120,7 @@ void FVoxelDefaultPool::FixPriorityOffsets(TMap<EVoxelTaskType, int32>& Priority
 	FIX(AsyncEditFunctions, 0);
 	FIX(RenderOctree, 0);
 	FIX(MeshMerge, 0);
+	// Below the chunks meshing tasks, as the prefetched chunks might never be needed
+	FIX(ChunksPrefetch, -1000000);
 #undef FIX
 }
\ No newline at end of file
@@ -0,0 +1,205 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelFrameScheduler.h"
+#include "RenderCore.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Voxel Frame Budget (ms)"), STAT_VoxelFrameBudget, STATGROUP_Voxel);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Voxel Frame Used Time (ms)"), STAT_VoxelFrameUsedTime, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Frame Deferred Renderer Updates"), STAT_VoxelFrameDeferred_Renderer, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Frame Deferred Physics Callbacks"), STAT_VoxelFrameDeferred_PhysicsCallbacks, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Frame Deferred Instanced Meshes Updates"), STAT_VoxelFrameDeferred_InstancedMeshes, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Frame Deferred Spawners Updates"), STAT_VoxelFrameDeferred_Spawners, STATGROUP_Voxel);
+
+static TAutoConsoleVariable<int32> CVarEnableFrameScheduler(
+	TEXT("voxel.scheduler.Enable"),
+	1,
+	TEXT("If true, the game thread work of the voxel worlds is limited by a frame budget adapting to the game thread time"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFrameSchedulerTargetFPS(
+	TEXT("voxel.scheduler.TargetFPS"),
+	60,
+	TEXT("The voxel frame budget is reduced when the game thread is slower than this"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFrameSchedulerMinBudget(
+	TEXT("voxel.scheduler.MinBudget"),
+	1.f,
+	TEXT("Min game thread time per frame for all the voxel worlds, in ms"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFrameSchedulerMaxBudget(
+	TEXT("voxel.scheduler.MaxBudget"),
+	8.f,
+	TEXT("Max game thread time per frame for all the voxel worlds, in ms"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFrameSchedulerLogDeferred(
+	TEXT("voxel.scheduler.LogDeferred"),
+	0,
+	TEXT("If true, will log the number of work items deferred to the next frames every frame"),
+	ECVF_Default);
+
+// Relative share of the budget of each category
+static const float GVoxelFrameBudgetWeights[] =
+{
+	0.f, // Multiplayer
+	4.f, // Renderer
+	2.f, // PhysicsCallbacks
+	2.f, // InstancedMeshes
+	1.f, // Spawners
+};
+static_assert(ARRAY_COUNT(GVoxelFrameBudgetWeights) == int32(EVoxelFrameBudgetCategory::Count), "");
+
+// Always give some time to each tick, else nothing would ever be processed when over budget
+static constexpr double VoxelFrameSchedulerMinTimePerTick = 0.1 / 1000;
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+struct FVoxelFrameSchedulerState
+{
+	uint64 FrameCounter = MAX_uint64;
+	// In seconds
+	double Budget = 0;
+	double UsedTime = 0;
+
+	double UsedTimes[int32(EVoxelFrameBudgetCategory::Count)] = {};
+	int32 NumDeferred[int32(EVoxelFrameBudgetCategory::Count)] = {};
+	// Categories that ticked last frame/this frame, to know how to share the budget
+	bool bWasActive[int32(EVoxelFrameBudgetCategory::Count)] = {};
+	bool bIsActive[int32(EVoxelFrameBudgetCategory::Count)] = {};
+
+	void StartFrameIfNeeded()
+	{
+		if (FrameCounter == GFrameCounter)
+		{
+			return;
+		}
+		const bool bFirstFrame = FrameCounter == MAX_uint64;
+		FrameCounter = GFrameCounter;
+
+		if (!bFirstFrame)
+		{
+			LogAndReportStats();
+		}
+
+		// The game thread time of the previous frame, without the voxel work
+		const double OtherTime = FMath::Max(0., FPlatformTime::ToSeconds(GGameThreadTime) - UsedTime);
+		const double TargetFrameTime = 1. / FMath::Max(1, CVarFrameSchedulerTargetFPS.GetValueOnGameThread());
+		const double MinBudget = FMath::Max(0.f, CVarFrameSchedulerMinBudget.GetValueOnGameThread()) / 1000;
+		const double MaxBudget = FMath::Max(MinBudget, CVarFrameSchedulerMaxBudget.GetValueOnGameThread() / 1000.);
+		const double WantedBudget = FMath::Clamp(TargetFrameTime - OtherTime, MinBudget, MaxBudget);
+
+		if (bFirstFrame || WantedBudget < Budget)
+		{
+			// Shrink right away to avoid hitches
+			Budget = WantedBudget;
+		}
+		else
+		{
+			// Grow slowly, as OtherTime is noisy
+			Budget = FMath::Lerp(Budget, WantedBudget, 0.1);
+		}
+
+		UsedTime = 0;
+		for (int32 Index = 0; Index < int32(EVoxelFrameBudgetCategory::Count); Index++)
+		{
+			UsedTimes[Index] = 0;
+			NumDeferred[Index] = 0;
+			bWasActive[Index] = bIsActive[Index];
+			bIsActive[Index] = false;
+		}
+	}
+
+	double GetShare(EVoxelFrameBudgetCategory Category) const
+	{
+		float TotalWeight = 0;
+		for (int32 Index = 0; Index < int32(EVoxelFrameBudgetCategory::Count); Index++)
+		{
+			if (bWasActive[Index] || bIsActive[Index] || Index == int32(Category))
+			{
+				TotalWeight += GVoxelFrameBudgetWeights[Index];
+			}
+		}
+		return TotalWeight > 0 ? Budget * GVoxelFrameBudgetWeights[int32(Category)] / TotalWeight : 0;
+	}
+
+	double GetAllowedTime(EVoxelFrameBudgetCategory Category) const
+	{
+		// Time left once the categories that did not tick yet this frame get their share
+		double ReservedTime = 0;
+		for (int32 Index = 0; Index < int32(EVoxelFrameBudgetCategory::Count); Index++)
+		{
+			if (bWasActive[Index] && !bIsActive[Index] && Index != int32(Category))
+			{
+				ReservedTime += GetShare(EVoxelFrameBudgetCategory(Index));
+			}
+		}
+		const double FreeTime = Budget - UsedTime - ReservedTime;
+		const double ShareLeft = GetShare(Category) - UsedTimes[int32(Category)];
+
+		return FMath::Max3(FreeTime, ShareLeft, VoxelFrameSchedulerMinTimePerTick);
+	}
+
+	void LogAndReportStats() const
+	{
+		SET_FLOAT_STAT(STAT_VoxelFrameBudget, Budget * 1000);
+		SET_FLOAT_STAT(STAT_VoxelFrameUsedTime, UsedTime * 1000);
+		SET_DWORD_STAT(STAT_VoxelFrameDeferred_Renderer, NumDeferred[int32(EVoxelFrameBudgetCategory::Renderer)]);
+		SET_DWORD_STAT(STAT_VoxelFrameDeferred_PhysicsCallbacks, NumDeferred[int32(EVoxelFrameBudgetCategory::PhysicsCallbacks)]);
+		SET_DWORD_STAT(STAT_VoxelFrameDeferred_InstancedMeshes, NumDeferred[int32(EVoxelFrameBudgetCategory::InstancedMeshes)]);
+		SET_DWORD_STAT(STAT_VoxelFrameDeferred_Spawners, NumDeferred[int32(EVoxelFrameBudgetCategory::Spawners)]);
+
+		if (CVarFrameSchedulerLogDeferred.GetValueOnGameThread() != 0)
+		{
+			UE_LOG(LogVoxel, Log, TEXT("Voxel frame: budget: %.2fms; used: %.2fms; deferred: renderer: %d; physics callbacks: %d; instanced meshes: %d; spawners: %d"),
+				Budget * 1000,
+				UsedTime * 1000,
+				NumDeferred[int32(EVoxelFrameBudgetCategory::Renderer)],
+				NumDeferred[int32(EVoxelFrameBudgetCategory::PhysicsCallbacks)],
+				NumDeferred[int32(EVoxelFrameBudgetCategory::InstancedMeshes)],
+				NumDeferred[int32(EVoxelFrameBudgetCategory::Spawners)]);
+		}
+	}
+};
+
+static FVoxelFrameSchedulerState GVoxelFrameSchedulerState;
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+double FVoxelFrameScheduler::BeginWork(EVoxelFrameBudgetCategory Category)
+{
+	check(IsInGameThread());
+	check(Category < EVoxelFrameBudgetCategory::Count);
+
+	auto& State = GVoxelFrameSchedulerState;
+	State.StartFrameIfNeeded();
+
+	const double Time = FPlatformTime::Seconds();
+	if (CVarEnableFrameScheduler.GetValueOnGameThread() == 0 || Category == EVoxelFrameBudgetCategory::Multiplayer)
+	{
+		return MAX_dbl;
+	}
+
+	return Time + State.GetAllowedTime(Category);
+}
+
+void FVoxelFrameScheduler::EndWork(EVoxelFrameBudgetCategory Category, double StartTime, int32 NumDeferred)
+{
+	check(IsInGameThread());
+
+	auto& State = GVoxelFrameSchedulerState;
+	State.StartFrameIfNeeded();
+
+	const double Duration = FPlatformTime::Seconds() - StartTime;
+	State.UsedTime += Duration;
+	State.UsedTimes[int32(Category)] += Duration;
+	// Several voxel worlds can use the same category
+	State.NumDeferred[int32(Category)] += NumDeferred;
+	State.bIsActive[int32(Category)] = true;
+}
\ No newline at end of file
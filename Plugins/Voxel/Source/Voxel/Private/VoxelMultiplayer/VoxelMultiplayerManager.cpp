@@ -8,6 +8,7 @@
 #include "VoxelDebug/VoxelDebugManager.h"
 #include "VoxelWorld.h"
 #include "VoxelMessages.h"
+#include "VoxelFrameScheduler.h"
 
 // TODO https://github.com/Phyronnaz/VoxelPrivate/blob/82df5f5c96f124139a13cbbf88453841e2bee0fe/Source/Voxel/Public/VoxelMultiplayer/VoxelMultiplayerManager.h#L1
 // TODO https://github.com/Phyronnaz/VoxelPrivate/blob/82df5f5c96f124139a13cbbf88453841e2bee0fe/Source/Voxel/Private/VoxelMultiplayer/VoxelMultiplayerManager.cpp#L1
@@ -79,6 +80,9 @@ FVoxelMultiplayerManager::FVoxelMultiplayerManager(
 
 void FVoxelMultiplayerManager::Tick(float DeltaTime)
 {
+	// Never deferred, but counts towards the frame budget of the other voxel tickables
+	FVoxelFrameBudgetScope FrameBudget(EVoxelFrameBudgetCategory::Multiplayer);
+
 	const double Time = FPlatformTime::Seconds();
 	if (Server.IsValid() && Time - LastSyncTime > 1. / Settings.MultiplayerSyncRate)
 	{
@@ -0,0 +1,372 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelPoolStats.h"
+#include "VoxelQueuedWork.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+
+static TAutoConsoleVariable<int32> CVarEnablePoolStats(
+	TEXT("voxel.threadpool.Stats.Enable"),
+	1,
+	TEXT("If true, the voxel pools will record the wait and run times of the works. See voxel.threadpool.Stats.Print"),
+	ECVF_Default);
+
+// Only the first values of EVoxelTaskType are used
+static constexpr int32 VoxelPoolStatsMaxTaskTypes = 32;
+// Bucket N counts the times between 2^N and 2^(N+1) microseconds. The last one also counts all the bigger times (> 8s)
+static constexpr int32 VoxelPoolStatsNumBuckets = 24;
+
+struct FVoxelPoolTimeHistogram
+{
+	FThreadSafeCounter64 Buckets[VoxelPoolStatsNumBuckets];
+	FThreadSafeCounter64 Num;
+	FThreadSafeCounter64 TotalMicroseconds;
+	volatile int64 MaxMicroseconds = 0;
+
+	void Add(double Seconds)
+	{
+		const int64 Microseconds = FMath::Max<int64>(0, int64(Seconds * 1e6));
+		const int32 Bucket = Microseconds < 2 ? 0 : FMath::Min<int32>(FMath::FloorLog2_64(Microseconds), VoxelPoolStatsNumBuckets - 1);
+
+		Buckets[Bucket].Increment();
+		Num.Increment();
+		TotalMicroseconds.Add(Microseconds);
+
+		int64 Max = MaxMicroseconds;
+		while (Microseconds > Max)
+		{
+			const int64 OldMax = FPlatformAtomics::InterlockedCompareExchange(&MaxMicroseconds, Microseconds, Max);
+			if (OldMax == Max) break;
+			Max = OldMax;
+		}
+	}
+	void Reset()
+	{
+		for (auto& Bucket : Buckets)
+		{
+			Bucket.Reset();
+		}
+		Num.Reset();
+		TotalMicroseconds.Reset();
+		FPlatformAtomics::InterlockedExchange(&MaxMicroseconds, 0);
+	}
+
+	// In ms
+	float GetAverage() const
+	{
+		const int64 LocalNum = Num.GetValue();
+		return LocalNum == 0 ? 0.f : TotalMicroseconds.GetValue() / 1000.f / LocalNum;
+	}
+	float GetMax() const
+	{
+		return MaxMicroseconds / 1000.f;
+	}
+	// Upper bound of the bucket containing the percentile, in ms
+	float GetPercentile(float Percentile) const
+	{
+		const int64 LocalNum = Num.GetValue();
+		if (LocalNum == 0)
+		{
+			return 0.f;
+		}
+
+		const int64 Target = FMath::CeilToInt(LocalNum * Percentile);
+		int64 Count = 0;
+		for (int32 Bucket = 0; Bucket < VoxelPoolStatsNumBuckets; Bucket++)
+		{
+			Count += Buckets[Bucket].GetValue();
+			if (Count >= Target)
+			{
+				return FMath::Min(GetMax(), (int64(1) << (Bucket + 1)) / 1000.f);
+			}
+		}
+		return GetMax();
+	}
+};
+
+struct FVoxelPoolTaskTypeCounters
+{
+	FThreadSafeCounter PriorityCategory;
+	FThreadSafeCounter64 NumQueued;
+	FThreadSafeCounter64 NumRun;
+	FThreadSafeCounter64 NumCanceled;
+	FThreadSafeCounter64 NumCanceledWhileRunning;
+	FThreadSafeCounter64 NumAbandoned;
+
+	FVoxelPoolTimeHistogram WaitTimes;
+	FVoxelPoolTimeHistogram RunTimes;
+
+	void Reset()
+	{
+		NumQueued.Reset();
+		NumRun.Reset();
+		NumCanceled.Reset();
+		NumCanceledWhileRunning.Reset();
+		NumAbandoned.Reset();
+		WaitTimes.Reset();
+		RunTimes.Reset();
+	}
+};
+
+static FVoxelPoolTaskTypeCounters GVoxelPoolTaskTypeCounters[VoxelPoolStatsMaxTaskTypes];
+static FThreadSafeCounter GVoxelPoolStatsNumThreads;
+// Set on the first work queued after a reset
+static double GVoxelPoolStatsStartTime = 0;
+
+inline FVoxelPoolTaskTypeCounters* GetVoxelPoolTaskTypeCounters(const IVoxelQueuedWork& Work)
+{
+	if (!Work.bRecordedInPoolStats)
+	{
+		// Not queued in a voxel pool, or queued while the stats were disabled
+		return nullptr;
+	}
+	if (!ensureVoxelSlow(uint8(Work.TaskType) < VoxelPoolStatsMaxTaskTypes))
+	{
+		return nullptr;
+	}
+	return &GVoxelPoolTaskTypeCounters[uint8(Work.TaskType)];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelPoolStats::ReportQueued(EVoxelTaskType Type, uint32 PriorityCategory, const TArray<IVoxelQueuedWork*>& Works)
+{
+	const double Time = FPlatformTime::Seconds();
+	const bool bRecord = CVarEnablePoolStats.GetValueOnAnyThread() != 0 && ensure(uint8(Type) < VoxelPoolStatsMaxTaskTypes);
+
+	for (auto* Work : Works)
+	{
+		Work->TaskType = Type;
+		Work->QueueTime = Time;
+		Work->bRecordedInPoolStats = bRecord;
+	}
+
+	if (!bRecord)
+	{
+		return;
+	}
+
+	if (GVoxelPoolStatsStartTime == 0)
+	{
+		GVoxelPoolStatsStartTime = Time;
+	}
+
+	auto& Counters = GVoxelPoolTaskTypeCounters[uint8(Type)];
+	Counters.PriorityCategory.Set(PriorityCategory);
+	Counters.NumQueued.Add(Works.Num());
+}
+
+void FVoxelPoolStats::DoThreadedWork(IVoxelQueuedWork& Work)
+{
+	auto* Counters = GetVoxelPoolTaskTypeCounters(Work);
+	if (!Counters)
+	{
+		Work.DoThreadedWork();
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	Counters->WaitTimes.Add(StartTime - Work.QueueTime);
+
+	// Might delete Work
+	Work.DoThreadedWork();
+
+	Counters->RunTimes.Add(FPlatformTime::Seconds() - StartTime);
+	Counters->NumRun.Increment();
+}
+
+void FVoxelPoolStats::ReportCanceled(const IVoxelQueuedWork& Work, bool bWhileRunning)
+{
+	if (auto* Counters = GetVoxelPoolTaskTypeCounters(Work))
+	{
+		(bWhileRunning ? Counters->NumCanceledWhileRunning : Counters->NumCanceled).Increment();
+	}
+}
+
+void FVoxelPoolStats::ReportAbandoned(const IVoxelQueuedWork& Work)
+{
+	if (auto* Counters = GetVoxelPoolTaskTypeCounters(Work))
+	{
+		Counters->NumAbandoned.Increment();
+	}
+}
+
+void FVoxelPoolStats::AddThreads(int32 Num)
+{
+	ensure(GVoxelPoolStatsNumThreads.Add(Num) + Num >= 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelPoolStats::Reset()
+{
+	for (auto& Counters : GVoxelPoolTaskTypeCounters)
+	{
+		Counters.Reset();
+	}
+	GVoxelPoolStatsStartTime = 0;
+}
+
+TArray<FVoxelPoolTaskTypeStats> FVoxelPoolStats::GetStats(float& OutWorkerUtilization, float& OutDuration)
+{
+	const double StartTime = GVoxelPoolStatsStartTime;
+	OutDuration = StartTime == 0 ? 0.f : float(FPlatformTime::Seconds() - StartTime);
+	// Approximation: assumes the pools were not created/destroyed since the last reset
+	const double ThreadsTime = OutDuration * GVoxelPoolStatsNumThreads.GetValue();
+
+	TArray<FVoxelPoolTaskTypeStats> Result;
+	double TotalRunTime = 0;
+	for (int32 Index = 0; Index < VoxelPoolStatsMaxTaskTypes; Index++)
+	{
+		const auto& Counters = GVoxelPoolTaskTypeCounters[Index];
+		if (Counters.NumQueued.GetValue() == 0 && Counters.NumRun.GetValue() == 0)
+		{
+			continue;
+		}
+
+		const double RunTime = Counters.RunTimes.TotalMicroseconds.GetValue() / 1e6;
+		TotalRunTime += RunTime;
+
+		FVoxelPoolTaskTypeStats Stats;
+		Stats.TaskType = EVoxelTaskType(Index);
+		Stats.PriorityCategory = Counters.PriorityCategory.GetValue();
+		Stats.NumQueued = int32(Counters.NumQueued.GetValue());
+		Stats.NumRun = int32(Counters.NumRun.GetValue());
+		Stats.NumCanceled = int32(Counters.NumCanceled.GetValue());
+		Stats.NumCanceledWhileRunning = int32(Counters.NumCanceledWhileRunning.GetValue());
+		Stats.NumAbandoned = int32(Counters.NumAbandoned.GetValue());
+		Stats.Throughput = OutDuration > 0 ? Stats.NumRun / OutDuration : 0.f;
+
+		Stats.AverageWaitTime = Counters.WaitTimes.GetAverage();
+		Stats.MedianWaitTime = Counters.WaitTimes.GetPercentile(0.5f);
+		Stats.P95WaitTime = Counters.WaitTimes.GetPercentile(0.95f);
+		Stats.MaxWaitTime = Counters.WaitTimes.GetMax();
+
+		Stats.AverageRunTime = Counters.RunTimes.GetAverage();
+		Stats.MedianRunTime = Counters.RunTimes.GetPercentile(0.5f);
+		Stats.P95RunTime = Counters.RunTimes.GetPercentile(0.95f);
+		Stats.MaxRunTime = Counters.RunTimes.GetMax();
+
+		Stats.Utilization = ThreadsTime > 0 ? float(RunTime / ThreadsTime) : 0.f;
+
+		Result.Add(Stats);
+	}
+
+	OutWorkerUtilization = ThreadsTime > 0 ? float(TotalRunTime / ThreadsTime) : 0.f;
+
+	return Result;
+}
+
+FString FVoxelPoolStats::GetStatsAsCSV()
+{
+	float WorkerUtilization;
+	float Duration;
+	const auto AllStats = GetStats(WorkerUtilization, Duration);
+
+	FString Result =
+		TEXT("TaskType,PriorityCategory,NumQueued,NumRun,NumCanceled,NumCanceledWhileRunning,NumAbandoned,Throughput,")
+		TEXT("AverageWaitTime,MedianWaitTime,P95WaitTime,MaxWaitTime,AverageRunTime,MedianRunTime,P95RunTime,MaxRunTime,Utilization,WorkerUtilization,Duration\n");
+	for (auto& Stats : AllStats)
+	{
+		Result += FString::Printf(TEXT("%s,%d,%d,%d,%d,%d,%d,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n"),
+			*GET_STATIC_UENUM(EVoxelTaskType).GetNameStringByValue(int64(Stats.TaskType)),
+			Stats.PriorityCategory,
+			Stats.NumQueued,
+			Stats.NumRun,
+			Stats.NumCanceled,
+			Stats.NumCanceledWhileRunning,
+			Stats.NumAbandoned,
+			Stats.Throughput,
+			Stats.AverageWaitTime,
+			Stats.MedianWaitTime,
+			Stats.P95WaitTime,
+			Stats.MaxWaitTime,
+			Stats.AverageRunTime,
+			Stats.MedianRunTime,
+			Stats.P95RunTime,
+			Stats.MaxRunTime,
+			Stats.Utilization,
+			WorkerUtilization,
+			Duration);
+	}
+	return Result;
+}
+
+bool FVoxelPoolStats::ExportStatsToCSV(const FString& Path)
+{
+	const bool bSuccess = FFileHelper::SaveStringToFile(GetStatsAsCSV(), *Path);
+	if (bSuccess)
+	{
+		UE_LOG(LogVoxel, Log, TEXT("Voxel pool stats exported to %s"), *FPaths::ConvertRelativePathToFull(Path));
+	}
+	else
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Failed to export the voxel pool stats to %s"), *Path);
+	}
+	return bSuccess;
+}
+
+void FVoxelPoolStats::PrintStats()
+{
+	float WorkerUtilization;
+	float Duration;
+	const auto AllStats = GetStats(WorkerUtilization, Duration);
+
+	UE_LOG(LogVoxel, Log, TEXT("Voxel pool stats over %.1fs: %d threads, %.1f%% utilization"), Duration, GVoxelPoolStatsNumThreads.GetValue(), WorkerUtilization * 100);
+	UE_LOG(LogVoxel, Log, TEXT("\t%-32s; Category; Queued   ; Run      ; Canceled ; Canceled Running; Works/s  ; Wait avg/p50/p95/max (ms)       ; Run avg/p50/p95/max (ms)        ; Utilization"), TEXT("Task Type"));
+	for (auto& Stats : AllStats)
+	{
+		UE_LOG(LogVoxel, Log, TEXT("\t%-32s; %8d; %9d; %9d; %9d; %16d; %9.1f; %7.2f/%7.2f/%7.2f/%7.2f; %7.2f/%7.2f/%7.2f/%7.2f; %5.1f%%"),
+			*GET_STATIC_UENUM(EVoxelTaskType).GetNameStringByValue(int64(Stats.TaskType)),
+			Stats.PriorityCategory,
+			Stats.NumQueued,
+			Stats.NumRun,
+			Stats.NumCanceled,
+			Stats.NumCanceledWhileRunning,
+			Stats.Throughput,
+			Stats.AverageWaitTime,
+			Stats.MedianWaitTime,
+			Stats.P95WaitTime,
+			Stats.MaxWaitTime,
+			Stats.AverageRunTime,
+			Stats.MedianRunTime,
+			Stats.P95RunTime,
+			Stats.MaxRunTime,
+			Stats.Utilization * 100);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+inline void ExportVoxelPoolStatsToCSV(const TArray<FString>& Args)
+{
+	const FString Path = Args.Num() > 0
+		? Args[0]
+		: FPaths::ProfilingDir() / FString::Printf(TEXT("VoxelPoolStats-%s.csv"), *FDateTime::Now().ToString());
+	FVoxelPoolStats::ExportStatsToCSV(Path);
+}
+
+static FAutoConsoleCommand PrintPoolStatsCmd(
+	TEXT("voxel.threadpool.Stats.Print"),
+	TEXT("Print the wait and run times of the voxel pools works, per task type"),
+	FConsoleCommandDelegate::CreateStatic(&FVoxelPoolStats::PrintStats));
+
+static FAutoConsoleCommand ResetPoolStatsCmd(
+	TEXT("voxel.threadpool.Stats.Reset"),
+	TEXT("Reset the voxel pools stats"),
+	FConsoleCommandDelegate::CreateStatic(&FVoxelPoolStats::Reset));
+
+static FAutoConsoleCommand ExportPoolStatsCmd(
+	TEXT("voxel.threadpool.Stats.ExportCSV"),
+	TEXT("Export the voxel pools stats to a CSV file. Args: [Path], defaults to the profiling directory"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ExportVoxelPoolStatsToCSV));
\ No newline at end of file
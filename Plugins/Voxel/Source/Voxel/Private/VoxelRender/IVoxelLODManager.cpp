@@ -28,7 +28,7 @@ FVoxelLODSettings::FVoxelLODSettings(
 		: false)
 	, MinDelayBetweenLODUpdates(InWorld->MinDelayBetweenLODUpdates)
 	, bEnableTransitions(InWorld->bEnableTransitions)
-	, bInvertTransitions(InWorld->RenderType == EVoxelRenderType::SurfaceNets)
+	, bInvertTransitions(FVoxelUtilities::UsesParentPositionTransitions(InWorld->RenderType))
 
 	, World(InWorld->GetWorld())
 {
@@ -86,8 +86,12 @@ FVoxelRendererSettingsBase::FVoxelRendererSettingsBase(
 	, ChunksDitheringDuration(InWorld->ChunksDitheringDuration)
 
 	, bOptimizeIndices(InWorld->bOptimizeIndices)
+	, MinDecimationLOD(InWorld->bDecimateMeshes ? InWorld->MinDecimationLOD : MAX_int32)
+	, DecimationMaxError(FMath::Max(0.f, InWorld->DecimationMaxError))
 	, MaxDistanceFieldLOD(InWorld->bGenerateDistanceFields ? InWorld->MaxDistanceFieldLOD : -1)
 	, bOneMaterialPerCubeSide(InWorld->MaterialConfig == EVoxelMaterialConfig::SingleIndex && InWorld->bOneMaterialPerCubeSide)
+	, bGreedyCubicMesher(InWorld->RenderType == EVoxelRenderType::Cubic && InWorld->bGreedyCubicMesher)
+	, DualContouringMaxError(FMath::Max(0.f, InWorld->DualContouringMaxError))
 	, bHalfPrecisionCoordinates(InWorld->bHalfPrecisionCoordinates)
 	, bInterpolateColors(InWorld->bInterpolateColors)
 	, bInterpolateUVs(InWorld->bInterpolateUVs)
@@ -108,6 +112,11 @@ FVoxelRendererSettingsBase::FVoxelRendererSettingsBase(
 	, bStaticWorld(InPlayType == EVoxelPlayType::Game
 		? InWorld->bStaticWorld
 		: false)
+	// Static worlds never update their chunks
+	, MeshCacheSize(bStaticWorld ? 0 : int64(FMath::Max(0.f, InWorld->MeshCacheSizeInMB) * (1 << 20)))
+	// Static worlds already free their meshes once uploaded
+	// Merged chunks meshes are also referenced by their cluster until the chunk is removed, so evicting them wouldn't free anything
+	, HiddenChunksMemoryBudget(bStaticWorld || bMergeChunks ? 0 : int64(FMath::Max(0.f, InWorld->HiddenChunksMemoryBudgetInMB) * (1 << 20)))
 
 	, PriorityDuration(InWorld->PriorityDuration)
 	, DynamicSettings(InWorld->GetRendererDynamicSettings())
@@ -137,7 +146,7 @@ IVoxelRenderer::IVoxelRenderer(const FVoxelRendererSettings& Settings)
 {
 }
 
-void IVoxelRenderer::SetInvokersPositions(const TArray<FIntVector>& NewInvokersPositions)
+void IVoxelRenderer::SetInvokersPositions(const TArray<FVoxelInvokerPosition>& NewInvokersPositions)
 {
 	while (InvokersPositions->GetMax() < NewInvokersPositions.Num())
 	{
@@ -7,6 +7,8 @@
 #include "IVoxelPool.h"
 #include "VoxelWorldInterface.h"
 #include "VoxelComponents/VoxelInvokerComponent.h"
+#include "VoxelDebug/VoxelDebugManager.h"
+#include "VoxelPriorityHandler.h"
 
 DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Chunk Updates"), STAT_VoxelChunkUpdates, STATGROUP_Voxel);
 
@@ -30,6 +32,7 @@ FVoxelDefaultLODManager::FVoxelDefaultLODManager(
 	, VoxelWorldInterface(VoxelWorldInterface)
 	, DynamicSettings(DynamicSettings)
 	, Task(MakeUnique<FVoxelRenderOctreeAsyncBuilder>(LODSettings.OctreeDepth, LODSettings.WorldBounds))
+	, PrefetchTask(MakeUnique<FVoxelRenderOctreeAsyncBuilder>(LODSettings.OctreeDepth, LODSettings.WorldBounds))
 {
 }
 
@@ -42,10 +45,28 @@ FVoxelDefaultLODManager::~FVoxelDefaultLODManager()
 		Task->CancelAndAutodelete();
 		Task.Release();
 	}
+	if (!PrefetchTask->IsDone())
+	{
+		PrefetchTask->CancelAndAutodelete();
+		PrefetchTask.Release();
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
+inline bool IsChunkVisible(const FVoxelRenderOctree& Octree, const FVoxelChunkUpdate& ChunkUpdate)
+{
+	const FVoxelRenderOctree* Ptr = &Octree;
+	while (Ptr->Height > ChunkUpdate.LOD && Ptr->HasChildren())
+	{
+		Ptr = &Ptr->GetChild(ChunkUpdate.Bounds.Min);
+	}
+	return
+		Ptr->Height == ChunkUpdate.LOD &&
+		Ptr->GetSettings().bVisible &&
+		Ptr->GetSettings().TransitionsMask == ChunkUpdate.NewSettings.TransitionsMask;
+}
+
 inline FIntBox GetBoundsToUpdate(const FIntBox& Bounds)
 {
 	// For normals etc
@@ -152,6 +173,7 @@ void FVoxelDefaultLODManager::Tick(float DeltaTime)
 
 			INC_DWORD_STAT_BY(STAT_VoxelChunkUpdates, Task->ChunkUpdates.Num());
 			Settings.Renderer->UpdateLODs(Octree->UpdateIndex, Task->ChunkUpdates);
+			Settings.Renderer->Settings.DebugManager->ReportRenderOctreeUpdate(LastLODUpdateTime);
 
 			if (Settings.bStaticWorld)
 			{
@@ -165,6 +187,40 @@ void FVoxelDefaultLODManager::Tick(float DeltaTime)
 		}
 		bAsyncTaskWorking = false;
 	}
+
+	if (bPrefetchTaskWorking && PrefetchTask->IsDone())
+	{
+		VOXEL_SCOPE_COUNTER("OnPrefetchTaskFinished");
+
+		if (PrefetchTask->NewOctree.IsValid())
+		{
+			ensure(!PrefetchTask->OctreeToDelete.IsValid());
+			PrefetchTask->OctreeToDelete = MoveTemp(PrefetchOctree);
+
+			PrefetchOctree = PrefetchTask->NewOctree;
+
+			TArray<FVoxelChunkUpdate> ChunkUpdates = PrefetchTask->ChunkUpdates;
+			if (Octree.IsValid())
+			{
+				for (auto& ChunkUpdate : ChunkUpdates)
+				{
+					// No need to prefetch chunks that are already meshed by the renderer
+					if (ChunkUpdate.NewSettings.bVisible && IsChunkVisible(*Octree, ChunkUpdate))
+					{
+						ChunkUpdate.NewSettings.bVisible = false;
+					}
+				}
+			}
+			Settings.Renderer->PrefetchChunks(ChunkUpdates);
+		}
+		bPrefetchTaskWorking = false;
+	}
+
+	if (QueuedPrefetchSettings.IsValid() && PrefetchTask->IsDone())
+	{
+		const TUniquePtr<FVoxelRenderOctreeSettings> PrefetchSettings = MoveTemp(QueuedPrefetchSettings);
+		UpdatePrefetch(*PrefetchSettings);
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -200,6 +256,17 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 				bNeedUpdate = true;
 				break;
 			}
+
+			// Also update if the predicted path changed
+			const FIntVector* OldPrefetchPosition = InvokerComponentsPrefetchPositions.Find(Invoker);
+			FIntVector NewPrefetchPosition;
+			const bool bPrefetch = GetPrefetchPosition(*Invoker, NewPrefetchPosition);
+			if (bPrefetch != (OldPrefetchPosition != nullptr) ||
+				(bPrefetch && FVoxelUtilities::SquaredSize(*OldPrefetchPosition - NewPrefetchPosition) > Threshold))
+			{
+				bNeedUpdate = true;
+				break;
+			}
 		}
 	}
 
@@ -212,15 +279,43 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 
 		InvokerComponents = NewInvokerComponents;
 		InvokerComponentsLocalPositions.Reset();
+		InvokerComponentsPrefetchPositions.Reset();
 
 		for (auto& Invoker : NewInvokerComponents)
 		{
 			const auto LocalPosition = VoxelWorldInterface->GlobalToLocal(Invoker->GetPosition());
 			InvokerComponentsLocalPositions.Add(Invoker, LocalPosition);
+
+			FIntVector PrefetchPosition;
+			if (GetPrefetchPosition(*Invoker, PrefetchPosition))
+			{
+				InvokerComponentsPrefetchPositions.Add(Invoker, PrefetchPosition);
+			}
+		}
+	}
+
+	// Always update the invokers positions used for priorities, as the views can change without triggering a LOD update
+	{
+		TArray<FVoxelInvokerPosition> InvokersPositions;
+		for (auto& It : InvokerComponentsLocalPositions)
+		{
+			FVoxelInvokerPosition InvokerPosition;
+			InvokerPosition.Position = It.Value;
+
+			auto* Invoker = It.Key.Get();
+			FVector ViewDirection;
+			float ViewFOV;
+			if (Invoker && Invoker->bPrioritizeChunksInView && Invoker->GetView(ViewDirection, ViewFOV))
+			{
+				// The voxel world can be rotated
+				const FVector GlobalPosition = Invoker->GetPosition();
+				InvokerPosition.ViewDirection = (VoxelWorldInterface->GlobalToLocalFloat(GlobalPosition + ViewDirection) - VoxelWorldInterface->GlobalToLocalFloat(GlobalPosition)).GetSafeNormal();
+				InvokerPosition.ViewHalfFOV = FMath::DegreesToRadians(FMath::Clamp(ViewFOV, 1.f, 179.f) / 2);
+				InvokerPosition.OutOfViewDistanceMultiplier = FMath::Max(Invoker->OutOfViewDistanceMultiplier, 1.f);
+			}
+			InvokersPositions.Add(InvokerPosition);
 		}
-		TArray<FIntVector> Array;
-		InvokerComponentsLocalPositions.GenerateValueArray(Array);
-		Settings.Renderer->SetInvokersPositions(Array);
+		Settings.Renderer->SetInvokersPositions(InvokersPositions);
 	}
 
 	const double Time = FPlatformTime::Seconds();
@@ -292,6 +387,68 @@ void FVoxelDefaultLODManager::UpdateLODs()
 	Task->Init(OctreeSettings, Octree);
 	Settings.Pool->QueueTask(EVoxelTaskType::RenderOctree, Task.Get());
 	bAsyncTaskWorking = true;
+
+	UpdatePrefetch(OctreeSettings);
+}
+
+void FVoxelDefaultLODManager::UpdatePrefetch(const FVoxelRenderOctreeSettings& OctreeSettings)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!PrefetchTask->IsDone())
+	{
+		// Never delay the LOD updates: start the prefetch once the previous one is done
+		QueuedPrefetchSettings = MakeUnique<FVoxelRenderOctreeSettings>(OctreeSettings);
+		return;
+	}
+
+	FVoxelRenderOctreeSettings PrefetchSettings = OctreeSettings;
+	PrefetchSettings.Invokers.Reset();
+
+	if (OctreeSettings.bEnableRender)
+	{
+		for (auto& It : InvokerComponentsPrefetchPositions)
+		{
+			FVoxelInvoker Invoker{};
+			Invoker.Position = It.Value;
+			Invoker.bUseForLODs = true;
+			PrefetchSettings.Invokers.Add(Invoker);
+		}
+	}
+
+	if (PrefetchSettings.Invokers.Num() == 0)
+	{
+		if (PrefetchOctree.IsValid())
+		{
+			Settings.Renderer->CancelPrefetch();
+			PrefetchOctree.Reset();
+			PrefetchTask->NewOctree.Reset();
+			PrefetchTask->OldOctree.Reset();
+			PrefetchTask->OctreeToDelete.Reset();
+		}
+		return;
+	}
+
+	// Only the visible chunks are prefetched
+	PrefetchSettings.bEnableCollisions = false;
+	PrefetchSettings.bEnableNavmesh = false;
+	PrefetchSettings.bEnableTessellation = false;
+
+	PrefetchTask->Init(PrefetchSettings, PrefetchOctree);
+	Settings.Pool->QueueTask(EVoxelTaskType::RenderOctree, PrefetchTask.Get());
+	bPrefetchTaskWorking = true;
+}
+
+bool FVoxelDefaultLODManager::GetPrefetchPosition(const UVoxelInvokerComponent& Invoker, FIntVector& OutPosition) const
+{
+	// The prefetched chunks are stored in the mesh cache
+	if (Settings.Renderer->Settings.MeshCacheSize <= 0 || !Invoker.bEnablePrefetch || !Invoker.bUseForLODs || !Invoker.IsLocalInvoker())
+	{
+		return false;
+	}
+
+	OutPosition = VoxelWorldInterface->GlobalToLocal(Invoker.GetPosition() + Invoker.GetVelocity() * Invoker.PrefetchTime);
+	return true;
 }
 
 uint64 FVoxelDefaultLODManager::GetSquaredDistance(float DistanceInCm) const
@@ -9,6 +9,7 @@
 
 class FVoxelRenderOctreeAsyncBuilder;
 class FVoxelRenderOctree;
+struct FVoxelRenderOctreeSettings;
 class UVoxelInvokerComponent;
 class AVoxelWorldInterface;
 
@@ -77,6 +78,15 @@ private:
 	TMap<TWeakObjectPtr<UVoxelInvokerComponent>, FIntVector> InvokerComponentsLocalPositions;
 	TArray<TWeakObjectPtr<UVoxelInvokerComponent>> InvokerComponents;
 
+	// Octree built from the invokers predicted positions, to mesh chunks ahead of time
+	TUniquePtr<FVoxelRenderOctreeAsyncBuilder> PrefetchTask;
+	TVoxelSharedPtr<FVoxelRenderOctree> PrefetchOctree;
+	// Only invokers with bEnablePrefetch
+	TMap<TWeakObjectPtr<UVoxelInvokerComponent>, FIntVector> InvokerComponentsPrefetchPositions;
+	bool bPrefetchTaskWorking = false;
+	// Set when the LODs were updated while the prefetch task was still working
+	TUniquePtr<FVoxelRenderOctreeSettings> QueuedPrefetchSettings;
+
 	bool bAsyncTaskWorking = false;
 	bool bLODUpdateQueued = true;
 	double LastLODUpdateTime = 0;
@@ -84,5 +94,7 @@ private:
 
 	void UpdateInvokers();
 	void UpdateLODs();
+	void UpdatePrefetch(const FVoxelRenderOctreeSettings& OctreeSettings);
+	bool GetPrefetchPosition(const UVoxelInvokerComponent& Invoker, FIntVector& OutPosition) const;
 	uint64 GetSquaredDistance(float DistanceInCm) const;
 };
\ No newline at end of file
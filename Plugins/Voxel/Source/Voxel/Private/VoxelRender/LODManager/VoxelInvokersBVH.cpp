@@ -0,0 +1,143 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelInvokersBVH.h"
+
+static constexpr int32 VoxelInvokersBVHMaxElementsPerLeaf = 4;
+
+void FVoxelInvokersBVH::Build(TArray<FElement>&& InElements)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	Elements = MoveTemp(InElements);
+	Nodes.Reset();
+
+	if (Elements.Num() > 0)
+	{
+		Nodes.AddDefaulted();
+		BuildNode(0, 0, Elements.Num());
+	}
+}
+
+void FVoxelInvokersBVH::BuildNode(int32 NodeIndex, int32 FirstElement, int32 NumElements)
+{
+	check(NumElements > 0);
+
+	FNode Node;
+	Node.Min = FIntVector(MAX_int32);
+	Node.Max = FIntVector(MIN_int32);
+	for (int32 Index = FirstElement; Index < FirstElement + NumElements; Index++)
+	{
+		const FElement& Element = Elements[Index];
+		Node.Min = FVoxelUtilities::ComponentMin(Node.Min, Element.Position);
+		Node.Max = FVoxelUtilities::ComponentMax(Node.Max, Element.Position);
+		Node.MaxSquaredRange = FMath::Max(Node.MaxSquaredRange, Element.SquaredRange);
+	}
+
+	if (NumElements <= VoxelInvokersBVHMaxElementsPerLeaf)
+	{
+		Node.FirstElement = FirstElement;
+		Node.NumElements = NumElements;
+		Nodes[NodeIndex] = Node;
+		return;
+	}
+
+	// Median split along the largest axis
+	const FIntVector Size = Node.Max - Node.Min;
+	const int32 Axis = Size.X >= Size.Y && Size.X >= Size.Z ? 0 : Size.Y >= Size.Z ? 1 : 2;
+	Sort(Elements.GetData() + FirstElement, NumElements, [&](const FElement& A, const FElement& B) { return A.Position[Axis] < B.Position[Axis]; });
+
+	Node.FirstChild = Nodes.Num();
+	Nodes.AddDefaulted(2);
+	Nodes[NodeIndex] = Node;
+
+	const int32 NumFirstHalf = NumElements / 2;
+	BuildNode(Node.FirstChild, FirstElement, NumFirstHalf);
+	BuildNode(Node.FirstChild + 1, FirstElement + NumFirstHalf, NumElements - NumFirstHalf);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+static void BenchmarkInvokersBVH()
+{
+	const int32 WorldSize = 1 << 16;
+	const int32 NumQueries = 100000;
+	const uint64 SquaredCollisionsRange = FMath::Square<uint64>(256);
+
+	FRandomStream Stream(0);
+
+	TArray<FIntBox> Queries;
+	for (int32 Index = 0; Index < NumQueries; Index++)
+	{
+		// Same chunk sizes as the render octree: 32 << Height, with more small chunks
+		const int32 Height = FMath::Min(Stream.RandRange(0, 8), Stream.RandRange(0, 8));
+		const int32 Size = RENDER_CHUNK_SIZE << Height;
+		const FIntVector Min = FIntVector(
+			Stream.RandRange(-WorldSize, WorldSize - Size),
+			Stream.RandRange(-WorldSize, WorldSize - Size),
+			Stream.RandRange(-WorldSize, WorldSize - Size));
+		Queries.Add(FIntBox(Min, Min + Size));
+	}
+
+	for (int32 NumInvokers : { 1, 16, 256 })
+	{
+		TArray<FVoxelInvokersBVH::FElement> Elements;
+		for (int32 Index = 0; Index < NumInvokers; Index++)
+		{
+			FVoxelInvokersBVH::FElement Element;
+			Element.Position = FIntVector(
+				Stream.RandRange(-WorldSize, WorldSize),
+				Stream.RandRange(-WorldSize, WorldSize),
+				Stream.RandRange(-WorldSize, WorldSize));
+			Element.SquaredRange = SquaredCollisionsRange;
+			Elements.Add(Element);
+		}
+
+		int32 NumHitsLinear = 0;
+		const double LinearStartTime = FPlatformTime::Seconds();
+		for (auto& Query : Queries)
+		{
+			for (auto& Element : Elements)
+			{
+				if (Query.ComputeSquaredDistanceFromBoxToPoint<uint64>(Element.Position) < Element.SquaredRange)
+				{
+					NumHitsLinear++;
+					break;
+				}
+			}
+		}
+		const double LinearTime = FPlatformTime::Seconds() - LinearStartTime;
+
+		const double BuildStartTime = FPlatformTime::Seconds();
+		FVoxelInvokersBVH BVH;
+		BVH.Build(MoveTemp(Elements));
+		const double BuildTime = FPlatformTime::Seconds() - BuildStartTime;
+
+		int32 NumHitsBVH = 0;
+		const double BVHStartTime = FPlatformTime::Seconds();
+		for (auto& Query : Queries)
+		{
+			if (BVH.AnyElement(Query, MAX_uint64, [&](auto& Element, uint64 SquaredDistance) { return SquaredDistance < Element.SquaredRange; }))
+			{
+				NumHitsBVH++;
+			}
+		}
+		const double BVHTime = FPlatformTime::Seconds() - BVHStartTime;
+
+		ensure(NumHitsLinear == NumHitsBVH);
+
+		UE_LOG(LogVoxel, Log, TEXT("Invokers BVH benchmark: %d invokers, %d queries: linear: %fms; BVH: %fms (build: %fms); %d hits"),
+			NumInvokers,
+			NumQueries,
+			LinearTime * 1000,
+			BVHTime * 1000,
+			BuildTime * 1000,
+			NumHitsBVH);
+	}
+}
+
+static FAutoConsoleCommand BenchmarkInvokersBVHCmd(
+	TEXT("voxel.renderer.BenchmarkInvokersBVH"),
+	TEXT("Compare the render octree invokers queries with and without the invokers BVH, for 1, 16 and 256 invokers"),
+	FConsoleCommandDelegate::CreateStatic(&BenchmarkInvokersBVH));
\ No newline at end of file
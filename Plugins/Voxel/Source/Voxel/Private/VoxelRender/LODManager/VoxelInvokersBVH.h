@@ -0,0 +1,106 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IntBox.h"
+#include "VoxelGlobals.h"
+
+// Bounding volume hierarchy of invokers positions, to only check the invokers close to a chunk
+// Built once per render octree update, one per invoker purpose
+class FVoxelInvokersBVH
+{
+public:
+	struct FElement
+	{
+		FIntVector Position = FIntVector(0);
+		// Max distance at which this element can be queried
+		uint64 SquaredRange = MAX_uint64;
+	};
+
+	void Build(TArray<FElement>&& InElements);
+
+	inline int32 Num() const
+	{
+		return Elements.Num();
+	}
+
+	// Calls Lambda(Element, SquaredDistance) for the elements with SquaredDistance <= Min(MaxSquaredDistance, Element.SquaredRange),
+	// SquaredDistance being the distance from Bounds to the element position
+	// Returns true as soon as Lambda returns true
+	template<typename T>
+	bool AnyElement(const FIntBox& Bounds, uint64 MaxSquaredDistance, T Lambda) const
+	{
+		if (Nodes.Num() == 0)
+		{
+			return false;
+		}
+
+		TArray<int32, TInlineAllocator<64>> Stack;
+		Stack.Add(0);
+		while (Stack.Num() > 0)
+		{
+			const FNode& Node = Nodes[Stack.Pop(false)];
+			if (GetSquaredDistance(Bounds, Node) > FMath::Min(MaxSquaredDistance, Node.MaxSquaredRange))
+			{
+				continue;
+			}
+
+			if (Node.FirstChild == -1)
+			{
+				for (int32 Index = Node.FirstElement; Index < Node.FirstElement + Node.NumElements; Index++)
+				{
+					const FElement& Element = Elements[Index];
+					const uint64 SquaredDistance = Bounds.ComputeSquaredDistanceFromBoxToPoint<uint64>(Element.Position);
+					if (SquaredDistance <= FMath::Min(MaxSquaredDistance, Element.SquaredRange) && Lambda(Element, SquaredDistance))
+					{
+						return true;
+					}
+				}
+			}
+			else
+			{
+				Stack.Add(Node.FirstChild);
+				Stack.Add(Node.FirstChild + 1);
+			}
+		}
+		return false;
+	}
+
+private:
+	struct FNode
+	{
+		// Bounds of the elements positions, inclusive
+		FIntVector Min;
+		FIntVector Max;
+		uint64 MaxSquaredRange = 0;
+
+		// -1 for leaves. The second child is FirstChild + 1
+		int32 FirstChild = -1;
+		int32 FirstElement = 0;
+		int32 NumElements = 0;
+	};
+
+	TArray<FElement> Elements;
+	TArray<FNode> Nodes;
+
+	void BuildNode(int32 NodeIndex, int32 FirstElement, int32 NumElements);
+
+	// Lower bound of the distance from Bounds to any element of Node
+	FORCEINLINE static uint64 GetSquaredDistance(const FIntBox& Bounds, const FNode& Node)
+	{
+		uint64 SquaredDistance = 0;
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			if (Node.Max[Axis] < Bounds.Min[Axis])
+			{
+				SquaredDistance += FMath::Square<uint64>(int64(Bounds.Min[Axis]) - Node.Max[Axis]);
+			}
+			else if (Node.Min[Axis] > Bounds.Max[Axis])
+			{
+				SquaredDistance += FMath::Square<uint64>(int64(Node.Min[Axis]) - Bounds.Max[Axis]);
+			}
+		}
+		return SquaredDistance;
+	}
+};
\ No newline at end of file
@@ -98,10 +98,20 @@ void FVoxelRenderOctreeAsyncBuilder::DoWork()
 		LOG_TIME("Cloning octree");
 	}
 
+	{
+		VOXEL_SCOPE_COUNTER("Building invokers BVHs");
+		BuildInvokersBVHs();
+		LOG_TIME("Building invokers BVHs");
+	}
+
+	FVoxelRenderOctreeInvokersDelta InvokersDelta;
+	const bool bUseInvokersDelta = ComputeInvokersDelta(InvokersDelta);
+
 	{
 		VOXEL_SCOPE_COUNTER("ResetDivisionType");
-		NewOctree->ResetDivisionType();
+		NewOctree->ResetDivisionType(bUseInvokersDelta ? &InvokersDelta : nullptr);
 		LOG_TIME("ResetDivisionType");
+		Log += "; Invokers delta: " + (bUseInvokersDelta ? FString::FromInt(InvokersDelta.Invokers.Num()) : FString("full update"));
 	}
 
 	bool bChanged;
@@ -177,6 +187,11 @@ void FVoxelRenderOctreeAsyncBuilder::DoWork()
 	{
 		NewOctree.Reset();
 	}
+	else
+	{
+		PreviousOctree = NewOctree.Get();
+		PreviousOctreeSettings = OctreeSettings;
+	}
 
 	LOG_TIME_IMPL("Total time working", WorkStartTime);
 }
@@ -186,6 +201,133 @@ uint32 FVoxelRenderOctreeAsyncBuilder::GetPriority() const
 	return 0;
 }
 
+bool FVoxelRenderOctreeAsyncBuilder::ComputeInvokersDelta(FVoxelRenderOctreeInvokersDelta& OutInvokersDelta) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// The cached queries are only valid if we are updating the octree we last built, with the same distances
+	if (!OldOctree.IsValid() ||
+		OldOctree.Get() != PreviousOctree ||
+		OctreeSettings.SquaredLODsDistances != PreviousOctreeSettings.SquaredLODsDistances ||
+		OctreeSettings.SquaredTessellationDistance != PreviousOctreeSettings.SquaredTessellationDistance)
+	{
+		return false;
+	}
+
+	const auto& Invokers = OctreeSettings.Invokers;
+	const auto& PreviousInvokers = PreviousOctreeSettings.Invokers;
+
+	TBitArray<> UsedPreviousInvokers(false, PreviousInvokers.Num());
+	for (int32 Index = 0; Index < Invokers.Num(); Index++)
+	{
+		const FVoxelInvoker& Invoker = Invokers[Index];
+
+		// Invokers are usually in the same order
+		int32 PreviousIndex = -1;
+		if (PreviousInvokers.IsValidIndex(Index) && !UsedPreviousInvokers[Index] && PreviousInvokers[Index] == Invoker)
+		{
+			PreviousIndex = Index;
+		}
+		else
+		{
+			for (int32 OtherIndex = 0; OtherIndex < PreviousInvokers.Num(); OtherIndex++)
+			{
+				if (!UsedPreviousInvokers[OtherIndex] && PreviousInvokers[OtherIndex] == Invoker)
+				{
+					PreviousIndex = OtherIndex;
+					break;
+				}
+			}
+		}
+
+		if (PreviousIndex == -1)
+		{
+			// New invoker, or invoker that moved
+			OutInvokersDelta.Invokers.Add(Invoker);
+		}
+		else
+		{
+			UsedPreviousInvokers[PreviousIndex] = true;
+		}
+	}
+	for (int32 PreviousIndex = 0; PreviousIndex < PreviousInvokers.Num(); PreviousIndex++)
+	{
+		if (!UsedPreviousInvokers[PreviousIndex])
+		{
+			// Removed invoker, or previous position of an invoker that moved
+			OutInvokersDelta.Invokers.Add(PreviousInvokers[PreviousIndex]);
+		}
+	}
+
+	OutInvokersDelta.MaxSquaredLODsDistances.Reserve(OctreeSettings.SquaredLODsDistances.Num());
+	uint64 MaxSquaredLODsDistance = 0;
+	for (uint64 SquaredLODsDistance : OctreeSettings.SquaredLODsDistances)
+	{
+		MaxSquaredLODsDistance = FMath::Max(MaxSquaredLODsDistance, SquaredLODsDistance);
+		OutInvokersDelta.MaxSquaredLODsDistances.Add(MaxSquaredLODsDistance);
+	}
+	OutInvokersDelta.SquaredTessellationDistance = OctreeSettings.SquaredTessellationDistance;
+
+	return true;
+}
+
+void FVoxelRenderOctreeAsyncBuilder::BuildInvokersBVHs()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	TArray<FVoxelInvokersBVH::FElement> LODsInvokers;
+	TArray<FVoxelInvokersBVH::FElement> CollisionsInvokers;
+	TArray<FVoxelInvokersBVH::FElement> NavmeshInvokers;
+
+	for (auto& Invoker : OctreeSettings.Invokers)
+	{
+		if (Invoker.bUseForLODs)
+		{
+			// Range depends on the chunk height, given when querying
+			LODsInvokers.Add({ Invoker.Position, MAX_uint64 });
+		}
+		if (Invoker.bUseForCollisions)
+		{
+			CollisionsInvokers.Add({ Invoker.Position, Invoker.SquaredCollisionsRange });
+		}
+		if (Invoker.bUseForNavmesh)
+		{
+			NavmeshInvokers.Add({ Invoker.Position, Invoker.SquaredNavmeshRange });
+		}
+	}
+
+	OctreeSettings.LODsInvokers.Build(MoveTemp(LODsInvokers));
+	OctreeSettings.CollisionsInvokers.Build(MoveTemp(CollisionsInvokers));
+	OctreeSettings.NavmeshInvokers.Build(MoveTemp(NavmeshInvokers));
+}
+
+bool FVoxelRenderOctreeInvokersDelta::IsAffected(const FIntBox& Bounds, int32 Height) const
+{
+	for (auto& Invoker : Invokers)
+	{
+		uint64 SquaredRange = 0;
+		if (Invoker.bUseForLODs)
+		{
+			SquaredRange = FMath::Max(MaxSquaredLODsDistances[Height], SquaredTessellationDistance);
+		}
+		if (Invoker.bUseForCollisions)
+		{
+			SquaredRange = FMath::Max(SquaredRange, Invoker.SquaredCollisionsRange);
+		}
+		if (Invoker.bUseForNavmesh)
+		{
+			SquaredRange = FMath::Max(SquaredRange, Invoker.SquaredNavmeshRange);
+		}
+
+		// <= as the LODs query also checks if the invoker is inside the chunk
+		if (Bounds.ComputeSquaredDistanceFromBoxToPoint<uint64>(Invoker.Position) <= SquaredRange)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 #undef LOG_TIME
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -273,16 +415,27 @@ FVoxelRenderOctree::~FVoxelRenderOctree()
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void FVoxelRenderOctree::ResetDivisionType()
+void FVoxelRenderOctree::ResetDivisionType(const FVoxelRenderOctreeInvokersDelta* InvokersDelta, bool bCanBeAffected)
 {
 	ChunkSettings.OldDivisionType = ChunkSettings.DivisionType;
 	ChunkSettings.DivisionType = EDivisionType::Uninitialized;
 
+	// If a chunk isn't affected, none of its children are: no need to check them
+	if (bCanBeAffected)
+	{
+		bCanBeAffected = !InvokersDelta || InvokersDelta->IsAffected(OctreeBounds, Height);
+		if (bCanBeAffected)
+		{
+			// Will be recomputed when needed
+			ChunkSettings.InvokersQueries.bIsValid = false;
+		}
+	}
+
 	if (!!HasChildren())
 	{
 		for (auto& Child : GetChildren())
 		{
-			Child.ResetDivisionType();
+			Child.ResetDivisionType(InvokersDelta, bCanBeAffected);
 		}
 	}
 }
@@ -425,23 +578,6 @@ void FVoxelRenderOctree::DeleteChunks(TArray<FVoxelChunkUpdate>& ChunkUpdates)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-template<typename T1, typename T2>
-inline bool IsInRange(const FVoxelRenderOctree* This, const TArray<FVoxelInvoker>& Invokers, T1 SelectInvoker, T2 SelectRange)
-{
-	for (auto& Invoker : Invokers)
-	{
-		if (SelectInvoker(Invoker))
-		{
-			uint64 SquaredDistance = This->OctreeBounds.ComputeSquaredDistanceFromBoxToPoint<uint64>(Invoker.Position);
-			if (SquaredDistance < SelectRange(Invoker))
-			{
-				return true;
-			}
-		}
-	}
-	return false;
-}
-
 void FVoxelRenderOctree::GetUpdates(
 	uint32 InUpdateIndex,
 	bool bRecomputeTransitionMasks,
@@ -494,22 +630,14 @@ void FVoxelRenderOctree::GetUpdates(
 
 	NewSettings.bEnableCollisions =
 		Settings.bEnableCollisions &&
-		((Height == 0 &&
-			IsInRange(this, Settings.Invokers,
-				[](auto& X) { return X.bUseForCollisions; },
-				[](auto& X) { return X.SquaredCollisionsRange; })
-			)
+		((Height == 0 && GetInvokersQueries(Settings).bInCollisionsRange)
 			||
 			(bVisibleForCollisionsAndNavmesh && Settings.bComputeVisibleChunksCollisions && Height <= Settings.VisibleChunksCollisionsMaxLOD)
 			);
 
 	NewSettings.bEnableNavmesh =
 		Settings.bEnableNavmesh &&
-		((Height == 0 &&
-			IsInRange(this, Settings.Invokers,
-				[](auto& X) { return X.bUseForNavmesh; },
-				[](auto& X) { return X.SquaredNavmeshRange; })
-			)
+		((Height == 0 && GetInvokersQueries(Settings).bInNavmeshRange)
 			||
 			(bVisibleForCollisionsAndNavmesh && Settings.bComputeVisibleChunksNavmesh && Height <= Settings.VisibleChunksNavmeshMaxLOD)
 			);
@@ -517,9 +645,7 @@ void FVoxelRenderOctree::GetUpdates(
 	NewSettings.bEnableTessellation =
 		Settings.bEnableTessellation &&
 		NewSettings.bVisible &&
-		IsInRange(this, Settings.Invokers,
-			[](auto& X) { return X.bUseForLODs; },
-			[&](auto&) { return Settings.SquaredTessellationDistance; });
+		GetInvokersQueries(Settings).bInTessellationRange;
 
 	check(NewSettings.TransitionsMask == 0);
 	if (NewSettings.HasRenderChunk())
@@ -621,7 +747,7 @@ FORCEINLINE bool FVoxelRenderOctree::IsCanceled() const
 
 ///////////////////////////////////////////////////////////////////////////////
 
-bool FVoxelRenderOctree::ShouldSubdivideByDistance(const FVoxelRenderOctreeSettings& Settings) const
+bool FVoxelRenderOctree::ShouldSubdivideByDistance(const FVoxelRenderOctreeSettings& Settings)
 {
 	if (!Settings.bEnableRender)
 	{
@@ -644,22 +770,7 @@ bool FVoxelRenderOctree::ShouldSubdivideByDistance(const FVoxelRenderOctreeSetti
 		return true;
 	}
 
-	for (auto& Invoker : Settings.Invokers)
-	{
-		if (Invoker.bUseForLODs && OctreeBounds.Contains(Invoker.Position))
-		{
-			return true;
-		}
-	}
-
-	if (IsInRange(this, Settings.Invokers,
-		[](auto& X) { return X.bUseForLODs; },
-		[&](auto&) { return Settings.SquaredLODsDistances[Height]; }))
-	{
-		return true;
-	}
-
-	return false;
+	return GetInvokersQueries(Settings).bSubdivideByDistance;
 }
 
 bool FVoxelRenderOctree::ShouldSubdivideByNeighbors(const FVoxelRenderOctreeSettings& Settings) const
@@ -697,7 +808,7 @@ bool FVoxelRenderOctree::ShouldSubdivideByNeighbors(const FVoxelRenderOctreeSett
 	return false;
 }
 
-bool FVoxelRenderOctree::ShouldSubdivideByOthers(const FVoxelRenderOctreeSettings& Settings) const
+bool FVoxelRenderOctree::ShouldSubdivideByOthers(const FVoxelRenderOctreeSettings& Settings)
 {
 	if (!Settings.bEnableCollisions && !Settings.bEnableNavmesh)
 	{
@@ -712,18 +823,37 @@ bool FVoxelRenderOctree::ShouldSubdivideByOthers(const FVoxelRenderOctreeSetting
 		return false;
 	}
 
-	if ((Settings.bEnableCollisions && IsInRange(this, Settings.Invokers,
-		[](auto& X) { return X.bUseForCollisions; },
-		[](auto& X) { return X.SquaredCollisionsRange; }))
-		||
-		(Settings.bEnableNavmesh &&	IsInRange(this, Settings.Invokers,
-			[](auto& X) { return X.bUseForNavmesh; },
-			[](auto& X) { return X.SquaredNavmeshRange; })))
+	const FInvokersQueries& Queries = GetInvokersQueries(Settings);
+	return
+		(Settings.bEnableCollisions && Queries.bInCollisionsRange) ||
+		(Settings.bEnableNavmesh && Queries.bInNavmeshRange);
+}
+
+const FVoxelRenderOctree::FInvokersQueries& FVoxelRenderOctree::GetInvokersQueries(const FVoxelRenderOctreeSettings& Settings)
+{
+	FInvokersQueries& Queries = ChunkSettings.InvokersQueries;
+	if (Queries.bIsValid)
 	{
-		return true;
+		return Queries;
 	}
 
-	return false;
+	Queries.bIsValid = true;
+
+	const uint64 SquaredLODsDistance = Settings.SquaredLODsDistances[Height];
+	Queries.bSubdivideByDistance = Settings.LODsInvokers.AnyElement(OctreeBounds, SquaredLODsDistance, [&](auto& Invoker, uint64 SquaredDistance)
+	{
+		return SquaredDistance < SquaredLODsDistance || OctreeBounds.Contains(Invoker.Position);
+	});
+	Queries.bInTessellationRange = Settings.LODsInvokers.AnyElement(OctreeBounds, Settings.SquaredTessellationDistance, [&](auto& Invoker, uint64 SquaredDistance)
+	{
+		return SquaredDistance < Settings.SquaredTessellationDistance;
+	});
+
+	const auto IsInRange = [](auto& Invoker, uint64 SquaredDistance) { return SquaredDistance < Invoker.SquaredRange; };
+	Queries.bInCollisionsRange = Settings.CollisionsInvokers.AnyElement(OctreeBounds, MAX_uint64, IsInRange);
+	Queries.bInNavmeshRange = Settings.NavmeshInvokers.AnyElement(OctreeBounds, MAX_uint64, IsInRange);
+
+	return Queries;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
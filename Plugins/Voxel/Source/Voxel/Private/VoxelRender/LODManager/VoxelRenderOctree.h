@@ -9,6 +9,7 @@
 #include "VoxelSimpleOctree.h"
 #include "VoxelAsyncWork.h"
 #include "VoxelRender/VoxelChunkToUpdate.h"
+#include "VoxelInvokersBVH.h"
 
 #include "HAL/ThreadSafeBool.h"
 
@@ -28,6 +29,17 @@ struct FVoxelInvoker
 
 	bool bUseForNavmesh;
 	uint64 SquaredNavmeshRange;
+
+	inline bool operator==(const FVoxelInvoker& Other) const
+	{
+		return
+			Position == Other.Position &&
+			bUseForLODs == Other.bUseForLODs &&
+			bUseForCollisions == Other.bUseForCollisions &&
+			SquaredCollisionsRange == Other.SquaredCollisionsRange &&
+			bUseForNavmesh == Other.bUseForNavmesh &&
+			SquaredNavmeshRange == Other.SquaredNavmeshRange;
+	}
 };
 
 struct FVoxelRenderOctreeSettings
@@ -57,6 +69,24 @@ struct FVoxelRenderOctreeSettings
 
 	bool bEnableTessellation;
 	uint64 SquaredTessellationDistance;
+
+	// Built by FVoxelRenderOctreeAsyncBuilder from Invokers, one per purpose
+	FVoxelInvokersBVH LODsInvokers;
+	FVoxelInvokersBVH CollisionsInvokers;
+	FVoxelInvokersBVH NavmeshInvokers;
+};
+
+// Invokers added, removed or moved since the previous build
+// The invokers queries of a chunk can only have changed if one of these invokers is in range
+struct FVoxelRenderOctreeInvokersDelta
+{
+	TArray<FVoxelInvoker> Invokers;
+	// Max of SquaredLODsDistances[0..Height]: children are queried with their own distances
+	TArray<uint64> MaxSquaredLODsDistances;
+	uint64 SquaredTessellationDistance = 0;
+
+	// Conservative: if false for a chunk, it's also false for all its children
+	bool IsAffected(const FIntBox& Bounds, int32 Height) const;
 };
 
 class FVoxelRenderOctreeAsyncBuilder : public FVoxelAsyncWork
@@ -92,6 +122,14 @@ private:
 	double Counter = 0;
 	FString Log;
 	int32 NumberOfChunks = 0;
+
+	// Octree built by the last successful build, and the settings used for it
+	// Used to only recompute the invokers queries affected by the invokers that changed
+	const FVoxelRenderOctree* PreviousOctree = nullptr;
+	FVoxelRenderOctreeSettings PreviousOctreeSettings{};
+
+	bool ComputeInvokersDelta(FVoxelRenderOctreeInvokersDelta& OutInvokersDelta) const;
+	void BuildInvokersBVHs();
 };
 
 class FVoxelRenderOctree : public TSimpleVoxelOctree<RENDER_CHUNK_SIZE, FVoxelRenderOctree>
@@ -113,11 +151,23 @@ public:
 		ByOthers = 3
 	};
 
+	// Results of the queries depending on the invokers positions
+	// Kept across builds, and only invalidated if an invoker that changed can affect them
+	struct FInvokersQueries
+	{
+		bool bIsValid = false;
+		bool bSubdivideByDistance = false;
+		bool bInCollisionsRange = false;
+		bool bInNavmeshRange = false;
+		bool bInTessellationRange = false;
+	};
+
 	struct FChunkSettings
 	{
 		FVoxelChunkSettings Settings{};
 		EDivisionType DivisionType = EDivisionType::Uninitialized;
 		EDivisionType OldDivisionType = EDivisionType::Uninitialized;
+		FInvokersQueries InvokersQueries;
 	};
 	FChunkSettings ChunkSettings;
 	int32 CurrentChunksCount = 0;
@@ -133,7 +183,8 @@ public:
 
 	~FVoxelRenderOctree();
 
-	void ResetDivisionType();
+	// If InvokersDelta is null, all the invokers queries are recomputed
+	void ResetDivisionType(const FVoxelRenderOctreeInvokersDelta* InvokersDelta, bool bCanBeAffected = true);
 	bool UpdateSubdividedByDistance(const FVoxelRenderOctreeSettings& Settings);
 	bool UpdateSubdividedByNeighbors(const FVoxelRenderOctreeSettings& Settings);
 	void ReuseOldNeighbors();
@@ -153,9 +204,11 @@ public:
 	bool IsCanceled() const;
 
 private:
-	bool ShouldSubdivideByDistance(const FVoxelRenderOctreeSettings& Settings) const;
+	bool ShouldSubdivideByDistance(const FVoxelRenderOctreeSettings& Settings);
 	bool ShouldSubdivideByNeighbors(const FVoxelRenderOctreeSettings& Settings) const;
-	bool ShouldSubdivideByOthers(const FVoxelRenderOctreeSettings& Settings) const;
+	bool ShouldSubdivideByOthers(const FVoxelRenderOctreeSettings& Settings);
+
+	const FInvokersQueries& GetInvokersQueries(const FVoxelRenderOctreeSettings& Settings);
 
 	const FVoxelRenderOctree* GetVisibleAdjacentChunk(EVoxelDirection::Type Direction, int32 Index) const;
 
@@ -2,6 +2,7 @@
 
 #include "VoxelRender/Meshers/VoxelCubicMesher.h"
 #include "VoxelRender/Meshers/VoxelMesherUtilities.h"
+#include "VoxelRender/VoxelChunkMesh.h"
 #include "VoxelRender/IVoxelRenderer.h"
 
 struct FVoxelCubicFullVertex : FVoxelMesherVertex
@@ -68,7 +69,8 @@ template<EVoxelDirection::Type Direction, typename TVertex, typename TMesher>
 FORCEINLINE void AddFace(
 	TMesher& Mesher, int32 Step, FVoxelMaterial Material,
 	int32 X, int32 Y, int32 Z,
-	TArray<uint32>& Indices, TArray<TVertex>& Vertices)
+	TArray<uint32>& Indices, TArray<TVertex>& Vertices,
+	const FIntVector& FaceSize = FIntVector(1))
 {
 	if (TVertex::bComputeMaterial && Mesher.Settings.bOneMaterialPerCubeSide)
 	{
@@ -103,6 +105,8 @@ FORCEINLINE void AddFace(
 	 * 3 --- 2
 	 *
 	 * Triangles: 0 1 2, 0 2 3
+	 *
+	 * FaceSize is the size of the quad in voxels, used by the greedy mesher. Its component along the normal must be 1
 	 */
 
 	switch (Direction)
@@ -161,7 +165,7 @@ FORCEINLINE void AddFace(
 	int32 PositionsIndices[4];
 	for (int32 Index = 0; Index < 4; Index++)
 	{
-		const FVector VertexPositionInCube = Positions[Index];
+		const FVector VertexPositionInCube = Positions[Index] * FVector(FaceSize);
 		const FVector VertexPosition = (VertexPositionInCube + FVector(X, Y, Z)) * Step;
 
 		TVertex Vertex;
@@ -203,11 +207,13 @@ FORCEINLINE void AddFace(
 			}
 			else if (Mesher.Settings.UVConfig == EVoxelUVConfig::PackWorldUpInUVs)
 			{
+				checkVoxelSlow(FaceSize == FIntVector(1));
 				TextureCoordinate = FVoxelMesherUtilities::GetUVs(Mesher, FVector(X, Y, Z));
 			}
 			else
 			{
 				check(Mesher.Settings.UVConfig == EVoxelUVConfig::PerVoxelUVs);
+				// Merged faces will have UVs going from 0 to FaceSize, tiling the texture once per voxel
 				const auto& V = VertexPositionInCube;
 				switch (Direction)
 				{
@@ -284,6 +290,11 @@ void FVoxelCubicMesher::CreateGeometryImpl(FVoxelMesherTimes& Times, TArray<uint
 	UnlockData();
 }
 
+FVoxelChunkMeshCachedValues FVoxelCubicMesher::GetCachedValues() const
+{
+	return { CachedValues.GetData(), FIntVector(-1), FIntVector(CUBIC_CHUNK_SIZE_WITH_NEIGHBORS) };
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -299,6 +310,13 @@ void FVoxelCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<
 	TVoxelQueryZone<FVoxelValue> QueryZone(GetBoundsToCheckIsEmptyOn(), FIntVector(CUBIC_CHUNK_SIZE_WITH_NEIGHBORS), LOD, CachedValues);
 	MESHER_TIME_VALUES(CUBIC_CHUNK_SIZE_WITH_NEIGHBORS * CUBIC_CHUNK_SIZE_WITH_NEIGHBORS * CUBIC_CHUNK_SIZE_WITH_NEIGHBORS, Data.Get<FVoxelValue>(QueryZone, LOD));
 
+	// Pack WorldUp UVs are computed per voxel, can't merge these faces
+	if (Settings.bGreedyCubicMesher && !(T::bComputeTextureCoordinate && Settings.UVConfig == EVoxelUVConfig::PackWorldUpInUVs))
+	{
+		CreateGreedyGeometry(Times, Indices, Vertices);
+		return;
+	}
+
 	{
 		VOXEL_SCOPE_COUNTER("Iteration");
 		for (int32 X = 0; X < RENDER_CHUNK_SIZE; X++)
@@ -344,6 +362,152 @@ void FVoxelCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<
 	}
 }
 
+template<typename T>
+void FVoxelCubicMesher::CreateGreedyGeometry(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// Faces flags & materials of every voxel in the chunk
+	TArray<uint8> Faces;
+	TArray<FVoxelMaterial> Materials;
+	Faces.SetNumUninitialized(RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE);
+	if (T::bComputeMaterial)
+	{
+		Materials.SetNumUninitialized(RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE);
+	}
+
+	{
+		VOXEL_SCOPE_COUNTER("Iteration");
+		for (int32 Z = 0; Z < RENDER_CHUNK_SIZE; Z++)
+		{
+			for (int32 Y = 0; Y < RENDER_CHUNK_SIZE; Y++)
+			{
+				for (int32 X = 0; X < RENDER_CHUNK_SIZE; X++)
+				{
+					const int32 Index = X + Y * RENDER_CHUNK_SIZE + Z * RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE;
+
+					const FVoxelValue Value = GetValue(X, Y, Z);
+					if (Value.IsEmpty())
+					{
+						Faces[Index] = 0;
+						continue;
+					}
+
+					const uint8 Flag =
+						(GetValue(X - 1, Y, Z).IsEmpty() << 0) |
+						(GetValue(X + 1, Y, Z).IsEmpty() << 1) |
+						(GetValue(X, Y - 1, Z).IsEmpty() << 2) |
+						(GetValue(X, Y + 1, Z).IsEmpty() << 3) |
+						(GetValue(X, Y, Z - 1).IsEmpty() << 4) |
+						(GetValue(X, Y, Z + 1).IsEmpty() << 5);
+
+					Faces[Index] = Flag;
+
+					if (T::bComputeMaterial && Flag)
+					{
+						Materials[Index] = MESHER_TIME_RETURN_MATERIALS(1, Accelerator->GetMaterial(
+							X + ChunkPosition.X,
+							Y + ChunkPosition.Y,
+							Z + ChunkPosition.Z,
+							LOD));
+					}
+				}
+			}
+		}
+	}
+
+	{
+		VOXEL_SCOPE_COUNTER("Merge Faces");
+		AddGreedyFaces<EVoxelDirection::XMin>(Faces, Materials, Indices, Vertices);
+		AddGreedyFaces<EVoxelDirection::XMax>(Faces, Materials, Indices, Vertices);
+		AddGreedyFaces<EVoxelDirection::YMin>(Faces, Materials, Indices, Vertices);
+		AddGreedyFaces<EVoxelDirection::YMax>(Faces, Materials, Indices, Vertices);
+		AddGreedyFaces<EVoxelDirection::ZMin>(Faces, Materials, Indices, Vertices);
+		AddGreedyFaces<EVoxelDirection::ZMax>(Faces, Materials, Indices, Vertices);
+	}
+}
+
+template<EVoxelDirection::Type Direction, typename T>
+void FVoxelCubicMesher::AddGreedyFaces(const TArray<uint8>& Faces, const TArray<FVoxelMaterial>& Materials, TArray<uint32>& Indices, TArray<T>& Vertices)
+{
+	// W is the axis of the normal, U and V the axes of the slice
+	constexpr int32 W =
+		(Direction == EVoxelDirection::XMin || Direction == EVoxelDirection::XMax) ? 0 :
+		(Direction == EVoxelDirection::YMin || Direction == EVoxelDirection::YMax) ? 1 : 2;
+	constexpr int32 U = W == 0 ? 1 : 0;
+	constexpr int32 V = W == 2 ? 1 : 2;
+
+	TStackArray<bool, RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE> Visited;
+
+	for (int32 Slice = 0; Slice < RENDER_CHUNK_SIZE; Slice++)
+	{
+		Visited.Memzero();
+
+		const auto GetIndex = [&](int32 LU, int32 LV)
+		{
+			FIntVector Position;
+			Position[W] = Slice;
+			Position[U] = LU;
+			Position[V] = LV;
+			return Position.X + Position.Y * RENDER_CHUNK_SIZE + Position.Z * RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE;
+		};
+		const auto CanMerge = [&](int32 LU, int32 LV, int32 StartIndex)
+		{
+			if (Visited[LU + LV * RENDER_CHUNK_SIZE]) return false;
+			const int32 Index = GetIndex(LU, LV);
+			if (!(Faces[Index] & Direction)) return false;
+			return !T::bComputeMaterial || Materials[Index] == Materials[StartIndex];
+		};
+
+		for (int32 LV = 0; LV < RENDER_CHUNK_SIZE; LV++)
+		{
+			for (int32 LU = 0; LU < RENDER_CHUNK_SIZE; LU++)
+			{
+				const int32 StartIndex = GetIndex(LU, LV);
+				if (Visited[LU + LV * RENDER_CHUNK_SIZE] || !(Faces[StartIndex] & Direction)) continue;
+
+				int32 SizeU = 1;
+				while (LU + SizeU < RENDER_CHUNK_SIZE && CanMerge(LU + SizeU, LV, StartIndex))
+				{
+					SizeU++;
+				}
+
+				int32 SizeV = 1;
+				while (LV + SizeV < RENDER_CHUNK_SIZE)
+				{
+					bool bCanMergeRow = true;
+					for (int32 Offset = 0; Offset < SizeU && bCanMergeRow; Offset++)
+					{
+						bCanMergeRow = CanMerge(LU + Offset, LV + SizeV, StartIndex);
+					}
+					if (!bCanMergeRow) break;
+					SizeV++;
+				}
+
+				for (int32 OffsetV = 0; OffsetV < SizeV; OffsetV++)
+				{
+					for (int32 OffsetU = 0; OffsetU < SizeU; OffsetU++)
+					{
+						Visited[(LU + OffsetU) + (LV + OffsetV) * RENDER_CHUNK_SIZE] = true;
+					}
+				}
+
+				FIntVector Position;
+				Position[W] = Slice;
+				Position[U] = LU;
+				Position[V] = LV;
+
+				FIntVector FaceSize(1);
+				FaceSize[U] = SizeU;
+				FaceSize[V] = SizeV;
+
+				const FVoxelMaterial Material = T::bComputeMaterial ? Materials[StartIndex] : FVoxelMaterial();
+				AddFace<Direction>(*this, Step, Material, Position.X, Position.Y, Position.Z, Indices, Vertices, FaceSize);
+			}
+		}
+	}
+}
+
 FORCEINLINE FVoxelValue FVoxelCubicMesher::GetValue(int32 X, int32 Y, int32 Z) const
 {
 	checkVoxelSlow(
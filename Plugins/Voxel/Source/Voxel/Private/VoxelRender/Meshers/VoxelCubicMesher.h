@@ -20,6 +20,7 @@ protected:
 	virtual FIntBox GetBoundsToLock() const override final;
 	virtual TVoxelSharedPtr<FVoxelChunkMesh> CreateFullChunkImpl(FVoxelMesherTimes& Times) override final;
 	virtual void CreateGeometryImpl(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<FVector>& Vertices) override final;
+	virtual FVoxelChunkMeshCachedValues GetCachedValues() const override final;
 
 private:
 	TUniquePtr<FVoxelConstDataAccelerator> Accelerator;
@@ -28,6 +29,11 @@ private:
 private:
 	template<typename T>
 	void CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices);
+	template<typename T>
+	void CreateGreedyGeometry(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices);
+	// Merge the Direction faces of each slice into maximal rectangles
+	template<EVoxelDirection::Type Direction, typename T>
+	void AddGreedyFaces(const TArray<uint8>& Faces, const TArray<FVoxelMaterial>& Materials, TArray<uint32>& Indices, TArray<T>& Vertices);
 
 private:
 	FVoxelValue GetValue(int32 X, int32 Y, int32 Z) const;
@@ -0,0 +1,606 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelRender/Meshers/VoxelDualContouringMesher.h"
+#include "VoxelRender/Meshers/VoxelMesherUtilities.h"
+#include "VoxelRender/VoxelChunkMesh.h"
+#include "VoxelRender/IVoxelRenderer.h"
+#include "VoxelData/VoxelDataUtilities.h"
+
+struct FVoxelDualContouringFullVertex : FVoxelMesherVertex
+{
+	static constexpr bool bComputeParentPosition = true;
+	static constexpr bool bComputeNormal = true;
+	static constexpr bool bComputeTextureCoordinate = true;
+	static constexpr bool bComputeMaterial = true;
+
+	FORCEINLINE void SetPosition(const FVector& InPosition)
+	{
+		Position = InPosition;
+	}
+	FORCEINLINE void SetParentPosition(const FVector& InParentPosition)
+	{
+		Tangent = FVoxelProcMeshTangent(InParentPosition, false);
+	}
+	FORCEINLINE void SetNormal(const FVector& InNormal)
+	{
+		Normal = InNormal;
+	}
+	FORCEINLINE void SetTextureCoordinate(const FVector2D& InTextureCoordinate)
+	{
+		TextureCoordinate = InTextureCoordinate;
+	}
+	FORCEINLINE void SetMaterial(const FVoxelMaterial& InMaterial)
+	{
+		Material = InMaterial;
+	}
+};
+static_assert(sizeof(FVoxelDualContouringFullVertex) == sizeof(FVoxelMesherVertex), "");
+
+struct FVoxelDualContouringGeometryVertex : FVector
+{
+	static constexpr bool bComputeParentPosition = false;
+	static constexpr bool bComputeNormal = false;
+	static constexpr bool bComputeTextureCoordinate = false;
+	static constexpr bool bComputeMaterial = false;
+
+	FORCEINLINE void SetPosition(const FVector& InPosition)
+	{
+		static_cast<FVector&>(*this) = InPosition;
+	}
+	FORCEINLINE void SetParentPosition(const FVector& InParentPosition)
+	{
+		checkVoxelSlow(false);
+	}
+	FORCEINLINE void SetNormal(const FVector& InNormal)
+	{
+		checkVoxelSlow(false);
+	}
+	FORCEINLINE void SetTextureCoordinate(const FVector2D& InTextureCoordinate)
+	{
+		checkVoxelSlow(false);
+	}
+	FORCEINLINE void SetMaterial(const FVoxelMaterial& InMaterial)
+	{
+		checkVoxelSlow(false);
+	}
+};
+static_assert(sizeof(FVoxelDualContouringGeometryVertex) == sizeof(FVector), "");
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelDualContouringQEF::Add(const FVector& Point, const FVector& Normal)
+{
+	const float Dot = Normal | Point;
+
+	AtA[0] += Normal.X * Normal.X;
+	AtA[1] += Normal.X * Normal.Y;
+	AtA[2] += Normal.X * Normal.Z;
+	AtA[3] += Normal.Y * Normal.Y;
+	AtA[4] += Normal.Y * Normal.Z;
+	AtA[5] += Normal.Z * Normal.Z;
+	AtB += Normal * Dot;
+	BtB += Dot * Dot;
+
+	MassPointSum += Point;
+	NormalSum += Normal;
+	NumPoints++;
+}
+
+void FVoxelDualContouringQEF::Add(const FVoxelDualContouringQEF& Other)
+{
+	for (int32 Index = 0; Index < 6; Index++)
+	{
+		AtA[Index] += Other.AtA[Index];
+	}
+	AtB += Other.AtB;
+	BtB += Other.BtB;
+
+	MassPointSum += Other.MassPointSum;
+	NormalSum += Other.NormalSum;
+	NumPoints += Other.NumPoints;
+}
+
+float FVoxelDualContouringQEF::GetError(const FVector& Position) const
+{
+	// xt AtA x - 2 xt AtB + BtB
+	const FVector AtAX(
+		AtA[0] * Position.X + AtA[1] * Position.Y + AtA[2] * Position.Z,
+		AtA[1] * Position.X + AtA[3] * Position.Y + AtA[4] * Position.Z,
+		AtA[2] * Position.X + AtA[4] * Position.Y + AtA[5] * Position.Z);
+	return FMath::Max(0.f, (Position | AtAX) - 2 * (Position | AtB) + BtB);
+}
+
+FVector FVoxelDualContouringQEF::Solve(const FBox& Bounds) const
+{
+	checkVoxelSlow(NumPoints > 0);
+
+	// Solve (AtA + Bias * I) X = AtB + Bias * MassPoint
+	// The bias pulls the vertex towards the mass point when the system is ill conditioned (eg flat surfaces)
+	constexpr float Bias = 0.05f;
+
+	const FVector MassPoint = GetMassPoint();
+
+	const float A00 = AtA[0] + Bias;
+	const float A01 = AtA[1];
+	const float A02 = AtA[2];
+	const float A11 = AtA[3] + Bias;
+	const float A12 = AtA[4];
+	const float A22 = AtA[5] + Bias;
+	const FVector B = AtB + Bias * MassPoint;
+
+	// Symmetric matrix: the adjugate is symmetric too
+	const float C00 = A11 * A22 - A12 * A12;
+	const float C01 = A02 * A12 - A01 * A22;
+	const float C02 = A01 * A12 - A02 * A11;
+	const float C11 = A00 * A22 - A02 * A02;
+	const float C12 = A01 * A02 - A00 * A12;
+	const float C22 = A00 * A11 - A01 * A01;
+
+	const float Determinant = A00 * C00 + A01 * C01 + A02 * C02;
+	if (FMath::Abs(Determinant) < KINDA_SMALL_NUMBER)
+	{
+		return ClampVector(MassPoint, Bounds.Min, Bounds.Max);
+	}
+
+	const FVector Position = FVector(
+		C00 * B.X + C01 * B.Y + C02 * B.Z,
+		C01 * B.X + C11 * B.Y + C12 * B.Z,
+		C02 * B.X + C12 * B.Y + C22 * B.Z) / Determinant;
+
+	return ClampVector(Position, Bounds.Min, Bounds.Max);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FIntBox FVoxelDualContouringMesher::GetBoundsToCheckIsEmptyOn() const
+{
+	return FIntBox(ChunkPosition - FIntVector(Step), ChunkPosition - FIntVector(Step) + DC_EXTENDED_CHUNK_SIZE * Step);
+}
+
+FIntBox FVoxelDualContouringMesher::GetBoundsToLock() const
+{
+	return GetBoundsToCheckIsEmptyOn();
+}
+
+TVoxelSharedPtr<FVoxelChunkMesh> FVoxelDualContouringMesher::CreateFullChunkImpl(FVoxelMesherTimes& Times)
+{
+	TArray<uint32> Indices;
+	TArray<FVoxelDualContouringFullVertex> Vertices;
+	CreateGeometryTemplate(Times, Indices, Vertices);
+
+	FVoxelMesherUtilities::SanitizeMesh(Indices, Vertices);
+
+	return MESHER_TIME_RETURN(CreateChunk, FVoxelMesherUtilities::CreateChunkFromVertices(
+		Settings,
+		MoveTemp(Indices),
+		MoveTemp(reinterpret_cast<TArray<FVoxelMesherVertex>&>(Vertices))));
+}
+
+void FVoxelDualContouringMesher::CreateGeometryImpl(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<FVector>& Vertices)
+{
+	CreateGeometryTemplate(Times, Indices, reinterpret_cast<TArray<FVoxelDualContouringGeometryVertex>&>(Vertices));
+}
+
+FVoxelChunkMeshCachedValues FVoxelDualContouringMesher::GetCachedValues() const
+{
+	return { CachedValues->GetData(), FIntVector(-1), FIntVector(DC_EXTENDED_CHUNK_SIZE) };
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename TVertex>
+void FVoxelDualContouringMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<TVertex>& Vertices)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	TVoxelQueryZone<FVoxelValue> QueryZone(GetBoundsToCheckIsEmptyOn(), FIntVector(DC_EXTENDED_CHUNK_SIZE), LOD, *CachedValues);
+	MESHER_TIME_VALUES(DC_EXTENDED_CHUNK_SIZE * DC_EXTENDED_CHUNK_SIZE * DC_EXTENDED_CHUNK_SIZE, Data.Get<FVoxelValue>(QueryZone, LOD));
+
+	Accelerator = MakeUnique<FVoxelConstDataAccelerator>(Data, GetBoundsToLock());
+
+	FindIntersections(Times);
+
+	FMemory::Memset(CellCollapsedIndices->GetData(), 0xFF, CellCollapsedIndices->Num() * CellCollapsedIndices->GetTypeSize());
+	if (Settings.DualContouringMaxError > 0)
+	{
+		CollapseCells();
+	}
+
+	{
+		VOXEL_SCOPE_COUNTER("Generate Vertices");
+
+		FMemory::Memset(CellVertexIndices->GetData(), 0xFF, CellVertexIndices->Num() * CellVertexIndices->GetTypeSize());
+
+		for (int32 LZ = 0; LZ < DC_CHUNK_SIZE; LZ++)
+		{
+			for (int32 LY = 0; LY < DC_CHUNK_SIZE; LY++)
+			{
+				for (int32 LX = 0; LX < DC_CHUNK_SIZE; LX++)
+				{
+					const int32 CellIndex = GetCellIndex(LX, LY, LZ);
+					const int32 QEFIndex = (*CellQEFIndices)[CellIndex];
+					if (QEFIndex == -1) continue;
+
+					const int32 CollapsedIndex = (*CellCollapsedIndices)[CellIndex];
+					if (CollapsedIndex != -1 && CollapsedVertices[CollapsedIndex].VertexIndex != -1)
+					{
+						(*CellVertexIndices)[CellIndex] = CollapsedVertices[CollapsedIndex].VertexIndex;
+						continue;
+					}
+
+					FVector Position = FVector::ZeroVector;
+					FVector ParentPosition = FVector::ZeroVector;
+					FVector Normal = FVector::ZeroVector;
+					if (CollapsedIndex != -1)
+					{
+						// Collapsed blocks are already coarser than the parent
+						Position = CollapsedVertices[CollapsedIndex].Position;
+						ParentPosition = Position;
+						Normal = CollapsedVertices[CollapsedIndex].Normal;
+					}
+					else
+					{
+						const FVoxelDualContouringQEF& QEF = CellQEFs[QEFIndex];
+						Position = QEF.Solve(FBox(FVector(LX, LY, LZ), FVector(LX + 1, LY + 1, LZ + 1)));
+						Normal = QEF.NormalSum.GetSafeNormal();
+
+						if (TVertex::bComputeParentPosition)
+						{
+							const FIntVector ParentMin(LX & ~1, LY & ~1, LZ & ~1);
+							FVoxelDualContouringQEF ParentQEF;
+							for (int32 Child = 0; Child < 8; Child++)
+							{
+								const FIntVector ChildPosition = ParentMin + FIntVector(bool(Child & 0x1), bool(Child & 0x2), bool(Child & 0x4));
+								const int32 ChildQEFIndex = (*CellQEFIndices)[GetCellIndex(ChildPosition)];
+								if (ChildQEFIndex != -1)
+								{
+									ParentQEF.Add(CellQEFs[ChildQEFIndex]);
+								}
+							}
+							ParentPosition = ParentQEF.Solve(FBox(FVector(ParentMin), FVector(ParentMin + FIntVector(2))));
+						}
+					}
+
+					const int32 VertexIndex = Vertices.Num();
+					(*CellVertexIndices)[CellIndex] = VertexIndex;
+					if (CollapsedIndex != -1)
+					{
+						CollapsedVertices[CollapsedIndex].VertexIndex = VertexIndex;
+					}
+
+					const FVector FinalPosition = Position * Step;
+
+					TVertex Vertex;
+					Vertex.SetPosition(FinalPosition);
+					if (TVertex::bComputeParentPosition)
+					{
+						Vertex.SetParentPosition(ParentPosition - Position); // Already divided by Step
+					}
+					if (TVertex::bComputeNormal)
+					{
+						Vertex.SetNormal(Settings.NormalConfig == EVoxelNormalConfig::NoNormal ? FVector::ZeroVector : Normal);
+					}
+					if (TVertex::bComputeMaterial)
+					{
+						const FIntVector MaterialPosition = FVoxelUtilities::RoundToInt(FinalPosition);
+						Vertex.SetMaterial(MESHER_TIME_RETURN_MATERIALS(1, Accelerator->GetMaterial(MaterialPosition + ChunkPosition, LOD)));
+					}
+					if (TVertex::bComputeTextureCoordinate)
+					{
+						Vertex.SetTextureCoordinate(MESHER_TIME_RETURN(UVs, FVoxelMesherUtilities::GetUVs(*this, FinalPosition)));
+					}
+					Vertices.Add(Vertex);
+				}
+			}
+		}
+	}
+
+	UnlockData();
+
+	{
+		VOXEL_SCOPE_COUNTER("Generate Mesh");
+
+		const auto AddTriangle = [&](int32 IndexA, int32 IndexB, int32 IndexC)
+		{
+			checkVoxelSlow(IndexA != -1 && IndexB != -1 && IndexC != -1);
+			// Collapsed cells share their vertex
+			if (IndexA == IndexB || IndexA == IndexC || IndexB == IndexC) return;
+			Indices.Add(IndexA);
+			Indices.Add(IndexB);
+			Indices.Add(IndexC);
+		};
+
+		// Each edge ending at (LX + 1, LY + 1, LZ + 1) with a sign change creates a quad joining the 4 cells around it
+		for (int32 LZ = 0; LZ < RENDER_CHUNK_SIZE; LZ++)
+		{
+			for (int32 LY = 0; LY < RENDER_CHUNK_SIZE; LY++)
+			{
+				for (int32 LX = 0; LX < RENDER_CHUNK_SIZE; LX++)
+				{
+					const FIntVector Cell(LX, LY, LZ);
+					const FIntVector EdgeEnd = Cell + FIntVector(1);
+					const bool bEndIsEmpty = GetValue(EdgeEnd).IsEmpty();
+
+					for (int32 Direction = 0; Direction < 3; Direction++)
+					{
+						// U, V, Direction are direct
+						const int32 U = (Direction + 1) % 3;
+						const int32 V = (Direction + 2) % 3;
+
+						FIntVector EdgeStart = EdgeEnd;
+						EdgeStart[Direction]--;
+						const bool bStartIsEmpty = GetValue(EdgeStart).IsEmpty();
+						if (bStartIsEmpty == bEndIsEmpty) continue;
+
+						FIntVector OffsetU(0);
+						FIntVector OffsetV(0);
+						OffsetU[U] = 1;
+						OffsetV[V] = 1;
+
+						const int32 Index00 = (*CellVertexIndices)[GetCellIndex(Cell)];
+						const int32 Index10 = (*CellVertexIndices)[GetCellIndex(Cell + OffsetU)];
+						const int32 Index01 = (*CellVertexIndices)[GetCellIndex(Cell + OffsetV)];
+						const int32 Index11 = (*CellVertexIndices)[GetCellIndex(Cell + OffsetU + OffsetV)];
+
+						// Faces must be clockwise when seen from the empty side
+						if (bStartIsEmpty)
+						{
+							AddTriangle(Index00, Index10, Index11);
+							AddTriangle(Index11, Index01, Index00);
+						}
+						else
+						{
+							AddTriangle(Index00, Index11, Index10);
+							AddTriangle(Index11, Index00, Index01);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelDualContouringMesher::FindIntersections(FVoxelMesherTimes& Times)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	FMemory::Memset(CellQEFIndices->GetData(), 0xFF, CellQEFIndices->Num() * CellQEFIndices->GetTypeSize());
+	CellQEFs.Reset();
+
+	// Edges going from Position to Position + 1 in Direction
+	// We need all the edges of the cells 0 to DC_PARENT_CHUNK_SIZE - 1
+	for (int32 LZ = 0; LZ <= DC_PARENT_CHUNK_SIZE; LZ++)
+	{
+		for (int32 LY = 0; LY <= DC_PARENT_CHUNK_SIZE; LY++)
+		{
+			for (int32 LX = 0; LX <= DC_PARENT_CHUNK_SIZE; LX++)
+			{
+				const FIntVector Position(LX, LY, LZ);
+				const FVoxelValue MinValue = GetValue(Position);
+
+				for (int32 Direction = 0; Direction < 3; Direction++)
+				{
+					if (Position[Direction] == DC_PARENT_CHUNK_SIZE) continue;
+
+					FIntVector MaxPosition = Position;
+					MaxPosition[Direction]++;
+					const FVoxelValue MaxValue = GetValue(MaxPosition);
+					if (MinValue.IsEmpty() == MaxValue.IsEmpty()) continue;
+
+					const float Factor = GetIntersection(Times, Position, Direction, MinValue, MaxValue);
+
+					FVector Point(Position);
+					Point[Direction] += Factor;
+					const FVector Normal = MESHER_TIME_RETURN(Normals, GetGradient(Point));
+
+					// Add the intersection to the 4 cells sharing this edge
+					const int32 U = (Direction + 1) % 3;
+					const int32 V = (Direction + 2) % 3;
+					for (int32 Corner = 0; Corner < 4; Corner++)
+					{
+						FIntVector Cell = Position;
+						Cell[U] -= bool(Corner & 0x1);
+						Cell[V] -= bool(Corner & 0x2);
+						if (Cell[U] < 0 || Cell[U] >= DC_PARENT_CHUNK_SIZE ||
+							Cell[V] < 0 || Cell[V] >= DC_PARENT_CHUNK_SIZE)
+						{
+							continue;
+						}
+
+						int32& QEFIndex = (*CellQEFIndices)[GetCellIndex(Cell)];
+						if (QEFIndex == -1)
+						{
+							QEFIndex = CellQEFs.Emplace();
+						}
+						CellQEFs[QEFIndex].Add(Point, Normal);
+					}
+				}
+			}
+		}
+	}
+}
+
+float FVoxelDualContouringMesher::GetIntersection(FVoxelMesherTimes& Times, const FIntVector& Min, int32 Direction, FVoxelValue MinValue, FVoxelValue MaxValue) const
+{
+	if (LOD == 0)
+	{
+		return MinValue.ToFloat() / (MinValue.ToFloat() - MaxValue.ToFloat());
+	}
+
+	// For LOD chunks, search along the edge for the actual intersecting segment
+	FIntVector MinPosition = Min * Step;
+	FIntVector MaxPosition = MinPosition;
+	MaxPosition[Direction] += Step;
+	float C1 = 0;
+	float C2 = 1;
+	for (int32 LocalStep = Step; LocalStep > 1; LocalStep >>= 1)
+	{
+		const float CMid = (C1 + C2) * 0.5f;
+		const FIntVector MidPosition = (MinPosition + MaxPosition) / 2;
+		const FVoxelValue MidValue = MESHER_TIME_RETURN_VALUES(1, Accelerator->Get<FVoxelValue>(MidPosition + ChunkPosition, LOD));
+		if (MinValue.IsEmpty() != MidValue.IsEmpty())
+		{
+			C2 = CMid;
+			MaxValue = MidValue;
+			MaxPosition = MidPosition;
+		}
+		else
+		{
+			C1 = CMid;
+			MinValue = MidValue;
+			MinPosition = MidPosition;
+		}
+	}
+	return C1 + (C2 - C1) * MinValue.ToFloat() / (MinValue.ToFloat() - MaxValue.ToFloat());
+}
+
+FVector FVoxelDualContouringMesher::GetGradient(const FVector& Position) const
+{
+	if (LOD == 0)
+	{
+		// Data gradient from the cached values
+		return FVoxelDataUtilities::GetGradientFromGetValue<v_flt>(
+			FVoxelDataUtilities::MakeBilinearInterpolatedData(*this),
+			Position.X,
+			Position.Y,
+			Position.Z,
+			0,
+			1);
+	}
+	else
+	{
+		// Generator gradient, with a fallback to the data one if the voxels are edited
+		return FVoxelDataUtilities::GetGradientFromGetFloatValue<v_flt>(
+			*Accelerator,
+			v_flt(Position.X) * Step + ChunkPosition.X,
+			v_flt(Position.Y) * Step + ChunkPosition.Y,
+			v_flt(Position.Z) * Step + ChunkPosition.Z,
+			LOD,
+			Step);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelDualContouringMesher::CollapseCells()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	CollapsedVertices.Reset();
+
+	for (int32 LZ = 0; LZ < RENDER_CHUNK_SIZE; LZ += DC_MAX_COLLAPSE_SIZE)
+	{
+		for (int32 LY = 0; LY < RENDER_CHUNK_SIZE; LY += DC_MAX_COLLAPSE_SIZE)
+		{
+			for (int32 LX = 0; LX < RENDER_CHUNK_SIZE; LX += DC_MAX_COLLAPSE_SIZE)
+			{
+				const FIntVector Min(LX, LY, LZ);
+				FVoxelDualContouringQEF QEF;
+				if (TryCollapse(Min, DC_MAX_COLLAPSE_SIZE, QEF) && QEF.NumPoints > 0)
+				{
+					CollapseBlock(Min, DC_MAX_COLLAPSE_SIZE, QEF);
+				}
+			}
+		}
+	}
+}
+
+bool FVoxelDualContouringMesher::TryCollapse(const FIntVector& Min, int32 BlockSize, FVoxelDualContouringQEF& OutQEF)
+{
+	if (BlockSize == 1)
+	{
+		const int32 QEFIndex = (*CellQEFIndices)[GetCellIndex(Min)];
+		if (QEFIndex != -1)
+		{
+			OutQEF = CellQEFs[QEFIndex];
+		}
+		return true;
+	}
+
+	const int32 ChildSize = BlockSize / 2;
+
+	bool bCanCollapse = true;
+	FVoxelDualContouringQEF ChildrenQEFs[8];
+	bool bChildrenCollapsed[8];
+	for (int32 Child = 0; Child < 8; Child++)
+	{
+		const FIntVector ChildMin = Min + FIntVector(bool(Child & 0x1), bool(Child & 0x2), bool(Child & 0x4)) * ChildSize;
+		bChildrenCollapsed[Child] = TryCollapse(ChildMin, ChildSize, ChildrenQEFs[Child]);
+		bCanCollapse &= bChildrenCollapsed[Child];
+	}
+
+	FVoxelDualContouringQEF QEF;
+	for (auto& ChildQEF : ChildrenQEFs)
+	{
+		QEF.Add(ChildQEF);
+	}
+
+	// The cells on the chunk borders are shared with the neighbors: don't collapse them to avoid cracks
+	const bool bIsOnBorder =
+		Min.X == 0 || Min.Y == 0 || Min.Z == 0 ||
+		Min.X + BlockSize > RENDER_CHUNK_SIZE ||
+		Min.Y + BlockSize > RENDER_CHUNK_SIZE ||
+		Min.Z + BlockSize > RENDER_CHUNK_SIZE;
+
+	if (bCanCollapse && QEF.NumPoints > 0)
+	{
+		if (bIsOnBorder)
+		{
+			bCanCollapse = false;
+		}
+		else
+		{
+			const FVector Position = QEF.Solve(FBox(FVector(Min), FVector(Min + FIntVector(BlockSize))));
+			// Error is in cells: far chunks are simplified as much as close ones relative to their resolution
+			bCanCollapse = QEF.GetError(Position) <= Settings.DualContouringMaxError;
+		}
+	}
+
+	if (bCanCollapse)
+	{
+		OutQEF = QEF;
+		return true;
+	}
+
+	// Collapse the biggest children we can
+	for (int32 Child = 0; Child < 8; Child++)
+	{
+		if (bChildrenCollapsed[Child] && ChildSize > 1 && ChildrenQEFs[Child].NumPoints > 0)
+		{
+			const FIntVector ChildMin = Min + FIntVector(bool(Child & 0x1), bool(Child & 0x2), bool(Child & 0x4)) * ChildSize;
+			CollapseBlock(ChildMin, ChildSize, ChildrenQEFs[Child]);
+		}
+	}
+	return false;
+}
+
+void FVoxelDualContouringMesher::CollapseBlock(const FIntVector& Min, int32 BlockSize, const FVoxelDualContouringQEF& QEF)
+{
+	FCollapsedVertex CollapsedVertex;
+	CollapsedVertex.Position = QEF.Solve(FBox(FVector(Min), FVector(Min + FIntVector(BlockSize))));
+	CollapsedVertex.Normal = QEF.NormalSum.GetSafeNormal();
+	const int32 CollapsedIndex = CollapsedVertices.Add(CollapsedVertex);
+
+	for (int32 LZ = 0; LZ < BlockSize; LZ++)
+	{
+		for (int32 LY = 0; LY < BlockSize; LY++)
+		{
+			for (int32 LX = 0; LX < BlockSize; LX++)
+			{
+				(*CellCollapsedIndices)[GetCellIndex(Min + FIntVector(LX, LY, LZ))] = CollapsedIndex;
+			}
+		}
+	}
+}
\ No newline at end of file
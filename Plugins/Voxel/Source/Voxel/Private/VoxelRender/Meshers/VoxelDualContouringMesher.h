@@ -0,0 +1,121 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StackArray.h"
+#include "VoxelData/VoxelDataAccelerator.h"
+#include "VoxelRender/Meshers/VoxelMesher.h"
+
+#define DC_CHUNK_SIZE (RENDER_CHUNK_SIZE + 1) /* +1 since DC vertices are within cells */
+#define DC_PARENT_CHUNK_SIZE (RENDER_CHUNK_SIZE + 2) /* +2 to get the parent of the last cell */
+#define DC_EXTENDED_CHUNK_SIZE (RENDER_CHUNK_SIZE + 5) /* -1 and +4 to get the gradients of the parent cells edges */
+#define DC_MAX_COLLAPSE_SIZE 8
+
+// Quadratic error function: sum of (Normal | (X - Point))^2 over all the edges intersections of a cell
+// All positions are in cells, relative to the chunk position
+struct FVoxelDualContouringQEF
+{
+	// Upper triangle of AtA: XX, XY, XZ, YY, YZ, ZZ
+	float AtA[6] = { 0, 0, 0, 0, 0, 0 };
+	FVector AtB = FVector::ZeroVector;
+	float BtB = 0;
+
+	FVector MassPointSum = FVector::ZeroVector;
+	FVector NormalSum = FVector::ZeroVector;
+	int32 NumPoints = 0;
+
+	void Add(const FVector& Point, const FVector& Normal);
+	void Add(const FVoxelDualContouringQEF& Other);
+
+	FORCEINLINE FVector GetMassPoint() const
+	{
+		return MassPointSum / NumPoints;
+	}
+	float GetError(const FVector& Position) const;
+
+	// Finds the position minimizing the error, biased towards the mass point and clamped to Bounds
+	FVector Solve(const FBox& Bounds) const;
+};
+
+class FVoxelDualContouringMesher : public FVoxelMesher
+{
+public:
+	using FVoxelMesher::FVoxelMesher;
+
+protected:
+	virtual FIntBox GetBoundsToCheckIsEmptyOn() const override final;
+	virtual FIntBox GetBoundsToLock() const override final;
+	virtual TVoxelSharedPtr<FVoxelChunkMesh> CreateFullChunkImpl(FVoxelMesherTimes& Times) override final;
+	virtual void CreateGeometryImpl(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<FVector>& Vertices) override final;
+	virtual FVoxelChunkMeshCachedValues GetCachedValues() const override final;
+
+public:
+	// For GetGradient template
+	FORCEINLINE FVoxelValue GetValue(int32 X, int32 Y, int32 Z, int32 InLOD) const
+	{
+		checkVoxelSlow(LOD == 0);
+		checkVoxelSlow(InLOD == 0);
+		return GetValue(X, Y, Z);
+	}
+
+private:
+	using FCachedValues = TStackArray<FVoxelValue, DC_EXTENDED_CHUNK_SIZE * DC_EXTENDED_CHUNK_SIZE * DC_EXTENDED_CHUNK_SIZE>;
+	using FCellIndices = TStackArray<int32, DC_PARENT_CHUNK_SIZE * DC_PARENT_CHUNK_SIZE * DC_PARENT_CHUNK_SIZE>;
+
+	TUniquePtr<FVoxelConstDataAccelerator> Accelerator;
+
+	TUniquePtr<FCachedValues> CachedValues = MakeUnique<FCachedValues>();
+	// Index in CellQEFs, -1 if the cell has no intersection
+	TUniquePtr<FCellIndices> CellQEFIndices = MakeUnique<FCellIndices>();
+	TArray<FVoxelDualContouringQEF> CellQEFs;
+
+	// Index in CollapsedVertices, -1 if the cell wasn't collapsed
+	TUniquePtr<FCellIndices> CellCollapsedIndices = MakeUnique<FCellIndices>();
+	struct FCollapsedVertex
+	{
+		FVector Position;
+		FVector Normal;
+		int32 VertexIndex = -1;
+	};
+	TArray<FCollapsedVertex> CollapsedVertices;
+
+	// Final vertex index, per cell. -1 if no vertex
+	TUniquePtr<FCellIndices> CellVertexIndices = MakeUnique<FCellIndices>();
+
+private:
+	template<typename TVertex>
+	void CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<TVertex>& Vertices);
+
+	void FindIntersections(FVoxelMesherTimes& Times);
+	void CollapseCells();
+	// Returns true if all the cells of the block can be merged. OutQEF is then the merged QEF
+	bool TryCollapse(const FIntVector& Min, int32 BlockSize, FVoxelDualContouringQEF& OutQEF);
+	void CollapseBlock(const FIntVector& Min, int32 BlockSize, const FVoxelDualContouringQEF& QEF);
+
+	float GetIntersection(FVoxelMesherTimes& Times, const FIntVector& Min, int32 Direction, FVoxelValue MinValue, FVoxelValue MaxValue) const;
+	FVector GetGradient(const FVector& Position) const;
+
+	FORCEINLINE static int32 GetCellIndex(int32 X, int32 Y, int32 Z)
+	{
+		checkVoxelSlow(0 <= X && X < DC_PARENT_CHUNK_SIZE);
+		checkVoxelSlow(0 <= Y && Y < DC_PARENT_CHUNK_SIZE);
+		checkVoxelSlow(0 <= Z && Z < DC_PARENT_CHUNK_SIZE);
+		return X + Y * DC_PARENT_CHUNK_SIZE + Z * DC_PARENT_CHUNK_SIZE * DC_PARENT_CHUNK_SIZE;
+	}
+	FORCEINLINE static int32 GetCellIndex(const FIntVector& P)
+	{
+		return GetCellIndex(P.X, P.Y, P.Z);
+	}
+	FORCEINLINE FVoxelValue GetValue(int32 X, int32 Y, int32 Z) const
+	{
+		checkVoxelSlow(-1 <= X && X < DC_EXTENDED_CHUNK_SIZE - 1);
+		checkVoxelSlow(-1 <= Y && Y < DC_EXTENDED_CHUNK_SIZE - 1);
+		checkVoxelSlow(-1 <= Z && Z < DC_EXTENDED_CHUNK_SIZE - 1);
+		return (*CachedValues)[(X + 1) + (Y + 1) * DC_EXTENDED_CHUNK_SIZE + (Z + 1) * DC_EXTENDED_CHUNK_SIZE * DC_EXTENDED_CHUNK_SIZE];
+	}
+	FORCEINLINE FVoxelValue GetValue(const FIntVector& P) const
+	{
+		return GetValue(P.X, P.Y, P.Z);
+	}
+};
\ No newline at end of file
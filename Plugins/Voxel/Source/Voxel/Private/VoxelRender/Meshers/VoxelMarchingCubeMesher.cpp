@@ -2,6 +2,7 @@
 
 #include "VoxelRender/Meshers/VoxelMarchingCubeMesher.h"
 #include "VoxelRender/Meshers/VoxelMesherUtilities.h"
+#include "VoxelRender/VoxelChunkMesh.h"
 #include "VoxelRender/IVoxelRenderer.h"
 #include "VoxelData/VoxelData.h"
 #include "VoxelData/VoxelDataUtilities.h"
@@ -275,6 +276,12 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMarchingCubeMesher::CreateFullChunkImpl(F
 	TArray<FLocalVertex> Vertices;
 	CreateGeometryTemplate(Times, Indices, Vertices);
 
+	if (CancelToken.IsCanceled())
+	{
+		UnlockData();
+		return {};
+	}
+
 	FVoxelMesherUtilities::SanitizeMesh(Indices, Vertices);
 
 	TArray<FVoxelMesherVertex> MesherVertices = FMarchingCubeHelpers::CreateMesherVertices(Vertices);
@@ -373,6 +380,19 @@ void FVoxelMarchingCubeMesher::CreateGeometryImpl(FVoxelMesherTimes& Times, TArr
 	UnlockData();
 }
 
+FVoxelChunkMeshCachedValues FVoxelMarchingCubeMesher::GetCachedValues() const
+{
+	if (LOD == 0)
+	{
+		// Account for normals
+		return { CachedValues, FIntVector(-1), FIntVector(CHUNK_SIZE_WITH_NORMALS) };
+	}
+	else
+	{
+		return { CachedValues, FIntVector(0), FIntVector(CHUNK_SIZE_WITH_END_EDGE) };
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -399,6 +419,8 @@ bool FVoxelMarchingCubeMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times,
 	if (LOD == 0) VoxelIndex += DataSize * DataSize; // Additional voxel for normals
 	for (int32 LZ = 0; LZ < RENDER_CHUNK_SIZE; LZ++)
 	{
+		if (CancelToken.IsCanceled()) return false;
+
 		if (LOD == 0) VoxelIndex += DataSize; // Additional voxel for normals
 		for (int32 LY = 0; LY < RENDER_CHUNK_SIZE; LY++)
 		{
@@ -723,6 +745,7 @@ template<uint8 Direction, typename T>
 bool FVoxelMarchingCubeTransitionsMesher::CreateGeometryForDirection(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices)
 {
 	if (!(TransitionsMask & Direction)) return true;
+	if (CancelToken.IsCanceled()) return false;
 
 #if VOXEL_DEBUG
 	for (auto& Value : Cache2D)
@@ -1032,6 +1055,7 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMarchingCubeTransitionsMesher::CreateFull
 
 	if (!CreateGeometryTemplate(Times, Indices, Vertices))
 	{
+		UnlockData();
 		return {};
 	}
 
@@ -23,6 +23,7 @@ protected:
 
 	virtual TVoxelSharedPtr<FVoxelChunkMesh> CreateFullChunkImpl(FVoxelMesherTimes& Times) override final;
 	virtual void CreateGeometryImpl(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<FVector>& Vertices) override final;
+	virtual FVoxelChunkMeshCachedValues GetCachedValues() const override final;
 
 public:
 	// For GetGradient template
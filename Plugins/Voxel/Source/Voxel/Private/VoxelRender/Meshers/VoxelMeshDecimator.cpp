@@ -0,0 +1,380 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelRender/Meshers/VoxelMeshDecimator.h"
+
+FVoxelMeshDecimator::FQuadric::FQuadric(const FVector& Normal, double W)
+	: XX(double(Normal.X) * Normal.X)
+	, XY(double(Normal.X) * Normal.Y)
+	, XZ(double(Normal.X) * Normal.Z)
+	, XW(double(Normal.X) * W)
+	, YY(double(Normal.Y) * Normal.Y)
+	, YZ(double(Normal.Y) * Normal.Z)
+	, YW(double(Normal.Y) * W)
+	, ZZ(double(Normal.Z) * Normal.Z)
+	, ZW(double(Normal.Z) * W)
+	, WW(W * W)
+{
+}
+
+void FVoxelMeshDecimator::FQuadric::operator+=(const FQuadric& Other)
+{
+	XX += Other.XX;
+	XY += Other.XY;
+	XZ += Other.XZ;
+	XW += Other.XW;
+	YY += Other.YY;
+	YZ += Other.YZ;
+	YW += Other.YW;
+	ZZ += Other.ZZ;
+	ZW += Other.ZW;
+	WW += Other.WW;
+}
+
+double FVoxelMeshDecimator::FQuadric::Evaluate(const FVector& Position) const
+{
+	const double X = Position.X;
+	const double Y = Position.Y;
+	const double Z = Position.Z;
+	return
+		XX * X * X + 2 * XY * X * Y + 2 * XZ * X * Z + 2 * XW * X +
+		YY * Y * Y + 2 * YZ * Y * Z + 2 * YW * Y +
+		ZZ * Z * Z + 2 * ZW * Z +
+		WW;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelMeshDecimator::FVoxelMeshDecimator(FVoxelChunkMeshBuffers& Buffers, const FBox& UnlockedBounds, float MaxError)
+	: Buffers(Buffers)
+	, UnlockedBounds(UnlockedBounds)
+	, MaxSquaredError(FMath::Square(double(MaxError)))
+{
+}
+
+void FVoxelMeshDecimator::Decimate()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	check(Buffers.Indices.Num() % 3 == 0);
+	if (Buffers.Indices.Num() == 0)
+	{
+		return;
+	}
+
+	Initialize();
+
+	int32 NumCollapses = 0;
+	while (Heap.Num() > 0)
+	{
+		FCollapse Collapse;
+		Heap.HeapPop(Collapse, false);
+
+		if (RemovedVertices[Collapse.From] ||
+			RemovedVertices[Collapse.To] ||
+			Versions[Collapse.From] != Collapse.FromVersion ||
+			Versions[Collapse.To] != Collapse.ToVersion)
+		{
+			// Outdated
+			continue;
+		}
+		if (Collapse.Cost > MaxSquaredError)
+		{
+			// All the remaining collapses are more expensive
+			break;
+		}
+		if (!CanCollapse(Collapse.From, Collapse.To))
+		{
+			// Will be added back if the neighborhood changes
+			continue;
+		}
+
+		this->Collapse(Collapse.From, Collapse.To);
+		NumCollapses++;
+	}
+
+	if (NumCollapses > 0)
+	{
+		Compact();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelMeshDecimator::Initialize()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const int32 NumVertices = Buffers.GetNumVertices();
+	const int32 NumTriangles = Buffers.Indices.Num() / 3;
+
+	Positions.Reserve(NumVertices);
+	for (int32 Index = 0; Index < NumVertices; Index++)
+	{
+		Positions.Add(Buffers.GetPosition(Index));
+	}
+
+	Quadrics.SetNum(NumVertices);
+	Versions.SetNumZeroed(NumVertices);
+	LockedVertices.Init(false, NumVertices);
+	RemovedVertices.Init(false, NumVertices);
+	RemovedTriangles.Init(false, NumTriangles);
+	VertexTriangles.SetNum(NumVertices);
+
+	for (int32 Triangle = 0; Triangle < NumTriangles; Triangle++)
+	{
+		const int32 A = GetIndex(Triangle, 0);
+		const int32 B = GetIndex(Triangle, 1);
+		const int32 C = GetIndex(Triangle, 2);
+
+		VertexTriangles[A].Add(Triangle);
+		VertexTriangles[B].Add(Triangle);
+		VertexTriangles[C].Add(Triangle);
+
+		const FVector Normal = ((Positions[B] - Positions[A]) ^ (Positions[C] - Positions[A])).GetSafeNormal();
+		if (Normal.IsZero())
+		{
+			continue;
+		}
+
+		const FQuadric Quadric(Normal, -(Normal | Positions[A]));
+		Quadrics[A] += Quadric;
+		Quadrics[B] += Quadric;
+		Quadrics[C] += Quadric;
+	}
+
+	// Count how many triangles share each edge
+	TMap<uint64, int32> EdgesCount;
+	EdgesCount.Reserve(NumTriangles * 3 / 2);
+	for (int32 Triangle = 0; Triangle < NumTriangles; Triangle++)
+	{
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			const uint32 A = GetIndex(Triangle, Corner);
+			const uint32 B = GetIndex(Triangle, (Corner + 1) % 3);
+			EdgesCount.FindOrAdd(uint64(FMath::Min(A, B)) << 32 | FMath::Max(A, B))++;
+		}
+	}
+
+	for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+	{
+		if (!UnlockedBounds.IsInside(Positions[Vertex]))
+		{
+			LockedVertices[Vertex] = true;
+		}
+	}
+	for (auto& It : EdgesCount)
+	{
+		if (It.Value != 2)
+		{
+			// Mesh borders (eg between two material buffers) or non manifold edges: can't move them without creating holes
+			LockedVertices[int32(It.Key >> 32)] = true;
+			LockedVertices[int32(It.Key & 0xFFFFFFFF)] = true;
+		}
+	}
+
+	Heap.Reserve(EdgesCount.Num());
+	for (auto& It : EdgesCount)
+	{
+		if (It.Value == 2)
+		{
+			AddCollapse(int32(It.Key >> 32), int32(It.Key & 0xFFFFFFFF));
+		}
+	}
+}
+
+void FVoxelMeshDecimator::Compact()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const int32 NumVertices = Buffers.GetNumVertices();
+	const int32 NumTriangles = Buffers.Indices.Num() / 3;
+
+	TArray<int32> OldToNew;
+	OldToNew.Init(-1, NumVertices);
+	TArray<int32> NewToOld;
+	NewToOld.Reserve(NumVertices);
+
+	TArray<uint32> NewIndices;
+	NewIndices.Reserve(Buffers.Indices.Num());
+	for (int32 Triangle = 0; Triangle < NumTriangles; Triangle++)
+	{
+		if (RemovedTriangles[Triangle])
+		{
+			continue;
+		}
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			const int32 OldIndex = GetIndex(Triangle, Corner);
+			int32& NewIndex = OldToNew[OldIndex];
+			if (NewIndex == -1)
+			{
+				NewIndex = NewToOld.Add(OldIndex);
+			}
+			NewIndices.Add(NewIndex);
+		}
+	}
+	Buffers.Indices = MoveTemp(NewIndices);
+	Buffers.RemapVertices(NewToOld);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelMeshDecimator::AddCollapse(int32 A, int32 B)
+{
+	const auto& Colors = Buffers.Colors;
+
+	if (Colors.Num() > 0 && Colors[A] != Colors[B])
+	{
+		// Keep material boundaries
+		return;
+	}
+
+	FQuadric Quadric = Quadrics[A];
+	Quadric += Quadrics[B];
+
+	const auto Add = [&](int32 From, int32 To)
+	{
+		if (LockedVertices[From])
+		{
+			return;
+		}
+		Heap.HeapPush(FCollapse{ Quadric.Evaluate(Positions[To]), From, To, Versions[From], Versions[To] });
+	};
+	// Both are pushed: the second one will be outdated once the first one is applied
+	Add(A, B);
+	Add(B, A);
+}
+
+bool FVoxelMeshDecimator::CanCollapse(int32 From, int32 To) const
+{
+	// Link condition: From and To must share exactly 2 neighbors, else the mesh would become non manifold
+	TArray<int32, TInlineAllocator<16>> FromNeighbors;
+	for (int32 Triangle : VertexTriangles[From])
+	{
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			const int32 Index = GetIndex(Triangle, Corner);
+			if (Index != From && Index != To)
+			{
+				FromNeighbors.AddUnique(Index);
+			}
+		}
+	}
+	TArray<int32, TInlineAllocator<16>> SharedNeighbors;
+	for (int32 Triangle : VertexTriangles[To])
+	{
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			const int32 Index = GetIndex(Triangle, Corner);
+			if (FromNeighbors.Contains(Index))
+			{
+				SharedNeighbors.AddUnique(Index);
+			}
+		}
+	}
+	if (SharedNeighbors.Num() != 2)
+	{
+		return false;
+	}
+
+	// Check that no triangle is flipped
+	for (int32 Triangle : VertexTriangles[From])
+	{
+		FVector Corners[3];
+		bool bHasTo = false;
+		int32 FromCorner = -1;
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			const int32 Index = GetIndex(Triangle, Corner);
+			bHasTo |= Index == To;
+			if (Index == From)
+			{
+				FromCorner = Corner;
+			}
+			Corners[Corner] = Positions[Index];
+		}
+		if (bHasTo)
+		{
+			// Will be removed
+			continue;
+		}
+		check(FromCorner != -1);
+
+		const FVector OldNormal = (Corners[1] - Corners[0]) ^ (Corners[2] - Corners[0]);
+		Corners[FromCorner] = Positions[To];
+		const FVector NewNormal = (Corners[1] - Corners[0]) ^ (Corners[2] - Corners[0]);
+
+		if (NewNormal.SizeSquared() <= SMALL_NUMBER || (OldNormal.GetSafeNormal() | NewNormal.GetSafeNormal()) < 0.2f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FVoxelMeshDecimator::Collapse(int32 From, int32 To)
+{
+	for (int32 Triangle : VertexTriangles[From])
+	{
+		bool bHasTo = false;
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			bHasTo |= GetIndex(Triangle, Corner) == To;
+		}
+
+		if (bHasTo)
+		{
+			RemovedTriangles[Triangle] = true;
+			for (int32 Corner = 0; Corner < 3; Corner++)
+			{
+				const int32 Index = GetIndex(Triangle, Corner);
+				if (Index != From)
+				{
+					VertexTriangles[Index].RemoveSingleSwap(Triangle, false);
+				}
+			}
+		}
+		else
+		{
+			for (int32 Corner = 0; Corner < 3; Corner++)
+			{
+				if (GetIndex(Triangle, Corner) == From)
+				{
+					SetIndex(Triangle, Corner, To);
+				}
+			}
+			VertexTriangles[To].Add(Triangle);
+		}
+	}
+
+	VertexTriangles[From].Empty();
+	RemovedVertices[From] = true;
+
+	Quadrics[To] += Quadrics[From];
+	Versions[To]++;
+
+	// Update the collapses around To, as its quadric changed
+	TArray<int32, TInlineAllocator<16>> Neighbors;
+	for (int32 Triangle : VertexTriangles[To])
+	{
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			const int32 Index = GetIndex(Triangle, Corner);
+			if (Index != To)
+			{
+				Neighbors.AddUnique(Index);
+			}
+		}
+	}
+	for (int32 Neighbor : Neighbors)
+	{
+		AddCollapse(To, Neighbor);
+	}
+}
@@ -0,0 +1,86 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGlobals.h"
+#include "VoxelRender/VoxelChunkMesh.h"
+
+// Quadric error edge collapse (Garland & Heckbert)
+// Uses half edge collapses: no vertex is created, so the kept vertices keep their exact attributes (normal, color, UVs, tangents)
+class FVoxelMeshDecimator
+{
+public:
+	// Vertices outside of UnlockedBounds are never moved nor removed
+	// MaxError is in the same unit as the positions
+	FVoxelMeshDecimator(FVoxelChunkMeshBuffers& Buffers, const FBox& UnlockedBounds, float MaxError);
+
+	void Decimate();
+
+private:
+	// Symmetric 4x4 matrix
+	struct FQuadric
+	{
+		double XX = 0;
+		double XY = 0;
+		double XZ = 0;
+		double XW = 0;
+		double YY = 0;
+		double YZ = 0;
+		double YW = 0;
+		double ZZ = 0;
+		double ZW = 0;
+		double WW = 0;
+
+		FQuadric() = default;
+		// Squared distance to the plane (Normal | P) + W = 0
+		FQuadric(const FVector& Normal, double W);
+
+		void operator+=(const FQuadric& Other);
+		double Evaluate(const FVector& Position) const;
+	};
+	struct FCollapse
+	{
+		double Cost;
+		int32 From;
+		int32 To;
+		uint32 FromVersion;
+		uint32 ToVersion;
+
+		FORCEINLINE bool operator<(const FCollapse& Other) const
+		{
+			return Cost < Other.Cost;
+		}
+	};
+
+	FVoxelChunkMeshBuffers& Buffers;
+	const FBox UnlockedBounds;
+	const double MaxSquaredError;
+
+	// Unpacked positions
+	TArray<FVector> Positions;
+	TArray<FQuadric> Quadrics;
+	// Incremented every time the quadric of a vertex changes, to detect outdated collapses
+	TArray<uint32> Versions;
+	TBitArray<> LockedVertices;
+	TBitArray<> RemovedVertices;
+	TBitArray<> RemovedTriangles;
+	TArray<TArray<int32, TInlineAllocator<8>>> VertexTriangles;
+	TArray<FCollapse> Heap;
+
+	void Initialize();
+	void Compact();
+
+	void AddCollapse(int32 A, int32 B);
+	bool CanCollapse(int32 From, int32 To) const;
+	void Collapse(int32 From, int32 To);
+
+	FORCEINLINE int32 GetIndex(int32 Triangle, int32 Corner) const
+	{
+		return Buffers.Indices.GetData()[3 * Triangle + Corner];
+	}
+	FORCEINLINE void SetIndex(int32 Triangle, int32 Corner, int32 Index)
+	{
+		Buffers.Indices.GetData()[3 * Triangle + Corner] = Index;
+	}
+};
\ No newline at end of file
@@ -1,6 +1,7 @@
 // Copyright 2020 Phyronnaz
 
 #include "VoxelRender/Meshers/VoxelMesher.h"
+#include "VoxelRender/Meshers/VoxelMeshDecimator.h"
 #include "VoxelRender/VoxelMesherAsyncWork.h"
 #include "VoxelRender/VoxelChunkMesh.h"
 #include "VoxelRender/IVoxelRenderer.h"
@@ -258,6 +259,12 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesherBase::CreateEmptyChunk() const
 
 void FVoxelMesherBase::FinishCreatingChunk(FVoxelChunkMesh& Chunk) const
 {
+	if (!bIsTransitions && LOD >= Settings.MinDecimationLOD && Settings.DecimationMaxError > 0)
+	{
+		// Lock the first & last cells: they are translated or morphed by the transitions
+		const FBox UnlockedBounds(FVector(Step), FVector((RENDER_CHUNK_SIZE - 1) * Step));
+		Chunk.IterateBuffers([&](auto& Buffer) { FVoxelMeshDecimator(Buffer, UnlockedBounds, Settings.DecimationMaxError * Step).Decimate(); });
+	}
 	if (Settings.bOptimizeIndices)
 	{
 		Chunk.IterateBuffers([](auto& Buffer) { Buffer.OptimizeIndices(); });
@@ -289,6 +296,8 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesher::CreateFullChunk()
 		Data.WorldGenerator->InitArea(FIntBox(ChunkPosition, ChunkPosition + Step * RENDER_CHUNK_SIZE), LOD);
 	}
 
+	if (CancelToken.IsCanceled()) return nullptr;
+
 	LockData();
 
 	TVoxelSharedPtr<FVoxelChunkMesh> Chunk;
@@ -307,13 +316,15 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesher::CreateFullChunk()
 		FVoxelMesherStats::Report(Settings.World, LOD, EndTime - StartTime, Times, false, false);
 	}
 
+	if (CancelToken.IsCanceled()) return nullptr;
+
 	if (Chunk.IsValid())
 	{
 		FinishCreatingChunk(*Chunk);
 
 		if (LOD <= Settings.MaxDistanceFieldLOD)
 		{
-			Chunk->BuildDistanceField(LOD, ChunkPosition, Data);
+			Chunk->BuildDistanceField(LOD, ChunkPosition, Data, GetCachedValues());
 		}
 	}
 
@@ -346,6 +357,11 @@ void FVoxelMesher::CreateGeometry(TArray<uint32>& Indices, TArray<FVector>& Vert
 	}
 }
 
+FVoxelChunkMeshCachedValues FVoxelMesher::GetCachedValues() const
+{
+	return {};
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -368,6 +384,8 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelTransitionsMesher::CreateFullChunk()
 
 	check(TransitionsMask);
 
+	if (CancelToken.IsCanceled()) return nullptr;
+
 	LockData();
 
 	TVoxelSharedPtr<FVoxelChunkMesh> Chunk;
@@ -386,6 +404,8 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelTransitionsMesher::CreateFullChunk()
 		FVoxelMesherStats::Report(Settings.World, LOD, EndTime - StartTime, Times, true, false);
 	}
 
+	if (CancelToken.IsCanceled()) return nullptr;
+
 	if (Chunk.IsValid())
 	{
 		FinishCreatingChunk(*Chunk);
@@ -5,11 +5,13 @@
 #include "CoreMinimal.h"
 #include "IntBox.h"
 #include "VoxelGlobals.h"
+#include "VoxelAsyncWork.h"
 
 struct FVoxelRendererSettings;
 struct FVoxelBlendedMaterialUnsorted;
 struct FVoxelBlendedMaterialSorted;
 struct FVoxelChunkMesh;
+struct FVoxelChunkMeshCachedValues;
 class FVoxelData;
 class FVoxelDataLockInfo;
 
@@ -78,6 +80,9 @@ public:
 	const FVoxelData& Data;
 	const bool bIsTransitions;
 
+	// Set by the mesher work. CreateFullChunk returns null if it's canceled
+	FVoxelCancelToken CancelToken;
+
 	FVoxelMesherBase(
 		int32 LOD,
 		const FIntVector& ChunkPosition,
@@ -122,6 +127,8 @@ protected:
 	virtual TVoxelSharedPtr<FVoxelChunkMesh> CreateFullChunkImpl(FVoxelMesherTimes& Times) = 0;
 	// Need to call UnlockData
 	virtual void CreateGeometryImpl(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<FVector>& Vertices) = 0;
+	// Values queried by CreateFullChunkImpl, reused to build the distance field
+	virtual FVoxelChunkMeshCachedValues GetCachedValues() const;
 };
 
 class FVoxelTransitionsMesher : public FVoxelMesherBase
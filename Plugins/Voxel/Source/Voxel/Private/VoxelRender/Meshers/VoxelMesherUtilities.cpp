@@ -184,6 +184,14 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesherUtilities::CreateChunkFromVertices(
 	VOXEL_FUNCTION_COUNTER();
 
 	auto Chunk = MakeVoxelShared<FVoxelChunkMesh>();
+	{
+		FBox PositionsBounds(ForceInit);
+		for (auto& Vertex : Vertices)
+		{
+			PositionsBounds += Vertex.Position;
+		}
+		Chunk->SetPositionsBounds(PositionsBounds.IsValid ? PositionsBounds : FBox(FVector::ZeroVector, FVector::ZeroVector));
+	}
 
 	Settings.DynamicSettings->DynamicSettingsLock.Lock();
 	const auto MaterialCollectionMap = Settings.DynamicSettings->MaterialCollectionMap; // Copy shared ptr to be safe if the voxel world changes it
@@ -2,6 +2,7 @@
 
 #include "VoxelRender/Meshers/VoxelSurfaceNetMesher.h"
 #include "VoxelRender/Meshers/VoxelMesherUtilities.h"
+#include "VoxelRender/VoxelChunkMesh.h"
 #include "VoxelRender/IVoxelRenderer.h"
 
 struct FVoxelSurfaceNetFullVertex : FVoxelMesherVertex
@@ -502,4 +503,9 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelSurfaceNetMesher::CreateFullChunkImpl(FVo
 void FVoxelSurfaceNetMesher::CreateGeometryImpl(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<FVector>& Vertices)
 {
 	CreateGeometryTemplate(Times, Indices, reinterpret_cast<TArray<FVoxelSurfaceNetGeometryVertex>&>(Vertices));
+}
+
+FVoxelChunkMeshCachedValues FVoxelSurfaceNetMesher::GetCachedValues() const
+{
+	return { CachedValues, FIntVector(0), FIntVector(SN_EXTENDED_CHUNK_SIZE) };
 }
\ No newline at end of file
@@ -19,6 +19,7 @@ protected:
 	virtual FIntBox GetBoundsToLock() const override final;
 	virtual TVoxelSharedPtr<FVoxelChunkMesh> CreateFullChunkImpl(FVoxelMesherTimes& Times) override final;
 	virtual void CreateGeometryImpl(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<FVector>& Vertices) override final;
+	virtual FVoxelChunkMeshCachedValues GetCachedValues() const override final;
 
 private:
 	TUniquePtr<FVoxelConstDataAccelerator> Accelerator;
@@ -0,0 +1,150 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelRender/Renderers/VoxelChunkMeshCache.h"
+#include "VoxelRender/VoxelChunkMesh.h"
+
+DECLARE_MEMORY_STAT(TEXT("Voxel Chunk Mesh Cache"), STAT_VoxelChunkMeshCacheMemory, STATGROUP_VoxelMemory);
+
+FVoxelChunkMeshCache::FVoxelChunkMeshCache(int64 MaxAllocatedSize)
+	: MaxAllocatedSize(MaxAllocatedSize)
+{
+}
+
+FVoxelChunkMeshCache::~FVoxelChunkMeshCache()
+{
+	DEC_MEMORY_STAT_BY(STAT_VoxelChunkMeshCacheMemory, AllocatedSize);
+}
+
+FIntBox FVoxelChunkMeshCache::GetDataBounds(int32 LOD, const FIntVector& Position)
+{
+	// Union of the bounds locked by the meshers and by the distance field builder, with some margin
+	const int32 Step = 1 << LOD;
+	return FIntBox(Position - FIntVector(2 * Step), Position + FIntVector((RENDER_CHUNK_SIZE + 6) * Step));
+}
+
+TVoxelSharedPtr<const FVoxelChunkMesh> FVoxelChunkMeshCache::Find(const FKey& Key, uint64 EditVersion)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+
+	const int32* IndexPtr = Map.Find(Key);
+	if (!IndexPtr)
+	{
+		return nullptr;
+	}
+
+	const int32 Index = *IndexPtr;
+	if (Entries[Index].EditVersion != EditVersion)
+	{
+		// Outdated, will never be used again
+		ensureVoxelSlow(Entries[Index].EditVersion < EditVersion);
+		Remove(Index);
+		return nullptr;
+	}
+
+	Unlink(Index);
+	Link(Index);
+	return Entries[Index].Mesh;
+}
+
+void FVoxelChunkMeshCache::Add(const FKey& Key, uint64 EditVersion, const TVoxelSharedRef<const FVoxelChunkMesh>& Mesh)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+
+	if (const int32* IndexPtr = Map.Find(Key))
+	{
+		if (Entries[*IndexPtr].EditVersion > EditVersion)
+		{
+			// Can happen if an older task finishes after a newer one
+			return;
+		}
+		Remove(*IndexPtr);
+	}
+
+	const int64 EntryAllocatedSize = sizeof(FEntry) + Mesh->GetAllocatedSize();
+	if (EntryAllocatedSize > MaxAllocatedSize)
+	{
+		return;
+	}
+
+	while (AllocatedSize + EntryAllocatedSize > MaxAllocatedSize)
+	{
+		check(Last != -1);
+		Remove(Last);
+	}
+
+	FEntry Entry;
+	Entry.Key = Key;
+	Entry.EditVersion = EditVersion;
+	Entry.Mesh = Mesh;
+	Entry.AllocatedSize = EntryAllocatedSize;
+
+	const int32 Index = Entries.Add(MoveTemp(Entry));
+	Map.Add(Key, Index);
+	Link(Index);
+
+	AllocatedSize += EntryAllocatedSize;
+	INC_MEMORY_STAT_BY(STAT_VoxelChunkMeshCacheMemory, EntryAllocatedSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelChunkMeshCache::Remove(int32 Index)
+{
+	const FEntry& Entry = Entries[Index];
+
+	AllocatedSize -= Entry.AllocatedSize;
+	DEC_MEMORY_STAT_BY(STAT_VoxelChunkMeshCacheMemory, Entry.AllocatedSize);
+
+	verify(Map.Remove(Entry.Key) == 1);
+	Unlink(Index);
+	Entries.RemoveAt(Index);
+}
+
+void FVoxelChunkMeshCache::Link(int32 Index)
+{
+	FEntry& Entry = Entries[Index];
+	checkVoxelSlow(Entry.Previous == -1 && Entry.Next == -1);
+
+	Entry.Next = First;
+	if (First != -1)
+	{
+		Entries[First].Previous = Index;
+	}
+	First = Index;
+	if (Last == -1)
+	{
+		Last = Index;
+	}
+}
+
+void FVoxelChunkMeshCache::Unlink(int32 Index)
+{
+	FEntry& Entry = Entries[Index];
+
+	if (Entry.Previous != -1)
+	{
+		Entries[Entry.Previous].Next = Entry.Next;
+	}
+	else
+	{
+		checkVoxelSlow(First == Index);
+		First = Entry.Next;
+	}
+
+	if (Entry.Next != -1)
+	{
+		Entries[Entry.Next].Previous = Entry.Previous;
+	}
+	else
+	{
+		checkVoxelSlow(Last == Index);
+		Last = Entry.Previous;
+	}
+
+	Entry.Previous = -1;
+	Entry.Next = -1;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IntBox.h"
+#include "VoxelGlobals.h"
+
+struct FVoxelChunkMesh;
+
+// Least recently used cache of the chunk meshes built by a renderer, with a memory budget
+// A mesh is only returned if the data it was built from wasn't edited since, using FVoxelData::GetEditVersion
+// Game thread only
+class FVoxelChunkMeshCache
+{
+public:
+	struct FKey
+	{
+		int32 LOD = 0;
+		FIntVector Position = FIntVector(0);
+		// 0 for main chunks
+		uint8 TransitionsMask = 0;
+
+		FORCEINLINE bool operator==(const FKey& Other) const
+		{
+			return LOD == Other.LOD && Position == Other.Position && TransitionsMask == Other.TransitionsMask;
+		}
+		FORCEINLINE friend uint32 GetTypeHash(const FKey& Key)
+		{
+			return HashCombine(HashCombine(GetTypeHash(Key.Position), GetTypeHash(Key.LOD)), GetTypeHash(Key.TransitionsMask));
+		}
+	};
+
+	explicit FVoxelChunkMeshCache(int64 MaxAllocatedSize);
+	~FVoxelChunkMeshCache();
+
+	// Bounds to compute the edit version on: must contain all the data a mesher can read
+	static FIntBox GetDataBounds(int32 LOD, const FIntVector& Position);
+
+	// Returns null if not in the cache, or if built from an older version of the data
+	TVoxelSharedPtr<const FVoxelChunkMesh> Find(const FKey& Key, uint64 EditVersion);
+	void Add(const FKey& Key, uint64 EditVersion, const TVoxelSharedRef<const FVoxelChunkMesh>& Mesh);
+
+	inline int64 GetAllocatedSize() const
+	{
+		return AllocatedSize;
+	}
+
+private:
+	struct FEntry
+	{
+		FKey Key;
+		uint64 EditVersion = 0;
+		TVoxelSharedPtr<const FVoxelChunkMesh> Mesh;
+		int64 AllocatedSize = 0;
+
+		// Indices in Entries. Previous is more recently used
+		int32 Previous = -1;
+		int32 Next = -1;
+	};
+
+	const int64 MaxAllocatedSize;
+
+	TSparseArray<FEntry> Entries;
+	TMap<FKey, int32> Map;
+	// Most recently used
+	int32 First = -1;
+	// Least recently used
+	int32 Last = -1;
+	int64 AllocatedSize = 0;
+
+	void Remove(int32 Index);
+	void Link(int32 Index);
+	void Unlink(int32 Index);
+};
\ No newline at end of file
@@ -8,13 +8,17 @@
 #include "VoxelRender/Renderers/VoxelRendererBasicMeshHandler.h"
 #include "VoxelRender/Renderers/VoxelRendererClusteredMeshHandler.h"
 #include "VoxelRender/Renderers/VoxelRendererMixedMeshHandler.h"
+#include "VoxelRender/Renderers/VoxelChunkMeshCache.h"
 #include "VoxelRender/VoxelChunkMesh.h"
 #include "VoxelRender/VoxelRenderUtilities.h"
 #include "VoxelRender/VoxelProcMeshBuffers.h"
 #include "VoxelDebug/VoxelDebugManager.h"
 #include "VoxelData/VoxelData.h"
+#include "VoxelFrameScheduler.h"
 
 DECLARE_MEMORY_STAT(TEXT("Voxel Renderer"), STAT_VoxelRenderer, STATGROUP_VoxelMemory);
+DECLARE_MEMORY_STAT(TEXT("Voxel Renderer Hidden Chunks"), STAT_VoxelRendererHiddenChunks, STATGROUP_VoxelMemory);
+DECLARE_MEMORY_STAT(TEXT("Voxel Renderer Hidden Chunks Budget"), STAT_VoxelRendererHiddenChunksBudget, STATGROUP_VoxelMemory);
 
 static TAutoConsoleVariable<int32> CVarFreezeRenderer(
 	TEXT("voxel.renderer.FreezeRenderer"),
@@ -29,6 +33,11 @@ FVoxelDefaultRenderer::FVoxelDefaultRenderer(const FVoxelRendererSettings& Setti
 		: StaticCastVoxelSharedRef<IVoxelRendererMeshHandler>(MakeVoxelShared<FVoxelRendererClusteredMeshHandler>(*this))
 		: StaticCastVoxelSharedRef<IVoxelRendererMeshHandler>(MakeVoxelShared<FVoxelRendererBasicMeshHandler>(*this)))
 {
+	if (Settings.MeshCacheSize > 0)
+	{
+		MeshCache = MakeUnique<FVoxelChunkMeshCache>(Settings.MeshCacheSize);
+	}
+	INC_MEMORY_STAT_BY(STAT_VoxelRendererHiddenChunksBudget, Settings.HiddenChunksMemoryBudget);
 }
 
 TVoxelSharedRef<FVoxelDefaultRenderer> FVoxelDefaultRenderer::Create(const FVoxelRendererSettings& Settings)
@@ -44,6 +53,8 @@ FVoxelDefaultRenderer::~FVoxelDefaultRenderer()
 	VOXEL_FUNCTION_COUNTER();
 
 	DEC_DWORD_STAT_BY(STAT_VoxelRenderer, AllocatedSize);
+	DEC_MEMORY_STAT_BY(STAT_VoxelRendererHiddenChunks, HiddenChunksAllocatedSize);
+	DEC_MEMORY_STAT_BY(STAT_VoxelRendererHiddenChunksBudget, Settings.HiddenChunksMemoryBudget);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -61,6 +72,29 @@ int32 FVoxelDefaultRenderer::UpdateChunks(
 		return 0;
 	}
 
+	if (PrefetchChunksMap.Num() > 0)
+	{
+		VOXEL_SCOPE_COUNTER("Update Prefetch Chunks");
+
+		// The prefetch tasks are only started once, so start them again if their meshes are outdated
+		// StartPrefetchTask checks the edit version and cancels any task started before the edit
+		for (auto& It : PrefetchChunksMap)
+		{
+			FPrefetchChunk& PrefetchChunk = It.Value;
+			if (!FVoxelChunkMeshCache::GetDataBounds(PrefetchChunk.LOD, PrefetchChunk.Bounds.Min).Intersect(Bounds))
+			{
+				continue;
+			}
+
+			StartPrefetchTask(It.Key, PrefetchChunk, EMainOrTransitions::Main);
+			if (PrefetchChunk.TransitionsMask != 0)
+			{
+				StartPrefetchTask(It.Key, PrefetchChunk, EMainOrTransitions::Transitions);
+			}
+		}
+		FlushQueuedTasks();
+	}
+
 	if (ChunksToUpdate.Num() == 0)
 	{
 		return 0;
@@ -69,7 +103,7 @@ int32 FVoxelDefaultRenderer::UpdateChunks(
 	const double Time = FPlatformTime::Seconds();
 	for (auto& ChunkId : ChunksToUpdate)
 	{
-		auto& Chunk = ChunksMap.FindChecked(ChunkId);
+		auto& Chunk = Chunks[ChunksHandles.FindChecked(ChunkId)];
 		Chunk.PendingUpdates.Add({ Time, FinishDelegate });
 		// Trigger tasks if not already triggered: if they are, they will trigger new ones when their callback will be processed in Tick
 		StartTask<EMainOrTransitions::Main, EIfTaskExists::DoNothing>(Chunk);
@@ -82,17 +116,25 @@ int32 FVoxelDefaultRenderer::UpdateChunks(
 	{
 		VOXEL_SCOPE_COUNTER("Cancel Dithering");
 
+		// Chunks to process now. Can't add them to the heaps while iterating them
+		TArray<FChunkHandle> ChunksToForce;
+
 		FIntBoxWithValidity ChunksToRemoveBounds;
 		// First remove all chunks that are dithering out
 		for (auto& ChunkToRemove : ChunksToRemove)
 		{
-			FChunk& Chunk = ChunksMap.FindChecked(ChunkToRemove.Id);
-			if (Chunk.Bounds.Intersect(Bounds))
+			FChunk* Chunk = Chunks.Find(ChunkToRemove.Handle);
+			if (Chunk && Chunk->RemoveTime == ChunkToRemove.Time && Chunk->Bounds.Intersect(Bounds))
 			{
-				ChunkToRemove.Time = 0;
-				ChunksToRemoveBounds += Chunk.Bounds;
+				ChunksToForce.Add(ChunkToRemove.Handle);
+				ChunksToRemoveBounds += Chunk->Bounds;
 			}
 		}
+		for (FChunkHandle Handle : ChunksToForce)
+		{
+			AddChunkToRemove(Chunks[Handle], 0);
+		}
+		ChunksToForce.Reset();
 
 		// Next force show all chunks dithering in overlapping the chunks dithering out we removed
 		// Else they will be holes
@@ -103,12 +145,16 @@ int32 FVoxelDefaultRenderer::UpdateChunks(
 		{
 			for (auto& ChunkToShow : ChunksToShow)
 			{
-				FChunk& Chunk = ChunksMap.FindChecked(ChunkToShow.Id);
-				if (Chunk.Bounds.Intersect(ChunksToRemoveBounds.GetBox()))
+				FChunk* Chunk = Chunks.Find(ChunkToShow.Handle);
+				if (Chunk && Chunk->ShowTime == ChunkToShow.Time && Chunk->Bounds.Intersect(ChunksToRemoveBounds.GetBox()))
 				{
-					ChunkToShow.Time = 0;
+					ChunksToForce.Add(ChunkToShow.Handle);
 				}
 			}
+			for (FChunkHandle Handle : ChunksToForce)
+			{
+				AddChunkToShow(Chunks[Handle], 0);
+			}
 		}
 
 		// Force update as we don't want to have any outdated chunks that could be used if UpdateLODs is called before Tick
@@ -125,7 +171,7 @@ int32 FVoxelDefaultRenderer::UpdateChunks(
 		UpdatedChunks.Reserve(ChunksToUpdate.Num());
 		for (auto& ChunkId : ChunksToUpdate)
 		{
-			auto& Chunk = ChunksMap.FindChecked(ChunkId);
+			auto& Chunk = Chunks[ChunksHandles.FindChecked(ChunkId)];
 			UpdatedChunks.Add(Chunk.Bounds);
 		}
 		return UpdatedChunks;
@@ -160,9 +206,8 @@ void FVoxelDefaultRenderer::ApplyNewMaterials()
 
 	MeshHandler->ClearChunkMaterials();
 
-	for (auto& It : ChunksMap)
+	for (auto& Chunk : Chunks)
 	{
-		const auto& Chunk = It.Value;
 		if (Chunk.MeshId.IsValid() && ensure(Chunk.BuiltData.MainChunk.IsValid()))
 		{
 			MeshHandler->UpdateChunk(
@@ -221,11 +266,12 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 	if (!ensure(UpdateIndex == InUpdateIndex)) return;
 
 	// Map used to know which chunks to wait for before dithering out
-	TMap<uint64, TArray<uint64, TInlineAllocator<8>>> OldChunksToNewChunks;
+	// Key is the render octree id of the old chunk
+	TMap<uint64, TArray<FChunkHandle, TInlineAllocator<8>>> OldChunksToNewChunks;
 	// Need to do it after the main pass, else OldChunksToNewChunks wouldn't be filled
-	TArray<uint64> ChunksToDitherOutOrRemoveOnceNewChunksAreUpdated;
+	TArray<FChunkHandle> ChunksToDitherOutOrRemoveOnceNewChunksAreUpdated;
 	// Can't call ClearPreviousChunks in the Update loop as old chunks are not processed yet
-	TArray<uint64> ChunksPendingClearPreviousChunks;
+	TArray<FChunkHandle> ChunksPendingClearPreviousChunks;
 
 	for (auto& ChunkUpdate : ChunkUpdates)
 	{
@@ -234,15 +280,19 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 
 		const auto GetChunk = [&]() -> FChunk&
 		{
-			FChunk* Chunk = ChunksMap.Find(ChunkUpdate.Id);
-			if (Chunk)
+			FChunk* Chunk = nullptr;
+			if (const FChunkHandle* Handle = ChunksHandles.Find(ChunkUpdate.Id))
 			{
+				Chunk = &Chunks[*Handle];
 				ensure(Chunk->LOD == ChunkUpdate.LOD && Chunk->Bounds == ChunkUpdate.Bounds);
 			}
 			else
 			{
 				ensure(!OldSettings.HasRenderChunk());
-				Chunk = &ChunksMap.Add(ChunkUpdate.Id, FChunk(ChunkUpdate.Id, ChunkUpdate.LOD, ChunkUpdate.Bounds));
+				const FChunkHandle Handle = Chunks.Emplace(ChunkUpdate.Id, ChunkUpdate.LOD, ChunkUpdate.Bounds);
+				ChunksHandles.Add(ChunkUpdate.Id, Handle);
+				Chunk = &Chunks[Handle];
+				Chunk->Handle = Handle;
 			}
 			check(Chunk);
 			return *Chunk;
@@ -263,7 +313,7 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 		{
 			for (auto& PreviousChunkId : ChunkUpdate.PreviousChunks)
 			{
-				OldChunksToNewChunks.FindOrAdd(PreviousChunkId).Add(ChunkUpdate.Id);
+				OldChunksToNewChunks.FindOrAdd(PreviousChunkId).Add(Chunk.Handle);
 			}
 		};
 
@@ -284,13 +334,13 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 				if (Chunk.State == EChunkState::DitheringOut)
 				{
 					ensure(Chunk.PreviousChunks.Num() == 0);
-					ChunksToRemove.RemoveAllSwap([&](auto& X) { return X.Id == Chunk.Id; }, false);
+					Chunk.RemoveTime = -1;
 				}
 				if (Chunk.State == EChunkState::DitheringIn)
 				{
 					ensure(Settings.bDitherChunks);
 					// Note: will probably have previous chunks
-					ChunksToShow.RemoveAllSwap([&](auto& X) { return X.Id == Chunk.Id; }, false);
+					Chunk.ShowTime = -1;
 				}
 			};
 
@@ -313,7 +363,7 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 					{
 						// Do not clear previous chunks now as it's not safe to do so while in Update (as old chunks have not been processed now)
 						// This chunk is already updated, no need to wait for it
-						ChunksPendingClearPreviousChunks.Add(Chunk.Id);
+						ChunksPendingClearPreviousChunks.Add(Chunk.Handle);
 					}
 					else
 					{
@@ -336,7 +386,7 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 					// So if there was an edit, the chunk would already be deleted
 
 					// This chunk is already updated, no need to wait for it
-					ChunksPendingClearPreviousChunks.Add(Chunk.Id);
+					ChunksPendingClearPreviousChunks.Add(Chunk.Handle);
 					break;
 				}
 				case EChunkState::DitheringIn:
@@ -348,7 +398,7 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 					{
 						// If we have not tasks but still dithering in, then the mesh must be already updated
 						// No need to wait
-						ChunksPendingClearPreviousChunks.Add(Chunk.Id);
+						ChunksPendingClearPreviousChunks.Add(Chunk.Handle);
 					}
 					break;
 				}
@@ -356,6 +406,14 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 				{
 					ensure(Chunk.NumNewChunksLeft == 0);
 					ensure(Chunk.PreviousChunks.Num() == 0);
+					if (Chunk.bBuiltDataEvicted)
+					{
+						// Our meshes were freed: same as a new chunk, the previous chunks need to wait for the task
+						// The mesh is kept hidden until then, and dithered in by the task callback
+						ensure(Chunk.MeshId.IsValid());
+						StartTask<EMainOrTransitions::Main, EIfTaskExists::DoNothing>(Chunk);
+						break;
+					}
 					if (Chunk.MeshId.IsValid())
 					{
 						// Note: will be shown by ApplyPendingSettings below
@@ -364,11 +422,12 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 							// Dither as we were hidden
 							// Dither out of the other chunks will happen when processing ChunksPendingClearPreviousChunks
 							// So both surface nets cases are correctly handled
-							DitherInChunk(Chunk, ChunkUpdate.PreviousChunks);
+							const FChunkHandle* PreviousChunkHandle = ChunkUpdate.PreviousChunks.Num() > 0 ? ChunksHandles.Find(ChunkUpdate.PreviousChunks[0]) : nullptr;
+							DitherInChunk(Chunk, PreviousChunkHandle ? Chunks.Find(*PreviousChunkHandle) : nullptr);
 						}
 					}
 					// This chunk is already updated, no need to wait for it
-					ChunksPendingClearPreviousChunks.Add(Chunk.Id);
+					ChunksPendingClearPreviousChunks.Add(Chunk.Handle);
 					break;
 				}
 				case EChunkState::NewChunk:
@@ -383,6 +442,7 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 				Chunk.UpdateIndex = UpdateIndex;
 
 				Chunk.State = Settings.bDitherChunks ? EChunkState::DitheringIn : EChunkState::Showed;
+				UpdateHiddenChunk(Chunk);
 				if (!Chunk.MeshId.IsValid())
 				{
 					// If we don't have a mesh:
@@ -438,13 +498,12 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 				}
 
 				// We can't be in any of these states if we get here
-				ensureVoxelSlow(!ChunksToRemove.FindByPredicate([&](const FChunkToRemove& ChunkToRemove) { return ChunkToRemove.Id == Chunk.Id; }));
-				ensureVoxelSlow(!ChunksToShow.FindByPredicate([&](const FChunkToShow& ChunkToShow) { return ChunkToShow.Id == Chunk.Id; }));
+				ensureVoxelSlow(Chunk.RemoveTime < 0 && Chunk.ShowTime < 0);
 
 				if (!NewSettings.HasRenderChunk())
 				{
 					// If this chunk is being removed, no need to finish computing the tasks
-					CancelTasks(Chunk);
+					CancelTasks(Chunk.Tasks);
 				}
 
 				if (!Chunk.MeshId.IsValid() && Chunk.PreviousChunks.Num() == 0)
@@ -465,7 +524,7 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 				else
 				{
 					Chunk.State = EChunkState::WaitingForNewChunks;
-					ChunksToDitherOutOrRemoveOnceNewChunksAreUpdated.Add(Chunk.Id);
+					ChunksToDitherOutOrRemoveOnceNewChunksAreUpdated.Add(Chunk.Handle);
 				}
 			}
 
@@ -505,25 +564,25 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 	{
 		VOXEL_SCOPE_COUNTER("Old Chunks");
 		// Now that OldChunksToNewChunks is fully built, add previous chunks
-		for (uint64 OldChunkId : ChunksToDitherOutOrRemoveOnceNewChunksAreUpdated)
+		for (FChunkHandle OldChunkHandle : ChunksToDitherOutOrRemoveOnceNewChunksAreUpdated)
 		{
-			auto* NewChunks = OldChunksToNewChunks.Find(OldChunkId);
+			FChunk& OldChunk = Chunks[OldChunkHandle];
+			auto* NewChunks = OldChunksToNewChunks.Find(OldChunk.Id);
 
 			// NewChunks is invalid when we don't have new chunks to replace us
 			// This seems to only happen when bEnableRender is set to false at runtime
 
-			FChunk& OldChunk = ChunksMap.FindChecked(OldChunkId);
 			ensure(OldChunk.MeshId.IsValid() || OldChunk.PreviousChunks.Num() > 0); // We need to have a mesh or be waiting for previous ones
 			ensure(OldChunk.NumNewChunksLeft == 0);
 			ensure(OldChunk.State == EChunkState::WaitingForNewChunks);
 
 			if (NewChunks)
 			{
-				for (uint64 NewChunkId : *NewChunks)
+				for (FChunkHandle NewChunkHandle : *NewChunks)
 				{
-					auto& NewChunk = ChunksMap.FindChecked(NewChunkId);
+					auto& NewChunk = Chunks[NewChunkHandle];
 					// AddUnique: in some cases NewChunks is already referencing us
-					NewChunk.PreviousChunks.AddUnique(OldChunkId);
+					NewChunk.PreviousChunks.AddUnique(OldChunkHandle);
 					OldChunk.NumNewChunksLeft++;
 				}
 			}
@@ -541,19 +600,19 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 		VOXEL_SCOPE_COUNTER("ClearPreviousChunks");
 		// Process all meshes already displayed
 		// Need to do it because needs to be done after old chunks
-		for (uint64 Id : ChunksPendingClearPreviousChunks)
+		for (FChunkHandle Handle : ChunksPendingClearPreviousChunks)
 		{
-			ClearPreviousChunks(ChunksMap.FindChecked(Id));
+			ClearPreviousChunks(Chunks[Handle]);
 		}
 	}
 
 	Settings.DebugManager->ReportRenderChunks([&]()
 	{
 		TArray<FIntBox> Result;
-		Result.Reserve(ChunksMap.Num());
-		for (auto& It : ChunksMap)
+		Result.Reserve(Chunks.Num());
+		for (auto& Chunk : Chunks)
 		{
-			Result.Add(It.Value.Bounds);
+			Result.Add(Chunk.Bounds);
 		}
 		return Result;
 	});
@@ -570,18 +629,26 @@ void FVoxelDefaultRenderer::Destroy()
 	// Destroy mesh handler & meshes
 	MeshHandler->StartDestroying();
 
-	for (auto& It : ChunksMap)
+	for (auto& Chunk : Chunks)
 	{
-		CancelTasks(It.Value);
-		if (It.Value.MeshId.IsValid())
+		CancelTasks(Chunk.Tasks);
+		if (Chunk.MeshId.IsValid())
 		{
 			// Not really needed, but useful for error checks
-			MeshHandler->RemoveChunk(It.Value.MeshId);
+			MeshHandler->RemoveChunk(Chunk.MeshId);
 		}
 	}
 
-	ChunksMap.Reset();
+	Chunks.Reset();
+	ChunksHandles.Reset();
+	ChunksToRemove.Reset();
+	ChunksToShow.Reset();
+	HiddenChunks.Reset();
+	DEC_MEMORY_STAT_BY(STAT_VoxelRendererHiddenChunks, HiddenChunksAllocatedSize);
+	HiddenChunksAllocatedSize = 0;
 	MeshHandler.Reset();
+
+	CancelPrefetch();
 }
 
 void FVoxelDefaultRenderer::CreateGeometry_AnyThread(
@@ -593,6 +660,75 @@ void FVoxelDefaultRenderer::CreateGeometry_AnyThread(
 	FVoxelMesherAsyncWork::CreateGeometry_AnyThread(*this, LOD, ChunkPosition, OutIndices, OutVertices);
 }
 
+void FVoxelDefaultRenderer::PrefetchChunks(const TArray<FVoxelChunkUpdate>& ChunkUpdates)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// The LOD manager doesn't prefetch without a mesh cache, as there would be nowhere to store the meshes
+	if (!ensure(MeshCache.IsValid()))
+	{
+		return;
+	}
+
+	for (auto& ChunkUpdate : ChunkUpdates)
+	{
+		if (!ChunkUpdate.NewSettings.bVisible)
+		{
+			if (FPrefetchChunk* PrefetchChunk = PrefetchChunksMap.Find(ChunkUpdate.Id))
+			{
+				CancelTasks(PrefetchChunk->Tasks);
+				PrefetchChunksMap.Remove(ChunkUpdate.Id);
+			}
+			continue;
+		}
+
+		const uint8 TransitionsMask = FVoxelUtilities::UsesParentPositionTransitions(Settings.RenderType) ? 0 : ChunkUpdate.NewSettings.TransitionsMask;
+
+		FPrefetchChunk* PrefetchChunk = PrefetchChunksMap.Find(ChunkUpdate.Id);
+		if (!PrefetchChunk)
+		{
+			PrefetchChunk = &PrefetchChunksMap.Add(ChunkUpdate.Id);
+			PrefetchChunk->LOD = ChunkUpdate.LOD;
+			PrefetchChunk->Bounds = ChunkUpdate.Bounds;
+			PrefetchChunk->TransitionsMask = TransitionsMask;
+
+			StartPrefetchTask(ChunkUpdate.Id, *PrefetchChunk, EMainOrTransitions::Main);
+			if (TransitionsMask != 0)
+			{
+				StartPrefetchTask(ChunkUpdate.Id, *PrefetchChunk, EMainOrTransitions::Transitions);
+			}
+		}
+		else if (PrefetchChunk->TransitionsMask != TransitionsMask)
+		{
+			PrefetchChunk->TransitionsMask = TransitionsMask;
+			if (TransitionsMask != 0)
+			{
+				StartPrefetchTask(ChunkUpdate.Id, *PrefetchChunk, EMainOrTransitions::Transitions);
+			}
+			else if (PrefetchChunk->Tasks.TransitionsTask.IsValid())
+			{
+				CancelTask(PrefetchChunk->Tasks.TransitionsTask);
+			}
+		}
+	}
+
+	FlushQueuedTasks();
+}
+
+void FVoxelDefaultRenderer::CancelPrefetch()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	for (auto& It : PrefetchChunksMap)
+	{
+		CancelTasks(It.Value.Tasks);
+	}
+	PrefetchChunksMap.Reset();
+
+	// Tasks are only queued in PrefetchChunks, which always flushes them
+	ensure(QueuedPrefetchTasks.Num() == 0);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void FVoxelDefaultRenderer::Tick(float DeltaTime)
@@ -604,8 +740,17 @@ void FVoxelDefaultRenderer::Tick(float DeltaTime)
 		return;
 	}
 
+	{
+		VOXEL_SCOPE_COUNTER("Physics Callbacks");
+		// Outside of the renderer budget scope, else its time would be counted twice
+		FVoxelFrameBudgetScope PhysicsCallbacksBudget(EVoxelFrameBudgetCategory::PhysicsCallbacks);
+		PhysicsCallbacksBudget.SetNumDeferred(MeshHandler->TickPhysicsCallbacks(PhysicsCallbacksBudget.GetMaxTime()));
+	}
+
+	FVoxelFrameBudgetScope FrameBudget(EVoxelFrameBudgetCategory::Renderer);
+
 	const double Time = FPlatformTime::Seconds();
-	const double MaxTime = Time + Settings.MeshUpdatesBudget * 0.001f;
+	const double MaxTime = FMath::Min(Time + Settings.MeshUpdatesBudget * 0.001f, FrameBudget.GetMaxTime());
 
 	{
 		VOXEL_SCOPE_COUNTER("MeshHandler Tick");
@@ -622,7 +767,13 @@ void FVoxelDefaultRenderer::Tick(float DeltaTime)
 			FPlatformTime::Seconds() < MaxTime &&
 			TasksCallbacksQueue.Dequeue(Callback))
 		{
-			FChunk* Chunk = ChunksMap.Find(Callback.ChunkId);
+			if (Callback.bIsPrefetchTask)
+			{
+				ProcessPrefetchTaskCallback(Callback.TaskId, Callback.ChunkId, Callback.bIsTransitionTask);
+				continue;
+			}
+
+			FChunk* Chunk = Chunks.Find(FChunkHandle::FromUint64(Callback.ChunkId));
 			if (!Chunk) continue;
 
 			auto& Tasks = Chunk->Tasks;
@@ -630,9 +781,15 @@ void FVoxelDefaultRenderer::Tick(float DeltaTime)
 			if (!Task.IsValid() || Task->TaskId != Callback.TaskId) continue; // If task was canceled
 			if (!ensure(Task->IsDone())) continue; // Must be done if we're in the callback
 
+			if (MeshCache.IsValid() && !Task->bIsCachedChunk)
+			{
+				MeshCache->Add({ Chunk->LOD, Chunk->Bounds.Min, Task->TransitionsMask }, Task->EditVersion, Task->Chunk.ToSharedRef());
+			}
+
 			// Move built data
 			auto& BuiltData = Chunk->BuiltData;
 			const auto PreviousBuiltData = BuiltData;
+			const bool bWasEvicted = Chunk->bBuiltDataEvicted;
 			if (Callback.bIsTransitionTask)
 			{
 				ensure(Task->TransitionsMask == Chunk->Settings.TransitionsMask); // Should have been canceled
@@ -644,6 +801,7 @@ void FVoxelDefaultRenderer::Tick(float DeltaTime)
 			{
 				BuiltData.MainChunk = Task->Chunk;
 				BuiltData.MainChunkCreationTime = Task->CreationTime;
+				Chunk->bBuiltDataEvicted = false;
 			}
 
 			// Finally, delete the task
@@ -672,7 +830,7 @@ void FVoxelDefaultRenderer::Tick(float DeltaTime)
 				const bool bTransitionsChunkIsBuilt =
 					BuiltData.TransitionsChunk.IsValid() ||
 					Chunk->Settings.TransitionsMask == 0 ||
-					Settings.RenderType == EVoxelRenderType::SurfaceNets;
+					FVoxelUtilities::UsesParentPositionTransitions(Settings.RenderType);
 
 				if (BuiltData.MainChunk->IsEmpty() && (!BuiltData.TransitionsChunk.IsValid() || BuiltData.TransitionsChunk->IsEmpty()))
 				{
@@ -698,10 +856,11 @@ void FVoxelDefaultRenderer::Tick(float DeltaTime)
 						// Can be a first update if:
 						// - we are a showed new chunks that's dithering in
 						// - we are a hidden chunk that's updated for the first time. If so don't dither in
-						ensure(Chunk->State == EChunkState::Hidden || Chunk->State == EChunkState::DitheringIn);
+						// - our meshes were freed while hidden
+						ensure(Chunk->State == EChunkState::Hidden || Chunk->State == EChunkState::DitheringIn || bWasEvicted);
 						if (Chunk->State == EChunkState::DitheringIn)
 						{
-							DitherInChunk(*Chunk, Chunk->PreviousChunks);
+							DitherInChunk(*Chunk, Chunk->PreviousChunks.Num() > 0 ? Chunks.Find(Chunk->PreviousChunks[0]) : nullptr);
 						}
 					}
 				}
@@ -713,6 +872,12 @@ void FVoxelDefaultRenderer::Tick(float DeltaTime)
 					ClearPreviousChunks(*Chunk);
 				}
 			}
+			else if (Chunk->bBuiltDataEvicted)
+			{
+				// Keep the old mesh until the main chunk is built again
+				ensure(Chunk->MeshId.IsValid());
+				StartTask<EMainOrTransitions::Main, EIfTaskExists::DoNothing>(*Chunk);
+			}
 			else
 			{
 				ensure(!Chunk->MeshId.IsValid());
@@ -720,11 +885,17 @@ void FVoxelDefaultRenderer::Tick(float DeltaTime)
 
 			// Start new tasks as needed
 			CheckPendingUpdates(*Chunk);
+
+			UpdateHiddenChunk(*Chunk);
 		}
 	}
 
+	EvictHiddenChunks();
+
 	FlushQueuedTasks();
 
+	FrameBudget.SetNumDeferred(TasksCallbacksQueue.Num());
+
 	if (!OnWorldLoadedFired && UpdateIndex > 0 && TaskCount.GetValue() == 0 && TasksCallbacksQueue.IsEmpty())
 	{
 		OnWorldLoaded.Broadcast();
@@ -735,6 +906,23 @@ void FVoxelDefaultRenderer::Tick(float DeltaTime)
 
 	Settings.DebugManager->ReportMeshTaskCount(TaskCount.GetValue());
 	Settings.DebugManager->ReportMeshTasksCallbacksQueueNum(TasksCallbacksQueue.Num());
+
+	if (Settings.DebugManager->IsMeasuringTimeToVisible())
+	{
+		VOXEL_SCOPE_COUNTER("Count in view mesh tasks");
+
+		int32 InViewMeshTaskCount = 0;
+		for (const FChunk& Chunk : Chunks)
+		{
+			if (Chunk.Tasks.MainTask.IsValid() &&
+				(Chunk.Settings.bVisible || Chunk.PendingSettings.bVisible) &&
+				FVoxelPriorityHandler(Chunk.Bounds, GetInvokersPositions()).IsInView())
+			{
+				InViewMeshTaskCount++;
+			}
+		}
+		Settings.DebugManager->ReportInViewMeshTaskCount(InViewMeshTaskCount);
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -761,7 +949,7 @@ void FVoxelDefaultRenderer::StartTask(FChunk& Chunk)
 
 	if (MainOrTransitions == EMainOrTransitions::Transitions)
 	{
-		if (Settings.RenderType == EVoxelRenderType::SurfaceNets)
+		if (FVoxelUtilities::UsesParentPositionTransitions(Settings.RenderType))
 		{
 			if (Chunk.MeshId.IsValid())
 			{
@@ -798,26 +986,91 @@ void FVoxelDefaultRenderer::StartTask(FChunk& Chunk)
 
 	Task = MakeUnique<FVoxelMesherAsyncWork>(
 		*this,
-		Chunk.Id,
+		Chunk.Handle.ToUint64(),
 		Chunk.LOD,
 		Chunk.Bounds,
 		MainOrTransitions == EMainOrTransitions::Transitions,
 		MainOrTransitions == EMainOrTransitions::Transitions ? Chunk.Settings.TransitionsMask : 0);
+
+	if (MeshCache.IsValid())
+	{
+		const uint64 EditVersion = Settings.Data->GetEditVersion(FVoxelChunkMeshCache::GetDataBounds(Chunk.LOD, Chunk.Bounds.Min));
+		const auto CachedChunk = MeshCache->Find({ Chunk.LOD, Chunk.Bounds.Min, Task->TransitionsMask }, EditVersion);
+		if (CachedChunk.IsValid())
+		{
+			// No need to mesh: the task callback will be processed in Tick like the others
+			TaskCount.Increment();
+			Task->FinishWithCachedChunk(CachedChunk.ToSharedRef());
+			return;
+		}
+	}
+
 	QueuedTasks[Chunk.Settings.bVisible][Chunk.Settings.bEnableCollisions].Emplace(Task.Get());
 }
 
-void FVoxelDefaultRenderer::CancelTasks(FChunk& Chunk)
+void FVoxelDefaultRenderer::CancelTasks(FChunk::FChunkTasks& Tasks)
 {
 	VOXEL_FUNCTION_COUNTER();
 
-	if (Chunk.Tasks.MainTask.IsValid())
+	if (Tasks.MainTask.IsValid())
 	{
-		CancelTask(Chunk.Tasks.MainTask);
+		CancelTask(Tasks.MainTask);
 	}
-	if (Chunk.Tasks.TransitionsTask.IsValid())
+	if (Tasks.TransitionsTask.IsValid())
+	{
+		CancelTask(Tasks.TransitionsTask);
+	}
+}
+
+void FVoxelDefaultRenderer::StartPrefetchTask(uint64 Id, FPrefetchChunk& PrefetchChunk, EMainOrTransitions MainOrTransitions)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(MeshCache.IsValid());
+
+	const bool bIsTransitionTask = MainOrTransitions == EMainOrTransitions::Transitions;
+	auto& Task = bIsTransitionTask ? PrefetchChunk.Tasks.TransitionsTask : PrefetchChunk.Tasks.MainTask;
+	if (Task.IsValid())
+	{
+		CancelTask(Task);
+	}
+
+	const uint8 TransitionsMask = bIsTransitionTask ? PrefetchChunk.TransitionsMask : 0;
+	const uint64 EditVersion = Settings.Data->GetEditVersion(FVoxelChunkMeshCache::GetDataBounds(PrefetchChunk.LOD, PrefetchChunk.Bounds.Min));
+	if (MeshCache->Find({ PrefetchChunk.LOD, PrefetchChunk.Bounds.Min, TransitionsMask }, EditVersion).IsValid())
+	{
+		// Already up to date
+		return;
+	}
+
+	Task = MakeUnique<FVoxelMesherAsyncWork>(
+		*this,
+		Id,
+		PrefetchChunk.LOD,
+		PrefetchChunk.Bounds,
+		bIsTransitionTask,
+		TransitionsMask,
+		true);
+	QueuedPrefetchTasks.Add(Task.Get());
+}
+
+void FVoxelDefaultRenderer::ProcessPrefetchTaskCallback(uint64 TaskId, uint64 PrefetchChunkId, bool bIsTransitionTask)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	FPrefetchChunk* PrefetchChunk = PrefetchChunksMap.Find(PrefetchChunkId);
+	if (!PrefetchChunk) return;
+
+	auto& Task = bIsTransitionTask ? PrefetchChunk->Tasks.TransitionsTask : PrefetchChunk->Tasks.MainTask;
+	if (!Task.IsValid() || Task->TaskId != TaskId) return; // If task was canceled
+	if (!ensure(Task->IsDone())) return;
+
+	if (ensure(MeshCache.IsValid()))
 	{
-		CancelTask(Chunk.Tasks.TransitionsTask);
+		MeshCache->Add({ PrefetchChunk->LOD, PrefetchChunk->Bounds.Min, Task->TransitionsMask }, Task->EditVersion, Task->Chunk.ToSharedRef());
 	}
+
+	// Keep the prefetch chunk so that it's not queued again, until it's canceled or edited (see UpdateChunks)
+	Task.Reset();
 }
 
 void FVoxelDefaultRenderer::ClearPreviousChunks(FChunk& Chunk)
@@ -826,13 +1079,15 @@ void FVoxelDefaultRenderer::ClearPreviousChunks(FChunk& Chunk)
 
 	VOXEL_FUNCTION_COUNTER();
 
-	static TSet<uint64> StackIds;
-	if (!ensure(!StackIds.Contains(Chunk.Id))) return;
-	StackIds.Add(Chunk.Id);
+	static TSet<FChunkHandle> StackHandles;
+	if (!ensure(!StackHandles.Contains(Chunk.Handle))) return;
+	StackHandles.Add(Chunk.Handle);
 
-	for (uint64 PreviousChunkId : Chunk.PreviousChunks)
+	for (FChunkHandle PreviousChunkHandle : Chunk.PreviousChunks)
 	{
-		auto& PreviousChunk = ChunksMap.FindChecked(PreviousChunkId);
+		FChunk* PreviousChunkPtr = Chunks.Find(PreviousChunkHandle);
+		if (!PreviousChunkPtr) continue; // This previous chunk has been destroyed since it was added to our PreviousChunk list
+		auto& PreviousChunk = *PreviousChunkPtr;
 		if (PreviousChunk.UpdateIndex > Chunk.UpdateIndex) continue; // This previous chunk has been updated since it was added to our PreviousChunk list
 
 		ensure(PreviousChunk.State == EChunkState::WaitingForNewChunks); // Should be true if the UpdateIndex is correct
@@ -850,7 +1105,7 @@ void FVoxelDefaultRenderer::ClearPreviousChunks(FChunk& Chunk)
 
 	Chunk.PreviousChunks.Reset();
 
-	ensure(StackIds.Remove(Chunk.Id) == 1);
+	ensure(StackHandles.Remove(Chunk.Handle) == 1);
 }
 
 void FVoxelDefaultRenderer::NewChunksFinished(FChunk& Chunk, const FChunk& NewChunk)
@@ -859,8 +1114,7 @@ void FVoxelDefaultRenderer::NewChunksFinished(FChunk& Chunk, const FChunk& NewCh
 
 	ensure(Chunk.State == EChunkState::WaitingForNewChunks);
 	ensure(Chunk.NumNewChunksLeft == 0);
-	ensureVoxelSlow(!ChunksToRemove.FindByPredicate([&](const FChunkToRemove& ChunkToRemove) { return ChunkToRemove.Id == Chunk.Id; }));
-	ensureVoxelSlow(!ChunksToShow.FindByPredicate([&](const FChunkToShow& ChunkToShow) { return ChunkToShow.Id == Chunk.Id; }));
+	ensureVoxelSlow(Chunk.RemoveTime < 0 && Chunk.ShowTime < 0);
 
 	ClearPreviousChunks(Chunk); // Recursively delete previous chunks
 
@@ -877,7 +1131,7 @@ void FVoxelDefaultRenderer::NewChunksFinished(FChunk& Chunk, const FChunk& NewCh
 			Chunk.PendingSettings.bVisible = false;
 			ensure(Chunk.Settings.bVisible == true);
 		};
-		if (Settings.RenderType == EVoxelRenderType::SurfaceNets)
+		if (FVoxelUtilities::UsesParentPositionTransitions(Settings.RenderType))
 		{
 			// For surface nets, the only chunk that can transition is the high res one
 			// So check if we're the high res one, and if not just delete self
@@ -888,7 +1142,7 @@ void FVoxelDefaultRenderer::NewChunksFinished(FChunk& Chunk, const FChunk& NewCh
 				{
 					Chunk.State = EChunkState::DitheringOut;
 					MeshHandler->DitherChunk(Chunk.MeshId, EDitheringType::SurfaceNets_HighResToLowRes);
-					ChunksToRemove.Add(FChunkToRemove{ Chunk.Id, FPlatformTime::Seconds() + Settings.ChunksDitheringDuration });
+					AddChunkToRemove(Chunk, FPlatformTime::Seconds() + Settings.ChunksDitheringDuration);
 				}
 				else
 				{
@@ -908,7 +1162,7 @@ void FVoxelDefaultRenderer::NewChunksFinished(FChunk& Chunk, const FChunk& NewCh
 				Chunk.State = EChunkState::DitheringOut;
 				MeshHandler->DitherChunk(Chunk.MeshId, EDitheringType::Classic_DitherOut);
 				// 2x: First dithering in new chunk, then dither out old chunk
-				ChunksToRemove.Add(FChunkToRemove{ Chunk.Id, FPlatformTime::Seconds() + 2 * Settings.ChunksDitheringDuration });
+				AddChunkToRemove(Chunk, FPlatformTime::Seconds() + 2 * Settings.ChunksDitheringDuration);
 			}
 			else
 			{
@@ -932,8 +1186,7 @@ void FVoxelDefaultRenderer::RemoveOrHideChunk(FChunk& Chunk)
 	// DitheringOut if dithering enabled, else it's removed once WaitingForNewChunks is over
 	ensure(Chunk.State == EChunkState::DitheringOut || Chunk.State == EChunkState::WaitingForNewChunks);
 
-	ensureVoxelSlow(!ChunksToRemove.FindByPredicate([&](const FChunkToRemove& ChunkToRemove) { return ChunkToRemove.Id == Chunk.Id; }));
-	ensureVoxelSlow(!ChunksToShow.FindByPredicate([&](const FChunkToShow& ChunkToShow) { return ChunkToShow.Id == Chunk.Id; }));
+	ensureVoxelSlow(Chunk.RemoveTime < 0 && Chunk.ShowTime < 0);
 
 	// Note: MeshId might be 0 if we were waiting for other chunks
 
@@ -949,10 +1202,11 @@ void FVoxelDefaultRenderer::RemoveOrHideChunk(FChunk& Chunk)
 	{
 		ApplyPendingSettings(Chunk); // Can apply the real settings now
 		Chunk.State = EChunkState::Hidden;
+		UpdateHiddenChunk(Chunk);
 	}
 	else
 	{
-		CancelTasks(Chunk);
+		CancelTasks(Chunk.Tasks);
 		if (Chunk.MeshId.IsValid())
 		{
 			MeshHandler->RemoveChunk(Chunk.MeshId);
@@ -963,46 +1217,43 @@ void FVoxelDefaultRenderer::RemoveOrHideChunk(FChunk& Chunk)
 	}
 }
 
-void FVoxelDefaultRenderer::DitherInChunk(FChunk& Chunk, const TArray<uint64, TInlineAllocator<8>>& PreviousChunks)
+void FVoxelDefaultRenderer::DitherInChunk(FChunk& Chunk, const FChunk* PreviousChunk)
 {
 	VOXEL_FUNCTION_COUNTER();
 
 	if (!ensure(Chunk.MeshId.IsValid())) return;
 
-	ensureVoxelSlow(!ChunksToRemove.FindByPredicate([&](const FChunkToRemove& ChunkToRemove) { return ChunkToRemove.Id == Chunk.Id; }));
-	ensureVoxelSlow(!ChunksToShow.FindByPredicate([&](const FChunkToShow& ChunkToShow) { return ChunkToShow.Id == Chunk.Id; }));
+	ensureVoxelSlow(Chunk.RemoveTime < 0 && Chunk.ShowTime < 0);
 
-	if (Settings.RenderType == EVoxelRenderType::SurfaceNets)
+	if (FVoxelUtilities::UsesParentPositionTransitions(Settings.RenderType))
 	{
 		// For surface nets, the only chunk that can transition is the high res one
 		// So check if we're the high res one, and if not just hide self until previous one finished dithering
 
 		// If no previous chunk nothing to transition from, just show
-		if (PreviousChunks.Num() > 0)
+		if (PreviousChunk)
 		{
-			const FChunk& PreviousChunk = ChunksMap[PreviousChunks[0]];
-			// PreviousChunk is always valid, as the LOD of a specific Id is always the same
-			// No need to check UpdateIndex etc
+			// No need to check UpdateIndex etc, as the LOD of a specific Id is always the same
 
-			if (PreviousChunk.LOD > Chunk.LOD)
+			if (PreviousChunk->LOD > Chunk.LOD)
 			{
 				// We are the high res one
 				MeshHandler->DitherChunk(Chunk.MeshId, EDitheringType::SurfaceNets_LowResToHighRes);
-				ChunksToShow.Add(FChunkToShow{ Chunk.Id, FPlatformTime::Seconds() + Settings.ChunksDitheringDuration });
+				AddChunkToShow(Chunk, FPlatformTime::Seconds() + Settings.ChunksDitheringDuration);
 			}
 			else
 			{
 				// We are the low res: the high res will do the work
 				// Note: bTransitionsChunkIsBuilt is always true for surface nets, so dithering will happen at the same time for both
 				MeshHandler->HideChunk(Chunk.MeshId);
-				ChunksToShow.Add(FChunkToShow{ Chunk.Id, FPlatformTime::Seconds() + Settings.ChunksDitheringDuration });
+				AddChunkToShow(Chunk, FPlatformTime::Seconds() + Settings.ChunksDitheringDuration);
 			}
 		}
 	}
 	else
 	{
 		MeshHandler->DitherChunk(Chunk.MeshId, EDitheringType::Classic_DitherIn);
-		ChunksToShow.Add(FChunkToShow{ Chunk.Id, FPlatformTime::Seconds() + Settings.ChunksDitheringDuration });
+		AddChunkToShow(Chunk, FPlatformTime::Seconds() + Settings.ChunksDitheringDuration);
 	}
 }
 
@@ -1020,7 +1271,12 @@ void FVoxelDefaultRenderer::ApplyPendingSettings(FChunk& Chunk)
 		NewSettings.bEnableNavmesh != OldSettings.bEnableNavmesh ||
 		NewSettings.bEnableTessellation != OldSettings.bEnableTessellation)
 	{
-		if (Chunk.MeshId.IsValid() && ensure(Chunk.BuiltData.MainChunk.IsValid())) // If we have a mesh we must have a built chunk
+		if (Chunk.bBuiltDataEvicted)
+		{
+			// The task callback will update the mesh with the new settings
+			StartTask<EMainOrTransitions::Main, EIfTaskExists::DoNothing>(Chunk);
+		}
+		else if (Chunk.MeshId.IsValid() && ensure(Chunk.BuiltData.MainChunk.IsValid())) // If we have a mesh we must have a built chunk, unless it was evicted
 		{
 			MeshHandler->UpdateChunk(
 				Chunk.MeshId,
@@ -1097,33 +1353,33 @@ void FVoxelDefaultRenderer::ProcessChunksToRemoveOrShow()
 	{
 		VOXEL_SCOPE_COUNTER("Processing ChunksToShow");
 		ensure(Settings.bDitherChunks || ChunksToShow.Num() == 0);
-		for (int32 Index = 0; Index < ChunksToShow.Num(); Index++)
+		while (ChunksToShow.Num() > 0 && ChunksToShow.HeapTop().Time < Time)
 		{
-			const auto ChunkToShow = ChunksToShow[Index];
-			if (ChunkToShow.Time < Time)
-			{
-				FChunk& Chunk = ChunksMap.FindChecked(ChunkToShow.Id);
-				if (Chunk.State != EChunkState::DitheringIn) continue; // Chunk is not dithering in anymore
+			FChunkDeadline ChunkToShow;
+			ChunksToShow.HeapPop(ChunkToShow, false);
 
-				// ensure(Chunk.PreviousChunks.Num() == 0); Not always true: main chunk can have finished dithering but transitions still being computed
-				Chunk.State = EChunkState::Showed;
+			FChunk* ChunkPtr = Chunks.Find(ChunkToShow.Handle);
+			if (!ChunkPtr || ChunkPtr->ShowTime != ChunkToShow.Time) continue; // Outdated entry
+			FChunk& Chunk = *ChunkPtr;
+			Chunk.ShowTime = -1;
 
-				if (Chunk.MeshId.IsValid())
+			if (Chunk.State != EChunkState::DitheringIn) continue; // Chunk is not dithering in anymore
+
+			// ensure(Chunk.PreviousChunks.Num() == 0); Not always true: main chunk can have finished dithering but transitions still being computed
+			Chunk.State = EChunkState::Showed;
+
+			if (Chunk.MeshId.IsValid())
+			{
+				if (FVoxelUtilities::UsesParentPositionTransitions(Settings.RenderType))
 				{
-					if (Settings.RenderType == EVoxelRenderType::SurfaceNets)
-					{
-						// If we were the low res chunk we were hidden
-						MeshHandler->ShowChunk(Chunk.MeshId);
-					}
-					else
-					{
-						// Needed if it was canceled in UpdateChunks
-						MeshHandler->ResetDithering(Chunk.MeshId);
-					}
+					// If we were the low res chunk we were hidden
+					MeshHandler->ShowChunk(Chunk.MeshId);
+				}
+				else
+				{
+					// Needed if it was canceled in UpdateChunks
+					MeshHandler->ResetDithering(Chunk.MeshId);
 				}
-
-				ChunksToShow.RemoveAtSwap(Index, 1, false);
-				Index--; // Go back to process the element we swapped
 			}
 		}
 	}
@@ -1131,25 +1387,106 @@ void FVoxelDefaultRenderer::ProcessChunksToRemoveOrShow()
 	{
 		VOXEL_SCOPE_COUNTER("Processing ChunksToRemove");
 		ensure(Settings.bDitherChunks || ChunksToRemove.Num() == 0);
-		for (int32 Index = 0; Index < ChunksToRemove.Num(); Index++)
+		while (ChunksToRemove.Num() > 0 && ChunksToRemove.HeapTop().Time < Time)
 		{
-			const auto ChunkToRemove = ChunksToRemove[Index];
-			if (ChunkToRemove.Time < Time)
-			{
-				FChunk& Chunk = ChunksMap.FindChecked(ChunkToRemove.Id);
-				if (Chunk.State != EChunkState::DitheringOut) continue; // Chunk is not dithering out anymore
+			FChunkDeadline ChunkToRemove;
+			ChunksToRemove.HeapPop(ChunkToRemove, false);
 
-				ChunksToRemove.RemoveAtSwap(Index, 1, false);
-				Index--; // Go back to process the element we swapped
+			FChunk* ChunkPtr = Chunks.Find(ChunkToRemove.Handle);
+			if (!ChunkPtr || ChunkPtr->RemoveTime != ChunkToRemove.Time) continue; // Outdated entry
+			FChunk& Chunk = *ChunkPtr;
+			// Do it before so that it's not in ChunksToRemove anymore for the checks to pass
+			Chunk.RemoveTime = -1;
 
-				// Do it after so that it's not in ChunksToRemove anymore
-				// for the checks to pass
-				RemoveOrHideChunk(Chunk);
-			}
+			if (Chunk.State != EChunkState::DitheringOut) continue; // Chunk is not dithering out anymore
+
+			RemoveOrHideChunk(Chunk);
 		}
 	}
 }
 
+void FVoxelDefaultRenderer::AddChunkToRemove(FChunk& Chunk, double Time)
+{
+	// Any previous entry is now outdated
+	Chunk.RemoveTime = Time;
+	ChunksToRemove.HeapPush(FChunkDeadline{ Chunk.Handle, Time });
+}
+
+void FVoxelDefaultRenderer::AddChunkToShow(FChunk& Chunk, double Time)
+{
+	// Any previous entry is now outdated
+	Chunk.ShowTime = Time;
+	ChunksToShow.HeapPush(FChunkDeadline{ Chunk.Handle, Time });
+}
+
+void FVoxelDefaultRenderer::UpdateHiddenChunk(FChunk& Chunk)
+{
+	HiddenChunksAllocatedSize -= Chunk.HiddenAllocatedSize;
+	DEC_MEMORY_STAT_BY(STAT_VoxelRendererHiddenChunks, Chunk.HiddenAllocatedSize);
+	Chunk.HiddenAllocatedSize = 0;
+
+	// Only chunks with a mesh can be evicted, as the mesh is what keeps their collisions & navmesh
+	if (Settings.HiddenChunksMemoryBudget == 0 || Chunk.State != EChunkState::Hidden || !Chunk.MeshId.IsValid())
+	{
+		// Any entry in HiddenChunks is now outdated
+		Chunk.HiddenTime = -1;
+		return;
+	}
+
+	// Only count the meshes that evicting would actually free: meshes also referenced by the mesh cache are counted in its own budget
+	if (Chunk.BuiltData.MainChunk.IsValid() && Chunk.BuiltData.MainChunk.IsUnique())
+	{
+		Chunk.HiddenAllocatedSize += Chunk.BuiltData.MainChunk->GetAllocatedSize();
+	}
+	if (Chunk.BuiltData.TransitionsChunk.IsValid() && Chunk.BuiltData.TransitionsChunk.IsUnique())
+	{
+		Chunk.HiddenAllocatedSize += Chunk.BuiltData.TransitionsChunk->GetAllocatedSize();
+	}
+	HiddenChunksAllocatedSize += Chunk.HiddenAllocatedSize;
+	INC_MEMORY_STAT_BY(STAT_VoxelRendererHiddenChunks, Chunk.HiddenAllocatedSize);
+
+	if (Chunk.HiddenTime < 0 && Chunk.HiddenAllocatedSize > 0)
+	{
+		Chunk.HiddenTime = FPlatformTime::Seconds();
+		HiddenChunks.HeapPush(FChunkDeadline{ Chunk.Handle, Chunk.HiddenTime });
+	}
+}
+
+void FVoxelDefaultRenderer::EvictHiddenChunks()
+{
+	if (HiddenChunksAllocatedSize <= Settings.HiddenChunksMemoryBudget)
+	{
+		return;
+	}
+
+	VOXEL_FUNCTION_COUNTER();
+
+	while (HiddenChunksAllocatedSize > Settings.HiddenChunksMemoryBudget && HiddenChunks.Num() > 0)
+	{
+		FChunkDeadline HiddenChunk;
+		HiddenChunks.HeapPop(HiddenChunk, false);
+
+		FChunk* ChunkPtr = Chunks.Find(HiddenChunk.Handle);
+		if (!ChunkPtr || ChunkPtr->HiddenTime != HiddenChunk.Time) continue; // Outdated entry
+		FChunk& Chunk = *ChunkPtr;
+		Chunk.HiddenTime = -1;
+
+		HiddenChunksAllocatedSize -= Chunk.HiddenAllocatedSize;
+		DEC_MEMORY_STAT_BY(STAT_VoxelRendererHiddenChunks, Chunk.HiddenAllocatedSize);
+		Chunk.HiddenAllocatedSize = 0;
+
+		// The mesh might have been removed by a transitions update
+		if (Chunk.State != EChunkState::Hidden || !Chunk.MeshId.IsValid()) continue;
+		// Will be added back by UpdateHiddenChunk once the tasks are done
+		if (Chunk.Tasks.MainTask.IsValid() || Chunk.Tasks.TransitionsTask.IsValid()) continue;
+
+		// Keep MeshId: the component is still used for collisions & navmesh
+		// The meshes will be built again, most likely from the mesh cache, when the chunk is shown or its settings change
+		Chunk.BuiltData = {};
+		Chunk.bBuiltDataEvicted = true;
+	}
+}
+
 void FVoxelDefaultRenderer::FlushQueuedTasks()
 {
 	VOXEL_FUNCTION_COUNTER();
@@ -1176,6 +1513,13 @@ void FVoxelDefaultRenderer::FlushQueuedTasks()
 	Flush(false, true);
 	Flush(true, false);
 	Flush(true, true);
+
+	if (QueuedPrefetchTasks.Num() > 0)
+	{
+		TaskCount.Add(QueuedPrefetchTasks.Num());
+		Settings.Pool->QueueTasks(EVoxelTaskType::ChunksPrefetch, QueuedPrefetchTasks);
+		QueuedPrefetchTasks.Reset();
+	}
 }
 
 void FVoxelDefaultRenderer::DestroyChunk(FChunk& Chunk)
@@ -1186,15 +1530,18 @@ void FVoxelDefaultRenderer::DestroyChunk(FChunk& Chunk)
 	ensure(Chunk.PreviousChunks.Num() == 0);
 	ensure(!Chunk.Tasks.MainTask.IsValid());
 	ensure(!Chunk.Tasks.TransitionsTask.IsValid());
-	ensureVoxelSlow(!ChunksToRemove.FindByPredicate([&](const FChunkToRemove& ChunkToRemove) { return ChunkToRemove.Id == Chunk.Id; }));
-	ensureVoxelSlow(!ChunksToShow.FindByPredicate([&](const FChunkToShow& ChunkToShow) { return ChunkToShow.Id == Chunk.Id; }));
+	ensureVoxelSlow(Chunk.RemoveTime < 0 && Chunk.ShowTime < 0);
+
+	HiddenChunksAllocatedSize -= Chunk.HiddenAllocatedSize;
+	DEC_MEMORY_STAT_BY(STAT_VoxelRendererHiddenChunks, Chunk.HiddenAllocatedSize);
 
 	for (auto& PendingUpdate : Chunk.PendingUpdates)
 	{
 		// We must always fire all delegates
 		PendingUpdate.OnUpdateFinished.Broadcast(FIntBox());
 	}
-	ensure(ChunksMap.Remove(Chunk.Id) == 1);
+	ensure(ChunksHandles.Remove(Chunk.Id) == 1);
+	Chunks.Remove(Chunk.Handle);
 }
 
 void FVoxelDefaultRenderer::UpdateAllocatedSize()
@@ -1202,9 +1549,12 @@ void FVoxelDefaultRenderer::UpdateAllocatedSize()
 	DEC_DWORD_STAT_BY(STAT_VoxelRenderer, AllocatedSize);
 
 	AllocatedSize = 0;
-	AllocatedSize += ChunksMap.GetAllocatedSize();
+	AllocatedSize += Chunks.GetAllocatedSize();
+	AllocatedSize += ChunksHandles.GetAllocatedSize();
 	AllocatedSize += ChunksToRemove.GetAllocatedSize();
 	AllocatedSize += ChunksToShow.GetAllocatedSize();
+	AllocatedSize += HiddenChunks.GetAllocatedSize();
+	AllocatedSize += PrefetchChunksMap.GetAllocatedSize();
 
 	INC_DWORD_STAT_BY(STAT_VoxelRenderer, AllocatedSize);
 }
@@ -1224,8 +1574,8 @@ void FVoxelDefaultRenderer::CancelTask(TUniquePtr<FVoxelMesherAsyncWork>& Task)
 	}
 }
 
-void FVoxelDefaultRenderer::QueueChunkCallback_AnyThread(uint64 TaskId, uint64 ChunkId, bool bIsTransitionTask)
+void FVoxelDefaultRenderer::QueueChunkCallback_AnyThread(uint64 TaskId, uint64 ChunkId, bool bIsTransitionTask, bool bIsPrefetchTask)
 {
 	ensure(TaskCount.Decrement() >= 0);
-	TasksCallbacksQueue.Enqueue({ TaskId, ChunkId, bIsTransitionTask });
+	TasksCallbacksQueue.Enqueue({ TaskId, ChunkId, bIsTransitionTask, bIsPrefetchTask });
 }
\ No newline at end of file
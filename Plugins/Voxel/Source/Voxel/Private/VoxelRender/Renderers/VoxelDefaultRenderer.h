@@ -9,8 +9,10 @@
 #include "VoxelRendererMeshHandler.h"
 #include "VoxelTickable.h"
 #include "QueueWithNum.h"
+#include "VoxelSlotMap.h"
 
 class IVoxelRendererMeshHandler;
+class FVoxelChunkMeshCache;
 struct FVoxelChunkMesh;
 
 class FVoxelDefaultRenderer : public IVoxelRenderer, public FVoxelTickable, public TVoxelSharedFromThis<FVoxelDefaultRenderer>
@@ -35,6 +37,8 @@ public:
 		const FIntVector& ChunkPosition,
 		TArray<uint32>& OutIndices,
 		TArray<FVector>& OutVertices) const override;
+	virtual void PrefetchChunks(const TArray<FVoxelChunkUpdate>& ChunkUpdates) override;
+	virtual void CancelPrefetch() override;
 	//~ End IVoxelRender Interface
 
 	//~ Begin FVoxelTickable Interface
@@ -57,8 +61,11 @@ private:
 		Main,
 		Transitions
 	};
+	using FChunkHandle = FVoxelSlotMapHandle;
+
 	struct FChunk
 	{
+		// Render octree id
 		const uint64 Id;
 		const uint8 LOD;
 		const FIntBox Bounds;
@@ -70,6 +77,8 @@ private:
 		{
 		}
 
+		FChunkHandle Handle;
+
 		struct FChunkTasks
 		{
 			TUniquePtr<FVoxelMesherAsyncWork> MainTask;
@@ -107,7 +116,7 @@ private:
 
 		// Chunks that were shown at this position before this one was shown, and that need to be dithered out
 		// once this chunk is updated
-		TArray<uint64, TInlineAllocator<8>> PreviousChunks;
+		TArray<FChunkHandle, TInlineAllocator<8>> PreviousChunks;
 		// Number of new chunks left to update
 		int32 NumNewChunksLeft = 0;
 
@@ -115,25 +124,54 @@ private:
 		// This is needed to track if chunks in PreviousChunks are still valid and haven't been switched back to Show
 		// Else we'd be decreasing a wrong NumNewChunksLeft
 		uint64 UpdateIndex = 0;
-	};
-	TMap<uint64, FChunk> ChunksMap;
 
-	struct FChunkToRemove
-	{
-		uint64 Id = 0;
-		double Time = 0; // Time at which to remove the chunk
+		// Time at which to remove the chunk once dithered out, -1 if not in ChunksToRemove
+		double RemoveTime = -1;
+		// Time at which to stop dithering the chunk in, -1 if not in ChunksToShow
+		double ShowTime = -1;
+
+		// Time at which the chunk was hidden, -1 if not in HiddenChunks
+		double HiddenTime = -1;
+		// Size of BuiltData counted in HiddenChunksAllocatedSize
+		int64 HiddenAllocatedSize = 0;
+		// True if BuiltData was freed while hidden: MeshId is still valid, but the meshes need to be built again before being updated
+		bool bBuiltDataEvicted = false;
 	};
-	TArray<FChunkToRemove> ChunksToRemove;
+	TVoxelSlotMap<FChunk> Chunks;
+	// Render octree id -> chunk handle, to translate the ids given by UpdateChunks and UpdateLODs
+	TMap<uint64, FChunkHandle> ChunksHandles;
 
-	struct FChunkToShow
+	struct FChunkDeadline
 	{
-		uint64 Id = 0;
-		double Time = 0; // Time at which to stop dithering the chunk
+		FChunkHandle Handle;
+		double Time = 0;
+
+		inline bool operator<(const FChunkDeadline& Other) const
+		{
+			return Time < Other.Time;
+		}
 	};
-	TArray<FChunkToShow> ChunksToShow;
+	// Heaps sorted by time, so that only the chunks that are due are processed every tick
+	// Entries are removed lazily: they are outdated if the chunk RemoveTime/ShowTime doesn't match their time anymore
+	TArray<FChunkDeadline> ChunksToRemove;
+	TArray<FChunkDeadline> ChunksToShow;
+	// Hidden chunks with built data, least recently hidden first. Used to free their built data when over Settings.HiddenChunksMemoryBudget
+	TArray<FChunkDeadline> HiddenChunks;
+	int64 HiddenChunksAllocatedSize = 0;
 
 	TArray<IVoxelQueuedWork*> QueuedTasks[2][2]; // [bVisible][bHasCollisions]
 
+	// Chunks meshed ahead of time for the mesh cache, by prefetch chunk id
+	struct FPrefetchChunk
+	{
+		uint8 LOD = 0;
+		FIntBox Bounds;
+		uint8 TransitionsMask = 0;
+		FChunk::FChunkTasks Tasks;
+	};
+	TMap<uint64, FPrefetchChunk> PrefetchChunksMap;
+	TArray<IVoxelQueuedWork*> QueuedPrefetchTasks;
+
 	enum class EIfTaskExists : uint8
 	{
 		DoNothing,
@@ -142,11 +180,17 @@ private:
 
 	template<EMainOrTransitions MainOrTransitions, EIfTaskExists IfTaskExists>
 	void StartTask(FChunk& Chunk);
-	void CancelTasks(FChunk& Chunk);
+	void CancelTasks(FChunk::FChunkTasks& Tasks);
+	void StartPrefetchTask(uint64 Id, FPrefetchChunk& PrefetchChunk, EMainOrTransitions MainOrTransitions);
+	void ProcessPrefetchTaskCallback(uint64 TaskId, uint64 PrefetchChunkId, bool bIsTransitionTask);
 	void ClearPreviousChunks(FChunk& Chunk);
 	void NewChunksFinished(FChunk& Chunk, const FChunk& NewChunk);
 	void RemoveOrHideChunk(FChunk& Chunk);
-	void DitherInChunk(FChunk& Chunk, const TArray<uint64, TInlineAllocator<8>>& PreviousChunks);
+	void DitherInChunk(FChunk& Chunk, const FChunk* PreviousChunk);
+	void AddChunkToRemove(FChunk& Chunk, double Time);
+	void AddChunkToShow(FChunk& Chunk, double Time);
+	void UpdateHiddenChunk(FChunk& Chunk);
+	void EvictHiddenChunks();
 	void ApplyPendingSettings(FChunk& Chunk);
 	void CheckPendingUpdates(FChunk& Chunk);
 	void ProcessChunksToRemoveOrShow();
@@ -156,6 +200,8 @@ private:
 private:
 	// Need shared ptr for async callbacks
 	TVoxelSharedPtr<IVoxelRendererMeshHandler> MeshHandler;
+	// Null if Settings.MeshCacheSize is 0
+	TUniquePtr<FVoxelChunkMeshCache> MeshCache;
 
 	FThreadSafeCounter TaskCount;
 	uint64 UpdateIndex = 0;
@@ -171,7 +217,7 @@ private:
 	void UpdateAllocatedSize();
 
 public:
-	void QueueChunkCallback_AnyThread(uint64 TaskId, uint64 ChunkId, bool bIsTransitionTask);
+	void QueueChunkCallback_AnyThread(uint64 TaskId, uint64 ChunkId, bool bIsTransitionTask, bool bIsPrefetchTask);
 
 private:
 	struct FVoxelTaskCallback
@@ -179,6 +225,7 @@ private:
 		uint64 TaskId;
 		uint64 ChunkId;
 		bool bIsTransitionTask;
+		bool bIsPrefetchTask;
 	};
 	TQueueWithNum<FVoxelTaskCallback, EQueueMode::Mpsc> TasksCallbacksQueue;
 
@@ -0,0 +1,442 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelMergedSection.h"
+#include "VoxelRender/VoxelProcMeshBuffers.h"
+#include "VoxelRender/IVoxelRenderer.h"
+
+inline bool AreSectionsEqual(const TArray<FVoxelChunkMeshSection>& A, const TArray<FVoxelChunkMeshSection>& B)
+{
+	if (A.Num() != B.Num())
+	{
+		return false;
+	}
+	for (int32 Index = 0; Index < A.Num(); Index++)
+	{
+		const FVoxelChunkMeshSection& SectionA = A[Index];
+		const FVoxelChunkMeshSection& SectionB = B[Index];
+		if (SectionA.LOD != SectionB.LOD ||
+			SectionA.ChunkPosition != SectionB.ChunkPosition ||
+			SectionA.bEnableTessellation != SectionB.bEnableTessellation ||
+			SectionA.bTranslateVertices != SectionB.bTranslateVertices ||
+			SectionA.TransitionsMask != SectionB.TransitionsMask ||
+			SectionA.MainChunk != SectionB.MainChunk ||
+			SectionA.TransitionChunk != SectionB.TransitionChunk)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+inline void CopyVertices(const FVoxelProcMeshBuffers& From, FVoxelProcMeshBuffers& To, int32 Offset, int32 Num, bool bRenderWorld)
+{
+	if (Num == 0)
+	{
+		return;
+	}
+
+	const auto Copy = [&](void* ToData, const void* FromData, uint32 Stride)
+	{
+		FMemory::Memcpy(
+			static_cast<uint8*>(ToData) + Offset * Stride,
+			static_cast<const uint8*>(FromData) + Offset * Stride,
+			Num * Stride);
+	};
+
+	const auto& FromBuffers = From.VertexBuffers;
+	auto& ToBuffers = To.VertexBuffers;
+
+	Copy(ToBuffers.PositionVertexBuffer.GetVertexData(), FromBuffers.PositionVertexBuffer.GetVertexData(), FromBuffers.PositionVertexBuffer.GetStride());
+	if (bRenderWorld)
+	{
+		const uint32 NumFromVertices = FromBuffers.StaticMeshVertexBuffer.GetNumVertices();
+		Copy(ToBuffers.StaticMeshVertexBuffer.GetTangentData(), FromBuffers.StaticMeshVertexBuffer.GetTangentData(), FromBuffers.StaticMeshVertexBuffer.GetTangentSize() / NumFromVertices);
+		Copy(ToBuffers.StaticMeshVertexBuffer.GetTexCoordData(), FromBuffers.StaticMeshVertexBuffer.GetTexCoordData(), FromBuffers.StaticMeshVertexBuffer.GetTexCoordSize() / NumFromVertices);
+		Copy(ToBuffers.ColorVertexBuffer.GetVertexData(), FromBuffers.ColorVertexBuffer.GetVertexData(), FromBuffers.ColorVertexBuffer.GetStride());
+	}
+}
+
+inline void CopyIndices(const FVoxelRawStaticIndexBuffer& From, FVoxelRawStaticIndexBuffer& To, int32 Offset, int32 Num)
+{
+	for (int32 Index = Offset; Index < Offset + Num; Index++)
+	{
+		To.SetIndex(Index, From.GetIndex(Index));
+	}
+}
+
+inline void ClearVertices(FVoxelProcMeshBuffers& Buffers, int32 Offset, int32 Num, const FVector& Position)
+{
+	// Unused vertices are never indexed, but are still seen by anything reading the whole buffer, eg the physics cooker bounds
+	// Position must be a used vertex, so that they don't change these bounds
+	for (int32 Index = Offset; Index < Offset + Num; Index++)
+	{
+		Buffers.VertexBuffers.PositionVertexBuffer.VertexPosition(Index) = Position;
+	}
+}
+
+inline FBox GetPositionsBounds(const FVoxelProcMeshBuffers& Buffers, int32 Offset, int32 Num)
+{
+	FBox Bounds(ForceInit);
+	for (int32 Index = Offset; Index < Offset + Num; Index++)
+	{
+		Bounds += Buffers.VertexBuffers.PositionVertexBuffer.VertexPosition(Index);
+	}
+	return Bounds;
+}
+
+inline void FillDegenerateTriangles(FVoxelProcMeshBuffers& Buffers, int32 Offset, int32 Num, uint32 Vertex, int32 AdjacencyMultiplier)
+{
+	for (int32 Index = Offset; Index < Offset + Num; Index++)
+	{
+		Buffers.IndexBuffer.SetIndex(Index, Vertex);
+	}
+	for (int32 Index = AdjacencyMultiplier * Offset; Index < AdjacencyMultiplier * (Offset + Num); Index++)
+	{
+		Buffers.AdjacencyIndexBuffer.SetIndex(Index, Vertex);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#define CHECK_CANCEL() if (CancelCounter.GetValue() > CancelThreshold) return {};
+
+TVoxelSharedPtr<const FVoxelMergedSection> FVoxelMergedSection::Merge_AnyThread(
+	const TVoxelSharedPtr<const FVoxelMergedSection>& Previous,
+	const FChunksSections& ChunksSections,
+	const FVoxelRendererSettingsBase& RendererSettings,
+	const FIntVector& CenterPosition,
+	const FThreadSafeCounter& CancelCounter,
+	int32 CancelThreshold)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const bool bShowMainChunks = FVoxelRenderUtilities::ShowMainChunks();
+
+	bool bEnableTessellation = false;
+	for (auto& It : ChunksSections)
+	{
+		for (auto& Section : It.Value)
+		{
+			bEnableTessellation |= Section.bEnableTessellation;
+		}
+	}
+
+	const bool bCanPatch =
+		Previous.IsValid() &&
+		Previous->bEnableTessellation == bEnableTessellation &&
+		Previous->bShowMainChunks == bShowMainChunks;
+
+	if (bCanPatch && Previous->Chunks.Num() == ChunksSections.Num())
+	{
+		bool bChanged = false;
+		for (auto& It : ChunksSections)
+		{
+			const FChunk* Chunk = Previous->Chunks.Find(It.Key);
+			if (!Chunk || !AreSectionsEqual(Chunk->Sections, It.Value))
+			{
+				bChanged = true;
+				break;
+			}
+		}
+		if (!bChanged)
+		{
+			// Keep the same buffers: nothing to copy, and their render resources can be reused if they are still alive
+			return Previous;
+		}
+	}
+
+	const TVoxelSharedRef<FVoxelMergedSection> Result = MakeShareable(new FVoxelMergedSection());
+	Result->bEnableTessellation = bEnableTessellation;
+	Result->bShowMainChunks = bShowMainChunks;
+
+	// Chunks that did not change, and that can be copied from the previous buffers
+	TSet<uint64> ChunksToCopy;
+
+	bool bFullRebuild = !bCanPatch;
+	if (bCanPatch)
+	{
+		VOXEL_SCOPE_COUNTER("Patch layout");
+
+		Result->Chunks = Previous->Chunks;
+		Result->FreeVertices = Previous->FreeVertices;
+		Result->FreeIndices = Previous->FreeIndices;
+		Result->NumVertices = Previous->NumVertices;
+		Result->NumIndices = Previous->NumIndices;
+
+		for (auto It = Result->Chunks.CreateIterator(); It; ++It)
+		{
+			if (!ChunksSections.Contains(It.Key()))
+			{
+				Free(Result->FreeVertices, Result->NumVertices, It.Value().Vertices);
+				Free(Result->FreeIndices, Result->NumIndices, It.Value().Indices);
+				It.RemoveCurrent();
+			}
+		}
+
+		for (auto& It : ChunksSections)
+		{
+			FChunk* OldChunk = Result->Chunks.Find(It.Key);
+			if (OldChunk && AreSectionsEqual(OldChunk->Sections, It.Value))
+			{
+				ChunksToCopy.Add(It.Key);
+				continue;
+			}
+
+			FChunk NewChunk;
+			NewChunk.Sections = It.Value;
+			int32 NumAdjacencyIndices = 0;
+			FVoxelRenderUtilities::GetSectionsSize(NewChunk.Sections, bShowMainChunks, NewChunk.NumVertices, NewChunk.NumIndices, NumAdjacencyIndices, NewChunk.Guids);
+
+			if (OldChunk && NewChunk.NumVertices <= OldChunk->Vertices.Num && NewChunk.NumIndices <= OldChunk->Indices.Num)
+			{
+				// Fits in the previous range: update in place
+				NewChunk.Vertices = OldChunk->Vertices;
+				NewChunk.Indices = OldChunk->Indices;
+			}
+			else
+			{
+				if (OldChunk)
+				{
+					Free(Result->FreeVertices, Result->NumVertices, OldChunk->Vertices);
+					Free(Result->FreeIndices, Result->NumIndices, OldChunk->Indices);
+				}
+
+				// Leave some room so that the next edits can be done in place
+				NewChunk.Vertices.Num = NewChunk.NumVertices + NewChunk.NumVertices / 4;
+				NewChunk.Indices.Num = 3 * FVoxelUtilities::DivideCeil(NewChunk.NumIndices + NewChunk.NumIndices / 4, 3);
+				NewChunk.Vertices.Offset = Allocate(Result->FreeVertices, Result->NumVertices, NewChunk.Vertices.Num);
+				NewChunk.Indices.Offset = Allocate(Result->FreeIndices, Result->NumIndices, NewChunk.Indices.Num);
+			}
+
+			Result->Chunks.Add(It.Key, MoveTemp(NewChunk));
+		}
+
+		int32 NumUsedVertices = 0;
+		int32 NumUsedIndices = 0;
+		for (auto& It : Result->Chunks)
+		{
+			NumUsedVertices += It.Value.NumVertices;
+			NumUsedIndices += It.Value.NumIndices;
+		}
+
+		// Compact the buffers if more than half of them is unused
+		// Also make sure the indices stride is enough to index all the vertices, as it's computed from the number of indices
+		if (NumUsedVertices == 0 ||
+			Result->NumVertices > 2 * NumUsedVertices + 1024 ||
+			Result->NumIndices > 2 * NumUsedIndices + 3 * 1024 ||
+			(Result->NumVertices > MAX_uint16 && Result->NumIndices <= MAX_uint16))
+		{
+			bFullRebuild = true;
+		}
+	}
+
+	if (bFullRebuild)
+	{
+		VOXEL_SCOPE_COUNTER("Full layout");
+
+		Result->Chunks.Reset();
+		Result->FreeVertices.Reset();
+		Result->FreeIndices.Reset();
+		Result->NumVertices = 0;
+		Result->NumIndices = 0;
+		ChunksToCopy.Reset();
+
+		for (auto& It : ChunksSections)
+		{
+			FChunk Chunk;
+			Chunk.Sections = It.Value;
+			int32 NumAdjacencyIndices = 0;
+			FVoxelRenderUtilities::GetSectionsSize(Chunk.Sections, bShowMainChunks, Chunk.NumVertices, Chunk.NumIndices, NumAdjacencyIndices, Chunk.Guids);
+
+			Chunk.Vertices = { Result->NumVertices, Chunk.NumVertices };
+			Chunk.Indices = { Result->NumIndices, Chunk.NumIndices };
+			Result->NumVertices += Chunk.NumVertices;
+			Result->NumIndices += Chunk.NumIndices;
+
+			Result->Chunks.Add(It.Key, MoveTemp(Chunk));
+		}
+	}
+
+	CHECK_CANCEL();
+
+	const int32 AdjacencyMultiplier = bEnableTessellation ? 4 : 0;
+
+	const TVoxelSharedRef<FVoxelProcMeshBuffers> Buffers = MakeVoxelShared<FVoxelProcMeshBuffers>();
+	FVoxelRenderUtilities::InitBuffers(*Buffers, RendererSettings, Result->NumVertices, Result->NumIndices, AdjacencyMultiplier * Result->NumIndices);
+
+	CHECK_CANCEL();
+
+	if (ChunksToCopy.Num() > 0)
+	{
+		VOXEL_SCOPE_COUNTER("Copy unchanged chunks");
+
+		const FVoxelProcMeshBuffers& PreviousBuffers = *Previous->Buffers;
+		for (uint64 Id : ChunksToCopy)
+		{
+			// Ranges of unchanged chunks are never moved
+			const FChunk& Chunk = Result->Chunks[Id];
+			CopyVertices(PreviousBuffers, *Buffers, Chunk.Vertices.Offset, Chunk.Vertices.Num, RendererSettings.bRenderWorld);
+			CopyIndices(PreviousBuffers.IndexBuffer, Buffers->IndexBuffer, Chunk.Indices.Offset, Chunk.Indices.Num);
+			CopyIndices(PreviousBuffers.AdjacencyIndexBuffer, Buffers->AdjacencyIndexBuffer, AdjacencyMultiplier * Chunk.Indices.Offset, AdjacencyMultiplier * Chunk.Indices.Num);
+		}
+	}
+
+	FBox LocalBounds(ForceInit);
+	for (auto& It : Result->Chunks)
+	{
+		FChunk& Chunk = It.Value;
+		if (!ChunksToCopy.Contains(It.Key))
+		{
+			CHECK_CANCEL();
+
+			Chunk.LocalBounds = FVoxelRenderUtilities::CopySections_AnyThread(
+				RendererSettings,
+				Chunk.Sections,
+				bShowMainChunks,
+				CenterPosition,
+				*Buffers,
+				Chunk.Vertices.Offset,
+				Chunk.Indices.Offset,
+				AdjacencyMultiplier * Chunk.Indices.Offset);
+
+			if (Chunk.NumVertices > 0)
+			{
+				// Use the chunk first vertex, like the degenerate triangles
+				const FVector FirstVertex = Buffers->VertexBuffers.PositionVertexBuffer.VertexPosition(Chunk.Vertices.Offset);
+				ClearVertices(*Buffers, Chunk.Vertices.Offset + Chunk.NumVertices, Chunk.Vertices.Num - Chunk.NumVertices, FirstVertex);
+			}
+			FillDegenerateTriangles(*Buffers, Chunk.Indices.Offset + Chunk.NumIndices, Chunk.Indices.Num - Chunk.NumIndices, Chunk.Vertices.Offset, AdjacencyMultiplier);
+		}
+
+		LocalBounds += Chunk.LocalBounds;
+		Buffers->Guids.Append(Chunk.Guids);
+	}
+
+	// Free ranges and empty chunks ranges don't have any vertex of their own: use the first used one
+	// There is always one, else the buffers would be fully rebuilt without any unused range
+	const FChunk* FirstUsedChunk = nullptr;
+	for (auto& It : Result->Chunks)
+	{
+		if (It.Value.NumVertices > 0)
+		{
+			FirstUsedChunk = &It.Value;
+			break;
+		}
+	}
+	if (FirstUsedChunk)
+	{
+		const FVector FirstVertex = Buffers->VertexBuffers.PositionVertexBuffer.VertexPosition(FirstUsedChunk->Vertices.Offset);
+		for (auto& It : Result->Chunks)
+		{
+			if (It.Value.NumVertices == 0)
+			{
+				ClearVertices(*Buffers, It.Value.Vertices.Offset, It.Value.Vertices.Num, FirstVertex);
+			}
+		}
+		for (auto& Range : Result->FreeVertices)
+		{
+			ClearVertices(*Buffers, Range.Offset, Range.Num, FirstVertex);
+		}
+	}
+	for (auto& Range : Result->FreeIndices)
+	{
+		FillDegenerateTriangles(*Buffers, Range.Offset, Range.Num, 0, AdjacencyMultiplier);
+	}
+
+	Buffers->LocalBounds = FVoxelRenderUtilities::GetFinalLocalBounds(RendererSettings, LocalBounds, bEnableTessellation);
+
+#if VOXEL_DEBUG
+	FVoxelRenderUtilities::CheckBuffers(*Buffers);
+
+	// The collision bounds are computed from the whole position buffer: make sure they are the same as without the unused ranges
+	{
+		FBox UsedBounds(ForceInit);
+		for (auto& It : Result->Chunks)
+		{
+			UsedBounds += GetPositionsBounds(*Buffers, It.Value.Vertices.Offset, It.Value.NumVertices);
+		}
+		const FBox AllBounds = GetPositionsBounds(*Buffers, 0, Result->NumVertices);
+		checkf(AllBounds == UsedBounds, TEXT("Merged bounds: %s; unmerged bounds: %s"), *AllBounds.ToString(), *UsedBounds.ToString());
+	}
+#endif
+
+	Buffers->UpdateStats();
+
+	CHECK_CANCEL();
+
+	Result->Buffers = Buffers;
+	return Result;
+}
+
+#undef CHECK_CANCEL
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+int32 FVoxelMergedSection::Allocate(TArray<FRange>& FreeRanges, int32& Num, int32 Size)
+{
+	if (Size == 0)
+	{
+		return 0;
+	}
+
+	// First fit
+	for (int32 Index = 0; Index < FreeRanges.Num(); Index++)
+	{
+		FRange& Range = FreeRanges[Index];
+		if (Range.Num >= Size)
+		{
+			const int32 Offset = Range.Offset;
+			Range.Offset += Size;
+			Range.Num -= Size;
+			if (Range.Num == 0)
+			{
+				FreeRanges.RemoveAt(Index);
+			}
+			return Offset;
+		}
+	}
+
+	const int32 Offset = Num;
+	Num += Size;
+	return Offset;
+}
+
+void FVoxelMergedSection::Free(TArray<FRange>& FreeRanges, int32& Num, const FRange& Range)
+{
+	if (Range.Num == 0)
+	{
+		return;
+	}
+
+	int32 Index = 0;
+	while (Index < FreeRanges.Num() && FreeRanges[Index].Offset < Range.Offset)
+	{
+		Index++;
+	}
+	FreeRanges.Insert(Range, Index);
+
+	// Merge with the next range
+	if (Index + 1 < FreeRanges.Num() && FreeRanges[Index].Offset + FreeRanges[Index].Num == FreeRanges[Index + 1].Offset)
+	{
+		FreeRanges[Index].Num += FreeRanges[Index + 1].Num;
+		FreeRanges.RemoveAt(Index + 1);
+	}
+	// Merge with the previous range
+	if (Index > 0 && FreeRanges[Index - 1].Offset + FreeRanges[Index - 1].Num == FreeRanges[Index].Offset)
+	{
+		FreeRanges[Index - 1].Num += FreeRanges[Index].Num;
+		FreeRanges.RemoveAt(Index);
+		Index--;
+	}
+
+	// Shrink the buffers if the range is at the end
+	if (Index == FreeRanges.Num() - 1 && FreeRanges[Index].Offset + FreeRanges[Index].Num == Num)
+	{
+		Num = FreeRanges[Index].Offset;
+		FreeRanges.RemoveAt(Index);
+	}
+}
\ No newline at end of file
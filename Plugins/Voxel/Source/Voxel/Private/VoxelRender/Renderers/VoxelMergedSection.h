@@ -0,0 +1,70 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGlobals.h"
+#include "VoxelRender/VoxelRenderUtilities.h"
+
+struct FVoxelProcMeshBuffers;
+struct FVoxelRendererSettingsBase;
+
+// Proc mesh buffers of a section merging several chunks, that keeps track of the sub-range used by each chunk
+// Updating a chunk only rewrites its own range: the other chunks are copied from the previous buffers instead of being merged again
+// Immutable once built, so that it can be used by async tasks and shared with the mesh component
+class FVoxelMergedSection
+{
+public:
+	// Key is the chunk unique id
+	using FChunksSections = TMap<uint64, TArray<FVoxelChunkMeshSection>>;
+
+	// Previous can be null. Returns Previous if nothing changed, and null if canceled
+	static TVoxelSharedPtr<const FVoxelMergedSection> Merge_AnyThread(
+		const TVoxelSharedPtr<const FVoxelMergedSection>& Previous,
+		const FChunksSections& ChunksSections,
+		const FVoxelRendererSettingsBase& RendererSettings,
+		const FIntVector& CenterPosition,
+		const FThreadSafeCounter& CancelCounter,
+		int32 CancelThreshold);
+
+	inline TVoxelSharedRef<const FVoxelProcMeshBuffers> GetBuffers() const
+	{
+		return Buffers.ToSharedRef();
+	}
+
+private:
+	struct FRange
+	{
+		int32 Offset = 0;
+		int32 Num = 0;
+	};
+	struct FChunk
+	{
+		// Sections merged in this range, to detect changes
+		TArray<FVoxelChunkMeshSection> Sections;
+		TArray<FGuid> Guids;
+		FBox LocalBounds = FBox(ForceInit);
+
+		FRange Vertices;
+		FRange Indices;
+		// Can be less than Indices.Num: the end of the range is filled with degenerate triangles
+		int32 NumIndices = 0;
+		int32 NumVertices = 0;
+	};
+
+	TMap<uint64, FChunk> Chunks;
+	// Unused ranges, sorted by offset
+	TArray<FRange> FreeVertices;
+	TArray<FRange> FreeIndices;
+	int32 NumVertices = 0;
+	int32 NumIndices = 0;
+	bool bEnableTessellation = false;
+	bool bShowMainChunks = true;
+
+	TVoxelSharedPtr<const FVoxelProcMeshBuffers> Buffers;
+
+	FVoxelMergedSection() = default;
+
+	static int32 Allocate(TArray<FRange>& FreeRanges, int32& Num, int32 Size);
+	static void Free(TArray<FRange>& FreeRanges, int32& Num, const FRange& Range);
+};
\ No newline at end of file
@@ -2,10 +2,13 @@
 
 #include "VoxelRender/VoxelMesherAsyncWork.h"
 #include "VoxelRender/Renderers/VoxelDefaultRenderer.h"
+#include "VoxelRender/Renderers/VoxelChunkMeshCache.h"
 #include "VoxelRender/Meshers/VoxelMarchingCubeMesher.h"
 #include "VoxelRender/Meshers/VoxelCubicMesher.h"
 #include "VoxelRender/Meshers/VoxelSurfaceNetMesher.h"
+#include "VoxelRender/Meshers/VoxelDualContouringMesher.h"
 #include "VoxelRender/VoxelChunkMesh.h"
+#include "VoxelData/VoxelData.h"
 
 #include "Async/Async.h"
 #include "Misc/MessageDialog.h"
@@ -17,13 +20,15 @@ FVoxelMesherAsyncWork::FVoxelMesherAsyncWork(
 	const int32 LOD,
 	const FIntBox& Bounds,
 	const bool bIsTransitionTask,
-	const uint8 TransitionsMask)
+	const uint8 TransitionsMask,
+	const bool bIsPrefetchTask)
 	: FVoxelAsyncWork(STATIC_FNAME("FVoxelMesherAsyncWork"), Renderer.Settings.PriorityDuration)
 	, ChunkId(ChunkId)
 	, LOD(LOD)
 	, ChunkPosition(Bounds.Min)
 	, bIsTransitionTask(bIsTransitionTask)
 	, TransitionsMask(TransitionsMask)
+	, bIsPrefetchTask(bIsPrefetchTask)
 	, Renderer(Renderer.AsShared())
 	, PriorityHandler(Bounds, Renderer.GetInvokersPositions())
 {
@@ -35,6 +40,18 @@ FVoxelMesherAsyncWork::~FVoxelMesherAsyncWork()
 {
 }
 
+void FVoxelMesherAsyncWork::FinishWithCachedChunk(const TVoxelSharedRef<const FVoxelChunkMesh>& CachedChunk)
+{
+	check(IsInGameThread());
+
+	Chunk = CachedChunk;
+	CreationTime = FPlatformTime::Seconds();
+	bIsCachedChunk = true;
+
+	// DoWork will return immediately, and PostDoWork will queue the callback
+	DoThreadedWork();
+}
+
 static void ShowWorldGeneratorError(TVoxelWeakPtr<const FVoxelData> Data)
 {
 	static TSet<TVoxelWeakPtr<const FVoxelData>> IgnoredDatas;
@@ -59,6 +76,11 @@ void FVoxelMesherAsyncWork::DoWork()
 {
 	VOXEL_FUNCTION_COUNTER();
 
+	if (bIsCachedChunk)
+	{
+		return;
+	}
+
 	auto PinnedRenderer = Renderer.Pin();
 	if (IsCanceled()) return;
 	if (!ensure(PinnedRenderer.IsValid())) return; // Either we're canceled, or the renderer is valid
@@ -69,14 +91,26 @@ void FVoxelMesherAsyncWork::DoWork()
 		ChunkPosition,
 		bIsTransitionTask,
 		TransitionsMask);
+	// The renderer cancels the tasks of the chunks it doesn't need anymore
+	Mesher->CancelToken = GetCancelToken();
 
 	CreationTime = FPlatformTime::Seconds();
 
+	if (PinnedRenderer->Settings.MeshCacheSize > 0)
+	{
+		// Before meshing: if the data is edited while we mesh, the version will be outdated and the chunk will be remeshed when needed
+		EditVersion = PinnedRenderer->Settings.Data->GetEditVersion(FVoxelChunkMeshCache::GetDataBounds(LOD, ChunkPosition));
+	}
+
 	const auto MesherChunk = Mesher->CreateFullChunk();
 	if (MesherChunk.IsValid())
 	{
 		Chunk = MesherChunk.ToSharedRef();
 	}
+	else if (IsCanceled())
+	{
+		// Stopped early, the result won't be used
+	}
 	else
 	{
 		AsyncTask(ENamedThreads::GameThread, [Data = MakeVoxelWeakPtr(PinnedRenderer->Settings.Data)]() { ShowWorldGeneratorError(Data); });
@@ -93,7 +127,7 @@ void FVoxelMesherAsyncWork::PostDoWork()
 	auto RendererPtr = Renderer.Pin();
 	if (ensure(RendererPtr.IsValid()))
 	{
-		RendererPtr->QueueChunkCallback_AnyThread(TaskId, ChunkId, bIsTransitionTask);
+		RendererPtr->QueueChunkCallback_AnyThread(TaskId, ChunkId, bIsTransitionTask, bIsPrefetchTask);
 		FVoxelUtilities::DeleteOnGameThread_AnyThread(RendererPtr);
 	}
 }
@@ -149,6 +183,18 @@ TUniquePtr<FVoxelMesherBase> FVoxelMesherAsyncWork::GetMesher(
 			return MakeUnique<FVoxelSurfaceNetMesher>(LOD, ChunkPosition, Settings);
 		}
 	}
+	case EVoxelRenderType::DualContouring:
+	{
+		if (bIsTransitionTask)
+		{
+			check(false);
+			return nullptr;
+		}
+		else
+		{
+			return MakeUnique<FVoxelDualContouringMesher>(LOD, ChunkPosition, Settings);
+		}
+	}
 	}
 }
 
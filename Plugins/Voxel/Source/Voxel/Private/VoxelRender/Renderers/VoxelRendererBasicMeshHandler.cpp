@@ -9,11 +9,19 @@
 #include "VoxelRender/VoxelProcMeshBuffers.h"
 #include "VoxelDebug/VoxelDebugManager.h"
 #include "VoxelThreadingUtilities.h"
+#include "VoxelMathUtilities.h"
 #include "IVoxelPool.h"
 #include "VoxelAsyncWork.h"
 
 #include "Async/Async.h"
 
+static TAutoConsoleVariable<int32> CVarCookCollisionsInMergeTasks(
+	TEXT("voxel.renderer.CookCollisionsInMergeTasks"),
+	1,
+	TEXT("If true, the mesh merge tasks will start cooking the collisions of their result, instead of waiting for the meshes to be updated on the game thread. ")
+	TEXT("Only used with complex collisions, and not with bMergeChunks"),
+	ECVF_Default);
+
 class FVoxelBasicMeshMergeWork : public FVoxelAsyncWork
 {
 public:
@@ -24,12 +32,26 @@ public:
 	{
 		auto* ChunkInfo = Handler.GetChunkInfo(ChunkInfoRef);
 		check(ChunkInfo);
+
+		TOptional<FVoxelAsyncPhysicsCookerSettings> CookerSettings;
+		if (CVarCookCollisionsInMergeTasks.GetValueOnGameThread() != 0 &&
+			FVoxelAsyncPhysicsCookerSettings::CanCookWithoutComponent(Handler.Renderer.Settings))
+		{
+			const FIntBox Bounds = FVoxelUtilities::GetBoundsFromPositionAndDepth<RENDER_CHUNK_SIZE>(ChunkInfo->Position, ChunkInfo->LOD);
+			CookerSettings = FVoxelAsyncPhysicsCookerSettings::Create(
+				Handler.Renderer.Settings,
+				Handler.AsShared(),
+				ChunkInfo->LOD,
+				FVoxelPriorityHandler(Bounds, Handler.Renderer.GetInvokersPositions()));
+		}
+
 		return new FVoxelBasicMeshMergeWork(
 			ChunkInfoRef,
 			ChunkInfo->Position,
 			Handler,
 			ChunkInfo->UpdateIndex.ToSharedRef(),
-			MoveTemp(MeshesToBuild));
+			MoveTemp(MeshesToBuild),
+			CookerSettings);
 	}
 
 private:
@@ -37,25 +59,34 @@ private:
 	const FIntVector Position;
 	const FVoxelRendererSettingsBase RendererSettings;
 	const TVoxelWeakPtr<FVoxelRendererBasicMeshHandler> Handler;
+	const TVoxelWeakPtr<IVoxelPool> Pool;
 
 	const FVoxelChunkMeshesToBuild MeshesToBuild;
 	const TVoxelSharedRef<FThreadSafeCounter> UpdateIndexPtr;
 	const int32 UpdateIndex;
 
+	// Set if the collisions are cooked by continuations of this task
+	const TOptional<FVoxelAsyncPhysicsCookerSettings> CookerSettings;
+	const double StartTime;
+
 	FVoxelBasicMeshMergeWork(
 		FVoxelRendererBasicMeshHandler::FChunkInfoRef Ref,
 		const FIntVector& Position,
 		FVoxelRendererBasicMeshHandler& Handler,
 		const TVoxelSharedRef<FThreadSafeCounter>& UpdateIndexPtr,
-		FVoxelChunkMeshesToBuild&& MeshesToBuild)
+		FVoxelChunkMeshesToBuild&& MeshesToBuild,
+		const TOptional<FVoxelAsyncPhysicsCookerSettings>& CookerSettings)
 		: FVoxelAsyncWork(STATIC_FNAME("FVoxelBasicMeshMergeWork"), 1e9, true)
 		, ChunkInfoRef(Ref)
 		, Position(Position)
 		, RendererSettings(static_cast<const FVoxelRendererSettingsBase&>(Handler.Renderer.Settings))
 		, Handler(StaticCastVoxelSharedRef<FVoxelRendererBasicMeshHandler>(Handler.AsShared()))
+		, Pool(Handler.Renderer.Settings.Pool)
 		, MeshesToBuild(MoveTemp(MeshesToBuild))
 		, UpdateIndexPtr(UpdateIndexPtr)
 		, UpdateIndex(UpdateIndexPtr->GetValue())
+		, CookerSettings(CookerSettings)
+		, StartTime(FPlatformTime::Seconds())
 	{
 	}
 
@@ -79,11 +110,49 @@ private:
 		auto HandlerPinned = Handler.Pin();
 		if (HandlerPinned.IsValid())
 		{
+			FVoxelRendererBasicMeshHandler::FChunkBuiltData BuiltData;
+			BuiltData.UpdateIndex = UpdateIndex;
+			BuiltData.StartTime = StartTime;
+			if (CookerSettings.IsSet())
+			{
+				BuiltData.Cookers = StartCookers(*BuiltMeshes);
+			}
+			BuiltData.BuiltMeshes = MoveTemp(BuiltMeshes);
+
 			// Queue callback
-			HandlerPinned->MeshMergeCallback(ChunkInfoRef, UpdateIndex, MoveTemp(BuiltMeshes));
+			HandlerPinned->MeshMergeCallback(ChunkInfoRef, MoveTemp(BuiltData));
 			FVoxelUtilities::DeleteOnGameThread_AnyThread(HandlerPinned);
 		}
 	}
+
+	TArray<FVoxelRendererBasicMeshHandler::FCookerPtr> StartCookers(const FVoxelBuiltChunkMeshes& BuiltMeshes)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		TArray<FVoxelRendererBasicMeshHandler::FCookerPtr> Cookers;
+		for (auto& BuiltMesh : BuiltMeshes)
+		{
+			// Must match the buffers the component will use, see UVoxelProceduralMeshComponent::AddProcMeshSection
+			TArray<TVoxelSharedPtr<const FVoxelProcMeshBuffers>> CollisionBuffers;
+			for (auto& Section : BuiltMesh.Value)
+			{
+				if (Section.Key.bEnableCollisions && Section.Value->GetNumIndices() > 0)
+				{
+					CollisionBuffers.Add(Section.Value);
+				}
+			}
+
+			FVoxelAsyncPhysicsCooker* Cooker = nullptr;
+			if (CollisionBuffers.Num() > 0)
+			{
+				Cooker = FVoxelAsyncPhysicsCooker::CreateForComponentLater(CookerSettings.GetValue(), CollisionBuffers, StartTime);
+				// Queued as soon as we are done, without waiting for the game thread
+				AddContinuation(Pool, EVoxelTaskType::CollisionCooking, Cooker);
+			}
+			Cookers.Emplace(Cooker);
+		}
+		return Cookers;
+	}
 };
 
 FVoxelRendererBasicMeshHandler::~FVoxelRendererBasicMeshHandler()
@@ -152,7 +221,7 @@ void FVoxelRendererBasicMeshHandler::ApplyAction(const FAction& Action)
 		NewAction.UpdateChunk().AfterCall.DistanceFieldVolumeData = Action.UpdateChunk().InitialCall.MainChunk->GetDistanceFieldVolumeData();
 		ActionQueue.Enqueue(NewAction);
 
-		if (Renderer.Settings.RenderType == EVoxelRenderType::SurfaceNets)
+		if (FVoxelUtilities::UsesParentPositionTransitions(Renderer.Settings.RenderType))
 		{
 			SetTransitionsMaskForSurfaceNets(Action.ChunkId, Action.UpdateChunk().InitialCall.ChunkSettings.TransitionsMask);
 		}
@@ -187,8 +256,6 @@ void FVoxelRendererBasicMeshHandler::Tick(double MaxTime)
 {
 	VOXEL_FUNCTION_COUNTER();
 
-	IVoxelRendererMeshHandler::Tick(MaxTime);
-
 	FlushBuiltDataQueue();
 	FlushActionQueue(MaxTime);
 
@@ -258,6 +325,7 @@ void FVoxelRendererBasicMeshHandler::FlushActionQueue(double MaxTime)
 					// Stored built data is outdated, clear it to save memory
 					ensure(ChunkInfo.BuiltData.BuiltMeshes.IsValid());
 					ChunkInfo.BuiltData.BuiltMeshes.Reset();
+					ChunkInfo.BuiltData.Cookers.Reset();
 					ChunkInfo.BuiltData.UpdateIndex = -1;
 				}
 
@@ -266,6 +334,7 @@ void FVoxelRendererBasicMeshHandler::FlushActionQueue(double MaxTime)
 
 			// Move to clear the built data value
 			const auto BuiltMeshes = MoveTemp(ChunkInfo.BuiltData.BuiltMeshes);
+			auto Cookers = MoveTemp(ChunkInfo.BuiltData.Cookers);
 			ChunkInfo.MeshUpdateIndex = ChunkInfo.BuiltData.UpdateIndex;
 			ChunkInfo.BuiltData.UpdateIndex = -1;
 
@@ -291,8 +360,11 @@ void FVoxelRendererBasicMeshHandler::FlushActionQueue(double MaxTime)
 				Mesh.ClearSections(EVoxelProcMeshSectionUpdate::DelayUpdate);
 				for (auto& Section : BuiltMesh.Value)
 				{
-					Mesh.AddProcMeshSection(Section.Key, MoveTemp(Section.Value), EVoxelProcMeshSectionUpdate::DelayUpdate);
+					Mesh.AddProcMeshSection(Section.Key, Section.Value.ToSharedRef(), EVoxelProcMeshSectionUpdate::DelayUpdate);
 				}
+				Mesh.SetPendingCollisionUpdate(
+					ChunkInfo.BuiltData.StartTime,
+					Cookers.IsValidIndex(MeshIndex) ? Cookers[MeshIndex].Release() : nullptr);
 				Mesh.FinishSectionsUpdates();
 
 				MeshIndex++;
@@ -387,7 +459,7 @@ void FVoxelRendererBasicMeshHandler::FlushActionQueue(double MaxTime)
 	}
 }
 
-void FVoxelRendererBasicMeshHandler::MeshMergeCallback(FChunkInfoRef ChunkInfoRef, int32 UpdateIndex, TUniquePtr<FVoxelBuiltChunkMeshes> BuiltMeshes)
+void FVoxelRendererBasicMeshHandler::MeshMergeCallback(FChunkInfoRef ChunkInfoRef, FChunkBuiltData&& BuiltData)
 {
-	CallbackQueue.Enqueue({ ChunkInfoRef, FChunkBuiltData{ UpdateIndex,  MoveTemp(BuiltMeshes) } });
+	CallbackQueue.Enqueue({ ChunkInfoRef, MoveTemp(BuiltData) });
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "QueueWithNum.h"
 #include "VoxelGlobals.h"
 #include "VoxelRender/VoxelRenderUtilities.h"
+#include "VoxelRender/VoxelAsyncPhysicsCooker.h"
 #include "VoxelRendererMeshHandler.h"
 
 class FVoxelRendererBasicMeshHandler : public IVoxelRendererMeshHandler
@@ -22,10 +23,16 @@ public:
 	//~ End IVoxelRendererMeshHandler Interface
 
 private:
+	using FCookerPtr = TUniquePtr<FVoxelAsyncPhysicsCooker, FVoxelAsyncWorkCancelAndAutodelete>;
+
 	struct FChunkBuiltData
 	{
 		int32 UpdateIndex = -1;
 		TUniquePtr<FVoxelBuiltChunkMeshes> BuiltMeshes;
+		// Collisions cooks started by the merge task, one per built mesh. Empty if disabled, see voxel.renderer.CookCollisionsInMergeTasks
+		TArray<FCookerPtr> Cookers;
+		// Time at which the update was queued
+		double StartTime = 0;
 	};
 	struct FChunkInfo
 	{
@@ -100,7 +107,7 @@ private:
 
 	void FlushBuiltDataQueue();
 	void FlushActionQueue(double MaxTime);
-	void MeshMergeCallback(FChunkInfoRef ChunkInfoRef, int32 UpdateIndex, TUniquePtr<FVoxelBuiltChunkMeshes> BuiltMeshes);
+	void MeshMergeCallback(FChunkInfoRef ChunkInfoRef, FChunkBuiltData&& BuiltData);
 
 	friend class FVoxelBasicMeshMergeWork;
 };
\ No newline at end of file
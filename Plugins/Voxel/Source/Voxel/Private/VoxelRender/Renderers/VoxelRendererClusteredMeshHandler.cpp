@@ -1,6 +1,7 @@
 // Copyright 2020 Phyronnaz
 
 #include "VoxelRendererClusteredMeshHandler.h"
+#include "VoxelMergedSection.h"
 #include "VoxelRender/IVoxelRenderer.h"
 #include "VoxelRender/VoxelProceduralMeshComponent.h"
 #include "VoxelRender/VoxelChunkMaterials.h"
@@ -27,7 +28,8 @@ public:
 			Cluster->Position,
 			Handler,
 			Cluster->UpdateIndex.ToSharedRef(),
-			Cluster->ChunkMeshesToBuild);
+			Cluster->ChunkMeshesToBuild,
+			Cluster->MergedMeshes);
 	}
 
 private:
@@ -37,6 +39,7 @@ private:
 	const TVoxelWeakPtr<FVoxelRendererClusteredMeshHandler> Handler;
 
 	const TMap<uint64, TVoxelSharedPtr<const FVoxelChunkMeshesToBuild>> MeshesToBuild;
+	const TVoxelSharedPtr<const FVoxelClusterMergedMeshes> PreviousMergedMeshes;
 	const TVoxelSharedRef<FThreadSafeCounter> UpdateIndexPtr;
 	const int32 UpdateIndex;
 
@@ -45,13 +48,15 @@ private:
 		const FIntVector& Position,
 		FVoxelRendererClusteredMeshHandler& Handler,
 		const TVoxelSharedRef<FThreadSafeCounter>& UpdateIndexPtr,
-		const TMap<uint64, TVoxelSharedPtr<const FVoxelChunkMeshesToBuild>>& MeshesToBuild)
+		const TMap<uint64, TVoxelSharedPtr<const FVoxelChunkMeshesToBuild>>& MeshesToBuild,
+		const TVoxelSharedPtr<const FVoxelClusterMergedMeshes>& PreviousMergedMeshes)
 		: FVoxelAsyncWork(STATIC_FNAME("FVoxelClusteredMeshMergeWork"), 1e9, true)
 		, ClusterRef(ClusterRef)
 		, Position(Position)
 		, RendererSettings(static_cast<const FVoxelRendererSettingsBase&>(Handler.Renderer.Settings))
 		, Handler(StaticCastVoxelSharedRef<FVoxelRendererClusteredMeshHandler>(Handler.AsShared()))
 		, MeshesToBuild(MeshesToBuild)
+		, PreviousMergedMeshes(PreviousMergedMeshes)
 		, UpdateIndexPtr(UpdateIndexPtr)
 		, UpdateIndex(UpdateIndexPtr->GetValue())
 	{
@@ -68,30 +73,47 @@ private:
 			// Canceled
 			return;
 		}
-		FVoxelChunkMeshesToBuild RealMap;
+		// Mesh config -> section settings -> chunk unique id -> sections
+		TMap<FVoxelMeshConfig, TMap<FVoxelProcMeshSectionSettings, FVoxelMergedSection::FChunksSections>> SectionsToMerge;
 		for (auto& ChunkIt : MeshesToBuild)
 		{
-			// Key is ChunkId = useless here
 			for (auto& MeshIt : *ChunkIt.Value)
 			{
-				auto& MeshMap = RealMap.FindOrAdd(MeshIt.Key);
+				auto& MeshMap = SectionsToMerge.FindOrAdd(MeshIt.Key);
 				for (auto& SectionIt : MeshIt.Value)
 				{
-					MeshMap.FindOrAdd(SectionIt.Key).Append(SectionIt.Value);
+					MeshMap.FindOrAdd(SectionIt.Key).Add(ChunkIt.Key, SectionIt.Value);
 				}
 			}
 		}
-		auto BuiltMeshes = FVoxelRenderUtilities::BuildMeshes_AnyThread(RealMap, RendererSettings, Position, *UpdateIndexPtr, UpdateIndex);
-		if (!BuiltMeshes.IsValid())
+
+		const auto MergedMeshes = MakeVoxelShared<FVoxelClusterMergedMeshes>();
+		for (auto& MeshIt : SectionsToMerge)
 		{
-			// Canceled
-			return;
+			const auto* PreviousSections = PreviousMergedMeshes.IsValid() ? PreviousMergedMeshes->Find(MeshIt.Key) : nullptr;
+			auto& MergedSections = MergedMeshes->Add(MeshIt.Key);
+			for (auto& SectionIt : MeshIt.Value)
+			{
+				TVoxelSharedPtr<const FVoxelMergedSection> PreviousSection;
+				if (PreviousSections && PreviousSections->Contains(SectionIt.Key))
+				{
+					PreviousSection = PreviousSections->FindChecked(SectionIt.Key);
+				}
+
+				auto MergedSection = FVoxelMergedSection::Merge_AnyThread(PreviousSection, SectionIt.Value, RendererSettings, Position, *UpdateIndexPtr, UpdateIndex);
+				if (!MergedSection.IsValid())
+				{
+					// Canceled
+					return;
+				}
+				MergedSections.Add(SectionIt.Key, MergedSection);
+			}
 		}
 		auto HandlerPinned = Handler.Pin();
 		if (HandlerPinned.IsValid())
 		{
 			// Queue callback
-			HandlerPinned->MeshMergeCallback(ClusterRef, UpdateIndex, MoveTemp(BuiltMeshes));
+			HandlerPinned->MeshMergeCallback(ClusterRef, UpdateIndex, MergedMeshes);
 			FVoxelUtilities::DeleteOnGameThread_AnyThread(HandlerPinned);
 		}
 	}
@@ -242,8 +264,6 @@ void FVoxelRendererClusteredMeshHandler::Tick(double MaxTime)
 {
 	VOXEL_FUNCTION_COUNTER();
 
-	IVoxelRendererMeshHandler::Tick(MaxTime);
-
 	FlushBuiltDataQueue();
 	FlushActionQueue(MaxTime);
 
@@ -277,13 +297,18 @@ void FVoxelRendererClusteredMeshHandler::FlushBuiltDataQueue()
 	{
 		auto& BuiltData = Callback.BuiltData;
 
-		if (!ensure(BuiltData.BuiltMeshes.IsValid())) continue;
+		if (!ensure(BuiltData.MergedMeshes.IsValid())) continue;
 
 		auto* Cluster = GetCluster(Callback.ClusterRef);
 		if (Cluster && BuiltData.UpdateIndex >= Cluster->UpdateIndex->GetValue())
 		{
 			// Not outdated
 			ensure(BuiltData.UpdateIndex == Cluster->UpdateIndex->GetValue());
+			if (!Renderer.Settings.bStaticWorld || Renderer.Settings.bRenderWorld)
+			{
+				// Static worlds without rendering clear the mesh buffers once the collisions are built, don't keep them alive
+				Cluster->MergedMeshes = BuiltData.MergedMeshes;
+			}
 			Cluster->BuiltData = MoveTemp(BuiltData);
 		}
 	}
@@ -325,8 +350,8 @@ void FVoxelRendererClusteredMeshHandler::FlushActionQueue(double MaxTime)
 				if (Cluster.BuiltData.UpdateIndex != -1)
 				{
 					// Stored built data is outdated, clear it to save memory
-					ensure(Cluster.BuiltData.BuiltMeshes.IsValid());
-					Cluster.BuiltData.BuiltMeshes.Reset();
+					ensure(Cluster.BuiltData.MergedMeshes.IsValid());
+					Cluster.BuiltData.MergedMeshes.Reset();
 					Cluster.BuiltData.UpdateIndex = -1;
 				}
 
@@ -334,18 +359,18 @@ void FVoxelRendererClusteredMeshHandler::FlushActionQueue(double MaxTime)
 			}
 
 			// Move to clear the built data value
-			const auto BuiltMeshes = MoveTemp(Cluster.BuiltData.BuiltMeshes);
+			const auto MergedMeshes = MoveTemp(Cluster.BuiltData.MergedMeshes);
 			Cluster.MeshUpdateIndex = Cluster.BuiltData.UpdateIndex;
 			Cluster.BuiltData.UpdateIndex = -1;
 
-			if (!ensure(BuiltMeshes.IsValid())) continue;
+			if (!ensure(MergedMeshes.IsValid())) continue;
 
 			int32 MeshIndex = 0;
 			CleanUp(Cluster.Meshes);
 			// Apply built meshes
-			for (auto& BuiltMesh : *BuiltMeshes)
+			for (auto& MergedMesh : *MergedMeshes)
 			{
-				const FVoxelMeshConfig& MeshConfig = BuiltMesh.Key;
+				const FVoxelMeshConfig& MeshConfig = MergedMesh.Key;
 				if (Cluster.Meshes.Num() <= MeshIndex)
 				{
 					// Not enough meshes to render the built mesh, allocate new ones
@@ -359,9 +384,9 @@ void FVoxelRendererClusteredMeshHandler::FlushActionQueue(double MaxTime)
 
 				Mesh.SetDistanceFieldData(nullptr);
 				Mesh.ClearSections(EVoxelProcMeshSectionUpdate::DelayUpdate);
-				for (auto& Section : BuiltMesh.Value)
+				for (auto& Section : MergedMesh.Value)
 				{
-					Mesh.AddProcMeshSection(Section.Key, MoveTemp(Section.Value), EVoxelProcMeshSectionUpdate::DelayUpdate);
+					Mesh.AddProcMeshSection(Section.Key, Section.Value->GetBuffers(), EVoxelProcMeshSectionUpdate::DelayUpdate);
 				}
 				Mesh.FinishSectionsUpdates();
 
@@ -428,7 +453,7 @@ void FVoxelRendererClusteredMeshHandler::FlushActionQueue(double MaxTime)
 	}
 }
 
-void FVoxelRendererClusteredMeshHandler::MeshMergeCallback(FClusterRef ClusterRef, int32 UpdateIndex, TUniquePtr<FVoxelBuiltChunkMeshes> BuiltMeshes)
+void FVoxelRendererClusteredMeshHandler::MeshMergeCallback(FClusterRef ClusterRef, int32 UpdateIndex, const TVoxelSharedRef<const FVoxelClusterMergedMeshes>& MergedMeshes)
 {
-	CallbackQueue.Enqueue({ ClusterRef, FClusterBuiltData{ UpdateIndex,  MoveTemp(BuiltMeshes) } });
+	CallbackQueue.Enqueue({ ClusterRef, FClusterBuiltData{ UpdateIndex, MergedMeshes } });
 }
\ No newline at end of file
@@ -8,6 +8,10 @@
 #include "VoxelRender/VoxelRenderUtilities.h"
 #include "VoxelRendererMeshHandler.h"
 
+class FVoxelMergedSection;
+
+using FVoxelClusterMergedMeshes = TMap<FVoxelMeshConfig, TMap<FVoxelProcMeshSectionSettings, TVoxelSharedPtr<const FVoxelMergedSection>>>;
+
 class FVoxelRendererClusteredMeshHandler : public IVoxelRendererMeshHandler
 {
 public:
@@ -27,7 +31,7 @@ private:
 	struct FClusterBuiltData
 	{
 		int32 UpdateIndex = -1;
-		TUniquePtr<FVoxelBuiltChunkMeshes> BuiltMeshes;
+		TVoxelSharedPtr<const FVoxelClusterMergedMeshes> MergedMeshes;
 	};
 	struct FCluster
 	{
@@ -48,6 +52,9 @@ private:
 
 		// Processed data waiting to be displayed
 		FClusterBuiltData BuiltData;
+		// Last merged meshes, used by the next build task to only update the chunks that changed
+		// Null if the buffers are not kept (static worlds without rendering)
+		TVoxelSharedPtr<const FVoxelClusterMergedMeshes> MergedMeshes;
 
 		// Chunk unique id -> its meshes
 		// Shared ptr: used by build task
@@ -138,7 +145,7 @@ private:
 
 	void FlushBuiltDataQueue();
 	void FlushActionQueue(double MaxTime);
-	void MeshMergeCallback(FClusterRef ClusterRef, int32 UpdateIndex, TUniquePtr<FVoxelBuiltChunkMeshes> BuiltMeshes);
+	void MeshMergeCallback(FClusterRef ClusterRef, int32 UpdateIndex, const TVoxelSharedRef<const FVoxelClusterMergedMeshes>& MergedMeshes);
 
 	friend class FVoxelClusteredMeshMergeWork;
 };
\ No newline at end of file
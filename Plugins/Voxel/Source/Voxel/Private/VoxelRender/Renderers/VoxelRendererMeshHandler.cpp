@@ -190,9 +190,9 @@ void IVoxelRendererMeshHandler::ShowChunk(FChunkId ChunkId)
 	ApplyAction(Action);
 }
 
-void IVoxelRendererMeshHandler::Tick(double MaxTime)
+int32 IVoxelRendererMeshHandler::TickPhysicsCallbacks(double MaxTime)
 {
-	TickHandler();
+	return TickHandler(MaxTime);
 }
 
 void IVoxelRendererMeshHandler::RecomputeMeshPositions()
@@ -266,6 +266,7 @@ UVoxelProceduralMeshComponent* IVoxelRendererMeshHandler::GetNewMesh(FChunkId Ch
 	NewMesh->Init(
 		LOD,
 		ChunkId.GetDebugValue(),
+		Position,
 		PriorityHandler,
 		AsShared(),
 		Settings);
@@ -56,7 +56,10 @@ public:
 	// Not required for tessellation change
 	virtual void ClearChunkMaterials() = 0;
 
-	virtual void Tick(double MaxTime);
+	virtual void Tick(double MaxTime) = 0;
+	// The physics cooker callbacks have their own frame budget, so they are not ticked by Tick
+	// Returns the number of callbacks left for the next frames
+	virtual int32 TickPhysicsCallbacks(double MaxTime);
 
 public:
 	virtual void RecomputeMeshPositions();
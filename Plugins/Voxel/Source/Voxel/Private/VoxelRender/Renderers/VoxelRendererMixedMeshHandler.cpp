@@ -125,12 +125,21 @@ void FVoxelRendererMixedMeshHandler::Tick(double MaxTime)
 {
 	VOXEL_FUNCTION_COUNTER();
 
-	IVoxelRendererMeshHandler::Tick(MaxTime);
-
 	BasicMeshHandler->Tick(MaxTime);
 	ClusteredMeshHandler->Tick(MaxTime);
 }
 
+int32 FVoxelRendererMixedMeshHandler::TickPhysicsCallbacks(double MaxTime)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// The components are created by the basic and clustered handlers, so most callbacks are in their queues
+	int32 NumLeft = IVoxelRendererMeshHandler::TickPhysicsCallbacks(MaxTime);
+	NumLeft += BasicMeshHandler->TickPhysicsCallbacks(MaxTime);
+	NumLeft += ClusteredMeshHandler->TickPhysicsCallbacks(MaxTime);
+	return NumLeft;
+}
+
 void FVoxelRendererMixedMeshHandler::RecomputeMeshPositions()
 {
 	VOXEL_FUNCTION_COUNTER();
@@ -19,6 +19,7 @@ public:
 	virtual void ApplyAction(const FAction& Action) override;
 	virtual void ClearChunkMaterials() override;
 	virtual void Tick(double MaxTime) override;
+	virtual int32 TickPhysicsCallbacks(double MaxTime) override;
 
 	virtual void RecomputeMeshPositions() override;
 	virtual void StartDestroying() override;
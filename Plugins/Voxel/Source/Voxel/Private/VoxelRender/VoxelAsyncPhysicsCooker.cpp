@@ -3,8 +3,10 @@
 #include "VoxelRender/VoxelAsyncPhysicsCooker.h"
 #include "VoxelRender/VoxelProceduralMeshComponent.h"
 #include "VoxelRender/VoxelProcMeshBuffers.h"
+#include "VoxelRender/IVoxelRenderer.h"
 #include "VoxelRender/IVoxelProceduralMeshComponent_PhysicsCallbackHandler.h"
 #include "VoxelThreadingUtilities.h"
+#include "VoxelIntVectorUtilities.h"
 #include "VoxelGlobals.h"
 
 #if ENGINE_MINOR_VERSION < 23
@@ -15,8 +17,14 @@
 #include "IPhysXCookingModule.h"
 #endif
 
+#include "VoxelData/VoxelData.h"
+#include "VoxelQueryZone.h"
+
 #include "Async/Async.h"
+#include "Misc/ScopeLock.h"
+#include "Hash/CityHash.h"
 #include "PhysicsPublic.h"
+#include "PhysXIncludes.h"
 #include "PhysicsEngine/PhysicsSettings.h"
 //#include "ThirdParty/VHACD/public/VHACD.h"
 
@@ -30,6 +38,21 @@ static TAutoConsoleVariable<int32> CVarLogCollisionCookingTimes(
 	TEXT("If true, will log the time it took to cook the voxel meshes collisions"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<int32> CVarCollisionCellSize(
+	TEXT("voxel.renderer.CollisionCellSize"),
+	16,
+	TEXT("Size in voxels of the cells the complex collisions of a chunk are split in. Only the cells changed by an edit are cooked again. 0 to cook a single mesh per chunk"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarConvexHullsFromData(
+	TEXT("voxel.renderer.ConvexHullsFromData"),
+	1,
+	TEXT("If true, simple collisions hulls will be built by merging the solid voxels into boxes instead of splitting the mesh vertices"),
+	ECVF_Default);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Collision Cells Cooked"), STAT_VoxelCollisionCellsCooked, STATGROUP_Voxel);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Collision Cells Reused"), STAT_VoxelCollisionCellsReused, STATGROUP_Voxel);
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -50,50 +73,228 @@ static const FName PhysXFormat = FPlatformProperties::GetPhysicsFormat();
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-FVoxelAsyncPhysicsCooker::FVoxelAsyncPhysicsCooker(UVoxelProceduralMeshComponent* Component)
-	: FVoxelAsyncWork("AsyncPhysicsCooker", Component->PriorityDuration)
-	, UniqueId(UNIQUE_ID())
-	, Component(Component)
-	, PhysicsCallbackHandler(Component->PhysicsCallbackHandler)
-	, LOD(Component->LOD)
-	, CollisionTraceFlag(
-		Component->CollisionTraceFlag == ECollisionTraceFlag::CTF_UseDefault
-		? ECollisionTraceFlag(UPhysicsSettings::Get()->DefaultShapeComplexity)
-		: Component->CollisionTraceFlag)
-	, PriorityHandler(Component->PriorityHandler)
-	, bCleanCollisionMesh(Component->bCleanCollisionMesh)
-	, NumConvexHullsPerAxis(Component->NumConvexHullsPerAxis)
-	, Buffers([&]()
+FVoxelCollisionCellCache::~FVoxelCollisionCellCache()
 {
-	TArray<TVoxelSharedPtr<const FVoxelProcMeshBuffers>> TmpBuffers;
-	TmpBuffers.Reserve(Component->ProcMeshSections.Num());
-	for (auto& Section : Component->ProcMeshSections)
+	for (auto& It : Meshes)
 	{
-		if (Section.Settings.bEnableCollisions)
+		It.Value->release();
+	}
+}
+
+physx::PxTriangleMesh* FVoxelCollisionCellCache::FindAndAcquire(uint64 Hash)
+{
+	FScopeLock Lock(&Section);
+
+	physx::PxTriangleMesh* const* Mesh = Meshes.Find(Hash);
+	if (!Mesh)
+	{
+		return nullptr;
+	}
+	(*Mesh)->acquireReference();
+	return *Mesh;
+}
+
+void FVoxelCollisionCellCache::Add(uint64 Hash, physx::PxTriangleMesh* Mesh)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(Mesh);
+
+	FScopeLock Lock(&Section);
+
+	if (Meshes.Contains(Hash))
+	{
+		// Cooked by another cooker at the same time
+		return;
+	}
+	Mesh->acquireReference();
+	Meshes.Add(Hash, Mesh);
+
+	if (Meshes.Num() < NumMeshesBeforeCleanup)
+	{
+		return;
+	}
+
+	// Release the meshes that are only referenced by the cache. No one else can acquire them as we have the lock
+	for (auto It = Meshes.CreateIterator(); It; ++It)
+	{
+		if (It.Value()->getReferenceCount() == 1)
 		{
-			TmpBuffers.Add(Section.Buffers);
+			It.Value()->release();
+			It.RemoveCurrent();
 		}
 	}
-	return TmpBuffers;
-}())
-, LocalToRoot(Component->GetRelativeTransform())
-, PhysXCooking(GetPhysXCooking())
+	NumMeshesBeforeCleanup = FMath::Max(1024, 2 * Meshes.Num());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+inline ECollisionTraceFlag GetCookerCollisionTraceFlag(ECollisionTraceFlag CollisionTraceFlag)
+{
+	return CollisionTraceFlag == ECollisionTraceFlag::CTF_UseDefault
+		? ECollisionTraceFlag(UPhysicsSettings::Get()->DefaultShapeComplexity)
+		: CollisionTraceFlag;
+}
+
+bool FVoxelAsyncPhysicsCookerSettings::CanCookWithoutComponent(const FVoxelRendererSettingsBase& RendererSettings)
+{
+	return GetCookerCollisionTraceFlag(RendererSettings.CollisionTraceFlag) == ECollisionTraceFlag::CTF_UseComplexAsSimple;
+}
+
+FVoxelAsyncPhysicsCookerSettings FVoxelAsyncPhysicsCookerSettings::Create(
+	const FVoxelRendererSettingsBase& RendererSettings,
+	const TVoxelWeakPtr<IVoxelProceduralMeshComponent_PhysicsCallbackHandler>& PhysicsCallbackHandler,
+	int32 LOD,
+	const FVoxelPriorityHandler& PriorityHandler)
+{
+	check(IsInGameThread());
+
+	FVoxelAsyncPhysicsCookerSettings Settings;
+	Settings.PriorityDuration = RendererSettings.PriorityDuration;
+	Settings.PhysicsCallbackHandler = PhysicsCallbackHandler;
+	Settings.LOD = LOD;
+	Settings.CollisionTraceFlag = GetCookerCollisionTraceFlag(RendererSettings.CollisionTraceFlag);
+	Settings.PriorityHandler = PriorityHandler;
+	Settings.bCleanCollisionMesh = RendererSettings.bCleanCollisionMeshes;
+	Settings.NumConvexHullsPerAxis = RendererSettings.NumConvexHullsPerAxis;
+	// Not thread safe
+	Settings.PhysXCooking = GetPhysXCooking();
+	return Settings;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelAsyncPhysicsCooker::FVoxelAsyncPhysicsCooker(UVoxelProceduralMeshComponent* InComponent)
+	: FVoxelAsyncPhysicsCooker(
+		GetComponentSettings(*InComponent),
+		GetComponentBuffers(*InComponent),
+		InComponent->GetRelativeTransform(),
+		InComponent->PendingCollisionUpdateStartTime > 0 ? InComponent->PendingCollisionUpdateStartTime : FPlatformTime::Seconds())
 {
 	check(IsInGameThread());
+	Component = InComponent;
+}
+
+FVoxelAsyncPhysicsCooker* FVoxelAsyncPhysicsCooker::CreateForComponentLater(
+	const FVoxelAsyncPhysicsCookerSettings& Settings,
+	const TArray<TVoxelSharedPtr<const FVoxelProcMeshBuffers>>& Buffers,
+	double StartTime)
+{
+	// Convex collisions need the component transform
+	ensure(Settings.CollisionTraceFlag == ECollisionTraceFlag::CTF_UseComplexAsSimple);
+	return new FVoxelAsyncPhysicsCooker(Settings, Buffers, FTransform::Identity, StartTime);
+}
+
+FVoxelAsyncPhysicsCooker::FVoxelAsyncPhysicsCooker(
+	const FVoxelAsyncPhysicsCookerSettings& Settings,
+	const TArray<TVoxelSharedPtr<const FVoxelProcMeshBuffers>>& Buffers,
+	const FTransform& LocalToRoot,
+	double StartTime)
+	: FVoxelAsyncWork("AsyncPhysicsCooker", Settings.PriorityDuration)
+	, UniqueId(UNIQUE_ID())
+	, PhysicsCallbackHandler(Settings.PhysicsCallbackHandler)
+	, LOD(Settings.LOD)
+	, CollisionTraceFlag(Settings.CollisionTraceFlag)
+	, PriorityHandler(Settings.PriorityHandler)
+	, bCleanCollisionMesh(Settings.bCleanCollisionMesh)
+	, NumConvexHullsPerAxis(Settings.NumConvexHullsPerAxis)
+	, Data(Settings.Data)
+	, VoxelPosition(Settings.VoxelPosition)
+	, Buffers(Buffers)
+	, LocalToRoot(LocalToRoot)
+	, StartTime(StartTime)
+	, PhysXCooking(Settings.PhysXCooking)
+{
+	check(PhysXCooking);
 	ensure(CollisionTraceFlag != ECollisionTraceFlag::CTF_UseDefault);
 	ensure(Buffers.Num() > 0);
 }
 
+FVoxelAsyncPhysicsCooker::~FVoxelAsyncPhysicsCooker()
+{
+	for (auto* ConvexMesh : CookResult.ConvexMeshes)
+	{
+		if (ConvexMesh)
+		{
+			ConvexMesh->release();
+		}
+	}
+	for (auto* TriangleMesh : CookResult.TriangleMeshes)
+	{
+		if (TriangleMesh)
+		{
+			TriangleMesh->release();
+		}
+	}
+}
+
+FVoxelAsyncPhysicsCookerSettings FVoxelAsyncPhysicsCooker::GetComponentSettings(const UVoxelProceduralMeshComponent& Component)
+{
+	FVoxelAsyncPhysicsCookerSettings Settings;
+	Settings.PriorityDuration = Component.PriorityDuration;
+	Settings.PhysicsCallbackHandler = Component.PhysicsCallbackHandler;
+	Settings.LOD = Component.LOD;
+	Settings.CollisionTraceFlag = GetCookerCollisionTraceFlag(Component.CollisionTraceFlag);
+	Settings.PriorityHandler = Component.PriorityHandler;
+	Settings.bCleanCollisionMesh = Component.bCleanCollisionMesh;
+	Settings.NumConvexHullsPerAxis = Component.NumConvexHullsPerAxis;
+	Settings.Data = Component.Data;
+	Settings.VoxelPosition = Component.VoxelPosition;
+	Settings.PhysXCooking = GetPhysXCooking();
+	return Settings;
+}
+
+TArray<TVoxelSharedPtr<const FVoxelProcMeshBuffers>> FVoxelAsyncPhysicsCooker::GetComponentBuffers(const UVoxelProceduralMeshComponent& Component)
+{
+	TArray<TVoxelSharedPtr<const FVoxelProcMeshBuffers>> Buffers;
+	Buffers.Reserve(Component.ProcMeshSections.Num());
+	for (auto& Section : Component.ProcMeshSections)
+	{
+		if (Section.Settings.bEnableCollisions)
+		{
+			Buffers.Add(Section.Buffers);
+		}
+	}
+	return Buffers;
+}
+
+bool FVoxelAsyncPhysicsCooker::IsCookingComponent(const UVoxelProceduralMeshComponent& InComponent) const
+{
+	return
+		CollisionTraceFlag == GetCookerCollisionTraceFlag(InComponent.CollisionTraceFlag) &&
+		Buffers == GetComponentBuffers(InComponent);
+}
+
+bool FVoxelAsyncPhysicsCooker::SetComponent(UVoxelProceduralMeshComponent* NewComponent)
+{
+	check(IsInGameThread());
+	{
+		FScopeLock Lock(&ComponentSection);
+		Component = NewComponent;
+	}
+	// PostDoWork is called after IsDone is set: if it's not set yet, PostDoWork will see the new component
+	return IsDone();
+}
+
 void FVoxelAsyncPhysicsCooker::DoWork()
 {
 	VOXEL_FUNCTION_COUNTER();
 
 	const double CookStartTime = FPlatformTime::Seconds();
 
+	// Canceled when the mesh is updated again or removed before we're done: stop between the cooking steps
 	if (CollisionTraceFlag != ECollisionTraceFlag::CTF_UseComplexAsSimple)
 	{
-		DecomposeMeshToHulls();
+		if (!DecomposeDataToHulls())
+		{
+			DecomposeMeshToHulls();
+		}
+		if (GetCancelToken().IsCanceled()) return;
 		CreateConvexMesh();
+		if (GetCancelToken().IsCanceled()) return;
 	}
 	if (CollisionTraceFlag != ECollisionTraceFlag::CTF_UseSimpleAsComplex)
 	{
@@ -108,10 +309,21 @@ void FVoxelAsyncPhysicsCooker::DoWork()
 
 void FVoxelAsyncPhysicsCooker::PostDoWork()
 {
+	TWeakObjectPtr<UVoxelProceduralMeshComponent> LocalComponent;
+	{
+		FScopeLock Lock(&ComponentSection);
+		LocalComponent = Component;
+	}
+	if (LocalComponent.IsExplicitlyNull())
+	{
+		// Not given to a component yet, it will use the result directly
+		return;
+	}
+
 	auto Pinned = PhysicsCallbackHandler.Pin();
 	if (Pinned.IsValid())
 	{
-		Pinned->CookerCallback(UniqueId, Component);
+		Pinned->CookerCallback(UniqueId, LocalComponent);
 		FVoxelUtilities::DeleteOnGameThread_AnyThread(Pinned);
 	}
 }
@@ -236,8 +448,179 @@ void FVoxelAsyncPhysicsCooker::CreateTriMesh()
 		// If less than 3 triangles the cooking is likely to fail
 		return;
 	}
+	if (GetCancelToken().IsCanceled())
+	{
+		return;
+	}
+
+	const int32 CellSize = CVarCollisionCellSize.GetValueOnAnyThread();
+	if (CellSize > 0)
+	{
+		// The cache is owned by the handler, so that it's released with the renderer
+		auto Handler = PhysicsCallbackHandler.Pin();
+		if (Handler.IsValid())
+		{
+			CreateTriMeshCells(Vertices, Indices, MaterialIndices, CellSize, Handler->CollisionCellCache);
+			FVoxelUtilities::DeleteOnGameThread_AnyThread(Handler);
+			return;
+		}
+	}
 
 	CookResult.TriangleMeshes.AddZeroed();
+	if (!CookTriMesh(Vertices, Indices, MaterialIndices, CookResult.TriangleMeshes.Last()))
+	{
+		ErrorCounter.Increment();
+	}
+}
+
+void FVoxelAsyncPhysicsCooker::CreateTriMeshCells(
+	const TArray<FVector>& Vertices,
+	const TArray<FTriIndices>& Indices,
+	const TArray<uint16>& MaterialIndices,
+	int32 CellSize,
+	FVoxelCollisionCellCache& Cache)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// Each triangle goes in the cell containing its centroid. Vertices are in LOD 0 voxels
+	TMap<FIntVector, TArray<int32>> CellsTriangles;
+	{
+		VOXEL_SCOPE_COUNTER("Split triangles");
+		const float CellWorldSize = float(CellSize) * float(1 << LOD);
+		for (int32 Index = 0; Index < Indices.Num(); Index++)
+		{
+			const FTriIndices& Triangle = Indices[Index];
+			const FVector Centroid = (Vertices[Triangle.v0] + Vertices[Triangle.v1] + Vertices[Triangle.v2]) / 3.f;
+			CellsTriangles.FindOrAdd(FVoxelUtilities::FloorToInt(Centroid / CellWorldSize)).Add(Index);
+		}
+	}
+
+	// Cooking is likely to fail with less than 3 triangles: merge these cells together
+	// Sort them so that the merged cell hash doesn't depend on the map order
+	TArray<TArray<int32>> Cells;
+	{
+		TArray<FIntVector> SmallCells;
+		for (auto& It : CellsTriangles)
+		{
+			if (It.Value.Num() < 3)
+			{
+				SmallCells.Add(It.Key);
+			}
+			else
+			{
+				Cells.Add(MoveTemp(It.Value));
+			}
+		}
+		SmallCells.Sort([](const FIntVector& A, const FIntVector& B)
+		{
+			return A.X != B.X ? A.X < B.X : A.Y != B.Y ? A.Y < B.Y : A.Z < B.Z;
+		});
+
+		TArray<int32> SmallCellsTriangles;
+		for (auto& Cell : SmallCells)
+		{
+			SmallCellsTriangles.Append(CellsTriangles[Cell]);
+		}
+		if (SmallCellsTriangles.Num() >= 3 || Cells.Num() == 0)
+		{
+			Cells.Add(MoveTemp(SmallCellsTriangles));
+		}
+		else if (SmallCellsTriangles.Num() > 0)
+		{
+			Cells.Last().Append(SmallCellsTriangles);
+		}
+	}
+
+	const uint64 CookFlagsHash = uint64(GetCookFlags());
+
+	TArray<int32> VertexRemap;
+	VertexRemap.Init(-1, Vertices.Num());
+
+	TArray<FVector> CellVertices;
+	TArray<FTriIndices> CellIndices;
+	TArray<uint16> CellMaterialIndices;
+
+	int32 NumCooked = 0;
+	int32 NumReused = 0;
+	for (const TArray<int32>& CellTriangles : Cells)
+	{
+		if (GetCancelToken().IsCanceled()) return;
+
+		CellVertices.Reset();
+		CellIndices.Reset(CellTriangles.Num());
+		CellMaterialIndices.Reset(CellTriangles.Num());
+		{
+			VOXEL_SCOPE_COUNTER("Copy cell");
+			const auto GetCellVertex = [&](int32 VertexIndex)
+			{
+				int32& CellVertexIndex = VertexRemap[VertexIndex];
+				if (CellVertexIndex == -1)
+				{
+					CellVertexIndex = CellVertices.Add(Vertices[VertexIndex]);
+				}
+				return CellVertexIndex;
+			};
+			for (int32 TriangleIndex : CellTriangles)
+			{
+				const FTriIndices& Triangle = Indices[TriangleIndex];
+				FTriIndices CellTriangle;
+				CellTriangle.v0 = GetCellVertex(Triangle.v0);
+				CellTriangle.v1 = GetCellVertex(Triangle.v1);
+				CellTriangle.v2 = GetCellVertex(Triangle.v2);
+				CellIndices.Add(CellTriangle);
+				CellMaterialIndices.Add(MaterialIndices[TriangleIndex]);
+			}
+			for (int32 TriangleIndex : CellTriangles)
+			{
+				const FTriIndices& Triangle = Indices[TriangleIndex];
+				VertexRemap[Triangle.v0] = -1;
+				VertexRemap[Triangle.v1] = -1;
+				VertexRemap[Triangle.v2] = -1;
+			}
+		}
+
+		uint64 Hash;
+		{
+			VOXEL_SCOPE_COUNTER("Hash cell");
+			Hash = CityHash64WithSeed(reinterpret_cast<const char*>(CellVertices.GetData()), CellVertices.Num() * sizeof(FVector), CookFlagsHash);
+			Hash = CityHash64WithSeed(reinterpret_cast<const char*>(CellIndices.GetData()), CellIndices.Num() * sizeof(FTriIndices), Hash);
+			Hash = CityHash64WithSeed(reinterpret_cast<const char*>(CellMaterialIndices.GetData()), CellMaterialIndices.Num() * sizeof(uint16), Hash);
+		}
+
+		physx::PxTriangleMesh* TriangleMesh = Cache.FindAndAcquire(Hash);
+		if (TriangleMesh)
+		{
+			NumReused++;
+		}
+		else
+		{
+			if (!CookTriMesh(CellVertices, CellIndices, CellMaterialIndices, TriangleMesh))
+			{
+				ErrorCounter.Increment();
+				continue;
+			}
+			Cache.Add(Hash, TriangleMesh);
+			NumCooked++;
+		}
+		CookResult.TriangleMeshes.Add(TriangleMesh);
+	}
+
+	INC_DWORD_STAT_BY(STAT_VoxelCollisionCellsCooked, NumCooked);
+	INC_DWORD_STAT_BY(STAT_VoxelCollisionCellsReused, NumReused);
+
+	if (CVarLogCollisionCookingTimes.GetValueOnAnyThread() != 0)
+	{
+		UE_LOG(LogVoxel, Log, TEXT("Collision cells: %d cooked, %d reused"), NumCooked, NumReused);
+	}
+}
+
+bool FVoxelAsyncPhysicsCooker::CookTriMesh(
+	const TArray<FVector>& Vertices,
+	const TArray<FTriIndices>& Indices,
+	const TArray<uint16>& MaterialIndices,
+	physx::PxTriangleMesh*& OutTriangleMesh) const
+{
+	VOXEL_FUNCTION_COUNTER();
 
 	constexpr bool bFlipNormals = true; // Always true due to the order of the vertices (clock wise vs not)
 	const bool bSuccess = PhysXCooking->CreateTriMesh(
@@ -247,14 +630,14 @@ void FVoxelAsyncPhysicsCooker::CreateTriMesh()
 		Indices,
 		MaterialIndices,
 		bFlipNormals,
-		CookResult.TriangleMeshes.Last());
+		OutTriangleMesh);
 
 	if (!bSuccess)
 	{
 		// Happens sometimes
 		UE_LOG(LogVoxel, Warning, TEXT("Failed to cook TriMesh. Num vertices: %d; Num triangles: %d"), Vertices.Num(), Indices.Num());
-		ErrorCounter.Increment();
 	}
+	return bSuccess;
 }
 
 void FVoxelAsyncPhysicsCooker::CreateConvexMesh()
@@ -263,6 +646,8 @@ void FVoxelAsyncPhysicsCooker::CreateConvexMesh()
 
 	for (auto& Element : CookResult.ConvexElems)
 	{
+		if (GetCancelToken().IsCanceled()) return;
+
 		CookResult.ConvexMeshes.AddZeroed();
 		const EPhysXCookingResult Result = PhysXCooking->CreateConvex(PhysXFormat, GetCookFlags(), Element.VertexData, CookResult.ConvexMeshes.Last());
 		switch (Result)
@@ -284,6 +669,243 @@ void FVoxelAsyncPhysicsCooker::CreateConvexMesh()
 	}
 }
 
+bool FVoxelAsyncPhysicsCooker::DecomposeDataToHulls()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (CVarConvexHullsFromData.GetValueOnAnyThread() == 0)
+	{
+		return false;
+	}
+
+	const FBox Box = GetBuffersBounds();
+	if (!Box.IsValid)
+	{
+		return false;
+	}
+
+	// Cells are the size of a voxel at this LOD. Add a one cell border to catch the solid voxels next to the mesh
+	const int32 Step = 1 << LOD;
+	const FIntVector Min = FVoxelUtilities::FloorToInt(Box.Min / Step) * Step - FIntVector(Step);
+	const FIntVector Max = FVoxelUtilities::CeilToInt(Box.Max / Step) * Step + FIntVector(Step);
+	const FIntVector NumCells = (Max - Min) / Step;
+	const FIntVector NumSamples = NumCells + FIntVector(1);
+	if (NumCells.GetMax() > 256)
+	{
+		// Too much memory, eg huge clusters
+		return false;
+	}
+
+	TArray<FVoxelValue> Values;
+	Values.SetNumUninitialized(NumSamples.X * NumSamples.Y * NumSamples.Z);
+	{
+		auto PinnedData = Data.Pin();
+		if (!PinnedData.IsValid())
+		{
+			return false;
+		}
+
+		const FIntBox Bounds(VoxelPosition + Min, VoxelPosition + Min + NumSamples * Step);
+		TVoxelQueryZone<FVoxelValue> QueryZone(Bounds, NumSamples, LOD, Values);
+		{
+			FVoxelReadScopeLock Lock(*PinnedData, Bounds, "AsyncPhysicsCooker");
+			PinnedData->Get(QueryZone, LOD);
+		}
+		FVoxelUtilities::DeleteOnGameThread_AnyThread(PinnedData);
+	}
+	if (GetCancelToken().IsCanceled()) return true;
+
+	const auto GetCellIndex = [&](int32 X, int32 Y, int32 Z)
+	{
+		return X + NumCells.X * Y + NumCells.X * NumCells.Y * Z;
+	};
+
+	// A cell is solid if the interpolated value at its center is
+	TBitArray<> SolidCells(false, NumCells.X * NumCells.Y * NumCells.Z);
+	int32 NumSolidCells = 0;
+	{
+		VOXEL_SCOPE_COUNTER("Find solid cells");
+		for (int32 Z = 0; Z < NumCells.Z; Z++)
+		{
+			for (int32 Y = 0; Y < NumCells.Y; Y++)
+			{
+				for (int32 X = 0; X < NumCells.X; X++)
+				{
+					float Sum = 0;
+					for (int32 Corner = 0; Corner < 8; Corner++)
+					{
+						const int32 SampleX = X + bool(Corner & 0x1);
+						const int32 SampleY = Y + bool(Corner & 0x2);
+						const int32 SampleZ = Z + bool(Corner & 0x4);
+						Sum += Values[SampleX + NumSamples.X * SampleY + NumSamples.X * NumSamples.Y * SampleZ].ToFloat();
+					}
+					if (Sum <= 0)
+					{
+						SolidCells[GetCellIndex(X, Y, Z)] = true;
+						NumSolidCells++;
+					}
+				}
+			}
+		}
+	}
+	if (NumSolidCells == 0)
+	{
+		// Data changed since the mesh was built
+		return false;
+	}
+
+	struct FHull
+	{
+		// In cells
+		FIntBox Bounds;
+		TArray<FIntBox, TInlineAllocator<1>> Boxes;
+		int64 NumSolidCells = 0;
+	};
+	TArray<FHull> Hulls;
+
+	// Greedily merge the solid cells into boxes, growing along X, then Y, then Z
+	{
+		VOXEL_SCOPE_COUNTER("Greedy boxes");
+
+		const auto IsSolid = [&](const FIntBox& Cells)
+		{
+			for (int32 Z = Cells.Min.Z; Z < Cells.Max.Z; Z++)
+			{
+				for (int32 Y = Cells.Min.Y; Y < Cells.Max.Y; Y++)
+				{
+					for (int32 X = Cells.Min.X; X < Cells.Max.X; X++)
+					{
+						if (!SolidCells[GetCellIndex(X, Y, Z)])
+						{
+							return false;
+						}
+					}
+				}
+			}
+			return true;
+		};
+
+		for (int32 Z = 0; Z < NumCells.Z; Z++)
+		{
+			for (int32 Y = 0; Y < NumCells.Y; Y++)
+			{
+				for (int32 X = 0; X < NumCells.X; X++)
+				{
+					if (!SolidCells[GetCellIndex(X, Y, Z)])
+					{
+						continue;
+					}
+
+					FIntVector BoxMax(X + 1, Y + 1, Z + 1);
+					while (BoxMax.X < NumCells.X && IsSolid(FIntBox(FIntVector(BoxMax.X, Y, Z), FIntVector(BoxMax.X + 1, BoxMax.Y, BoxMax.Z))))
+					{
+						BoxMax.X++;
+					}
+					while (BoxMax.Y < NumCells.Y && IsSolid(FIntBox(FIntVector(X, BoxMax.Y, Z), FIntVector(BoxMax.X, BoxMax.Y + 1, BoxMax.Z))))
+					{
+						BoxMax.Y++;
+					}
+					while (BoxMax.Z < NumCells.Z && IsSolid(FIntBox(FIntVector(X, Y, BoxMax.Z), FIntVector(BoxMax.X, BoxMax.Y, BoxMax.Z + 1))))
+					{
+						BoxMax.Z++;
+					}
+
+					const FIntBox CellsBox(FIntVector(X, Y, Z), BoxMax);
+					for (int32 BoxZ = CellsBox.Min.Z; BoxZ < CellsBox.Max.Z; BoxZ++)
+					{
+						for (int32 BoxY = CellsBox.Min.Y; BoxY < CellsBox.Max.Y; BoxY++)
+						{
+							for (int32 BoxX = CellsBox.Min.X; BoxX < CellsBox.Max.X; BoxX++)
+							{
+								SolidCells[GetCellIndex(BoxX, BoxY, BoxZ)] = false;
+							}
+						}
+					}
+
+					FHull& Hull = Hulls.AddDefaulted_GetRef();
+					Hull.Bounds = CellsBox;
+					Hull.Boxes.Add(CellsBox);
+					Hull.NumSolidCells = CellsBox.Count();
+				}
+			}
+		}
+	}
+
+	// Merge the smallest hull with the one adding the least empty space to it, until we are within the NumConvexHullsPerAxis budget
+	{
+		VOXEL_SCOPE_COUNTER("Merge hulls");
+
+		const FIntVector Size = GetNumConvexHulls(Box);
+		const int32 MaxNumHulls = Size.X * Size.Y * Size.Z;
+		while (Hulls.Num() > MaxNumHulls)
+		{
+			if (GetCancelToken().IsCanceled()) return true;
+
+			int32 SmallestIndex = 0;
+			for (int32 Index = 1; Index < Hulls.Num(); Index++)
+			{
+				if (Hulls[Index].NumSolidCells < Hulls[SmallestIndex].NumSolidCells)
+				{
+					SmallestIndex = Index;
+				}
+			}
+			const FHull& Smallest = Hulls[SmallestIndex];
+
+			int32 BestIndex = -1;
+			int64 BestEmptyCells = MAX_int64;
+			for (int32 Index = 0; Index < Hulls.Num(); Index++)
+			{
+				if (Index == SmallestIndex) continue;
+
+				const FHull& Hull = Hulls[Index];
+				const int64 EmptyCells = int64((Hull.Bounds + Smallest.Bounds).Count()) - Hull.NumSolidCells - Smallest.NumSolidCells;
+				if (EmptyCells < BestEmptyCells)
+				{
+					BestIndex = Index;
+					BestEmptyCells = EmptyCells;
+				}
+			}
+			check(BestIndex != -1);
+
+			FHull& Best = Hulls[BestIndex];
+			Best.Bounds = Best.Bounds + Smallest.Bounds;
+			Best.Boxes.Append(Smallest.Boxes);
+			Best.NumSolidCells += Smallest.NumSolidCells;
+			Hulls.RemoveAtSwap(SmallestIndex);
+		}
+	}
+
+	auto& ConvexElems = CookResult.ConvexElems;
+	ensure(ConvexElems.Num() == 0);
+	CookResult.ConvexBounds = FBox(ForceInit);
+	for (const FHull& Hull : Hulls)
+	{
+		TSet<FIntVector> Corners;
+		for (const FIntBox& CellsBox : Hull.Boxes)
+		{
+			for (int32 Corner = 0; Corner < 8; Corner++)
+			{
+				Corners.Add(FIntVector(
+					(Corner & 0x1) ? CellsBox.Max.X : CellsBox.Min.X,
+					(Corner & 0x2) ? CellsBox.Max.Y : CellsBox.Min.Y,
+					(Corner & 0x4) ? CellsBox.Max.Z : CellsBox.Min.Z));
+			}
+		}
+
+		FKConvexElem& Element = ConvexElems.AddDefaulted_GetRef();
+		Element.VertexData.Reserve(Corners.Num());
+		for (const FIntVector& Corner : Corners)
+		{
+			// Transform from component space to root component space, as the root is going to hold the convex meshes
+			Element.VertexData.Add(LocalToRoot.TransformPosition(FVector(Min + Corner * Step)));
+		}
+		Element.UpdateElemBox();
+		CookResult.ConvexBounds += Element.ElemBox;
+	}
+
+	return true;
+}
+
 void FVoxelAsyncPhysicsCooker::DecomposeMeshToHulls()
 {
 	VOXEL_FUNCTION_COUNTER();
@@ -460,21 +1082,10 @@ void FVoxelAsyncPhysicsCooker::DecomposeMeshToHulls()
 
 	auto& ConvexElems = CookResult.ConvexElems;
 
-	FBox Box(ForceInit);
-	for (auto& Buffer : Buffers)
-	{
-		auto& PositionBuffer = Buffer->VertexBuffers.PositionVertexBuffer;
-		for (uint32 Index = 0; Index < PositionBuffer.GetNumVertices(); Index++)
-		{
-			Box += PositionBuffer.VertexPosition(Index);
-		}
-	}
+	const FBox Box = GetBuffersBounds();
 
 	const int32 ChunkSize = RENDER_CHUNK_SIZE << LOD;
-	const FIntVector Size =
-		FVoxelUtilities::ComponentMax(
-			FIntVector(1),
-			FVoxelUtilities::CeilToInt(Box.GetSize() / ChunkSize * NumConvexHullsPerAxis));
+	const FIntVector Size = GetNumConvexHulls(Box);
 
 	if (!ensure(Size.GetMax() <= 64)) return;
 
@@ -559,6 +1170,28 @@ void FVoxelAsyncPhysicsCooker::DecomposeMeshToHulls()
 #endif
 }
 
+FBox FVoxelAsyncPhysicsCooker::GetBuffersBounds() const
+{
+	FBox Box(ForceInit);
+	for (auto& Buffer : Buffers)
+	{
+		auto& PositionBuffer = Buffer->VertexBuffers.PositionVertexBuffer;
+		for (uint32 Index = 0; Index < PositionBuffer.GetNumVertices(); Index++)
+		{
+			Box += PositionBuffer.VertexPosition(Index);
+		}
+	}
+	return Box;
+}
+
+FIntVector FVoxelAsyncPhysicsCooker::GetNumConvexHulls(const FBox& Bounds) const
+{
+	const int32 ChunkSize = RENDER_CHUNK_SIZE << LOD;
+	return FVoxelUtilities::ComponentMax(
+		FIntVector(1),
+		FVoxelUtilities::CeilToInt(Bounds.GetSize() / ChunkSize * NumConvexHullsPerAxis));
+}
+
 EPhysXMeshCookFlags FVoxelAsyncPhysicsCooker::GetCookFlags() const
 {
 	EPhysXMeshCookFlags CookFlags = EPhysXMeshCookFlags::Default;
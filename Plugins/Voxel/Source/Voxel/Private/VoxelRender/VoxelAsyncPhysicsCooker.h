@@ -7,19 +7,47 @@
 #include "VoxelAsyncWork.h"
 #include "VoxelPriorityHandler.h"
 #include "PhysicsEngine/BodySetup.h"
+#include "Interfaces/Interface_CollisionDataProvider.h"
 #include "UObject/WeakObjectPtrTemplates.h"
 
 struct FVoxelProcMeshBuffers;
 class IVoxelProceduralMeshComponent_PhysicsCallbackHandler;
+class FVoxelCollisionCellCache;
+class FVoxelData;
+struct FVoxelRendererSettingsBase;
 class IPhysXCooking;
 class UBodySetup;
 class UVoxelProceduralMeshComponent;
 
+// Settings of a cook started before its component is known, see FVoxelAsyncPhysicsCooker::CreateForComponentLater
+struct FVoxelAsyncPhysicsCookerSettings
+{
+	float PriorityDuration = 0;
+	TVoxelWeakPtr<IVoxelProceduralMeshComponent_PhysicsCallbackHandler> PhysicsCallbackHandler;
+	int32 LOD = 0;
+	ECollisionTraceFlag CollisionTraceFlag = ECollisionTraceFlag::CTF_UseDefault;
+	FVoxelPriorityHandler PriorityHandler;
+	bool bCleanCollisionMesh = false;
+	int32 NumConvexHullsPerAxis = 0;
+	// Used to build the convex hulls from the voxels. Only set when the component is known
+	TVoxelWeakPtr<const FVoxelData> Data;
+	FIntVector VoxelPosition = FIntVector::ZeroValue;
+	IPhysXCooking* PhysXCooking = nullptr;
+
+	// Only complex collisions can be cooked without knowing the component, as the convex ones are in root space
+	static bool CanCookWithoutComponent(const FVoxelRendererSettingsBase& RendererSettings);
+	// Must be called on the game thread
+	static FVoxelAsyncPhysicsCookerSettings Create(
+		const FVoxelRendererSettingsBase& RendererSettings,
+		const TVoxelWeakPtr<IVoxelProceduralMeshComponent_PhysicsCallbackHandler>& PhysicsCallbackHandler,
+		int32 LOD,
+		const FVoxelPriorityHandler& PriorityHandler);
+};
+
 class FVoxelAsyncPhysicsCooker : public FVoxelAsyncWork
 {
 public:
 	const uint64 UniqueId;
-	const TWeakObjectPtr<UVoxelProceduralMeshComponent> Component;
 	const TVoxelWeakPtr<IVoxelProceduralMeshComponent_PhysicsCallbackHandler> PhysicsCallbackHandler;
 
 	const int32 LOD;
@@ -27,16 +55,34 @@ public:
 	const FVoxelPriorityHandler PriorityHandler;
 	const bool bCleanCollisionMesh;
 	const int32 NumConvexHullsPerAxis;
+	const TVoxelWeakPtr<const FVoxelData> Data;
+	// Position of the buffers in voxels
+	const FIntVector VoxelPosition;
 	const TArray<TVoxelSharedPtr<const FVoxelProcMeshBuffers>> Buffers;
 	const FTransform LocalToRoot;
+	// Time at which the collision update was requested, to measure its latency
+	const double StartTime;
 
 	explicit FVoxelAsyncPhysicsCooker(UVoxelProceduralMeshComponent* Component);
+	// Can be called from any thread, eg by a mesh merge task to cook its result as a continuation
+	// The cooker must then be given to the component using the buffers, see UVoxelProceduralMeshComponent::SetPendingCooker
+	static FVoxelAsyncPhysicsCooker* CreateForComponentLater(
+		const FVoxelAsyncPhysicsCookerSettings& Settings,
+		const TArray<TVoxelSharedPtr<const FVoxelProcMeshBuffers>>& Buffers,
+		double StartTime);
+	// Releases the meshes that weren't given to a body setup
+	~FVoxelAsyncPhysicsCooker() override;
 
 	inline bool IsSuccessful() const
 	{
 		return ErrorCounter.GetValue() == 0;
 	}
 
+	// Whether the cook result can be used by Component, ie if it was started with the same buffers & settings
+	bool IsCookingComponent(const UVoxelProceduralMeshComponent& Component) const;
+	// Set the component to send the result to. Returns IsDone: if true, the component won't be called back
+	bool SetComponent(UVoxelProceduralMeshComponent* NewComponent);
+
 protected:
 	//~ Begin FVoxelAsyncWork Interface
 	virtual void DoWork() override;
@@ -45,20 +91,50 @@ protected:
 	//~ End FVoxelAsyncWork Interface
 
 private:
+	FVoxelAsyncPhysicsCooker(
+		const FVoxelAsyncPhysicsCookerSettings& Settings,
+		const TArray<TVoxelSharedPtr<const FVoxelProcMeshBuffers>>& Buffers,
+		const FTransform& LocalToRoot,
+		double StartTime);
+
+	static FVoxelAsyncPhysicsCookerSettings GetComponentSettings(const UVoxelProceduralMeshComponent& Component);
+	static TArray<TVoxelSharedPtr<const FVoxelProcMeshBuffers>> GetComponentBuffers(const UVoxelProceduralMeshComponent& Component);
+
 	void CreateTriMesh();
+	// Split the triangles in cells of voxel.renderer.CollisionCellSize voxels, and only cook the ones not in the cache
+	void CreateTriMeshCells(
+		const TArray<FVector>& Vertices,
+		const TArray<FTriIndices>& Indices,
+		const TArray<uint16>& MaterialIndices,
+		int32 CellSize,
+		FVoxelCollisionCellCache& Cache);
+	bool CookTriMesh(
+		const TArray<FVector>& Vertices,
+		const TArray<FTriIndices>& Indices,
+		const TArray<uint16>& MaterialIndices,
+		physx::PxTriangleMesh*& OutTriangleMesh) const;
 	void CreateConvexMesh();
+	// Greedily merge the solid voxels in boxes, and then merge the boxes into hulls. Returns false if Data isn't available
+	bool DecomposeDataToHulls();
 	void DecomposeMeshToHulls();
+	FBox GetBuffersBounds() const;
+	FIntVector GetNumConvexHulls(const FBox& Bounds) const;
 	EPhysXMeshCookFlags GetCookFlags() const;
 
 	IPhysXCooking* const PhysXCooking;
 	FThreadSafeCounter ErrorCounter;
 
+	// Can be set after the cook started
+	FCriticalSection ComponentSection;
+	TWeakObjectPtr<UVoxelProceduralMeshComponent> Component;
+
 public:
 	struct FCookResult
 	{
 		FBox ConvexBounds;
 		TArray<FKConvexElem> ConvexElems;
 		TArray<physx::PxConvexMesh*> ConvexMeshes;
+		// One per collision cell. Each holds a reference that is given to the body setup
 		TArray<physx::PxTriangleMesh*> TriangleMeshes;
 	};
 	FCookResult CookResult;
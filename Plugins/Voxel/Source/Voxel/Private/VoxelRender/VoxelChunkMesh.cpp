@@ -1,7 +1,10 @@
 // Copyright 2020 Phyronnaz
 
 #include "VoxelRender/VoxelChunkMesh.h"
+#include "VoxelRender/VoxelIndicesOptimizer.h"
 #include "VoxelData/VoxelDataUtilities.h"
+#include "VoxelData/VoxelDataAccelerator.h"
+#include "VoxelIntVectorUtilities.h"
 #include "StackArray.h"
 
 #include "Materials/MaterialInstanceDynamic.h"
@@ -11,12 +14,64 @@
 #include "ThirdParty/nvtesslib/inc/nvtess.h"
 #endif
 
-#if ENABLE_OPTIMIZE_INDICES
-#include "ThirdParty/ForsythTriOO/Src/forsythtriangleorderoptimizer.h"
-#endif
-
 DEFINE_STAT(STAT_VoxelChunkMeshMemory);
 
+static TAutoConsoleVariable<int32> CVarMeasureACMR(
+	TEXT("voxel.mesher.MeasureACMR"),
+	0,
+	TEXT("If true, the average cache miss ratio of the chunks will be measured before and after optimizing their indices. Use voxel.mesher.PrintACMR to print the results"),
+	ECVF_Default);
+
+struct FVoxelACMRStats
+{
+	static FVoxelACMRStats Singleton;
+
+	FCriticalSection Section;
+	int64 NumTriangles = 0;
+	int64 MissesBefore = 0;
+	int64 MissesAfter = 0;
+
+	static void Report(int32 NumTriangles, int32 MissesBefore, int32 MissesAfter)
+	{
+		FScopeLock Lock(&Singleton.Section);
+		Singleton.NumTriangles += NumTriangles;
+		Singleton.MissesBefore += MissesBefore;
+		Singleton.MissesAfter += MissesAfter;
+	}
+	static void Print()
+	{
+		FScopeLock Lock(&Singleton.Section);
+		if (Singleton.NumTriangles == 0)
+		{
+			UE_LOG(LogVoxel, Log, TEXT("No ACMR recorded. Set voxel.mesher.MeasureACMR to 1 and enable Optimize Indices on the voxel world"));
+			return;
+		}
+		UE_LOG(LogVoxel, Log, TEXT("ACMR over %lld triangles: before: %.3f; after: %.3f"),
+			Singleton.NumTriangles,
+			double(Singleton.MissesBefore) / Singleton.NumTriangles,
+			double(Singleton.MissesAfter) / Singleton.NumTriangles);
+	}
+	static void Clear()
+	{
+		FScopeLock Lock(&Singleton.Section);
+		Singleton.NumTriangles = 0;
+		Singleton.MissesBefore = 0;
+		Singleton.MissesAfter = 0;
+	}
+};
+
+FVoxelACMRStats FVoxelACMRStats::Singleton;
+
+static FAutoConsoleCommand PrintACMRCmd(
+	TEXT("voxel.mesher.PrintACMR"),
+	TEXT("Print the average cache miss ratio measured with voxel.mesher.MeasureACMR"),
+	FConsoleCommandDelegate::CreateStatic(&FVoxelACMRStats::Print));
+
+static FAutoConsoleCommand ClearACMRCmd(
+	TEXT("voxel.mesher.ClearACMR"),
+	TEXT("Clear the average cache miss ratio stats"),
+	FConsoleCommandDelegate::CreateStatic(&FVoxelACMRStats::Clear));
+
 #if ENABLE_TESSELLATION
 /**
 * Provides static mesh render data to the NVIDIA tessellation library.
@@ -60,6 +115,71 @@ private:
 };
 #endif
 
+FVoxelPackedNormal::FVoxelPackedNormal(const FVector& Normal)
+{
+	const float Norm = FMath::Abs(Normal.X) + FMath::Abs(Normal.Y) + FMath::Abs(Normal.Z);
+	if (Norm < SMALL_NUMBER)
+	{
+		X = Null;
+		Y = Null;
+		return;
+	}
+
+	float U = Normal.X / Norm;
+	float V = Normal.Y / Norm;
+	if (Normal.Z < 0)
+	{
+		const float OldU = U;
+		U = (1 - FMath::Abs(V)) * (OldU >= 0 ? 1 : -1);
+		V = (1 - FMath::Abs(OldU)) * (V >= 0 ? 1 : -1);
+	}
+
+	X = int16(FMath::Clamp<int32>(FMath::RoundToInt(U * MAX_int16), -MAX_int16, MAX_int16));
+	Y = int16(FMath::Clamp<int32>(FMath::RoundToInt(V * MAX_int16), -MAX_int16, MAX_int16));
+}
+
+FVector FVoxelPackedNormal::Unpack() const
+{
+	if (X == Null)
+	{
+		return FVector::ZeroVector;
+	}
+
+	const float U = float(X) / MAX_int16;
+	const float V = float(Y) / MAX_int16;
+	FVector Normal(U, V, 1 - FMath::Abs(U) - FMath::Abs(V));
+	if (Normal.Z < 0)
+	{
+		Normal.X = (1 - FMath::Abs(V)) * (U >= 0 ? 1 : -1);
+		Normal.Y = (1 - FMath::Abs(U)) * (V >= 0 ? 1 : -1);
+	}
+	return Normal.GetUnsafeNormal();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelChunkMeshBuffers::FVoxelChunkMeshBuffers(const FBox& PositionsBounds)
+{
+	const float MaxSize = PositionsBounds.GetSize().GetMax();
+	if (MaxSize <= 0)
+	{
+		// All the vertices are at the same point, or there are none: they are all encoded as 0
+		PositionsScale = 1;
+		PositionsInvScale = 1;
+		PositionsOffset = PositionsBounds.Min;
+		return;
+	}
+
+	// Use a power of 2 step aligned on the same lattice for all the chunks,
+	// so that the vertices shared by neighbors of similar sizes are quantized the same way
+	// -1 to leave room for the offset alignment
+	PositionsScale = FMath::Pow(2.f, FMath::CeilToFloat(FMath::Log2(MaxSize / (MAX_uint16 - 1))));
+	PositionsInvScale = 1.f / PositionsScale;
+	PositionsOffset = FVector(FVoxelUtilities::FloorToInt(PositionsBounds.Min * PositionsInvScale)) * PositionsScale;
+}
+
 void FVoxelChunkMeshBuffers::BuildAdjacency(TArray<uint32>& OutAdjacencyIndices) const
 {
 	VOXEL_FUNCTION_COUNTER();
@@ -67,7 +187,14 @@ void FVoxelChunkMeshBuffers::BuildAdjacency(TArray<uint32>& OutAdjacencyIndices)
 #if ENABLE_TESSELLATION
 	if (Indices.Num())
 	{
-		FVoxelStaticMeshNvRenderBuffer StaticMeshRenderBuffer(Positions, Indices);
+		TArray<FVector> UnpackedPositions;
+		UnpackedPositions.Reserve(GetNumVertices());
+		for (int32 Index = 0; Index < GetNumVertices(); Index++)
+		{
+			UnpackedPositions.Add(GetPosition(Index));
+		}
+
+		FVoxelStaticMeshNvRenderBuffer StaticMeshRenderBuffer(UnpackedPositions, Indices);
 		nv::IndexBuffer* PnAENIndexBuffer = nv::tess::buildTessellationBuffer(&StaticMeshRenderBuffer, nv::DBM_PnAenDominantCorner, true);
 		check(PnAENIndexBuffer);
 		const int32 IndexCount = int32(PnAENIndexBuffer->getLength());
@@ -88,15 +215,24 @@ void FVoxelChunkMeshBuffers::BuildAdjacency(TArray<uint32>& OutAdjacencyIndices)
 
 void FVoxelChunkMeshBuffers::OptimizeIndices()
 {
-#if ENABLE_OPTIMIZE_INDICES
 	VOXEL_FUNCTION_COUNTER();
 
-	TArray<uint32> OptimizedIndices;
-	OptimizedIndices.AddUninitialized(Indices.Num());
-	const uint16 CacheSize = 32;
-	Forsyth::OptimizeFaces(Indices.GetData(), Indices.Num(), GetNumVertices(), OptimizedIndices.GetData(), CacheSize);
-	Indices = MoveTemp(OptimizedIndices);
-#endif
+	// Tipsify is robust to the actual cache size, 16 is a safe lower bound
+	constexpr int32 CacheSize = 16;
+
+	const bool bMeasureACMR = CVarMeasureACMR.GetValueOnAnyThread() != 0;
+	const int32 MissesBefore = bMeasureACMR ? FVoxelIndicesOptimizer::ComputeCacheMisses(Indices, GetNumVertices(), CacheSize) : 0;
+
+	FVoxelIndicesOptimizer::OptimizeVertexCache(Indices, GetNumVertices(), CacheSize);
+
+	TArray<int32> NewToOld;
+	FVoxelIndicesOptimizer::OptimizeVertexFetch(Indices, GetNumVertices(), NewToOld);
+	RemapVertices(NewToOld);
+
+	if (bMeasureACMR)
+	{
+		FVoxelACMRStats::Report(Indices.Num() / 3, MissesBefore, FVoxelIndicesOptimizer::ComputeCacheMisses(Indices, GetNumVertices(), CacheSize));
+	}
 }
 
 void FVoxelChunkMeshBuffers::Shrink()
@@ -105,10 +241,8 @@ void FVoxelChunkMeshBuffers::Shrink()
 	Normals.Shrink();
 	Tangents.Shrink();
 	Colors.Shrink();
-	for (uint32 Tex = 0; Tex < NUM_VOXEL_TEXTURE_COORDINATES; Tex++)
-	{
-		TextureCoordinates[Tex].Shrink();
-	}
+	TextureCoordinates.Shrink();
+	MaterialTextureCoordinates.Shrink();
 
 	UpdateStat();
 }
@@ -116,13 +250,44 @@ void FVoxelChunkMeshBuffers::Shrink()
 void FVoxelChunkMeshBuffers::ComputeBounds()
 {
 	Bounds = FBox(ForceInit);
-	for (auto& Vertex : Positions)
+	for (int32 Index = 0; Index < GetNumVertices(); Index++)
 	{
-		Bounds += Vertex;
+		Bounds += GetPosition(Index);
 	}
 }
 
-void FVoxelChunkMesh::BuildDistanceField(int32 LOD, const FIntVector& Position, const FVoxelData& Data)
+void FVoxelChunkMeshBuffers::RemapVertices(const TArray<int32>& NewToOld)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const int32 NumVertices = GetNumVertices();
+	const auto Remap = [&](auto& Array, int32 Stride)
+	{
+		if (Array.Num() == 0)
+		{
+			// Not rendered
+			return;
+		}
+		check(Array.Num() == NumVertices * Stride);
+
+		typename TDecay<decltype(Array)>::Type NewArray;
+		NewArray.Reserve(NewToOld.Num() * Stride);
+		for (int32 OldIndex : NewToOld)
+		{
+			NewArray.Append(&Array[OldIndex * Stride], Stride);
+		}
+		Array = MoveTemp(NewArray);
+	};
+
+	Remap(Positions, 1);
+	Remap(Normals, 1);
+	Remap(Tangents, 1);
+	Remap(Colors, 1);
+	Remap(TextureCoordinates, 1);
+	Remap(MaterialTextureCoordinates, NUM_VOXEL_MATERIAL_TEXTURE_COORDINATES);
+}
+
+void FVoxelChunkMesh::BuildDistanceField(int32 LOD, const FIntVector& Position, const FVoxelData& Data, const FVoxelChunkMeshCachedValues& CachedValues)
 {
 #if ENABLE_VOXEL_DISTANCE_FIELDS
 	VOXEL_FUNCTION_COUNTER();
@@ -140,31 +305,79 @@ void FVoxelChunkMesh::BuildDistanceField(int32 LOD, const FIntVector& Position,
 	constexpr int32 NumVoxels = Size * Size * Size;
 
 	const int32 Step = 1 << LOD;
+	const FIntBox Bounds(Position - BorderSize * Step, Position + (Size - BorderSize) * Step);
 
 	TStackArray<FVoxelValue, NumVoxels> Values;
+	if (!CachedValues.IsValid())
 	{
-		const FIntBox LockedBounds(Position - BorderSize * Step, Position + (Size - BorderSize) * Step);
-		FVoxelReadScopeLock Lock(Data, LockedBounds, "Distance Field Build");
-		TVoxelQueryZone<FVoxelValue> QueryZone(LockedBounds, FIntVector(Size), LOD, Values);
+		FVoxelReadScopeLock Lock(Data, Bounds, "Distance Field Build");
+		TVoxelQueryZone<FVoxelValue> QueryZone(Bounds, FIntVector(Size), LOD, Values);
 		Data.Get<FVoxelValue>(QueryZone, LOD);
 	}
-
-	TStackArray<float, NumVoxels> DistanceFieldVolume;
-	for (int32 Z = 0; Z < Size; Z++)
+	else
 	{
-		for (int32 Y = 0; Y < Size; Y++)
+		// Reuse the values queried by the mesher, and only query the ones it didn't need (usually a part of the border)
+		TArray<int32> MissingIndices;
 		{
-			for (int32 X = 0; X < Size; X++)
+			VOXEL_SCOPE_COUNTER("Copy Cached Values");
+			for (int32 Z = 0; Z < Size; Z++)
 			{
-				const uint32 Index = X + Size * Y + Size * Size * Z;
-				float Value = Values[Index].ToFloat();
-				if (X == 0 || X == Size - 1 ||
-					Y == 0 || Y == Size - 1 ||
-					Z == 0 || Z == Size - 1)
+				for (int32 Y = 0; Y < Size; Y++)
 				{
-					Value = FMath::Max(1.f, Value);
+					for (int32 X = 0; X < Size; X++)
+					{
+						const int32 Index = X + Size * Y + Size * Size * Z;
+						if (CachedValues.Contains(X - BorderSize, Y - BorderSize, Z - BorderSize))
+						{
+							Values[Index] = CachedValues.Get(X - BorderSize, Y - BorderSize, Z - BorderSize);
+						}
+						else
+						{
+							MissingIndices.Add(Index);
+						}
+					}
 				}
-				DistanceFieldVolume[Index] = Value * Step;
+			}
+		}
+		if (MissingIndices.Num() > 0)
+		{
+			VOXEL_SCOPE_COUNTER("Query Missing Values");
+			FVoxelReadScopeLock Lock(Data, Bounds, "Distance Field Build");
+			const FVoxelConstDataAccelerator Accelerator(Data, Bounds);
+			for (int32 Index : MissingIndices)
+			{
+				const FIntVector LocalPosition(Index % Size, Index / Size % Size, Index / (Size * Size));
+				Values[Index] = Accelerator.Get<FVoxelValue>(Bounds.Min + LocalPosition * Step, LOD);
+			}
+		}
+	}
+
+	// Flat branchless loops so that they can be vectorized
+	TStackArray<float, NumVoxels> DistanceFieldVolume;
+	{
+		VOXEL_SCOPE_COUNTER("Compute Distances");
+		for (int32 Index = 0; Index < NumVoxels; Index++)
+		{
+			DistanceFieldVolume[Index] = Values[Index].ToFloat() * Step;
+		}
+
+		// Force the border layer to be outside
+		const float MinBorderDistance = Step;
+		const auto ClampBorder = [&](int32 X, int32 Y, int32 Z)
+		{
+			float& Distance = DistanceFieldVolume[X + Size * Y + Size * Size * Z];
+			Distance = FMath::Max(MinBorderDistance, Distance);
+		};
+		for (int32 A = 0; A < Size; A++)
+		{
+			for (int32 B = 0; B < Size; B++)
+			{
+				ClampBorder(0, A, B);
+				ClampBorder(Size - 1, A, B);
+				ClampBorder(A, 0, B);
+				ClampBorder(A, Size - 1, B);
+				ClampBorder(A, B, 0);
+				ClampBorder(A, B, Size - 1);
 			}
 		}
 	}
@@ -180,28 +393,26 @@ void FVoxelChunkMesh::BuildDistanceField(int32 LOD, const FIntVector& Position,
 	constexpr int32 MaxFormatSize = FMath::Max(sizeof(uint8), sizeof(FFloat16));
 
 	TStackArray<uint8, MaxFormatSize * NumVoxels> QuantizedDistanceFieldVolume;
-	for (int32 Z = 0; Z < Size; Z++)
 	{
-		for (int32 Y = 0; Y < Size; Y++)
+		VOXEL_SCOPE_COUNTER("Quantize");
+		if (bEightBitFixedPoint)
 		{
-			for (int32 X = 0; X < Size; X++)
+			uint8* RESTRICT const QuantizedDistances = QuantizedDistanceFieldVolume.GetData();
+			for (int32 Index = 0; Index < NumVoxels; Index++)
 			{
-				const uint32 Index = X + Size * Y + Size * Size * Z;
-				const float Distance = DistanceFieldVolume[Index];
-				if (bEightBitFixedPoint)
-				{
-					check(FormatSize == sizeof(uint8));
-					// [MinVolumeDistance, MaxVolumeDistance] -> [0, 1]
-					const float RescaledDistance = (Distance - MinVolumeDistance) * InvDistanceRange;
-					// Encoding based on D3D format conversion rules for float -> UNORM
-					const int32 QuantizedDistance = FMath::FloorToInt(RescaledDistance * 255.0f + .5f);
-					QuantizedDistanceFieldVolume[Index * FormatSize] = FMath::Clamp<int32>(QuantizedDistance, 0, 255);
-				}
-				else
-				{
-					check(FormatSize == sizeof(FFloat16));
-					reinterpret_cast<FFloat16&>(QuantizedDistanceFieldVolume[Index * FormatSize]) = Distance;
-				}
+				// [MinVolumeDistance, MaxVolumeDistance] -> [0, 1]
+				const float RescaledDistance = (DistanceFieldVolume[Index] - MinVolumeDistance) * InvDistanceRange;
+				// Encoding based on D3D format conversion rules for float -> UNORM
+				const int32 QuantizedDistance = FMath::FloorToInt(RescaledDistance * 255.0f + .5f);
+				QuantizedDistances[Index] = FMath::Clamp<int32>(QuantizedDistance, 0, 255);
+			}
+		}
+		else
+		{
+			FFloat16* RESTRICT const QuantizedDistances = reinterpret_cast<FFloat16*>(QuantizedDistanceFieldVolume.GetData());
+			for (int32 Index = 0; Index < NumVoxels; Index++)
+			{
+				QuantizedDistances[Index] = DistanceFieldVolume[Index];
 			}
 		}
 	}
@@ -221,7 +432,7 @@ void FVoxelChunkMesh::BuildDistanceField(int32 LOD, const FIntVector& Position,
 
 	if (bCompress)
 	{
-		const int32 UncompressedSize = QuantizedDistanceFieldVolume.Num() * QuantizedDistanceFieldVolume.GetTypeSize();
+		const int32 UncompressedSize = NumVoxels * FormatSize;
 
 		// Compressed can be slightly larger than uncompressed
 		CompressedDistanceFieldVolume.Empty(UncompressedSize * 4 / 3);
@@ -240,7 +451,7 @@ void FVoxelChunkMesh::BuildDistanceField(int32 LOD, const FIntVector& Position,
 	}
 	else
 	{
-		CompressedDistanceFieldVolume = QuantizedDistanceFieldVolume;
+		CompressedDistanceFieldVolume = TArray<uint8>(QuantizedDistanceFieldVolume.GetData(), NumVoxels * FormatSize);
 	}
 #endif
 }
@@ -256,6 +467,20 @@ void FVoxelChunkMesh::ComputeBounds()
 	});
 }
 
+int64 FVoxelChunkMesh::GetAllocatedSize() const
+{
+	int64 AllocatedSize = sizeof(FVoxelChunkMesh) + Map.GetAllocatedSize();
+	IterateBuffers([&](const FVoxelChunkMeshBuffers& Buffer)
+	{
+		AllocatedSize += sizeof(FVoxelChunkMeshBuffers) + Buffer.GetAllocatedSize();
+	});
+	if (DistanceFieldVolumeData.IsValid())
+	{
+		AllocatedSize += sizeof(FDistanceFieldVolumeData) + DistanceFieldVolumeData->CompressedDistanceFieldVolume.GetAllocatedSize();
+	}
+	return AllocatedSize;
+}
+
 void FVoxelChunkMesh::ComputeGuid()
 {
 	VOXEL_FUNCTION_COUNTER();
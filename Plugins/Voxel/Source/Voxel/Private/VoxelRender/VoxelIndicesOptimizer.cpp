@@ -0,0 +1,175 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelRender/VoxelIndicesOptimizer.h"
+
+void FVoxelIndicesOptimizer::OptimizeVertexCache(TArray<uint32>& Indices, int32 NumVertices, int32 CacheSize)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	check(Indices.Num() % 3 == 0);
+	const int32 NumTriangles = Indices.Num() / 3;
+	if (NumTriangles == 0)
+	{
+		return;
+	}
+
+	// Vertex to triangles adjacency, stored contiguously
+	TArray<int32> AdjacencyOffsets;
+	TArray<int32> Adjacency;
+	// Number of non emitted triangles using each vertex
+	TArray<int32> LiveTriangles;
+	{
+		LiveTriangles.SetNumZeroed(NumVertices);
+		for (uint32 Index : Indices)
+		{
+			checkVoxelSlow(Index < uint32(NumVertices));
+			LiveTriangles[Index]++;
+		}
+
+		AdjacencyOffsets.SetNumUninitialized(NumVertices + 1);
+		AdjacencyOffsets[0] = 0;
+		for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+		{
+			AdjacencyOffsets[Vertex + 1] = AdjacencyOffsets[Vertex] + LiveTriangles[Vertex];
+		}
+
+		TArray<int32> Cursors(AdjacencyOffsets.GetData(), NumVertices);
+		Adjacency.SetNumUninitialized(Indices.Num());
+		for (int32 Index = 0; Index < Indices.Num(); Index++)
+		{
+			Adjacency[Cursors[Indices[Index]]++] = Index / 3;
+		}
+	}
+
+	// Time at which each vertex was last added to the cache
+	TArray<int32> CacheTimes;
+	CacheTimes.SetNumZeroed(NumVertices);
+	TBitArray<> EmittedTriangles(false, NumTriangles);
+	// Vertices of the recently emitted triangles, used to recover from dead ends
+	TArray<int32> DeadEndStack;
+
+	TArray<uint32> OutIndices;
+	OutIndices.Reserve(Indices.Num());
+
+	TArray<int32, TInlineAllocator<64>> Candidates;
+
+	int32 Time = CacheSize + 1;
+	int32 Cursor = 1;
+	int32 FanningVertex = 0;
+	while (FanningVertex >= 0)
+	{
+		Candidates.Reset();
+
+		// Emit all the triangles around the fanning vertex
+		for (int32 AdjacencyIndex = AdjacencyOffsets[FanningVertex]; AdjacencyIndex < AdjacencyOffsets[FanningVertex + 1]; AdjacencyIndex++)
+		{
+			const int32 Triangle = Adjacency[AdjacencyIndex];
+			if (EmittedTriangles[Triangle])
+			{
+				continue;
+			}
+			EmittedTriangles[Triangle] = true;
+
+			for (int32 Corner = 0; Corner < 3; Corner++)
+			{
+				const int32 Vertex = Indices[3 * Triangle + Corner];
+				OutIndices.Add(Vertex);
+				DeadEndStack.Add(Vertex);
+				Candidates.AddUnique(Vertex);
+				LiveTriangles[Vertex]--;
+
+				if (Time - CacheTimes[Vertex] > CacheSize)
+				{
+					CacheTimes[Vertex] = Time;
+					Time++;
+				}
+			}
+		}
+
+		// Pick the candidate that will still be in cache the longest, as long as all its triangles can be emitted before it gets evicted
+		FanningVertex = -1;
+		int32 BestPriority = -1;
+		for (int32 Vertex : Candidates)
+		{
+			if (LiveTriangles[Vertex] <= 0)
+			{
+				continue;
+			}
+
+			int32 Priority = 0;
+			if (Time - CacheTimes[Vertex] + 2 * LiveTriangles[Vertex] <= CacheSize)
+			{
+				Priority = Time - CacheTimes[Vertex];
+			}
+			if (Priority > BestPriority)
+			{
+				BestPriority = Priority;
+				FanningVertex = Vertex;
+			}
+		}
+
+		if (FanningVertex == -1)
+		{
+			// Dead end: try the recently used vertices first, then scan the input
+			while (DeadEndStack.Num() > 0)
+			{
+				const int32 Vertex = DeadEndStack.Pop(false);
+				if (LiveTriangles[Vertex] > 0)
+				{
+					FanningVertex = Vertex;
+					break;
+				}
+			}
+			while (FanningVertex == -1 && Cursor < NumVertices)
+			{
+				if (LiveTriangles[Cursor] > 0)
+				{
+					FanningVertex = Cursor;
+				}
+				Cursor++;
+			}
+		}
+	}
+
+	check(OutIndices.Num() == Indices.Num());
+	Indices = MoveTemp(OutIndices);
+}
+
+void FVoxelIndicesOptimizer::OptimizeVertexFetch(TArray<uint32>& Indices, int32 NumVertices, TArray<int32>& OutNewToOld)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	TArray<int32> OldToNew;
+	OldToNew.Init(-1, NumVertices);
+
+	OutNewToOld.Reset(NumVertices);
+	for (uint32& Index : Indices)
+	{
+		int32& NewIndex = OldToNew[Index];
+		if (NewIndex == -1)
+		{
+			NewIndex = OutNewToOld.Add(Index);
+		}
+		Index = NewIndex;
+	}
+}
+
+int32 FVoxelIndicesOptimizer::ComputeCacheMisses(const TArray<uint32>& Indices, int32 NumVertices, int32 CacheSize)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// Same timestamp trick as in Tipsify: a vertex is in the FIFO if it was added less than CacheSize misses ago
+	TArray<int32> CacheTimes;
+	CacheTimes.Init(MIN_int32 / 2, NumVertices);
+
+	int32 Misses = 0;
+	for (uint32 Index : Indices)
+	{
+		if (Misses - CacheTimes[Index] >= CacheSize)
+		{
+			CacheTimes[Index] = Misses;
+			Misses++;
+		}
+	}
+	return Misses;
+}
\ No newline at end of file
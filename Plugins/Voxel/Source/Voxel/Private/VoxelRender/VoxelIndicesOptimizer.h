@@ -0,0 +1,22 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGlobals.h"
+
+// Platform independent replacement of the Forsyth optimizer
+namespace FVoxelIndicesOptimizer
+{
+	// Reorders the triangles to improve the post transform vertex cache hit rate
+	// Tipsify: Sander, Nehab & Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007
+	void OptimizeVertexCache(TArray<uint32>& Indices, int32 NumVertices, int32 CacheSize);
+
+	// Renumbers the vertices in the order they are first used by Indices, to improve the vertex fetch locality
+	// Indices are remapped in place. OutNewToOld[NewIndex] = OldIndex. Unused vertices are removed
+	void OptimizeVertexFetch(TArray<uint32>& Indices, int32 NumVertices, TArray<int32>& OutNewToOld);
+
+	// Number of vertices transformed by a FIFO cache of size CacheSize
+	// ACMR (average cache miss ratio) = this / num triangles
+	int32 ComputeCacheMisses(const TArray<uint32>& Indices, int32 NumVertices, int32 CacheSize);
+}
\ No newline at end of file
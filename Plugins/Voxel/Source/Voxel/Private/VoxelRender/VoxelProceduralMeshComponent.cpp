@@ -28,23 +28,34 @@ static TAutoConsoleVariable<int32> CVarShowCollisionsUpdates(
 	TEXT("If true, will show the chunks that finished updating collisions"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<int32> CVarLogCollisionsUpdatesLatency(
+	TEXT("voxel.renderer.LogCollisionsUpdatesLatency"),
+	0,
+	TEXT("If true, will log the time between a chunk update and its new collisions being used"),
+	ECVF_Default);
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Voxel Collisions Update Latency (ms)"), STAT_VoxelCollisionsUpdateLatency, STATGROUP_Voxel);
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-void IVoxelProceduralMeshComponent_PhysicsCallbackHandler::TickHandler()
+int32 IVoxelProceduralMeshComponent_PhysicsCallbackHandler::TickHandler(double MaxTime)
 {
 	VOXEL_FUNCTION_COUNTER();
 	check(IsInGameThread());
 
 	FCallback Callback;
-	while (Queue.Dequeue(Callback))
+	// First check the time, else dequeued elements aren't processed
+	while (FPlatformTime::Seconds() < MaxTime && Queue.Dequeue(Callback))
 	{
 		if (Callback.Component.IsValid())
 		{
 			Callback.Component->PhysicsCookerCallback(Callback.CookerId);
 		}
 	}
+
+	return Queue.Num();
 }
 
 void IVoxelProceduralMeshComponent_PhysicsCallbackHandler::CookerCallback(uint64 CookerId, TWeakObjectPtr<UVoxelProceduralMeshComponent> Component)
@@ -59,6 +70,7 @@ void IVoxelProceduralMeshComponent_PhysicsCallbackHandler::CookerCallback(uint64
 void UVoxelProceduralMeshComponent::Init(
 	int32 InDebugLOD,
 	uint32 InDebugChunkId,
+	const FIntVector& InVoxelPosition,
 	const FVoxelPriorityHandler& InPriorityHandler,
 	const TVoxelWeakPtr<IVoxelProceduralMeshComponent_PhysicsCallbackHandler>& InPhysicsCallbackHandler,
 	const FVoxelRendererSettings& RendererSettings)
@@ -82,6 +94,8 @@ void UVoxelProceduralMeshComponent::Init(
 	PriorityDuration = RendererSettings.PriorityDuration;
 	CollisionTraceFlag = RendererSettings.CollisionTraceFlag;
 	NumConvexHullsPerAxis = RendererSettings.NumConvexHullsPerAxis;
+	Data = RendererSettings.Data;
+	VoxelPosition = InVoxelPosition;
 	bCleanCollisionMesh = RendererSettings.bCleanCollisionMeshes;
 	bClearProcMeshBuffersOnFinishUpdate = RendererSettings.bStaticWorld && !RendererSettings.bRenderWorld; // We still need the buffers if we are rendering!
 	bNewInit = true;
@@ -110,6 +124,11 @@ UVoxelProceduralMeshComponent::~UVoxelProceduralMeshComponent()
 		AsyncCooker->CancelAndAutodelete();
 		AsyncCooker = nullptr;
 	}
+	if (PendingCooker)
+	{
+		PendingCooker->CancelAndAutodelete();
+		PendingCooker = nullptr;
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -167,6 +186,17 @@ void UVoxelProceduralMeshComponent::SetDistanceFieldData(const TVoxelSharedPtr<c
 }
 
 void UVoxelProceduralMeshComponent::SetProcMeshSection(int32 Index, FVoxelProcMeshSectionSettings Settings, TUniquePtr<FVoxelProcMeshBuffers> Buffers, EVoxelProcMeshSectionUpdate Update)
+{
+	check(Buffers.IsValid());
+
+	Buffers->UpdateStats();
+
+	// Due to InitResources etc, we must make sure we are the only component using this buffers, hence the TUniquePtr
+	// However the buffer is shared between the component and the proxy
+	SetProcMeshSection(Index, Settings, TVoxelSharedRef<const FVoxelProcMeshBuffers>(MakeShareable(Buffers.Release())), Update);
+}
+
+void UVoxelProceduralMeshComponent::SetProcMeshSection(int32 Index, FVoxelProcMeshSectionSettings Settings, const TVoxelSharedRef<const FVoxelProcMeshBuffers>& Buffers, EVoxelProcMeshSectionUpdate Update)
 {
 	VOXEL_FUNCTION_COUNTER();
 	if (!ensure(ProcMeshSections.IsValidIndex(Index)))
@@ -174,13 +204,8 @@ void UVoxelProceduralMeshComponent::SetProcMeshSection(int32 Index, FVoxelProcMe
 		return;
 	}
 
-	Buffers->UpdateStats();
-
 	ProcMeshSections[Index].Settings = Settings;
-
-	// Due to InitResources etc, we must make sure we are the only component using this buffers, hence the TUniquePtr
-	// However the buffer is shared between the component and the proxy
-	ProcMeshSections[Index].Buffers = MakeShareable(Buffers.Release());
+	ProcMeshSections[Index].Buffers = Buffers;
 
 	if (Update == EVoxelProcMeshSectionUpdate::UpdateNow)
 	{
@@ -204,6 +229,21 @@ int32 UVoxelProceduralMeshComponent::AddProcMeshSection(FVoxelProcMeshSectionSet
 	return Index;
 }
 
+int32 UVoxelProceduralMeshComponent::AddProcMeshSection(FVoxelProcMeshSectionSettings Settings, const TVoxelSharedRef<const FVoxelProcMeshBuffers>& Buffers, EVoxelProcMeshSectionUpdate Update)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (Buffers->GetNumIndices() == 0)
+	{
+		return -1;
+	}
+
+	const int32 Index = ProcMeshSections.Emplace();
+	SetProcMeshSection(Index, Settings, Buffers, Update);
+
+	return Index;
+}
+
 void UVoxelProceduralMeshComponent::ReplaceProcMeshSection(FVoxelProcMeshSectionSettings Settings, TUniquePtr<FVoxelProcMeshBuffers> Buffers, EVoxelProcMeshSectionUpdate Update)
 {
 	VOXEL_FUNCTION_COUNTER();
@@ -306,9 +346,29 @@ void UVoxelProceduralMeshComponent::FinishSectionsUpdates()
 		ProcMeshSections.Reset();
 	}
 
+	if (PendingCooker)
+	{
+		// Not used, eg if the collisions didn't change
+		PendingCooker->CancelAndAutodelete();
+		PendingCooker = nullptr;
+	}
+	PendingCollisionUpdateStartTime = 0;
+
 	LastFinishSectionsUpdatesTime = FPlatformTime::Seconds();
 }
 
+void UVoxelProceduralMeshComponent::SetPendingCollisionUpdate(double StartTime, FVoxelAsyncPhysicsCooker* Cooker)
+{
+	check(IsInGameThread());
+
+	if (PendingCooker)
+	{
+		PendingCooker->CancelAndAutodelete();
+	}
+	PendingCooker = Cooker;
+	PendingCollisionUpdateStartTime = StartTime;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -594,13 +654,33 @@ void UVoxelProceduralMeshComponent::UpdateCollision()
 	}
 	BodySetupBeingCooked->ClearPhysicsMeshes();
 
+	if (PendingCooker && !PendingCooker->IsCookingComponent(*this))
+	{
+		ensureMsgf(false, TEXT("Pending cooker wasn't started on the component buffers"));
+		PendingCooker->CancelAndAutodelete();
+		PendingCooker = nullptr;
+	}
+
 	if (ProcMeshSections.FindByPredicate([](auto& Section) { return Section.Settings.bEnableCollisions; }))
 	{
-		auto PoolPtr = Pool.Pin();
-		if (ensure(PoolPtr.IsValid()))
+		if (PendingCooker)
+		{
+			AsyncCooker = PendingCooker;
+			PendingCooker = nullptr;
+			if (AsyncCooker->SetComponent(this))
+			{
+				// Already cooked
+				PhysicsCookerCallback(AsyncCooker->UniqueId);
+			}
+		}
+		else
 		{
-			AsyncCooker = new FVoxelAsyncPhysicsCooker(this);
-			PoolPtr->QueueTask(EVoxelTaskType::CollisionCooking, AsyncCooker);
+			auto PoolPtr = Pool.Pin();
+			if (ensure(PoolPtr.IsValid()))
+			{
+				AsyncCooker = new FVoxelAsyncPhysicsCooker(this);
+				PoolPtr->QueueTask(EVoxelTaskType::CollisionCooking, AsyncCooker);
+			}
 		}
 	}
 	else
@@ -712,9 +792,18 @@ void UVoxelProceduralMeshComponent::PhysicsCookerCallback(uint64 CookerId)
 #else
 		UMRMeshComponent::FinishCreatingPhysicsMeshes(BodySetupBeingCooked, {}, {}, CookResult.TriangleMeshes);
 #endif
+		// The body setup now owns their references
+		CookResult.TriangleMeshes.Reset();
 	}
 	UpdateConvexMeshes(CookResult.ConvexBounds, MoveTemp(CookResult.ConvexElems), MoveTemp(CookResult.ConvexMeshes));
 
+	const double Latency = FPlatformTime::Seconds() - AsyncCooker->StartTime;
+	SET_FLOAT_STAT(STAT_VoxelCollisionsUpdateLatency, Latency * 1000);
+	if (CVarLogCollisionsUpdatesLatency.GetValueOnGameThread() != 0)
+	{
+		UE_LOG(LogVoxel, Log, TEXT("Collisions update latency: %fms"), Latency * 1000);
+	}
+
 	AsyncCooker->CancelAndAutodelete();
 	AsyncCooker = nullptr;
 
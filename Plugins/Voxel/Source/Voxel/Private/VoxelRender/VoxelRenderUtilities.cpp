@@ -72,7 +72,7 @@ inline void SetMaterialDithering(
 	const FVoxelRendererSettingsBase& Settings,
 	const FVoxelRenderUtilities::FDitheringInfo& DitheringInfo)
 {
-	if (Settings.RenderType == EVoxelRenderType::SurfaceNets)
+	if (FVoxelUtilities::UsesParentPositionTransitions(Settings.RenderType))
 	{
 		check(DitheringInfo.DitheringType == EDitheringType::SurfaceNets_LowResToHighRes || DitheringInfo.DitheringType == EDitheringType::SurfaceNets_HighResToLowRes);
 		Material.SetScalarParameterValue(STATIC_FNAME("StartTime"), DitheringInfo.Time);
@@ -115,7 +115,7 @@ void FVoxelRenderUtilities::ResetDithering(UVoxelProceduralMeshComponent& Mesh,
 	VOXEL_FUNCTION_COUNTER();
 	IterateDynamicMaterials(Mesh, [&](UMaterialInstanceDynamic& Material)
 	{
-		if (Settings.RenderType == EVoxelRenderType::SurfaceNets)
+		if (FVoxelUtilities::UsesParentPositionTransitions(Settings.RenderType))
 		{
 			Material.SetScalarParameterValue(STATIC_FNAME("StartTime"), 0);
 			Material.SetScalarParameterValue(STATIC_FNAME("InversedFade"), 0);
@@ -170,36 +170,34 @@ void FVoxelRenderUtilities::ShowMesh(UVoxelProceduralMeshComponent& Mesh)
 
 #define CHECK_CANCEL() if (CancelCounter.GetValue() > CancelThreshold) return {};
 
-TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread(
-	const FVoxelRendererSettingsBase& RendererSettings,
-	const TArray<FVoxelChunkMeshSection>& Sections,
-	const FIntVector& CenterPosition,
-	const FThreadSafeCounter& CancelCounter,
-	int32 CancelThreshold)
+bool FVoxelRenderUtilities::ShowMainChunks()
 {
-	VOXEL_FUNCTION_COUNTER();
-
-	const bool bShowMainChunks = CVarShowTransitions.GetValueOnAnyThread() == 0;
+	return CVarShowTransitions.GetValueOnAnyThread() == 0;
+}
 
-	auto ProcMeshBuffersPtr = MakeUnique<FVoxelProcMeshBuffers>();
-	auto& ProcMeshBuffers = *ProcMeshBuffersPtr;
+void FVoxelRenderUtilities::GetSectionsSize(
+	const TArray<FVoxelChunkMeshSection>& Sections,
+	bool bShowMainChunks,
+	int32& OutNumVertices,
+	int32& OutNumIndices,
+	int32& OutNumAdjacencyIndices,
+	TArray<FGuid>& OutGuids)
+{
+	OutNumVertices = 0;
+	OutNumIndices = 0;
+	OutNumAdjacencyIndices = 0;
 
-	int32 NumVertices = 0;
-	int32 NumIndices = 0;
-	int32 NumAdjacencyIndices = 0;
 	for (auto& Section : Sections)
 	{
-		CHECK_CANCEL();
-
 		const auto BufferIterator = [&](const FVoxelChunkMeshBuffers& ChunkBuffers)
 		{
-			ProcMeshBuffers.Guids.Add(ChunkBuffers.Guid);
-			NumVertices += ChunkBuffers.GetNumVertices();
-			NumIndices += ChunkBuffers.Indices.Num();
+			OutGuids.Add(ChunkBuffers.Guid);
+			OutNumVertices += ChunkBuffers.GetNumVertices();
+			OutNumIndices += ChunkBuffers.Indices.Num();
 			if (Section.bEnableTessellation)
 			{
 				// 4x as much adjacency indices
-				NumAdjacencyIndices += 4 * ChunkBuffers.Indices.Num();
+				OutNumAdjacencyIndices += 4 * ChunkBuffers.Indices.Num();
 			}
 		};
 
@@ -212,33 +210,48 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 			BufferIterator(*Section.TransitionChunk);
 		}
 	}
-	ensure(NumAdjacencyIndices == 4 * NumIndices || NumAdjacencyIndices == 0); // If false, then some chunks have tessellation enabled and some others don't
+	ensure(OutNumAdjacencyIndices == 4 * OutNumIndices || OutNumAdjacencyIndices == 0); // If false, then some chunks have tessellation enabled and some others don't
+}
 
-	auto& PositionBuffer = ProcMeshBuffers.VertexBuffers.PositionVertexBuffer;
-	auto& StaticMeshBuffer = ProcMeshBuffers.VertexBuffers.StaticMeshVertexBuffer;
-	auto& ColorBuffer = ProcMeshBuffers.VertexBuffers.ColorVertexBuffer;
-	auto& IndexBuffer = ProcMeshBuffers.IndexBuffer;
-	auto& AdjacencyIndexBuffer = ProcMeshBuffers.AdjacencyIndexBuffer;
+void FVoxelRenderUtilities::InitBuffers(
+	FVoxelProcMeshBuffers& Buffers,
+	const FVoxelRendererSettingsBase& RendererSettings,
+	int32 NumVertices,
+	int32 NumIndices,
+	int32 NumAdjacencyIndices)
+{
+	VOXEL_FUNCTION_COUNTER();
 
-	CHECK_CANCEL();
-	PositionBuffer.Init(NumVertices, FVoxelProcMeshBuffers::bNeedsCPUAccess);
-	CHECK_CANCEL();
+	Buffers.VertexBuffers.PositionVertexBuffer.Init(NumVertices, FVoxelProcMeshBuffers::bNeedsCPUAccess);
 	if (RendererSettings.bRenderWorld)
 	{
-		StaticMeshBuffer.SetUseFullPrecisionUVs(!RendererSettings.bHalfPrecisionCoordinates);
-		StaticMeshBuffer.Init(NumVertices, NUM_VOXEL_TEXTURE_COORDINATES, FVoxelProcMeshBuffers::bNeedsCPUAccess);
-		CHECK_CANCEL();
-		ColorBuffer.Init(NumVertices, FVoxelProcMeshBuffers::bNeedsCPUAccess);
+		Buffers.VertexBuffers.StaticMeshVertexBuffer.SetUseFullPrecisionUVs(!RendererSettings.bHalfPrecisionCoordinates);
+		Buffers.VertexBuffers.StaticMeshVertexBuffer.Init(NumVertices, NUM_VOXEL_TEXTURE_COORDINATES, FVoxelProcMeshBuffers::bNeedsCPUAccess);
+		Buffers.VertexBuffers.ColorVertexBuffer.Init(NumVertices, FVoxelProcMeshBuffers::bNeedsCPUAccess);
 	}
-	CHECK_CANCEL();
-	IndexBuffer.AllocateData(NumIndices);
-	CHECK_CANCEL();
-	AdjacencyIndexBuffer.AllocateData(NumAdjacencyIndices);
-	CHECK_CANCEL();
+	Buffers.IndexBuffer.AllocateData(NumIndices);
+	Buffers.AdjacencyIndexBuffer.AllocateData(NumAdjacencyIndices);
+}
 
-	int32 VerticesOffset = 0;
-	int32 IndicesOffset = 0;
-	int32 AdjacencyIndicesOffset = 0;
+FBox FVoxelRenderUtilities::CopySections_AnyThread(
+	const FVoxelRendererSettingsBase& RendererSettings,
+	const TArray<FVoxelChunkMeshSection>& Sections,
+	bool bShowMainChunks,
+	const FIntVector& CenterPosition,
+	FVoxelProcMeshBuffers& ProcMeshBuffers,
+	int32 VerticesOffset,
+	int32 IndicesOffset,
+	int32 AdjacencyIndicesOffset)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	FBox LocalBounds(ForceInit);
+
+	auto& PositionBuffer = ProcMeshBuffers.VertexBuffers.PositionVertexBuffer;
+	auto& StaticMeshBuffer = ProcMeshBuffers.VertexBuffers.StaticMeshVertexBuffer;
+	auto& ColorBuffer = ProcMeshBuffers.VertexBuffers.ColorVertexBuffer;
+	auto& IndexBuffer = ProcMeshBuffers.IndexBuffer;
+	auto& AdjacencyIndexBuffer = ProcMeshBuffers.AdjacencyIndexBuffer;
 
 	const auto Get = [](auto& Array, int32 Index) -> const auto&
 	{
@@ -255,7 +268,7 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 		const int32 ChunkNumVertices = Chunk.GetNumVertices();
 		for (int32 Index = 0; Index < ChunkNumVertices; Index++)
 		{
-			PositionBuffer.VertexPosition(VerticesOffset + Index) = Get(Chunk.Positions, Index) + Offset;
+			PositionBuffer.VertexPosition(VerticesOffset + Index) = Chunk.GetPosition(Index) + Offset;
 		}
 	};
 	const auto CopyColors = [&](auto& Chunk)
@@ -279,7 +292,8 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 		{
 			ensure(Chunk.Tangents.Num() == 0);
 			ensure(Chunk.Normals.Num() == 0);
-			for (uint32 Tex = 0; Tex < NUM_VOXEL_TEXTURE_COORDINATES; Tex++) ensure(Chunk.TextureCoordinates[Tex].Num() == 0);
+			ensure(Chunk.TextureCoordinates.Num() == 0);
+			ensure(Chunk.MaterialTextureCoordinates.Num() == 0);
 			return;
 		}
 
@@ -288,14 +302,13 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 		for (int32 Index = 0; Index < ChunkNumVertices; Index++)
 		{
 			{
-				auto& Tangent = Get(Chunk.Tangents, Index);
-				auto& Normal = Get(Chunk.Normals, Index);
+				const FVoxelProcMeshTangent Tangent = Chunk.GetTangent(Index);
+				const FVector Normal = Chunk.GetNormal(Index);
 				StaticMeshBuffer.SetVertexTangents(VerticesOffset + Index, Tangent.TangentX, Tangent.GetY(Normal), Normal);
 			}
 			for (uint32 Tex = 0; Tex < NUM_VOXEL_TEXTURE_COORDINATES; Tex++)
 			{
-				auto& TextureCoordinate = Get(Chunk.TextureCoordinates[Tex], Index);
-				StaticMeshBuffer.SetVertexUV(VerticesOffset + Index, Tex, TextureCoordinate);
+				StaticMeshBuffer.SetVertexUV(VerticesOffset + Index, Tex, Chunk.GetTextureCoordinate(Index, Tex));
 			}
 		}
 	};
@@ -323,8 +336,6 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 
 	for (auto& Chunk : Sections)
 	{
-		CHECK_CANCEL();
-
 		const FVector PositionOffset(Chunk.ChunkPosition - CenterPosition);
 
 		// Copy main chunk
@@ -333,7 +344,7 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 			auto& MainChunk = *Chunk.MainChunk;
 
 			// Copy bounds
-			ProcMeshBuffers.LocalBounds += MainChunk.Bounds.ShiftBy(PositionOffset);
+			LocalBounds += MainChunk.Bounds.ShiftBy(PositionOffset);
 
 			if (Chunk.bTranslateVertices && Chunk.TransitionsMask)
 			{
@@ -341,8 +352,8 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 				for (int32 Index = 0; Index < MainChunk.GetNumVertices(); Index++)
 				{
 					PositionBuffer.VertexPosition(VerticesOffset + Index) = FVoxelMesherUtilities::GetTranslatedTransvoxel(
-						Get(MainChunk.Positions, Index),
-						Get(MainChunk.Normals, Index),
+						MainChunk.GetPosition(Index),
+						MainChunk.GetNormal(Index),
 						Chunk.TransitionsMask,
 						Chunk.LOD) + PositionOffset;
 				}
@@ -351,18 +362,13 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 			{
 				CopyPositions(MainChunk, PositionOffset);
 			}
-			CHECK_CANCEL();
 			CopyColors(MainChunk);
-			CHECK_CANCEL();
 			CopyStaticMesh(MainChunk);
-			CHECK_CANCEL();
 			CopyIndices(MainChunk);
-			CHECK_CANCEL();
 			if (Chunk.bEnableTessellation)
 			{
 				AdjacencyIndicesOffset += CopyAdjacencyIndices(MainChunk);
 			}
-			CHECK_CANCEL();
 
 			VerticesOffset += MainChunk.GetNumVertices();
 			IndicesOffset += MainChunk.Indices.Num();
@@ -374,53 +380,84 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 			auto& TransitionChunk = *Chunk.TransitionChunk;
 
 			// Copy bounds
-			ProcMeshBuffers.LocalBounds += TransitionChunk.Bounds.ShiftBy(PositionOffset);
+			LocalBounds += TransitionChunk.Bounds.ShiftBy(PositionOffset);
 
-			CHECK_CANCEL();
 			CopyPositions(TransitionChunk, PositionOffset);
-			CHECK_CANCEL();
 			CopyColors(TransitionChunk);
-			CHECK_CANCEL();
 			CopyStaticMesh(TransitionChunk);
-			CHECK_CANCEL();
 			CopyIndices(TransitionChunk);
-			CHECK_CANCEL();
 
 			if (Chunk.bEnableTessellation)
 			{
 				AdjacencyIndicesOffset += CopyAdjacencyIndices(TransitionChunk);
 			}
-			CHECK_CANCEL();
 
 			VerticesOffset += TransitionChunk.GetNumVertices();
 			IndicesOffset += TransitionChunk.Indices.Num();
 		}
 	}
 
-	check(VerticesOffset == NumVertices);
-	check(IndicesOffset == NumIndices);
-	check(AdjacencyIndicesOffset == NumAdjacencyIndices);
-
-	CHECK_CANCEL();
+	return LocalBounds;
+}
 
-	if (NumAdjacencyIndices > 0) // Tessellation enabled
+FBox FVoxelRenderUtilities::GetFinalLocalBounds(const FVoxelRendererSettingsBase& RendererSettings, const FBox& LocalBounds, bool bEnableTessellation)
+{
+	if (bEnableTessellation)
 	{
 		// Bounds extension is in world space, and we're in local (voxel) space
-		ProcMeshBuffers.LocalBounds = ProcMeshBuffers.LocalBounds.ExpandBy(RendererSettings.TessellationBoundsExtension / RendererSettings.VoxelSize);
+		return LocalBounds.ExpandBy(RendererSettings.TessellationBoundsExtension / RendererSettings.VoxelSize);
 	}
+	else
+	{
+		return LocalBounds;
+	}
+}
 
 #if VOXEL_DEBUG
+void FVoxelRenderUtilities::CheckBuffers(const FVoxelProcMeshBuffers& Buffers)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const int32 NumVertices = Buffers.GetNumVertices();
+	for (int32 Index = 0; Index < Buffers.IndexBuffer.GetNumIndices(); Index++)
 	{
-		VOXEL_SCOPE_COUNTER("Check");
-		for (int32 Index = 0; Index < IndexBuffer.GetNumIndices(); Index++)
-		{
-			checkf(IndexBuffer.GetIndex(Index) < uint32(NumVertices), TEXT("Invalid index: %u < %u"), IndexBuffer.GetIndex(Index), uint32(NumVertices));
-		}
-		for (int32 Index = 0; Index < AdjacencyIndexBuffer.GetNumIndices(); Index++)
-		{
-			checkf(AdjacencyIndexBuffer.GetIndex(Index) < uint32(NumVertices), TEXT("Invalid index: %u < %u"), AdjacencyIndexBuffer.GetIndex(Index), uint32(NumVertices));
-		}
+		checkf(Buffers.IndexBuffer.GetIndex(Index) < uint32(NumVertices), TEXT("Invalid index: %u < %u"), Buffers.IndexBuffer.GetIndex(Index), uint32(NumVertices));
+	}
+	for (int32 Index = 0; Index < Buffers.AdjacencyIndexBuffer.GetNumIndices(); Index++)
+	{
+		checkf(Buffers.AdjacencyIndexBuffer.GetIndex(Index) < uint32(NumVertices), TEXT("Invalid index: %u < %u"), Buffers.AdjacencyIndexBuffer.GetIndex(Index), uint32(NumVertices));
 	}
+}
+#endif
+
+TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread(
+	const FVoxelRendererSettingsBase& RendererSettings,
+	const TArray<FVoxelChunkMeshSection>& Sections,
+	const FIntVector& CenterPosition,
+	const FThreadSafeCounter& CancelCounter,
+	int32 CancelThreshold)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const bool bShowMainChunks = ShowMainChunks();
+
+	auto ProcMeshBuffersPtr = MakeUnique<FVoxelProcMeshBuffers>();
+	auto& ProcMeshBuffers = *ProcMeshBuffersPtr;
+
+	int32 NumVertices = 0;
+	int32 NumIndices = 0;
+	int32 NumAdjacencyIndices = 0;
+	GetSectionsSize(Sections, bShowMainChunks, NumVertices, NumIndices, NumAdjacencyIndices, ProcMeshBuffers.Guids);
+
+	CHECK_CANCEL();
+	InitBuffers(ProcMeshBuffers, RendererSettings, NumVertices, NumIndices, NumAdjacencyIndices);
+	CHECK_CANCEL();
+
+	const FBox LocalBounds = CopySections_AnyThread(RendererSettings, Sections, bShowMainChunks, CenterPosition, ProcMeshBuffers, 0, 0, 0);
+	ProcMeshBuffers.LocalBounds = GetFinalLocalBounds(RendererSettings, LocalBounds, NumAdjacencyIndices > 0);
+
+#if VOXEL_DEBUG
+	CheckBuffers(ProcMeshBuffers);
 #endif
 
 	ProcMeshBuffers.UpdateStats();
@@ -442,14 +479,14 @@ TUniquePtr<FVoxelBuiltChunkMeshes> FVoxelRenderUtilities::BuildMeshes_AnyThread(
 	for (auto& MeshToBuild : ChunkMeshesToBuild)
 	{
 		const auto& MeshConfig = MeshToBuild.Key;
-		TArray<TPair<FVoxelProcMeshSectionSettings, TUniquePtr<FVoxelProcMeshBuffers>>> BuiltSections;
+		TArray<TPair<FVoxelProcMeshSectionSettings, TVoxelSharedPtr<FVoxelProcMeshBuffers>>> BuiltSections;
 		CHECK_CANCEL();
 		for (auto& Section : MeshToBuild.Value)
 		{
 			const auto& SectionSettings = Section.Key;
 			auto BuiltSection = MergeSections_AnyThread(RendererSettings, Section.Value, Position, CancelCounter, CancelThreshold);
 			CHECK_CANCEL();
-			BuiltSections.Emplace(SectionSettings, MoveTemp(BuiltSection));
+			BuiltSections.Emplace(SectionSettings, TVoxelSharedPtr<FVoxelProcMeshBuffers>(MakeShareable(BuiltSection.Release())));
 		}
 		BuiltMeshes.Emplace(MeshConfig, MoveTemp(BuiltSections));
 		CHECK_CANCEL();
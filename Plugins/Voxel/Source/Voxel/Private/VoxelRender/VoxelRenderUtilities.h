@@ -49,7 +49,8 @@ struct FVoxelChunkMeshSection
 // Map from mesh config -> section config -> array of meshes to merge into that section
 using FVoxelChunkMeshesToBuild = TMap<FVoxelMeshConfig, TMap<FVoxelProcMeshSectionSettings, TArray<FVoxelChunkMeshSection>>>;
 // Map from mesh config -> section config -> built section
-using FVoxelBuiltChunkMeshes = TArray<TPair<FVoxelMeshConfig, TArray<TPair<FVoxelProcMeshSectionSettings, TUniquePtr<FVoxelProcMeshBuffers>>>>>;
+// Shared: the collision cooking can start before the buffers are given to a component
+using FVoxelBuiltChunkMeshes = TArray<TPair<FVoxelMeshConfig, TArray<TPair<FVoxelProcMeshSectionSettings, TVoxelSharedPtr<FVoxelProcMeshBuffers>>>>>;
 
 enum class EDitheringType : uint8
 {
@@ -87,6 +88,39 @@ namespace FVoxelRenderUtilities
 	void HideMesh(UVoxelProceduralMeshComponent& Mesh);
 	void ShowMesh(UVoxelProceduralMeshComponent& Mesh);
 
+	// Whether to merge the main chunks, see voxel.renderer.ShowTransitions
+	bool ShowMainChunks();
+
+	// Number of vertices/indices needed to merge these sections, and their GUIDs
+	void GetSectionsSize(
+		const TArray<FVoxelChunkMeshSection>& Sections,
+		bool bShowMainChunks,
+		int32& OutNumVertices,
+		int32& OutNumIndices,
+		int32& OutNumAdjacencyIndices,
+		TArray<FGuid>& OutGuids);
+	void InitBuffers(
+		FVoxelProcMeshBuffers& Buffers,
+		const FVoxelRendererSettingsBase& RendererSettings,
+		int32 NumVertices,
+		int32 NumIndices,
+		int32 NumAdjacencyIndices);
+	// Copy the sections into already allocated buffers, at the given offsets. Returns the local bounds of the copied data
+	FBox CopySections_AnyThread(
+		const FVoxelRendererSettingsBase& RendererSettings,
+		const TArray<FVoxelChunkMeshSection>& Sections,
+		bool bShowMainChunks,
+		const FIntVector& CenterPosition,
+		FVoxelProcMeshBuffers& Buffers,
+		int32 VerticesOffset,
+		int32 IndicesOffset,
+		int32 AdjacencyIndicesOffset);
+	// Add the tessellation bounds extension if needed
+	FBox GetFinalLocalBounds(const FVoxelRendererSettingsBase& RendererSettings, const FBox& LocalBounds, bool bEnableTessellation);
+#if VOXEL_DEBUG
+	void CheckBuffers(const FVoxelProcMeshBuffers& Buffers);
+#endif
+
 	TUniquePtr<FVoxelProcMeshBuffers> MergeSections_AnyThread(
 		const FVoxelRendererSettingsBase& RendererSettings,
 		const TArray<FVoxelChunkMeshSection>& Sections,
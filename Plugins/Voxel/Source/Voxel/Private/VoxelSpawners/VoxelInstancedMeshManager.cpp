@@ -7,6 +7,7 @@
 #include "VoxelData/VoxelDataAccelerator.h"
 #include "VoxelGlobals.h"
 #include "VoxelWorld.h"
+#include "VoxelFrameScheduler.h"
 
 #include "GameFramework/Actor.h"
 #include "Engine/StaticMesh.h"
@@ -199,14 +200,19 @@ void FVoxelInstancedMeshManager::Tick(float DeltaTime)
 {
 	VOXEL_FUNCTION_COUNTER();
 
+	FVoxelFrameBudgetScope FrameBudget(EVoxelFrameBudgetCategory::InstancedMeshes);
+
 	FQueuedBuildCallback Callback;
-	while (HISMBuiltDataQueue.Dequeue(Callback))
+	// First check the time, else dequeued elements aren't processed
+	while (FrameBudget.HasTimeLeft() && HISMBuiltDataQueue.Dequeue(Callback))
 	{
 		auto* HISM = Callback.Component.Get();
 		if (!HISM) continue;
 
 		HISM->Voxel_FinishBuilding(*Callback.Data);
 	}
+
+	FrameBudget.SetNumDeferred(HISMBuiltDataQueue.Num());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -16,6 +16,7 @@
 #include "VoxelPriorityHandler.h"
 #include "VoxelMessages.h"
 #include "VoxelThreadingUtilities.h"
+#include "VoxelFrameScheduler.h"
 
 #include "DrawDebugHelpers.h"
 #include "Async/Async.h"
@@ -306,8 +307,9 @@ void FVoxelSpawnerManager::Tick(float DeltaTime)
 {
 	VOXEL_FUNCTION_COUNTER();
 
-	// TODO: time limit?
-	FlushGameThreadQueue();
+	FVoxelFrameBudgetScope FrameBudget(EVoxelFrameBudgetCategory::Spawners);
+	FlushGameThreadQueue(FrameBudget.GetMaxTime());
+	FrameBudget.SetNumDeferred(ApplyGameThreadQueue.Num());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -475,11 +477,12 @@ void FVoxelSpawnerManager::FlushAnyThreadQueue()
 	}
 }
 
-void FVoxelSpawnerManager::FlushGameThreadQueue()
+void FVoxelSpawnerManager::FlushGameThreadQueue(double MaxTime)
 {
 	check(IsInGameThread());
 	TVoxelSharedPtr<FVoxelSpawnerProxyResult> Result;
-	while (ApplyGameThreadQueue.Dequeue(Result))
+	// First check the time, else dequeued elements aren't processed
+	while (FPlatformTime::Seconds() < MaxTime && ApplyGameThreadQueue.Dequeue(Result))
 	{
 		check(Result.IsValid());
 		Result->Apply_GameThread();
@@ -4,16 +4,30 @@
 #include "VoxelQueuedWork.h"
 #include "VoxelGlobals.h"
 #include "IVoxelPool.h"
+#include "VoxelPoolStats.h"
 
 #include "HAL/Event.h"
 #include "HAL/Runnable.h"
 #include "HAL/RunnableThread.h"
 #include "Misc/ScopeLock.h"
+#include "HAL/IConsoleManager.h"
 #include "Async/TaskGraphInterfaces.h"
 
 DECLARE_DWORD_COUNTER_STAT(TEXT("VoxelThreadPoolDummyCounter"), STAT_VoxelThreadPoolDummyCounter, STATGROUP_ThreadPoolAsyncTasks);
 DECLARE_DWORD_COUNTER_STAT(TEXT("Recomputed Voxel Tasks Priorities"), STAT_RecomputedVoxelTasksPriorities, STATGROUP_Voxel);
 
+static TAutoConsoleVariable<float> CVarPriorityRefreshPeriod(
+	TEXT("voxel.threadpool.PriorityRefreshPeriod"),
+	1.f,
+	TEXT("Min time, in ms, between two refreshes of the priorities of the queued tasks of a priority category"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMaxPriorityUpdatesPerRefresh(
+	TEXT("voxel.threadpool.MaxPriorityUpdatesPerRefresh"),
+	1024,
+	TEXT("Max number of queued tasks checked for an outdated priority per refresh"),
+	ECVF_Default);
+
 class FScopeLockWithStats
 {
 public:
@@ -104,7 +118,7 @@ uint32 FVoxelQueuedThread::Run()
 
 			while (LocalQueuedWork)
 			{
-				LocalQueuedWork->DoThreadedWork();
+				FVoxelPoolStats::DoThreadedWork(*LocalQueuedWork);
 				LocalQueuedWork = ThreadPool->ReturnToPoolOrGetNextJob(this);
 			}
 		}
@@ -121,12 +135,14 @@ FVoxelQueuedThreadPoolSettings::FVoxelQueuedThreadPoolSettings(
 	uint32 NumThreads,
 	uint32 StackSize,
 	EThreadPriority ThreadPriority,
-	bool bConstantPriorities)
+	bool bConstantPriorities,
+	const TArray<uint32>& PriorityCategories)
 	: PoolName(PoolName)
 	, NumThreads(NumThreads)
 	, StackSize(StackSize)
 	, ThreadPriority(ThreadPriority)
 	, bConstantPriorities(bConstantPriorities)
+	, PriorityCategories(PriorityCategories)
 {
 }
 
@@ -147,15 +163,38 @@ inline TArray<TUniquePtr<FVoxelQueuedThread>> CreateThreads(FVoxelQueuedThreadPo
 	return Threads;
 }
 
+template<typename T>
+inline TArray<TUniquePtr<T>> CreateQueues(const TArray<uint32>& PriorityCategories)
+{
+	TArray<uint32> SortedCategories = PriorityCategories;
+	SortedCategories.Sort([](uint32 A, uint32 B) { return A > B; });
+
+	TArray<TUniquePtr<T>> Queues;
+	for (uint32 PriorityCategory : SortedCategories)
+	{
+		if (Queues.Num() == 0 || Queues.Last()->PriorityCategory != PriorityCategory)
+		{
+			Queues.Add(MakeUnique<T>(PriorityCategory));
+		}
+	}
+	if (Queues.Num() == 0)
+	{
+		Queues.Add(MakeUnique<T>(0));
+	}
+	return Queues;
+}
+
 FVoxelQueuedThreadPool::FVoxelQueuedThreadPool(const FVoxelQueuedThreadPoolSettings& Settings)
 	: Settings(Settings)
 	, AllThreads(CreateThreads(this))
+	, Queues(CreateQueues<FQueue>(Settings.PriorityCategories))
 {
 	QueuedThreads.Reserve(Settings.NumThreads);
 	for (auto& Thread : AllThreads)
 	{
 		QueuedThreads.Add(Thread.Get());
 	}
+	NumQueuedThreads.Set(QueuedThreads.Num());
 }
 
 TVoxelSharedRef<FVoxelQueuedThreadPool> FVoxelQueuedThreadPool::Create(const FVoxelQueuedThreadPoolSettings& Settings)
@@ -194,62 +233,150 @@ FORCEINLINE void FVoxelQueuedThreadPool::FQueuedWorkInfo::RecomputePriority(doub
 	NextPriorityUpdateTime = Time + Work->PriorityDuration;
 }
 
-void FVoxelQueuedThreadPool::AddQueuedWork(IVoxelQueuedWork* InQueuedWork, uint32 PriorityCategory, int32 PriorityOffset)
-{
-	VOXEL_FUNCTION_COUNTER();
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
 
-	check(IsInGameThread());
-	check(InQueuedWork);
+// Binary heap helpers with the highest priority on top
+// The TArray heap functions can't move an element whose priority changed in place
 
-	if (TimeToDie)
+template<typename T>
+inline int32 HeapSiftUp(TArray<T>& Heap, int32 Index)
+{
+	while (Index > 0)
 	{
-		InQueuedWork->Abandon();
-		return;
+		const int32 ParentIndex = (Index - 1) / 2;
+		if (Heap[ParentIndex].Priority >= Heap[Index].Priority) break;
+		Heap.Swap(ParentIndex, Index);
+		Index = ParentIndex;
 	}
+	return Index;
+}
 
-	FQueuedWorkInfo WorkInfo;
+template<typename T>
+inline void HeapSiftDown(TArray<T>& Heap, int32 Index)
+{
+	const int32 Num = Heap.Num();
+	while (true)
 	{
-		VOXEL_SCOPE_COUNTER("Compute Priority");
-		WorkInfo = FQueuedWorkInfo(InQueuedWork, PriorityCategory, PriorityOffset);
+		const int32 LeftIndex = 2 * Index + 1;
+		if (LeftIndex >= Num) break;
+		const int32 RightIndex = LeftIndex + 1;
+		const int32 BestChildIndex = RightIndex < Num && Heap[RightIndex].Priority > Heap[LeftIndex].Priority ? RightIndex : LeftIndex;
+		if (Heap[Index].Priority >= Heap[BestChildIndex].Priority) break;
+		Heap.Swap(Index, BestChildIndex);
+		Index = BestChildIndex;
 	}
+}
 
+void FVoxelQueuedThreadPool::FQueue::FlushNewWorks()
+{
+	FQueuedWorkInfo WorkInfo;
+	while (NewWorks.Dequeue(WorkInfo))
 	{
-		VOXEL_SCOPE_COUNTER("Lock");
-		Section.Lock();
+		Push(WorkInfo);
 	}
+}
+
+void FVoxelQueuedThreadPool::FQueue::Push(const FQueuedWorkInfo& WorkInfo)
+{
+	// NumWorks was incremented when queuing to NewWorks
+	HeapSiftUp(Works, Works.Add(WorkInfo));
+}
+
+FVoxelQueuedThreadPool::FQueuedWorkInfo FVoxelQueuedThreadPool::FQueue::Pop()
+{
+	check(Works.Num() > 0);
+	const FQueuedWorkInfo WorkInfo = Works[0];
+	Works.RemoveAtSwap(0, 1, false);
+	HeapSiftDown(Works, 0);
+	NumWorks.Decrement();
+	return WorkInfo;
+}
+
+void FVoxelQueuedThreadPool::FQueue::RefreshPriorities(double Time, int32 MaxNumToRecompute)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// Elements move when sifted, so a few might be skipped until the next pass: that's fine as priorities are only hints
+	const int32 NumToCheck = FMath::Min(Works.Num(), MaxNumToRecompute);
+	int32 NumRecomputed = 0;
+	for (int32 Count = 0; Count < NumToCheck; Count++)
 	{
-		VOXEL_SCOPE_COUNTER("Add Work");
-		if (Settings.bConstantPriorities)
+		if (RefreshIndex >= Works.Num())
+		{
+			RefreshIndex = 0;
+		}
+		const int32 Index = RefreshIndex++;
+
+		auto& WorkInfo = Works[Index];
+		if (WorkInfo.NextPriorityUpdateTime >= Time) continue;
+
+		const uint32 OldPriority = WorkInfo.Priority;
+		WorkInfo.RecomputePriority(Time);
+		NumRecomputed++;
+
+		if (WorkInfo.Priority > OldPriority)
 		{
-			WorkInfo.RecomputePriority(FPlatformTime::Seconds());
-			StaticQueuedWorks.push(WorkInfo);
+			HeapSiftUp(Works, Index);
 		}
-		else
+		else if (WorkInfo.Priority < OldPriority)
 		{
-			QueuedWorks.Add(WorkInfo);
+			HeapSiftDown(Works, Index);
 		}
 	}
 
+	INC_DWORD_STAT_BY(STAT_RecomputedVoxelTasksPriorities, NumRecomputed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelQueuedThreadPool::FQueue& FVoxelQueuedThreadPool::GetQueue(uint32 PriorityCategory) const
+{
+	// Few categories: a linear search is fine
+	for (auto& Queue : Queues)
 	{
-		VOXEL_SCOPE_COUNTER("Wake up threads");
-		for (auto* QueuedThread : QueuedThreads)
+		if (Queue->PriorityCategory <= PriorityCategory)
 		{
-			QueuedThread->DoWorkEvent->Trigger();
+			ensureMsgf(Queue->PriorityCategory == PriorityCategory, TEXT("Priority category %u not in the pool settings"), PriorityCategory);
+			return *Queue;
 		}
-		QueuedThreads.Reset();
 	}
+	ensureMsgf(false, TEXT("Priority category %u not in the pool settings"), PriorityCategory);
+	return *Queues.Last();
+}
 
+bool FVoxelQueuedThreadPool::HasQueuedWorks() const
+{
+	for (auto& Queue : Queues)
 	{
-		VOXEL_SCOPE_COUNTER("Unlock");
-		Section.Unlock();
+		if (Queue->NumWorks.GetValue() > 0)
+		{
+			return true;
+		}
 	}
+	return false;
+}
+
+void FVoxelQueuedThreadPool::AddQueuedWork(IVoxelQueuedWork* InQueuedWork, uint32 PriorityCategory, int32 PriorityOffset)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	check(InQueuedWork);
+
+	AddQueuedWorks({ InQueuedWork }, PriorityCategory, PriorityOffset);
 }
 
 void FVoxelQueuedThreadPool::AddQueuedWorks(const TArray<IVoxelQueuedWork*>& InQueuedWorks, uint32 PriorityCategory, int32 PriorityOffset)
 {
 	VOXEL_FUNCTION_COUNTER();
 
-	check(IsInGameThread());
+	if (InQueuedWorks.Num() == 0)
+	{
+		return;
+	}
 
 	if (TimeToDie)
 	{
@@ -260,46 +387,43 @@ void FVoxelQueuedThreadPool::AddQueuedWorks(const TArray<IVoxelQueuedWork*>& InQ
 		return;
 	}
 
+	FQueue& Queue = GetQueue(PriorityCategory);
 	{
-		VOXEL_SCOPE_COUNTER("Lock");
-		Section.Lock();
-	}
-
-	{
-		if (!Settings.bConstantPriorities)
-		{
-			VOXEL_SCOPE_COUNTER("Reserve");
-			QueuedWorks.Reserve(QueuedWorks.Num() + InQueuedWorks.Num());
-		}
 		VOXEL_SCOPE_COUNTER("Add Works");
+
+		// Before enqueuing, so that the threads can't miss a work
+		Queue.NumWorks.Add(InQueuedWorks.Num());
+
+		const double Time = FPlatformTime::Seconds();
 		for (auto* InQueuedWork : InQueuedWorks)
 		{
-			FQueuedWorkInfo WorkInfo(InQueuedWork, PriorityCategory, PriorityOffset);
-
-			if (Settings.bConstantPriorities)
-			{
-				WorkInfo.RecomputePriority(FPlatformTime::Seconds());
-				StaticQueuedWorks.push(WorkInfo);
-			}
-			else
-			{
-				QueuedWorks.Add(WorkInfo);
-			}
+			check(InQueuedWork);
+			FQueuedWorkInfo WorkInfo(InQueuedWork, PriorityOffset);
+			WorkInfo.RecomputePriority(Time);
+			Queue.NewWorks.Enqueue(WorkInfo);
 		}
 	}
 
+	if (TimeToDie)
 	{
+		// AbandonAllTasks might have flushed the queue before we enqueued our works
+		FScopeLockWithStats Lock(Queue.Section);
+		AbandonWorks(Queue);
+		return;
+	}
+
+	// Must be done after the works are added: see ReturnToPoolOrGetNextJob
+	if (NumQueuedThreads.GetValue() > 0)
+	{
+		FScopeLockWithStats Lock(ThreadsSection);
+
 		VOXEL_SCOPE_COUNTER("Wake up threads");
 		for (auto* QueuedThread : QueuedThreads)
 		{
 			QueuedThread->DoWorkEvent->Trigger();
 		}
 		QueuedThreads.Reset();
-	}
-
-	{
-		VOXEL_SCOPE_COUNTER("Unlock");
-		Section.Unlock();
+		NumQueuedThreads.Reset();
 	}
 }
 
@@ -309,55 +433,46 @@ IVoxelQueuedWork* FVoxelQueuedThreadPool::ReturnToPoolOrGetNextJob(FVoxelQueuedT
 
 	check(InQueuedThread);
 
-	FScopeLockWithStats Lock(Section);
-
-	if (QueuedWorks.Num() > 0)
+	while (true)
 	{
-		check(!Settings.bConstantPriorities);
-		check(!TimeToDie);
+		// Queues are sorted by decreasing category: the first non empty queue has the best work
+		for (auto& QueuePtr : Queues)
+		{
+			FQueue& Queue = *QueuePtr;
+			if (Queue.NumWorks.GetValue() <= 0) continue;
 
-		VOXEL_SCOPE_COUNTER("Voxel Thread Pool Recompute Priorities");
+			FScopeLockWithStats Lock(Queue.Section);
+			if (TimeToDie) continue; // The works are being abandoned
 
-		// Find best work. We recompute every priorities as the priorities can change (eg, the camera might have moved)
-		int32 BestIndex = -1;
-		uint64 BestPriority = 0;
-		int32 NumRecomputed = 0;
-		const double Time = FPlatformTime::Seconds();
-		for (int32 Index = 0; Index < QueuedWorks.Num(); Index++)
-		{
-			auto& WorkInfo = QueuedWorks.GetData()[Index];
-			if (WorkInfo.NextPriorityUpdateTime < Time)
-			{
-				NumRecomputed++;
-				WorkInfo.RecomputePriority(Time);
-			}
-			const uint64 Priority = WorkInfo.GetPriority();
-			if (Priority >= BestPriority)
+			Queue.FlushNewWorks();
+			if (Queue.Works.Num() == 0) continue; // Another thread was faster, or the works are still being enqueued
+
+			if (!Settings.bConstantPriorities)
 			{
-				BestPriority = Priority;
-				BestIndex = Index;
+				// Priorities can change, eg if the camera moved
+				const double Time = FPlatformTime::Seconds();
+				if (Time >= Queue.NextRefreshTime)
+				{
+					Queue.NextRefreshTime = Time + CVarPriorityRefreshPeriod.GetValueOnAnyThread() / 1000;
+					Queue.RefreshPriorities(Time, CVarMaxPriorityUpdatesPerRefresh.GetValueOnAnyThread());
+				}
 			}
-		}
 
-		INC_DWORD_STAT_BY(STAT_RecomputedVoxelTasksPriorities, NumRecomputed);
+			auto* Work = Queue.Pop().Work;
+			check(Work);
+			return Work;
+		}
 
-		auto* Work = QueuedWorks[BestIndex].Work;
-		QueuedWorks.RemoveAtSwap(BestIndex);
-		check(Work);
-		return Work;
-	}
-	else if (!StaticQueuedWorks.empty())
-	{
-		check(Settings.bConstantPriorities);
-		auto* Work = StaticQueuedWorks.top().Work;
-		StaticQueuedWorks.pop();
-		check(Work);
-		return Work;
-	}
-	else
-	{
+		FScopeLockWithStats Lock(ThreadsSection);
+		// Register before checking again: AddQueuedWorks adds its works before reading NumQueuedThreads, so one of us sees the other
 		QueuedThreads.Add(InQueuedThread);
-		return nullptr;
+		NumQueuedThreads.Increment();
+		if (TimeToDie || !HasQueuedWorks())
+		{
+			return nullptr;
+		}
+		QueuedThreads.Pop(false);
+		NumQueuedThreads.Decrement();
 	}
 }
 
@@ -367,26 +482,17 @@ void FVoxelQueuedThreadPool::AbandonAllTasks()
 
 	ensure(!TimeToDie);
 
+	TimeToDie = true;
+	for (auto& Queue : Queues)
 	{
-		FScopeLockWithStats Lock(Section);
-		TimeToDie = true;
-		// Clean up all queued objects
-		for (auto& WorkInfo : QueuedWorks)
-		{
-			WorkInfo.Work->Abandon();
-		}
-		QueuedWorks.Reset();
-		while (!StaticQueuedWorks.empty())
-		{
-			StaticQueuedWorks.top().Work->Abandon();
-			StaticQueuedWorks.pop();
-		}
+		FScopeLockWithStats Lock(Queue->Section);
+		AbandonWorks(*Queue);
 	}
 	// Wait for all threads to finish up
 	while (true)
 	{
 		{
-			FScopeLockWithStats Lock(Section);
+			FScopeLockWithStats Lock(ThreadsSection);
 			if (AllThreads.Num() == QueuedThreads.Num())
 			{
 				break;
@@ -394,4 +500,16 @@ void FVoxelQueuedThreadPool::AbandonAllTasks()
 		}
 		FPlatformProcess::Sleep(0.0f);
 	}
+}
+
+void FVoxelQueuedThreadPool::AbandonWorks(FQueue& Queue)
+{
+	Queue.FlushNewWorks();
+	// Clean up all queued objects
+	for (auto& WorkInfo : Queue.Works)
+	{
+		WorkInfo.Work->Abandon();
+	}
+	Queue.NumWorks.Subtract(Queue.Works.Num());
+	Queue.Works.Reset();
 }
\ No newline at end of file
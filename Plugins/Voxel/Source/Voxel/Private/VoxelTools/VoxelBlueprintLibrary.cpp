@@ -17,6 +17,7 @@
 
 #include "Async/Async.h"
 #include "Engine/StaticMesh.h"
+#include "Misc/Paths.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -538,7 +539,7 @@ void UVoxelBlueprintLibrary::CreateGlobalVoxelThreadPool(
 			IVoxelPool::GetGlobalPoolCreator(WorldContextObject->GetWorld()));
 		return;
 	}
-	const auto Pool = FVoxelDefaultPool::Create(
+	const auto Pool = IVoxelPool::Create(
 		FMath::Max(1, NumberOfThreads),
 		bConstantPriorities,
 		PriorityCategoriesOverrides,
@@ -565,6 +566,27 @@ bool UVoxelBlueprintLibrary::IsGlobalVoxelPoolCreated(UObject* WorldContextObjec
 	return IVoxelPool::IsGlobalVoxelPoolCreated(WorldContextObject->GetWorld());
 }
 
+TArray<FVoxelPoolTaskTypeStats> UVoxelBlueprintLibrary::GetVoxelPoolStats(float& WorkerUtilization, float& Duration)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	return FVoxelPoolStats::GetStats(WorkerUtilization, Duration);
+}
+
+void UVoxelBlueprintLibrary::ResetVoxelPoolStats()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	FVoxelPoolStats::Reset();
+}
+
+bool UVoxelBlueprintLibrary::ExportVoxelPoolStatsToCSV(const FString& Path)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	return FVoxelPoolStats::ExportStatsToCSV(FPaths::IsRelative(Path) ? FPaths::ProjectDir() / Path : Path);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
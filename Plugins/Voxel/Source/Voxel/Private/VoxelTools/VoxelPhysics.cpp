@@ -104,97 +104,67 @@ void UVoxelPhysicsTools::RemoveFloatingParts(
 {
 	VOXEL_TOOL_FUNCTION_COUNTER(Bounds.Count());
 
-	const FIntVector Size = Bounds.Size();
+	TArray<FIntVector> FloatingPoints;
+	{
+		FVoxelReadScopeLock Lock(Data, Bounds, "SearchForFloatingBlocks");
+		Data.GetConnectivityGraph().FindFloatingVoxels(Data, Bounds, FloatingPoints);
+	}
 
-	// TODO bit array
-	TArray<bool> Visited;
-	Visited.SetNumZeroed(Size.X * Size.Y * Size.Z);
+	if (FloatingPoints.Num() == 0)
+	{
+		return;
+	}
 
-	TArray<FIntVector> FloatingPoints;
+	// The parts also copy the empty voxels around the floating ones
+	FIntBox PartsBounds;
+	{
+		FIntBoxWithValidity FloatingBounds;
+		for (auto& Point : FloatingPoints)
+		{
+			FloatingBounds += Point;
+		}
+		PartsBounds = FloatingBounds.GetBox().Extend(1).Overlap(Bounds);
+	}
+	const FIntVector Size = PartsBounds.Size();
 
+	TArray<bool> Visited;
 	TArray<FIntVector> Queue;
-	Queue.Reserve(Size.X * Size.Y * Size.Z);
-
 	TArray<FVoxelValue> Values;
 	TArray<FVoxelMaterial> Materials;
 	{
-		FVoxelPromotableReadScopeLock Lock(Data, Bounds, "SearchForFloatingBlocks");
+		// Only write lock the floating voxels, so that the edit versions of the rest of Bounds are kept
+		FVoxelWriteScopeLock Lock(Data, PartsBounds, "RemoveFloatingBlocks");
 
-		Values = Data.GetValues(Bounds);
+		Values = Data.GetValues(PartsBounds);
+		Materials.SetNumUninitialized(Size.X * Size.Y * Size.Z);
 
-		// Fill Visited array
+		// Solid voxels that are not floating must not be added to the parts
+		Visited.SetNumUninitialized(Size.X * Size.Y * Size.Z);
+		for (int32 Index = 0; Index < Values.Num(); Index++)
 		{
-			VOXEL_SCOPE_COUNTER("Fill Visited array");
-
-			// Add borders
-			for (int32 X = Bounds.Min.X; X < Bounds.Max.X; X++)
-			{
-				for (int32 Y = Bounds.Min.Y; Y < Bounds.Max.Y; Y++)
-				{
-					Queue.Emplace(X, Y, Bounds.Min.Z);
-					Queue.Emplace(X, Y, Bounds.Max.Z - 1);
-				}
-				for (int32 Z = Bounds.Min.Z; Z < Bounds.Max.Z; Z++)
-				{
-					Queue.Emplace(X, Bounds.Min.Y, Z);
-					Queue.Emplace(X, Bounds.Max.Y - 1, Z);
-				}
-			}
-			for (int32 Y = Bounds.Min.Y; Y < Bounds.Max.Y; Y++)
-			{
-				for (int32 Z = Bounds.Min.Z; Z < Bounds.Max.Z; Z++)
-				{
-					Queue.Emplace(Bounds.Min.X, Y, Z);
-					Queue.Emplace(Bounds.Max.X - 1, Y, Z);
-				}
-			}
-
-			while (Queue.Num() > 0)
-			{
-				const FIntVector Position = Queue.Pop(false);
-
-				if (Bounds.Contains(Position))
-				{
-					const int32 Index = GetIndex(Bounds, Size, Position);
-					if (!Visited[Index] && !Values[Index].IsEmpty())
-					{
-						Visited[Index] = true;
-						FVoxelUtilities::AddImmediateNeighborsToArray(Position, Queue);
-					}
-				}
-			}
+			Visited[Index] = !Values[Index].IsEmpty();
 		}
 
+		VOXEL_SCOPE_COUNTER("Remove floating voxels");
+		FVoxelMutableDataAccelerator OctreeAccelerator(Data, PartsBounds);
+		for (int32 PointIndex = 0; PointIndex < FloatingPoints.Num(); PointIndex++)
 		{
-			VOXEL_SCOPE_COUNTER("Remove not visited voxels");
-			FVoxelMutableDataAccelerator OctreeAccelerator(Data, Bounds);
-			for (int32 Z = Bounds.Min.Z; Z < Bounds.Max.Z; Z++)
-			{
-				for (int32 Y = Bounds.Min.Y; Y < Bounds.Max.Y; Y++)
-				{
-					for (int32 X = Bounds.Min.X; X < Bounds.Max.X; X++)
-					{
-						const int32 Index = GetIndex(Bounds, Size, X, Y, Z);
-
-						if (Visited[Index]) continue;
-
-						if (Values[Index].IsEmpty()) continue;
+			const FIntVector& Point = FloatingPoints[PointIndex];
+			const int32 Index = GetIndex(PartsBounds, Size, Point);
 
-						// Write lock is expensive, so we avoid calling it until we really have to
-						if (!Lock.IsPromoted())
-						{
-							Lock.Promote();
-							Materials.SetNumUninitialized(Size.X * Size.Y * Size.Z);
-						}
+			// Might have been edited since the read lock was released
+			if (Values[Index].IsEmpty())
+			{
+				FloatingPoints.RemoveAtSwap(PointIndex, 1, false);
+				PointIndex--;
+				continue;
+			}
 
-						Materials[Index] = OctreeAccelerator.GetMaterial(X, Y, Z, 0);
-						OctreeAccelerator.SetValue(X, Y, Z, FVoxelValue::Empty());
+			Visited[Index] = false;
+			Materials[Index] = OctreeAccelerator.GetMaterial(Point, 0);
+			OctreeAccelerator.SetValue(Point, FVoxelValue::Empty());
 
-						FloatingPoints.Emplace(X, Y, Z);
-						OutResult.BoxToUpdate += FIntVector(X, Y, Z);
-					}
-				}
-			}
+			OutResult.BoxToUpdate += Point;
 		}
 	}
 
@@ -230,7 +200,7 @@ void UVoxelPhysicsTools::RemoveFloatingParts(
 
 		if (bCreateData)
 		{
-			const uint8 Depth = FVoxelUtilities::GetDepthFromSize<DATA_CHUNK_SIZE>(Size.GetMax());
+			const uint8 Depth = FVoxelUtilities::GetDepthFromSize<DATA_CHUNK_SIZE>(Bounds.Size().GetMax());
 			const auto WorldGenerator = MakeVoxelShared<FVoxelEmptyWorldGeneratorInstance>(Data.WorldGenerator);
 
 			struct FNewPart
@@ -277,7 +247,7 @@ void UVoxelPhysicsTools::RemoveFloatingParts(
 				OutResult.Parts.Add({ NewPart.NewPartCenter, NewPart.NewPartData, {} });
 			};
 
-			CreateParts(Queue, FloatingPoints, Visited, Values, Materials, Bounds, Size, InitNewPart, AddVoxel, FinishPart);
+			CreateParts(Queue, FloatingPoints, Visited, Values, Materials, PartsBounds, Size, InitNewPart, AddVoxel, FinishPart);
 		}
 
 		if (bCreateVoxels)
@@ -298,7 +268,7 @@ void UVoxelPhysicsTools::RemoveFloatingParts(
 				OutResult.Parts.Add(MoveTemp(NewPart));
 			};
 
-			CreateParts(Queue, FloatingPoints, Visited, Values, Materials, Bounds, Size, InitNewPart, AddVoxel, FinishPart);
+			CreateParts(Queue, FloatingPoints, Visited, Values, Materials, PartsBounds, Size, InitNewPart, AddVoxel, FinishPart);
 		}
 	}
 }
@@ -0,0 +1,558 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelTools/VoxelQueryTools.h"
+#include "VoxelTools/VoxelToolHelpers.h"
+#include "VoxelData/VoxelData.h"
+#include "VoxelData/VoxelDataUtilities.h"
+#include "VoxelWorld.h"
+
+#include "Async/ParallelFor.h"
+
+// Trilinear interpolation of the values of a cell: A + B X + C Y + D Z + E XY + F XZ + G YZ + H XYZ, with XYZ relative to the cell min
+struct FVoxelQueryCell
+{
+	float A, B, C, D, E, F, G, H;
+
+	FVoxelQueryCell(const FVoxelData& Data, const FIntVector& Position)
+	{
+		const auto Get = [&](int32 X, int32 Y, int32 Z)
+		{
+			return Data.GetValue(Position.X + X, Position.Y + Y, Position.Z + Z, 0).ToFloat();
+		};
+		const float V000 = Get(0, 0, 0);
+		const float V100 = Get(1, 0, 0);
+		const float V010 = Get(0, 1, 0);
+		const float V110 = Get(1, 1, 0);
+		const float V001 = Get(0, 0, 1);
+		const float V101 = Get(1, 0, 1);
+		const float V011 = Get(0, 1, 1);
+		const float V111 = Get(1, 1, 1);
+
+		A = V000;
+		B = V100 - V000;
+		C = V010 - V000;
+		D = V001 - V000;
+		E = V110 - V100 - V010 + V000;
+		F = V101 - V100 - V001 + V000;
+		G = V011 - V010 - V001 + V000;
+		H = V111 - V110 - V101 - V011 + V100 + V010 + V001 - V000;
+	}
+
+	FVector GetGradient(const FVector& P) const
+	{
+		return FVector(
+			B + E * P.Y + F * P.Z + H * P.Y * P.Z,
+			C + E * P.X + G * P.Z + H * P.X * P.Z,
+			D + F * P.X + G * P.Y + H * P.X * P.Y);
+	}
+};
+
+// Walks down the data octree along the ray, skipping the nodes whose value range doesn't contain the surface
+class FVoxelQueryRaycaster
+{
+public:
+	FVoxelQueryRaycaster(const FVoxelData& Data, const FVector& Start, const FVector& End)
+		: Data(Data)
+		, Start(Start)
+		, Direction(End - Start)
+		, InvDirection(GetSafeInverse(Direction.X), GetSafeInverse(Direction.Y), GetSafeInverse(Direction.Z))
+		, Bounds(UVoxelQueryTools::GetSweepBounds(Start, End, 0))
+	{
+	}
+
+	FVoxelQueryHit Raycast()
+	{
+		FVoxelQueryHit Hit;
+
+		const FIntBox& Root = Data.GetOctree().GetBounds();
+		float TMin = 0;
+		float TMax = 1;
+		if (!ClipToBox(Root, TMin, TMax) || !Traverse(Root, TMin, TMax))
+		{
+			return Hit;
+		}
+
+		Hit.bHit = true;
+		Hit.Position = Start + Direction * HitTime;
+		Hit.Normal = HitNormal.IsNearlyZero() ? -Direction.GetSafeNormal() : HitNormal.GetSafeNormal();
+		Hit.Distance = HitTime * Direction.Size();
+		return Hit;
+	}
+
+private:
+	const FVoxelData& Data;
+	const FVector Start;
+	// The ray is Start + T * Direction, T between 0 and 1
+	const FVector Direction;
+	const FVector InvDirection;
+	// Locked bounds
+	const FIntBox Bounds;
+
+	float HitTime = 0;
+	FVector HitNormal = FVector::ZeroVector;
+
+	static float GetSafeInverse(float Value)
+	{
+		// Avoid NaNs when multiplying by 0
+		return Value != 0 ? 1 / Value : BIG_NUMBER;
+	}
+
+	// Box of cells: the cell Position goes from Position to Position + 1
+	bool ClipToBox(const FIntBox& Box, float& TMin, float& TMax) const
+	{
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			float T0 = (Box.Min[Axis] - Start[Axis]) * InvDirection[Axis];
+			float T1 = (Box.Max[Axis] - Start[Axis]) * InvDirection[Axis];
+			if (T0 > T1)
+			{
+				Swap(T0, T1);
+			}
+			TMin = FMath::Max(TMin, T0);
+			TMax = FMath::Min(TMax, T1);
+		}
+		return TMin <= TMax;
+	}
+
+	bool Traverse(const FIntBox& Box, float TMin, float TMax)
+	{
+		// The cells use the values up to Max included
+		const FIntBox ValuesBounds(Box.Min, Box.Max + 1);
+		if (!ValuesBounds.Intersect(Bounds))
+		{
+			return false;
+		}
+
+		const TVoxelRange<FVoxelValue> Range = Data.GetValueRange(ValuesBounds.Overlap(Bounds), 0);
+		if (Range.Min.IsEmpty())
+		{
+			// Only empty values
+			return false;
+		}
+		if (!Range.Max.IsEmpty())
+		{
+			// Only full values: we are inside as soon as we enter the box
+			HitTime = TMin;
+			HitNormal = FVector::ZeroVector;
+			return true;
+		}
+
+		const int32 Size = Box.Size().X;
+		if (Size == 1)
+		{
+			return IntersectCell(Box.Min, TMin, TMax);
+		}
+
+		struct FChild
+		{
+			FIntBox Box;
+			float TMin;
+			float TMax;
+		};
+		TArray<FChild, TFixedAllocator<8>> Children;
+
+		const int32 ChildSize = Size / 2;
+		for (int32 Index = 0; Index < 8; Index++)
+		{
+			const FIntVector ChildMin = Box.Min + ChildSize * FIntVector(bool(Index & 0x1), bool(Index & 0x2), bool(Index & 0x4));
+			FChild Child{ FIntBox(ChildMin, ChildMin + FIntVector(ChildSize)), TMin, TMax };
+			if (ClipToBox(Child.Box, Child.TMin, Child.TMax))
+			{
+				Children.Add(Child);
+			}
+		}
+		Children.Sort([](const FChild& ChildA, const FChild& ChildB) { return ChildA.TMin < ChildB.TMin; });
+
+		for (const FChild& Child : Children)
+		{
+			if (Traverse(Child.Box, Child.TMin, Child.TMax))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool IntersectCell(const FIntVector& Position, float TMin, float TMax)
+	{
+		const FVoxelQueryCell Cell(Data, Position);
+
+		// Restrict the interpolation to the segment inside the cell: it's a cubic in U, U between 0 and 1
+		const FVector O = Start + Direction * TMin - FVector(Position);
+		const FVector D = Direction * (TMax - TMin);
+
+		const float C0 =
+			Cell.A + Cell.B * O.X + Cell.C * O.Y + Cell.D * O.Z +
+			Cell.E * O.X * O.Y + Cell.F * O.X * O.Z + Cell.G * O.Y * O.Z +
+			Cell.H * O.X * O.Y * O.Z;
+		const float C1 =
+			Cell.B * D.X + Cell.C * D.Y + Cell.D * D.Z +
+			Cell.E * (O.X * D.Y + O.Y * D.X) +
+			Cell.F * (O.X * D.Z + O.Z * D.X) +
+			Cell.G * (O.Y * D.Z + O.Z * D.Y) +
+			Cell.H * (O.X * O.Y * D.Z + O.X * D.Y * O.Z + D.X * O.Y * O.Z);
+		const float C2 =
+			Cell.E * D.X * D.Y + Cell.F * D.X * D.Z + Cell.G * D.Y * D.Z +
+			Cell.H * (O.X * D.Y * D.Z + D.X * O.Y * D.Z + D.X * D.Y * O.Z);
+		const float C3 = Cell.H * D.X * D.Y * D.Z;
+
+		const auto GetValue = [&](float U)
+		{
+			return ((C3 * U + C2) * U + C1) * U + C0;
+		};
+
+		const auto SetHit = [&](float U)
+		{
+			HitTime = TMin + U * (TMax - TMin);
+			HitNormal = Cell.GetGradient(O + D * U);
+		};
+
+		if (GetValue(0) <= 0)
+		{
+			SetHit(0);
+			return true;
+		}
+
+		// Split the segment where the derivative 3 C3 U^2 + 2 C2 U + C1 is 0, so that the value is monotonic in each part
+		TArray<float, TFixedAllocator<4>> Parts;
+		Parts.Add(0);
+		{
+			const float QA = 3 * C3;
+			const float QB = 2 * C2;
+			const float QC = C1;
+
+			TArray<float, TFixedAllocator<2>> Roots;
+			if (FMath::Abs(QA) > KINDA_SMALL_NUMBER)
+			{
+				const float Discriminant = QB * QB - 4 * QA * QC;
+				if (Discriminant >= 0)
+				{
+					const float Sqrt = FMath::Sqrt(Discriminant);
+					Roots.Add((-QB - Sqrt) / (2 * QA));
+					Roots.Add((-QB + Sqrt) / (2 * QA));
+					Roots.Sort();
+				}
+			}
+			else if (FMath::Abs(QB) > KINDA_SMALL_NUMBER)
+			{
+				Roots.Add(-QC / QB);
+			}
+
+			for (float Root : Roots)
+			{
+				if (0 < Root && Root < 1)
+				{
+					Parts.Add(Root);
+				}
+			}
+		}
+		Parts.Add(1);
+
+		for (int32 Index = 0; Index < Parts.Num() - 1; Index++)
+		{
+			float Low = Parts[Index];
+			float High = Parts[Index + 1];
+			if (GetValue(High) > 0)
+			{
+				continue;
+			}
+
+			// Value(Low) > 0, Value(High) <= 0 and monotonic in between
+			for (int32 Iteration = 0; Iteration < 24; Iteration++)
+			{
+				const float Middle = (Low + High) / 2;
+				if (GetValue(Middle) > 0)
+				{
+					Low = Middle;
+				}
+				else
+				{
+					High = Middle;
+				}
+			}
+			SetHit(High);
+			return true;
+		}
+
+		return false;
+	}
+};
+
+// True if a voxel inside the sphere is full, or if the center is inside the surface
+// OutContact: the average of the full voxels inside the sphere
+inline bool VoxelQuerySphereOverlap(const FVoxelData& Data, const FVector& Position, float Radius, FVector* OutContact)
+{
+	// Max is exclusive: + 1 so that the voxels at exactly Radius on the max side are visited too, like on the min side
+	const FIntBox SphereBounds(FVoxelUtilities::FloorToInt(Position - Radius), FVoxelUtilities::CeilToInt(Position + Radius) + 1);
+	checkVoxelSlow(SphereBounds.Contains(FVoxelUtilities::CeilToInt(Position + Radius)));
+
+	const TVoxelRange<FVoxelValue> Range = Data.GetValueRange(SphereBounds, 0);
+	if (Range.Min.IsEmpty())
+	{
+		return false;
+	}
+
+	FVector Sum = FVector::ZeroVector;
+	int32 NumFull = 0;
+
+	const float RadiusSquared = FMath::Square(Radius);
+	for (int32 X = SphereBounds.Min.X; X < SphereBounds.Max.X; X++)
+	{
+		for (int32 Y = SphereBounds.Min.Y; Y < SphereBounds.Max.Y; Y++)
+		{
+			for (int32 Z = SphereBounds.Min.Z; Z < SphereBounds.Max.Z; Z++)
+			{
+				const FVector VoxelPosition(X, Y, Z);
+				if (FVector::DistSquared(VoxelPosition, Position) <= RadiusSquared && !Data.GetValue(X, Y, Z, 0).IsEmpty())
+				{
+					if (!OutContact)
+					{
+						return true;
+					}
+					Sum += VoxelPosition;
+					NumFull++;
+				}
+			}
+		}
+	}
+
+	if (NumFull > 0)
+	{
+		*OutContact = Sum / NumFull;
+		return true;
+	}
+
+	if (FVoxelDataUtilities::MakeBilinearInterpolatedData(Data).GetValue(Position, 0) <= 0)
+	{
+		if (OutContact)
+		{
+			*OutContact = Position;
+		}
+		return true;
+	}
+
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelQueryHit UVoxelQueryTools::RaycastImpl(
+	const FVoxelData& Data,
+	const FVector& Start,
+	const FVector& End)
+{
+	VOXEL_FUNCTION_COUNTER();
+	return FVoxelQueryRaycaster(Data, Start, End).Raycast();
+}
+
+FVoxelQueryHit UVoxelQueryTools::SphereSweepImpl(
+	const FVoxelData& Data,
+	const FVector& Start,
+	const FVector& End,
+	float Radius)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	FVoxelQueryHit Hit;
+
+	const FVector Direction = End - Start;
+	// Small enough to not miss voxels
+	const float StepSize = FMath::Clamp(Radius / 2, 0.1f, 0.5f);
+	const int32 NumSteps = FMath::Max(1, FMath::CeilToInt(Direction.Size() / StepSize));
+	// Number of steps checked at once for empty values
+	constexpr int32 StepsPerSegment = 32;
+
+	const auto GetTime = [&](int32 Step)
+	{
+		return float(Step) / NumSteps;
+	};
+	const auto IsOverlapping = [&](float Time)
+	{
+		return VoxelQuerySphereOverlap(Data, Start + Time * Direction, Radius, nullptr);
+	};
+
+	int32 HitStep = -1;
+	for (int32 SegmentStart = 0; SegmentStart <= NumSteps && HitStep == -1; SegmentStart += StepsPerSegment)
+	{
+		const int32 SegmentEnd = FMath::Min(SegmentStart + StepsPerSegment, NumSteps + 1);
+
+		const FIntBox SegmentBounds = GetSweepBounds(Start + GetTime(SegmentStart) * Direction, Start + GetTime(SegmentEnd - 1) * Direction, Radius);
+		if (Data.GetValueRange(SegmentBounds.Overlap(GetSweepBounds(Start, End, Radius)), 0).Min.IsEmpty())
+		{
+			continue;
+		}
+
+		for (int32 Step = SegmentStart; Step < SegmentEnd; Step++)
+		{
+			if (IsOverlapping(GetTime(Step)))
+			{
+				HitStep = Step;
+				break;
+			}
+		}
+	}
+
+	if (HitStep == -1)
+	{
+		return Hit;
+	}
+
+	float HitTime = 0;
+	if (HitStep > 0)
+	{
+		float Low = GetTime(HitStep - 1);
+		float High = GetTime(HitStep);
+		for (int32 Iteration = 0; Iteration < 12; Iteration++)
+		{
+			const float Middle = (Low + High) / 2;
+			if (IsOverlapping(Middle))
+			{
+				High = Middle;
+			}
+			else
+			{
+				Low = Middle;
+			}
+		}
+		HitTime = High;
+	}
+
+	Hit.bHit = true;
+	Hit.Position = Start + HitTime * Direction;
+	Hit.Distance = HitTime * Direction.Size();
+
+	FVector Contact = Hit.Position;
+	ensure(VoxelQuerySphereOverlap(Data, Hit.Position, Radius, &Contact));
+	Hit.Normal = (Hit.Position - Contact).GetSafeNormal();
+	if (Hit.Normal.IsNearlyZero())
+	{
+		Hit.Normal = -Direction.GetSafeNormal();
+	}
+
+	return Hit;
+}
+
+bool UVoxelQueryTools::SphereOverlapImpl(
+	const FVoxelData& Data,
+	const FVector& Position,
+	float Radius)
+{
+	VOXEL_FUNCTION_COUNTER();
+	return VoxelQuerySphereOverlap(Data, Position, Radius, nullptr);
+}
+
+void UVoxelQueryTools::RaycastBatchImpl(
+	const FVoxelData& Data,
+	const TArray<FVoxelQueryRay>& Rays,
+	TArray<FVoxelQueryHit>& OutHits)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	OutHits.SetNum(Rays.Num());
+	ParallelFor(Rays.Num(), [&](int32 Index)
+	{
+		OutHits[Index] = RaycastImpl(Data, Rays[Index].Start, Rays[Index].End);
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+inline void VoxelQueryHitToWorldSpace(AVoxelWorld* World, const FVector& WorldStart, FVoxelQueryHit& Hit, bool bConvertToVoxelSpace)
+{
+	if (!bConvertToVoxelSpace || !Hit.bHit)
+	{
+		return;
+	}
+	Hit.Position = World->LocalToGlobalFloat(Hit.Position);
+	Hit.Normal = World->GetActorTransform().TransformVectorNoScale(Hit.Normal);
+	Hit.Distance = FVector::Distance(WorldStart, Hit.Position);
+}
+
+#define LINE_TRACE_TOOL_PREFIX \
+	const FVector WorldStart = Start; \
+	Start = FVoxelToolHelpers::GetRealPosition(World, Start, bConvertToVoxelSpace); \
+	End = FVoxelToolHelpers::GetRealPosition(World, End, bConvertToVoxelSpace); \
+	const auto Bounds = GetSweepBounds(Start, End, 0);
+
+#define LINE_TRACE_MULTI_TOOL_PREFIX \
+	TArray<FVoxelQueryRay> VoxelRays = Rays; \
+	FIntBoxWithValidity BoundsWithValidity; \
+	for (auto& Ray : VoxelRays) \
+	{ \
+		Ray.Start = FVoxelToolHelpers::GetRealPosition(World, Ray.Start, bConvertToVoxelSpace); \
+		Ray.End = FVoxelToolHelpers::GetRealPosition(World, Ray.End, bConvertToVoxelSpace); \
+		BoundsWithValidity += GetSweepBounds(Ray.Start, Ray.End, 0); \
+	} \
+	const auto Bounds = BoundsWithValidity.GetBox();
+
+#define SPHERE_SWEEP_TOOL_PREFIX \
+	const FVector WorldStart = Start; \
+	Radius = FVoxelToolHelpers::GetRealDistance(World, Radius, bConvertToVoxelSpace); \
+	Start = FVoxelToolHelpers::GetRealPosition(World, Start, bConvertToVoxelSpace); \
+	End = FVoxelToolHelpers::GetRealPosition(World, End, bConvertToVoxelSpace); \
+	const auto Bounds = GetSweepBounds(Start, End, Radius);
+
+#define SPHERE_OVERLAP_TOOL_PREFIX \
+	Radius = FVoxelToolHelpers::GetRealDistance(World, Radius, bConvertToVoxelSpace); \
+	Position = FVoxelToolHelpers::GetRealPosition(World, Position, bConvertToVoxelSpace); \
+	const auto Bounds = GetSweepBounds(Position, Position, Radius);
+
+void UVoxelQueryTools::VoxelLineTrace(
+	FVoxelQueryHit& Hit,
+	AVoxelWorld* World,
+	FVector Start,
+	FVector End,
+	bool bConvertToVoxelSpace)
+{
+	Hit = FVoxelQueryHit();
+	VOXEL_TOOL_HELPER(Read, DoNotUpdateRender, LINE_TRACE_TOOL_PREFIX, Hit = RaycastImpl(Data, Start, End));
+	VoxelQueryHitToWorldSpace(World, WorldStart, Hit, bConvertToVoxelSpace);
+}
+
+void UVoxelQueryTools::VoxelLineTraceMulti(
+	TArray<FVoxelQueryHit>& Hits,
+	AVoxelWorld* World,
+	const TArray<FVoxelQueryRay>& Rays,
+	bool bConvertToVoxelSpace)
+{
+	Hits.Reset();
+	if (Rays.Num() == 0)
+	{
+		return;
+	}
+
+	VOXEL_TOOL_HELPER(Read, DoNotUpdateRender, LINE_TRACE_MULTI_TOOL_PREFIX, RaycastBatchImpl(Data, VoxelRays, Hits));
+
+	for (int32 Index = 0; Index < Hits.Num(); Index++)
+	{
+		VoxelQueryHitToWorldSpace(World, Rays[Index].Start, Hits[Index], bConvertToVoxelSpace);
+	}
+}
+
+void UVoxelQueryTools::VoxelSphereSweep(
+	FVoxelQueryHit& Hit,
+	AVoxelWorld* World,
+	FVector Start,
+	FVector End,
+	float Radius,
+	bool bConvertToVoxelSpace)
+{
+	Hit = FVoxelQueryHit();
+	VOXEL_TOOL_HELPER(Read, DoNotUpdateRender, SPHERE_SWEEP_TOOL_PREFIX, Hit = SphereSweepImpl(Data, Start, End, Radius));
+	VoxelQueryHitToWorldSpace(World, WorldStart, Hit, bConvertToVoxelSpace);
+}
+
+void UVoxelQueryTools::VoxelSphereOverlap(
+	bool& bOverlap,
+	AVoxelWorld* World,
+	FVector Position,
+	float Radius,
+	bool bConvertToVoxelSpace)
+{
+	bOverlap = false;
+	VOXEL_TOOL_HELPER(Read, DoNotUpdateRender, SPHERE_OVERLAP_TOOL_PREFIX, bOverlap = SphereOverlapImpl(Data, Position, Radius));
+}
\ No newline at end of file
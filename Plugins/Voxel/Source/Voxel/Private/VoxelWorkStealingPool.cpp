@@ -0,0 +1,568 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelWorkStealingPool.h"
+#include "VoxelDefaultPool.h"
+#include "VoxelQueuedWork.h"
+#include "VoxelPoolStats.h"
+#include "VoxelGlobals.h"
+
+#include "HAL/Event.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformAffinity.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "Async/TaskGraphInterfaces.h"
+
+static TAutoConsoleVariable<int32> CVarWorkStealingPoolMaxBatchSize(
+	TEXT("voxel.threadpool.WorkStealingMaxBatchSize"),
+	16,
+	TEXT("Max number of works a thread of the work stealing pool moves from the shared queue to its own queue at once"),
+	ECVF_Default);
+
+class FVoxelWorkStealingThread : public FRunnable
+{
+public:
+	FVoxelWorkStealingPool& Pool;
+	const int32 ThreadIndex;
+	// Auto reset: a trigger before the wait isn't lost
+	FEvent* const WakeUpEvent;
+
+	FVoxelWorkStealingThread(FVoxelWorkStealingPool& Pool, int32 ThreadIndex, const FString& ThreadName)
+		: Pool(Pool)
+		, ThreadIndex(ThreadIndex)
+		, WakeUpEvent(FPlatformProcess::GetSynchEventFromPool()) // Create event BEFORE thread
+		, TimeToDie(false) // BEFORE creating thread
+		, Thread(FRunnableThread::Create(this, *ThreadName, 1024 * 1024, EThreadPriority::TPri_Normal, FPlatformAffinity::GetPoolThreadMask()))
+	{
+		check(Thread.IsValid());
+	}
+	~FVoxelWorkStealingThread()
+	{
+		TimeToDie = true;
+		WakeUpEvent->Trigger();
+		Thread->WaitForCompletion();
+		FPlatformProcess::ReturnSynchEventToPool(WakeUpEvent);
+	}
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override
+	{
+		while (!TimeToDie)
+		{
+			IVoxelQueuedWork* Work = Pool.GetNextWork(ThreadIndex);
+			while (Work)
+			{
+				FVoxelPoolStats::DoThreadedWork(*Work);
+				Work = Pool.GetNextWork(ThreadIndex);
+			}
+
+			VOXEL_SCOPE_COUNTER("FVoxelWorkStealingThread::Run.WaitForWork");
+			WakeUpEvent->Wait();
+		}
+		return 0;
+	}
+	//~ End FRunnable Interface
+
+private:
+	FThreadSafeBool TimeToDie;
+	const TUniquePtr<FRunnableThread> Thread;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelWorkStealingPool::FVoxelWorkStealingPool(
+	int32 ThreadCount,
+	const TMap<EVoxelTaskType, int32>& InPriorityCategories,
+	const TMap<EVoxelTaskType, int32>& InPriorityOffsets)
+{
+	for (int32 Index = 0; Index < 256; Index++)
+	{
+		const_cast<TStaticArray<uint32, 256>&>(PriorityCategories)[Index] = InPriorityCategories.FindRef(EVoxelTaskType(Index));
+		const_cast<TStaticArray<uint32, 256>&>(PriorityOffsets)[Index] = InPriorityOffsets.FindRef(EVoxelTaskType(Index));
+	}
+
+	TRACE_THREAD_GROUP_SCOPE("VoxelWorkStealingPool");
+
+	const uint64 PoolId = UNIQUE_ID();
+	for (int32 ThreadIndex = 0; ThreadIndex < ThreadCount; ThreadIndex++)
+	{
+		ThreadQueues.Add(MakeUnique<FWorkQueue>());
+	}
+	// Queues must be created before any thread starts
+	Threads.Reserve(ThreadCount);
+	for (int32 ThreadIndex = 0; ThreadIndex < ThreadCount; ThreadIndex++)
+	{
+		const FString Name = FString::Printf(TEXT("Work Stealing Pool %llu Thread %d"), PoolId, ThreadIndex);
+		Threads.Add(MakeUnique<FVoxelWorkStealingThread>(*this, ThreadIndex, Name));
+	}
+	FVoxelPoolStats::AddThreads(ThreadCount);
+}
+
+FVoxelWorkStealingPool::~FVoxelWorkStealingPool()
+{
+	if (!TimeToDie)
+	{
+		AbandonAllTasks();
+	}
+	// Stop the threads before the queues are destroyed
+	FVoxelPoolStats::AddThreads(-Threads.Num());
+	Threads.Reset();
+}
+
+TVoxelSharedRef<FVoxelWorkStealingPool> FVoxelWorkStealingPool::Create(
+	int32 ThreadCount,
+	const TMap<EVoxelTaskType, int32>& PriorityCategories,
+	const TMap<EVoxelTaskType, int32>& PriorityOffsets)
+{
+	UE_LOG(LogVoxel, Log, TEXT("Creating work stealing pool with %d threads"), ThreadCount);
+	if (!ensureMsgf(ThreadCount >= 1, TEXT("Invalid MeshThreadCount: %d"), ThreadCount))
+	{
+		ThreadCount = 1;
+	}
+
+	auto FixedPriorityCategories = PriorityCategories;
+	auto FixedPriorityOffsets = PriorityOffsets;
+	FVoxelDefaultPool::FixPriorityCategories(FixedPriorityCategories);
+	FVoxelDefaultPool::FixPriorityOffsets(FixedPriorityOffsets);
+
+	const TVoxelSharedRef<FVoxelWorkStealingPool> Pool = MakeShareable(new FVoxelWorkStealingPool(
+		ThreadCount,
+		FixedPriorityCategories,
+		FixedPriorityOffsets));
+
+	TFunction<void()> ShutdownCallback = [WeakPool = MakeVoxelWeakPtr(Pool)]()
+	{
+		auto PoolPtr = WeakPool.Pin();
+		if (PoolPtr.IsValid() && !PoolPtr->TimeToDie)
+		{
+			PoolPtr->AbandonAllTasks();
+		}
+	};
+	FTaskGraphInterface::Get().AddShutdownCallback(ShutdownCallback);
+
+	return Pool;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelWorkStealingPool::QueueTask(EVoxelTaskType Type, IVoxelQueuedWork* Task)
+{
+	QueueTasks(Type, { Task });
+}
+
+void FVoxelWorkStealingPool::QueueTasks(EVoxelTaskType Type, const TArray<IVoxelQueuedWork*>& Tasks)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (Tasks.Num() == 0)
+	{
+		return;
+	}
+
+	if (TimeToDie)
+	{
+		for (auto* Task : Tasks)
+		{
+			Task->Abandon();
+		}
+		return;
+	}
+
+	{
+		VOXEL_SCOPE_COUNTER("Add Works");
+		const uint64 PriorityCategory = PriorityCategories[uint8(Type)];
+		const int32 PriorityOffset = PriorityOffsets[uint8(Type)];
+
+		FVoxelPoolStats::ReportQueued(Type, PriorityCategory, Tasks);
+
+		// Before enqueuing, so that the threads can't miss a work
+		InjectionQueue.NumWorks.Add(Tasks.Num());
+
+		for (auto* Task : Tasks)
+		{
+			check(Task);
+			const uint32 Priority = FMath::Clamp<int64>(int64(Task->GetPriority()) + PriorityOffset, MIN_uint32, MAX_uint32);
+			NewWorks.Enqueue({ Task, (PriorityCategory << 32) | Priority });
+		}
+	}
+
+	if (TimeToDie)
+	{
+		// AbandonAllTasks might have flushed the queue before we enqueued our works
+		FScopeLock Lock(&InjectionQueue.Section);
+		FlushNewWorks();
+		AbandonWorks(InjectionQueue);
+		return;
+	}
+
+	// Must be done after the works are added: see GetNextWork
+	WakeUpThreads(Tasks.Num());
+}
+
+int32 FVoxelWorkStealingPool::GetNumTasks() const
+{
+	// Not really thread safe, only use this for debug
+	// Also count active threads
+	int32 NumTasks = InjectionQueue.NumWorks.GetValue() + Threads.Num() - NumIdleThreads.GetValue();
+	for (auto& Queue : ThreadQueues)
+	{
+		NumTasks += Queue->NumWorks.GetValue();
+	}
+	return NumTasks;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+IVoxelQueuedWork* FVoxelWorkStealingPool::GetNextWork(int32 ThreadIndex)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	FWorkQueue& OwnQueue = *ThreadQueues[ThreadIndex];
+
+	while (true)
+	{
+		if (TimeToDie)
+		{
+			break;
+		}
+
+		// First our own works
+		if (IVoxelQueuedWork* Work = PopWork(OwnQueue))
+		{
+			return Work;
+		}
+
+		// Then take a batch of the best new works
+		if (InjectionQueue.NumWorks.GetValue() > 0)
+		{
+			IVoxelQueuedWork* Work = nullptr;
+			int32 NumMoved = 0;
+			{
+				FScopeLock Lock(&InjectionQueue.Section);
+				FlushNewWorks();
+				const int32 Num = InjectionQueue.Works.Num();
+				if (Num > 0 && !TimeToDie)
+				{
+					// Leave some works for the other threads
+					const int32 BatchSize = FMath::Clamp(Num / ThreadQueues.Num(), 1, FMath::Max(1, CVarWorkStealingPoolMaxBatchSize.GetValueOnAnyThread()));
+
+					FQueuedWork QueuedWork;
+					InjectionQueue.Works.HeapPop(QueuedWork, false);
+					Work = QueuedWork.Work;
+
+					FScopeLock OwnLock(&OwnQueue.Section);
+					for (NumMoved = 0; NumMoved < BatchSize - 1; NumMoved++)
+					{
+						InjectionQueue.Works.HeapPop(QueuedWork, false);
+						OwnQueue.Works.HeapPush(QueuedWork);
+					}
+					OwnQueue.NumWorks.Add(NumMoved);
+					InjectionQueue.NumWorks.Subtract(NumMoved + 1);
+				}
+			}
+			if (Work)
+			{
+				// Let idle threads steal the rest of the batch
+				WakeUpThreads(NumMoved);
+				return Work;
+			}
+		}
+
+		// Finally steal from the other threads, starting with the next one to spread the stealing
+		for (int32 Offset = 1; Offset < ThreadQueues.Num(); Offset++)
+		{
+			if (IVoxelQueuedWork* Work = PopWork(*ThreadQueues[(ThreadIndex + Offset) % ThreadQueues.Num()]))
+			{
+				return Work;
+			}
+		}
+
+		FScopeLock Lock(&IdleSection);
+		// Register before checking again: QueueTasks adds its works before reading NumIdleThreads, so one of us sees the other
+		IdleThreads.Add(ThreadIndex);
+		NumIdleThreads.Increment();
+		if (TimeToDie || !HasQueuedWorks())
+		{
+			return nullptr;
+		}
+		IdleThreads.Pop(false);
+		NumIdleThreads.Decrement();
+	}
+
+	FScopeLock Lock(&IdleSection);
+	IdleThreads.Add(ThreadIndex);
+	NumIdleThreads.Increment();
+	return nullptr;
+}
+
+void FVoxelWorkStealingPool::AbandonAllTasks()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	ensure(!TimeToDie);
+
+	TimeToDie = true;
+
+	{
+		FScopeLock Lock(&InjectionQueue.Section);
+		FlushNewWorks();
+		AbandonWorks(InjectionQueue);
+	}
+	for (auto& Queue : ThreadQueues)
+	{
+		FScopeLock Lock(&Queue->Section);
+		AbandonWorks(*Queue);
+	}
+
+	// Wake up everyone so that they see TimeToDie, and wait for all threads to finish up
+	WakeUpThreads(Threads.Num());
+	while (true)
+	{
+		{
+			FScopeLock Lock(&IdleSection);
+			if (IdleThreads.Num() == Threads.Num())
+			{
+				break;
+			}
+		}
+		FPlatformProcess::Sleep(0.0f);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+bool FVoxelWorkStealingPool::HasQueuedWorks() const
+{
+	if (InjectionQueue.NumWorks.GetValue() > 0)
+	{
+		return true;
+	}
+	for (auto& Queue : ThreadQueues)
+	{
+		if (Queue->NumWorks.GetValue() > 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FVoxelWorkStealingPool::WakeUpThreads(int32 Num)
+{
+	// Safe to check without locking: the idle threads register before checking for works, see GetNextWork
+	if (Num <= 0 || NumIdleThreads.GetValue() == 0)
+	{
+		return;
+	}
+
+	VOXEL_FUNCTION_COUNTER();
+
+	FScopeLock Lock(&IdleSection);
+	while (Num-- > 0 && IdleThreads.Num() > 0)
+	{
+		Threads[IdleThreads.Pop(false)]->WakeUpEvent->Trigger();
+		NumIdleThreads.Decrement();
+	}
+}
+
+IVoxelQueuedWork* FVoxelWorkStealingPool::PopWork(FWorkQueue& Queue)
+{
+	if (Queue.NumWorks.GetValue() == 0)
+	{
+		return nullptr;
+	}
+
+	FScopeLock Lock(&Queue.Section);
+	if (Queue.Works.Num() == 0)
+	{
+		// Another thread was faster
+		return nullptr;
+	}
+
+	FQueuedWork Work;
+	Queue.Works.HeapPop(Work, false);
+	Queue.NumWorks.Decrement();
+	return Work.Work;
+}
+
+void FVoxelWorkStealingPool::FlushNewWorks()
+{
+	FQueuedWork Work;
+	while (NewWorks.Dequeue(Work))
+	{
+		InjectionQueue.Works.HeapPush(Work);
+	}
+}
+
+void FVoxelWorkStealingPool::AbandonWorks(FWorkQueue& Queue)
+{
+	for (auto& Work : Queue.Works)
+	{
+		Work.Work->Abandon();
+	}
+	Queue.NumWorks.Subtract(Queue.Works.Num());
+	Queue.Works.Reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+struct FVoxelPoolBenchmarkStats
+{
+	FThreadSafeCounter NumDone;
+	// In microseconds, by task type
+	FThreadSafeCounter64 TotalWaitTime[256];
+	volatile int64 MaxWaitTime[256] = {};
+	FThreadSafeCounter NumWorks[256];
+};
+
+class FVoxelPoolBenchmarkWork : public IVoxelQueuedWork
+{
+public:
+	FVoxelPoolBenchmarkWork(FVoxelPoolBenchmarkStats& Stats, EVoxelTaskType Type, double Duration, uint32 Priority)
+		: IVoxelQueuedWork(STATIC_FNAME("Pool Benchmark"), 0)
+		, Stats(Stats)
+		, Type(Type)
+		, Duration(Duration)
+		, Priority(Priority)
+	{
+	}
+
+	//~ Begin IVoxelQueuedWork Interface
+	virtual void DoThreadedWork() override
+	{
+		// QueueTime is set by the pools
+		const double StartTime = FPlatformTime::Seconds();
+		const int64 WaitTime = int64((StartTime - QueueTime) * 1e6);
+		Stats.TotalWaitTime[uint8(Type)].Add(WaitTime);
+		Stats.NumWorks[uint8(Type)].Increment();
+		int64 MaxWaitTime = Stats.MaxWaitTime[uint8(Type)];
+		while (WaitTime > MaxWaitTime)
+		{
+			const int64 PreviousMaxWaitTime = FPlatformAtomics::InterlockedCompareExchange(&Stats.MaxWaitTime[uint8(Type)], WaitTime, MaxWaitTime);
+			if (PreviousMaxWaitTime == MaxWaitTime) break;
+			MaxWaitTime = PreviousMaxWaitTime;
+		}
+
+		// Simulate the work
+		while (FPlatformTime::Seconds() < StartTime + Duration)
+		{
+		}
+
+		Stats.NumDone.Increment();
+	}
+	virtual void Abandon() override
+	{
+		Stats.NumDone.Increment();
+	}
+	virtual uint32 GetPriority() const override
+	{
+		return Priority;
+	}
+	//~ End IVoxelQueuedWork Interface
+
+private:
+	FVoxelPoolBenchmarkStats& Stats;
+	const EVoxelTaskType Type;
+	const double Duration;
+	const uint32 Priority;
+};
+
+// Simulates a few seconds of a voxel world being generated while moving: every frame, a mix of short and long tasks is queued
+static void BenchmarkPool(IVoxelPool& Pool, const FString& PoolName, int32 NumFrames)
+{
+	struct FTaskMix
+	{
+		EVoxelTaskType Type;
+		const TCHAR* Name;
+		int32 NumPerFrame;
+		// In seconds
+		double Duration;
+	};
+	static const FTaskMix TaskMixes[] =
+	{
+		{ EVoxelTaskType::RenderOctree, TEXT("RenderOctree"), 1, 0.0002 },
+		{ EVoxelTaskType::VisibleChunksMeshing, TEXT("VisibleChunksMeshing"), 24, 0.0004 },
+		{ EVoxelTaskType::VisibleCollisionsChunksMeshing, TEXT("VisibleCollisionsChunksMeshing"), 4, 0.0004 },
+		{ EVoxelTaskType::ChunksMeshing, TEXT("ChunksMeshing"), 8, 0.0004 },
+		{ EVoxelTaskType::MeshMerge, TEXT("MeshMerge"), 28, 0.00003 },
+		{ EVoxelTaskType::CollisionCooking, TEXT("CollisionCooking"), 4, 0.001 },
+		{ EVoxelTaskType::AsyncEditFunctions, TEXT("AsyncEditFunctions"), 4, 0.00005 },
+		{ EVoxelTaskType::FoliageBuild, TEXT("FoliageBuild"), 2, 0.002 },
+		{ EVoxelTaskType::HISMBuild, TEXT("HISMBuild"), 2, 0.0005 },
+		{ EVoxelTaskType::ChunksPrefetch, TEXT("ChunksPrefetch"), 8, 0.0004 },
+	};
+
+	FVoxelPoolBenchmarkStats Stats;
+	TArray<TUniquePtr<FVoxelPoolBenchmarkWork>> AllWorks;
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		const double FrameStartTime = FPlatformTime::Seconds();
+		for (auto& TaskMix : TaskMixes)
+		{
+			TArray<IVoxelQueuedWork*> Works;
+			for (int32 Index = 0; Index < TaskMix.NumPerFrame; Index++)
+			{
+				auto* Work = new FVoxelPoolBenchmarkWork(Stats, TaskMix.Type, TaskMix.Duration, FMath::Rand());
+				AllWorks.Emplace(Work);
+				Works.Add(Work);
+			}
+			Pool.QueueTasks(TaskMix.Type, Works);
+		}
+		// 60 FPS
+		const double TimeLeft = FrameStartTime + 1. / 60 - FPlatformTime::Seconds();
+		if (TimeLeft > 0)
+		{
+			FPlatformProcess::Sleep(TimeLeft);
+		}
+	}
+	while (Stats.NumDone.GetValue() < AllWorks.Num())
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+	const double TotalTime = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogVoxel, Log, TEXT("%s: %d tasks in %fs (%d frames)"), *PoolName, AllWorks.Num(), TotalTime, NumFrames);
+	for (auto& TaskMix : TaskMixes)
+	{
+		const int32 Num = FMath::Max(1, Stats.NumWorks[uint8(TaskMix.Type)].GetValue());
+		UE_LOG(LogVoxel, Log, TEXT("\t%s: average wait: %.3fms; max wait: %.3fms"),
+			TaskMix.Name,
+			Stats.TotalWaitTime[uint8(TaskMix.Type)].GetValue() / 1000. / Num,
+			Stats.MaxWaitTime[uint8(TaskMix.Type)] / 1000.);
+	}
+}
+
+static void BenchmarkPools(const TArray<FString>& Args)
+{
+	const int32 NumThreads = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 4;
+	const int32 NumFrames = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 300;
+
+	const TMap<EVoxelTaskType, int32> Empty;
+	{
+		const auto Pool = FVoxelDefaultPool::Create(NumThreads, false, Empty, Empty);
+		BenchmarkPool(*Pool, FString::Printf(TEXT("Default pool (%d threads)"), NumThreads), NumFrames);
+	}
+	{
+		const auto Pool = FVoxelWorkStealingPool::Create(NumThreads, Empty, Empty);
+		BenchmarkPool(*Pool, FString::Printf(TEXT("Work stealing pool (%d threads)"), NumThreads), NumFrames);
+	}
+}
+
+static FAutoConsoleCommand BenchmarkPoolsCmd(
+	TEXT("voxel.threadpool.BenchmarkPools"),
+	TEXT("Compare the default pool and the work stealing pool on a mix of voxel tasks. Args: NumThreads (default 4), NumFrames (default 300). Blocks the game thread while running"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkPools));
\ No newline at end of file
@@ -695,7 +695,7 @@ TVoxelSharedRef<IVoxelPool> AVoxelWorld::CreatePool() const
 
 	const auto CreateOwnPool = [&](int32 InNumberOfThreads, bool bInConstantPriorities)
 	{
-		return FVoxelDefaultPool::Create(
+		return IVoxelPool::Create(
 			FMath::Max(1, InNumberOfThreads),
 			bInConstantPriorities,
 			PriorityCategories,
@@ -31,7 +31,10 @@ enum class EVoxelTaskType : uint8
 	MeshMerge,
 	// The render octree is used to determine the LODs to display
 	// Should be done as fast as possible to start meshing tasks
-	RenderOctree
+	RenderOctree,
+	// Meshing of the chunks ahead of fast invokers, see UVoxelInvokerComponent::bEnablePrefetch
+	// The meshes are only stored in the mesh cache until they are needed
+	ChunksPrefetch
 };
 
 class FVoxelQueuedThreadPool;
@@ -45,12 +48,21 @@ public:
 	virtual ~IVoxelPool() {}
 
 	//~ Begin IVoxelPool Interface
+	// Can be called from any thread
 	virtual void QueueTask(EVoxelTaskType Type, IVoxelQueuedWork* Task) = 0;
 	virtual void QueueTasks(EVoxelTaskType Type, const TArray<IVoxelQueuedWork*>& Tasks) = 0;
 
 	virtual int32 GetNumTasks() const = 0;
 	//~ End IVoxelPool Interface
 
+public:
+	// Creates a FVoxelDefaultPool, or a FVoxelWorkStealingPool if voxel.threadpool.UseWorkStealingPool is true
+	static TVoxelSharedRef<IVoxelPool> Create(
+		int32 NumberOfThreads,
+		bool bConstantPriorities,
+		const TMap<EVoxelTaskType, int32>& PriorityCategories,
+		const TMap<EVoxelTaskType, int32>& PriorityOffsets);
+
 public:
 	static TVoxelSharedPtr<IVoxelPool> GetGlobalPool(UWorld* World);
 	static const FString& GetGlobalPoolCreator(UWorld* World);
@@ -4,6 +4,30 @@
 
 #include "CoreMinimal.h"
 #include "VoxelQueuedWork.h"
+#include "VoxelSharedPtr.h"
+
+enum class EVoxelTaskType : uint8;
+class IVoxelPool;
+
+// Lets a running work stop early once it's canceled: check it at natural points, eg once per Z slice
+// Only valid while the work is running. Default constructed tokens are never canceled
+class FVoxelCancelToken
+{
+public:
+	FVoxelCancelToken() = default;
+	explicit FVoxelCancelToken(const FThreadSafeCounter& CanceledCounter)
+		: CanceledCounter(&CanceledCounter)
+	{
+	}
+
+	inline bool IsCanceled() const
+	{
+		return CanceledCounter && CanceledCounter->GetValue() > 0;
+	}
+
+private:
+	const FThreadSafeCounter* CanceledCounter = nullptr;
+};
 
 class VOXEL_API FVoxelAsyncWork : public IVoxelQueuedWork
 {
@@ -28,6 +52,14 @@ public:
 	// @return: IsDone and PostDoWork was called
 	bool CancelAndAutodelete();
 
+	// Queue Work once this work is done, directly from the pool thread: used to chain tasks without going through the game thread
+	// Must be called from DoWork. Work is abandoned if this work is canceled, or if the pool is destroyed
+	void AddContinuation(const TVoxelWeakPtr<IVoxelPool>& Pool, EVoxelTaskType Type, IVoxelQueuedWork* Work);
+
+	// To give to the code called by DoWork, so that it can stop once CancelAndAutodelete is called
+	// Never canceled if voxel.threadpool.CooperativeCancel is false
+	FVoxelCancelToken GetCancelToken() const;
+
 	bool IsDone() const
 	{
 		return IsDoneCounter.GetValue() > 0;
@@ -56,6 +88,25 @@ private:
 	bool bAutodelete = false;
 
 	FThreadSafeCounter WasAbandonedCounter;
+
+	struct FContinuation
+	{
+		TVoxelWeakPtr<IVoxelPool> Pool;
+		EVoxelTaskType Type;
+		IVoxelQueuedWork* Work;
+	};
+	TArray<FContinuation> Continuations;
+
+	static void QueueContinuations(TArray<FContinuation>&& Continuations, bool bCanceled);
+};
+
+// To own a work with a TUniquePtr while it might still be in a pool
+struct FVoxelAsyncWorkCancelAndAutodelete
+{
+	void operator()(FVoxelAsyncWork* Work) const
+	{
+		Work->CancelAndAutodelete();
+	}
 };
 
 class VOXEL_API FVoxelAsyncWorkWithWait : public FVoxelAsyncWork
@@ -26,6 +26,25 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Voxel", meta = (EditCondition = bEnablePrediction, ClampMin = 0))
 		float PredictionTime = 1;
 
+	// Will mesh ahead of time, at a lower priority, the chunks needed at the position the invoker will be at in PrefetchTime seconds
+	// Unlike prediction, the LODs around the current position are unchanged
+	// The meshes are stored in the voxel world mesh cache: Mesh Cache Size In MB must be > 0
+	UPROPERTY(EditAnywhere, Category = "Voxel", meta = (EditCondition = bUseForLODs))
+		bool bEnablePrefetch = false;
+
+	// In seconds
+	UPROPERTY(EditAnywhere, Category = "Voxel", meta = (EditCondition = bEnablePrefetch, ClampMin = 0))
+		float PrefetchTime = 2;
+
+	// If true, the chunks in the player camera view will be meshed first
+	// Only used if the invoker is owned by a player pawn, or is an auto camera invoker
+	UPROPERTY(EditAnywhere, Category = "Voxel")
+		bool bPrioritizeChunksInView = true;
+
+	// When computing task priorities, the distance to chunks out of view is multiplied by this
+	UPROPERTY(EditAnywhere, Category = "Voxel", meta = (EditCondition = bPrioritizeChunksInView, ClampMin = 1))
+		float OutOfViewDistanceMultiplier = 4;
+
 	UPROPERTY(EditAnywhere, Category = "Voxel")
 		bool bUseForLODs = true;
 
@@ -45,6 +64,10 @@ public:
 	bool IsLocalInvoker() const;
 
 	virtual FVector GetPosition() const;
+	// In cm/s
+	virtual FVector GetVelocity() const;
+	// OutFOV is in degrees. Returns false if there's no view to use
+	virtual bool GetView(FVector& OutDirection, float& OutFOV) const;
 
 public:
 	static const TArray<TWeakObjectPtr<UVoxelInvokerComponent>>& GetInvokers(UWorld* World);
@@ -74,4 +97,6 @@ public:
 	UVoxelInvokerAutoCameraComponent();
 
 	virtual FVector GetPosition() const override;
+	virtual FVector GetVelocity() const override;
+	virtual bool GetView(FVector& OutDirection, float& OutFOV) const override;
 };
\ No newline at end of file
@@ -10,9 +10,20 @@ enum class EVoxelRenderType : uint8
 {
 	MarchingCubes,
 	Cubic,
-	SurfaceNets
+	SurfaceNets,
+	// Places the vertices using the normals of the surface: keeps sharp edges & corners
+	DualContouring
 };
 
+namespace FVoxelUtilities
+{
+	// Surface Nets & Dual Contouring don't have transition meshes: their vertices are morphed to their parent position instead
+	FORCEINLINE bool UsesParentPositionTransitions(EVoxelRenderType RenderType)
+	{
+		return RenderType == EVoxelRenderType::SurfaceNets || RenderType == EVoxelRenderType::DualContouring;
+	}
+}
+
 UENUM(BlueprintType)
 enum class EVoxelNormalConfig : uint8
 {
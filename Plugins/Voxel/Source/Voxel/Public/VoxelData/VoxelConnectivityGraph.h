@@ -0,0 +1,51 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGlobals.h"
+#include "IntBox.h"
+
+class FVoxelData;
+
+// Connected components of the solid voxels of a data chunk
+struct FVoxelConnectivityChunk
+{
+	// Part of the chunk that was flood filled
+	FIntBox Bounds;
+	// FVoxelData::GetEditVersion of Bounds when computed
+	uint64 EditVersion = 0;
+	int32 NumComponents = 0;
+	// Component of the voxels on the faces of Bounds, 0 if empty. Components start at 1
+	// Faces order: -X, +X, -Y, +Y, -Z, +Z
+	TArray<uint16> FaceLabels[6];
+};
+
+/**
+ * Used to find the floating parts of the data without flood filling the whole bounds every time
+ * The solid voxels are split in connected components per data chunk, which are cached with the chunk edit version:
+ * only the chunks edited since the last query are flood filled again, in parallel
+ * The components of neighboring chunks are then merged using an union find over the chunk faces
+ * Owned by FVoxelData. Thread safe
+ */
+class VOXEL_API FVoxelConnectivityGraph
+{
+public:
+	// Requires read lock in Bounds
+	// OutFloatingVoxels: the solid voxels in Bounds that are not connected to the faces of Bounds, using only voxels in Bounds
+	void FindFloatingVoxels(const FVoxelData& Data, const FIntBox& Bounds, TArray<FIntVector>& OutFloatingVoxels);
+
+	void ClearCache();
+
+private:
+	struct FCachedChunk
+	{
+		TVoxelSharedPtr<const FVoxelConnectivityChunk> Chunk;
+		uint64 LastUsed = 0;
+	};
+
+	FCriticalSection Section;
+	// Only chunks entirely inside the query bounds are cached, as the others depend on the bounds
+	TMap<FIntVector, FCachedChunk> Chunks;
+	uint64 NumQueries = 0;
+};
\ No newline at end of file
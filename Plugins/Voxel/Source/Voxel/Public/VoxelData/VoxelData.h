@@ -21,6 +21,7 @@ class FVoxelData;
 class AVoxelWorld;
 class FVoxelWorldGeneratorInstance;
 class FVoxelPlaceableItem;
+class FVoxelConnectivityGraph;
 
 DECLARE_DWORD_COUNTER_STAT(TEXT("Edited Voxels"), STAT_EditedVoxels, STATGROUP_Voxel);
 
@@ -40,6 +41,7 @@ private:
 
 	FName Name;
 	EVoxelLockType LockType = EVoxelLockType::Read;
+	FIntBox Bounds;
 	TArray<FVoxelOctreeId> LockedOctrees; // In depth first order
 
 	friend class FVoxelData;
@@ -353,6 +355,47 @@ private:
 	TArray<FIntBox> RedoFramesBounds;
 	bool bIsDirty = false;
 
+public:
+	/**
+	 * Edit versions
+	 */
+
+	// Returns a number that increases every time the data in Bounds is write locked. No lock required
+	// Conservative: edits close to Bounds might increase it too
+	// Can be used to check if something computed from the data is still up to date
+	uint64 GetEditVersion(const FIntBox& Bounds) const;
+
+private:
+	struct FEditVersion
+	{
+		// Last write recorded at this level
+		uint64 Direct = 0;
+		// Last write recorded at this level or at a lower one
+		uint64 Subtree = 0;
+	};
+	// One map per octree height: cells are DATA_CHUNK_SIZE << Height wide, like the octree nodes
+	// Kept outside of the octree so that it can be read without locking it
+	// Writes are recorded at the lowest height where they don't cover too many cells
+	mutable FCriticalSection EditVersionsSection;
+	mutable TArray<TMap<FIntVector, FEditVersion>> EditVersions;
+	mutable uint64 EditVersionsCounter = 0;
+
+	void IncrementEditVersion(const FIntBox& Bounds) const;
+
+public:
+	/**
+	 * Connectivity
+	 */
+
+	// Connected components of the solid voxels, cached per data chunk using the edit versions. Used to find floating parts
+	FORCEINLINE FVoxelConnectivityGraph& GetConnectivityGraph() const
+	{
+		return *ConnectivityGraph;
+	}
+
+private:
+	const TVoxelSharedRef<FVoxelConnectivityGraph> ConnectivityGraph;
+
 public:
 	/**
 	 * Placeable items
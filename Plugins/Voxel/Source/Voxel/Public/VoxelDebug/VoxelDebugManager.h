@@ -12,6 +12,7 @@ class IVoxelPool;
 class FVoxelData;
 class AVoxelWorld;
 class UVoxelProceduralMeshComponent;
+class UVoxelInvokerComponent;
 
 struct FVoxelDebugManagerSettings
 {
@@ -49,6 +50,17 @@ public:
 	void ReportChunkEmptyState(const FIntBox& Bounds, bool bIsEmpty);
 	void ClearChunksEmptyStates();
 
+	// Measure the time it takes to mesh all the chunks in the invokers view, eg after a teleport
+	void StartTimeToVisibleMeasure();
+	inline bool IsMeasuringTimeToVisible() const
+	{
+		return TimeToVisibleStartTime > 0;
+	}
+	// TaskStartTime: time at which the render octree task was started, using FPlatformTime::Seconds
+	void ReportRenderOctreeUpdate(double TaskStartTime);
+	// Number of visible chunks in view still waiting for their main mesh task. Only reported when IsMeasuringTimeToVisible
+	void ReportInViewMeshTaskCount(int32 Num);
+
 public:
 	static bool ShowCollisionAndNavmeshDebug();
 	static FColor GetCollisionAndNavmeshDebugColor(bool bEnableCollisions, bool bEnableNavmesh);
@@ -77,4 +89,15 @@ private:
 		bool bIsEmpty;
 	};
 	TArray<FChunkEmptyState> ChunksEmptyStates;
+
+	// 0 if not measuring
+	double TimeToVisibleStartTime = 0;
+	// 0 until a render octree started after TimeToVisibleStartTime is applied
+	double TimeToVisibleOctreeUpdateTime = 0;
+	// -1 until reported by the renderer
+	int32 InViewMeshTaskCount = -1;
+	// Used to detect teleports
+	TMap<TWeakObjectPtr<UVoxelInvokerComponent>, FVector> InvokersPositions;
+
+	void UpdateTimeToVisibleMeasure();
 };
\ No newline at end of file
@@ -0,0 +1,66 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGlobals.h"
+
+// Game thread work sharing the voxel frame budget
+enum class EVoxelFrameBudgetCategory : uint8
+{
+	// Only accounted for, never deferred
+	Multiplayer,
+	Renderer,
+	// Physics cookers callbacks of the renderer
+	PhysicsCallbacks,
+	InstancedMeshes,
+	Spawners,
+	Count
+};
+
+// Distributes a game thread time budget between the voxel tickables, by priority
+// The budget adapts to the game thread time of the previous frame, to stay under voxel.scheduler.TargetFPS
+// Work that doesn't fit in the budget stays queued and is processed in the next frames
+class VOXEL_API FVoxelFrameScheduler
+{
+public:
+	// Time at which the category should stop working this frame
+	static double BeginWork(EVoxelFrameBudgetCategory Category);
+	// NumDeferred: number of work items left for the next frames
+	static void EndWork(EVoxelFrameBudgetCategory Category, double StartTime, int32 NumDeferred);
+};
+
+// Use GetMaxTime to know when to stop working, and SetNumDeferred to report the work left
+class FVoxelFrameBudgetScope
+{
+public:
+	explicit FVoxelFrameBudgetScope(EVoxelFrameBudgetCategory Category)
+		: Category(Category)
+		, StartTime(FPlatformTime::Seconds())
+		, MaxTime(FVoxelFrameScheduler::BeginWork(Category))
+	{
+	}
+	~FVoxelFrameBudgetScope()
+	{
+		FVoxelFrameScheduler::EndWork(Category, StartTime, NumDeferred);
+	}
+
+	inline double GetMaxTime() const
+	{
+		return MaxTime;
+	}
+	inline bool HasTimeLeft() const
+	{
+		return FPlatformTime::Seconds() < MaxTime;
+	}
+	inline void SetNumDeferred(int32 InNumDeferred)
+	{
+		NumDeferred = InNumDeferred;
+	}
+
+private:
+	const EVoxelFrameBudgetCategory Category;
+	const double StartTime;
+	const double MaxTime;
+	int32 NumDeferred = 0;
+};
\ No newline at end of file
@@ -75,12 +75,6 @@
 #define ENABLE_MESHER_STATS (!UE_BUILD_SHIPPING)
 #endif
 
-// No support for indices optimizations on some platforms
-// Note: I have yet to find any performance improvements due to this
-#ifndef ENABLE_OPTIMIZE_INDICES
-#define ENABLE_OPTIMIZE_INDICES PLATFORM_WINDOWS
-#endif
-
 #ifndef EIGHT_BITS_VOXEL_VALUE
 #define EIGHT_BITS_VOXEL_VALUE 0
 #endif
@@ -0,0 +1,96 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGlobals.h"
+#include "IVoxelPool.h"
+#include "VoxelPoolStats.generated.h"
+
+class IVoxelQueuedWork;
+
+// Stats of the works of a task type since the last FVoxelPoolStats::Reset. Times are in ms
+USTRUCT(BlueprintType)
+struct VOXEL_API FVoxelPoolTaskTypeStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		EVoxelTaskType TaskType = EVoxelTaskType(0);
+
+	// Priority category given to this task type by the last pool that queued it
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		int32 PriorityCategory = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		int32 NumQueued = 0;
+
+	// Includes the works canceled before they started, as they are still dequeued by a thread
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		int32 NumRun = 0;
+
+	// Canceled before starting
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		int32 NumCanceled = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		int32 NumCanceledWhileRunning = 0;
+
+	// Abandoned when a pool is destroyed
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		int32 NumAbandoned = 0;
+
+	// Works run per second
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		float Throughput = 0;
+
+	// Time between the work being queued and a thread starting it
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		float AverageWaitTime = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		float MedianWaitTime = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		float P95WaitTime = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		float MaxWaitTime = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		float AverageRunTime = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		float MedianRunTime = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		float P95RunTime = 0;
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		float MaxRunTime = 0;
+
+	// Part of the pool threads time spent running this task type, between 0 and 1
+	UPROPERTY(BlueprintReadOnly, Category = "Voxel")
+		float Utilization = 0;
+};
+
+// Latency and throughput of the works run by the voxel pools, per task type. Shared by all the pools
+// Medians and percentiles are approximated using power of 2 histograms
+// See voxel.threadpool.Stats.Print/Reset/ExportCSV and UVoxelBlueprintLibrary::GetVoxelPoolStats
+class VOXEL_API FVoxelPoolStats
+{
+public:
+	// Called by the pools before the works can be started. Sets their TaskType and QueueTime, even if the stats are disabled
+	static void ReportQueued(EVoxelTaskType Type, uint32 PriorityCategory, const TArray<IVoxelQueuedWork*>& Works);
+	// Called by the pool threads instead of Work.DoThreadedWork(). Work might be deleted once done
+	static void DoThreadedWork(IVoxelQueuedWork& Work);
+	// Called by FVoxelAsyncWork
+	static void ReportCanceled(const IVoxelQueuedWork& Work, bool bWhileRunning);
+	static void ReportAbandoned(const IVoxelQueuedWork& Work);
+	// Called by the pools when their threads are created/destroyed, to compute the utilization
+	static void AddThreads(int32 Num);
+
+public:
+	static void Reset();
+
+	// OutWorkerUtilization: part of the pool threads time spent running works, between 0 and 1
+	// OutDuration: time since the last reset, in seconds
+	static TArray<FVoxelPoolTaskTypeStats> GetStats(float& OutWorkerUtilization, float& OutDuration);
+	static FString GetStatsAsCSV();
+	static bool ExportStatsToCSV(const FString& Path);
+	static void PrintStats();
+};
\ No newline at end of file
@@ -5,6 +5,40 @@
 #include "CoreMinimal.h"
 #include "IntBox.h"
 
+// Position of an invoker, and optionally its view to prioritize the chunks in front of it
+struct FVoxelInvokerPosition
+{
+	FIntVector Position = FIntVector(0);
+	// Zero if the invoker has no view: all the chunks around it are then treated the same
+	FVector ViewDirection = FVector::ZeroVector;
+	// In radians, using the horizontal FOV
+	float ViewHalfFOV = 0;
+	// Distance from the invoker to the chunks out of view is multiplied by this
+	float OutOfViewDistanceMultiplier = 1;
+
+	inline bool HasView() const
+	{
+		return !ViewDirection.IsZero();
+	}
+	// Coarse test using the bounding sphere of Bounds and a view cone
+	inline bool IsInView(const FIntBox& Bounds) const
+	{
+		const FVector Center = FVector(Bounds.Min + Bounds.Max) / 2;
+		const float Radius = FVector(Bounds.Size()).Size() / 2;
+
+		const FVector Direction = Center - FVector(Position);
+		const float Distance = Direction.Size();
+		if (Distance <= Radius)
+		{
+			return true;
+		}
+
+		const float Angle = FMath::Acos(FMath::Clamp(FVector::DotProduct(Direction / Distance, ViewDirection), -1.f, 1.f));
+		const float AngularRadius = FMath::Asin(Radius / Distance);
+		return Angle - AngularRadius <= ViewHalfFOV;
+	}
+};
+
 // Somewhat thread safe array
 class FInvokerPositionsArray
 {
@@ -12,7 +46,7 @@ public:
 	FInvokerPositionsArray() = default;
 	explicit FInvokerPositionsArray(int32 NewMax)
 		: Max(NewMax)
-		, Data(reinterpret_cast<FIntVector*>(FMemory::Malloc(sizeof(FIntVector) * NewMax, alignof(FIntVector))))
+		, Data(reinterpret_cast<FVoxelInvokerPosition*>(FMemory::Malloc(sizeof(FVoxelInvokerPosition) * NewMax, alignof(FVoxelInvokerPosition))))
 	{
 	}
 	~FInvokerPositionsArray()
@@ -20,7 +54,7 @@ public:
 		FMemory::Free(Data);
 	}
 
-	void Set(const TArray<FIntVector>& Array)
+	void Set(const TArray<FVoxelInvokerPosition>& Array)
 	{
 		check(Array.Num() <= Max);
 		for (int32 Index = 0; Index < Array.Num(); Index++)
@@ -41,7 +75,7 @@ public:
 	{
 		return Num;
 	}
-	FORCEINLINE FIntVector Get(int32 Index) const
+	FORCEINLINE FVoxelInvokerPosition Get(int32 Index) const
 	{
 		ensure(Index < Num);
 		return Data[Index];
@@ -50,7 +84,7 @@ public:
 private:
 	int32 Num = 0;
 	const int32 Max = 0;
-	FIntVector* const Data = nullptr;
+	FVoxelInvokerPosition* const Data = nullptr;
 };
 
 struct FVoxelPriorityHandler
@@ -67,12 +101,31 @@ struct FVoxelPriorityHandler
 
 	inline uint32 GetPriority() const
 	{
-		uint64 Distance = MAX_uint64;
+		double Distance = MAX_uint32;
+		for (int32 Index = 0; Index < InvokersPositions->GetNum(); Index++)
+		{
+			const FVoxelInvokerPosition Invoker = InvokersPositions->Get(Index);
+			double InvokerDistance = FMath::Sqrt(double(Bounds.ComputeSquaredDistanceFromBoxToPoint<uint64>(Invoker.Position)));
+			if (InvokerDistance > 0 && Invoker.HasView() && !Invoker.IsInView(Bounds))
+			{
+				InvokerDistance *= Invoker.OutOfViewDistanceMultiplier;
+			}
+			Distance = FMath::Min(Distance, InvokerDistance);
+		}
+		return MAX_uint32 - uint32(FMath::Min<double>(Distance, MAX_uint32));
+	}
+
+	// True if any invoker sees the bounds, or if an invoker has no view
+	inline bool IsInView() const
+	{
 		for (int32 Index = 0; Index < InvokersPositions->GetNum(); Index++)
 		{
-			const FIntVector Position = InvokersPositions->Get(Index);
-			Distance = FMath::Min<uint64>(Distance, Bounds.ComputeSquaredDistanceFromBoxToPoint<uint64>(Position));
+			const FVoxelInvokerPosition Invoker = InvokersPositions->Get(Index);
+			if (!Invoker.HasView() || Invoker.IsInView(Bounds))
+			{
+				return true;
+			}
 		}
-		return MAX_uint32 - uint32(FMath::Sqrt(Distance));
+		return false;
 	}
 };
\ No newline at end of file
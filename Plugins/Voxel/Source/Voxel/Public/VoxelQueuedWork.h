@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "Misc/IQueuedWork.h"
 
+enum class EVoxelTaskType : uint8;
+
 class IVoxelQueuedWork : public IQueuedWork
 {
 public:
@@ -25,4 +27,12 @@ public:
 	// Voxel works are usually quite long, so it's worth it to compute all the priorities
 	// Must be thread safe
 	virtual uint32 GetPriority() const = 0;
+
+public:
+	// Set by the voxel pools when queued
+	EVoxelTaskType TaskType = EVoxelTaskType(0);
+	// 0 if not queued in a voxel pool
+	double QueueTime = 0;
+	// False if queued while the pool stats were disabled
+	bool bRecordedInPoolStats = false;
 };
\ No newline at end of file
@@ -4,16 +4,42 @@
 
 #include "CoreMinimal.h"
 #include "VoxelGlobals.h"
-#include "Containers/Queue.h"
+#include "QueueWithNum.h"
 
 class UVoxelProceduralMeshComponent;
 
+namespace physx
+{
+	class PxTriangleMesh;
+}
+
+// Collision cells cooked by FVoxelAsyncPhysicsCooker, keyed by the hash of their triangles, see voxel.renderer.CollisionCellSize
+// Lets an edit only recook the cells it touched. Thread safe
+// Each entry holds a reference to its mesh: the ones not used by any body setup anymore are released when the cache grows
+class FVoxelCollisionCellCache
+{
+public:
+	FVoxelCollisionCellCache() = default;
+	~FVoxelCollisionCellCache();
+
+	// Returns null if not found. Else the caller gets a new reference to the mesh
+	physx::PxTriangleMesh* FindAndAcquire(uint64 Hash);
+	// The cache acquires its own reference to Mesh
+	void Add(uint64 Hash, physx::PxTriangleMesh* Mesh);
+
+private:
+	FCriticalSection Section;
+	TMap<uint64, physx::PxTriangleMesh*> Meshes;
+	int32 NumMeshesBeforeCleanup = 1024;
+};
+
 // We don't want to have every component ticking
 // Will be deleted on the game thread when pinned
 class IVoxelProceduralMeshComponent_PhysicsCallbackHandler : public TVoxelSharedFromThis<IVoxelProceduralMeshComponent_PhysicsCallbackHandler>
 {
 public:
-	void TickHandler();
+	// Calls the cooker callbacks until MaxTime. Returns the number of callbacks left for the next frames
+	int32 TickHandler(double MaxTime);
 
 private:
 	struct FCallback
@@ -21,8 +47,11 @@ private:
 		uint64 CookerId;
 		TWeakObjectPtr<UVoxelProceduralMeshComponent> Component;
 	};
-	TQueue<FCallback, EQueueMode::Mpsc> Queue;
+	TQueueWithNum<FCallback, EQueueMode::Mpsc> Queue;
 
 public:
 	void CookerCallback(uint64 CookerId, TWeakObjectPtr<UVoxelProceduralMeshComponent> Component);
+
+	// Shared by the cookers of all the components using this handler
+	FVoxelCollisionCellCache CollisionCellCache;
 };
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include "VoxelRender/VoxelBlendedMaterial.h"
 
 class FInvokerPositionsArray;
+struct FVoxelInvokerPosition;
 class IVoxelPool;
 class FVoxelData;
 class FVoxelDebugManager;
@@ -76,8 +77,12 @@ struct FVoxelRendererSettingsBase
 	const bool bDitherChunks;
 	const float ChunksDitheringDuration;
 	const bool bOptimizeIndices;
+	const int32 MinDecimationLOD;
+	const float DecimationMaxError;
 	const int32 MaxDistanceFieldLOD;
 	const bool bOneMaterialPerCubeSide;
+	const bool bGreedyCubicMesher;
+	const float DualContouringMaxError;
 	const bool bHalfPrecisionCoordinates;
 	const bool bInterpolateColors;
 	const bool bInterpolateUVs;
@@ -94,6 +99,11 @@ struct FVoxelRendererSettingsBase
 
 	const bool bStaticWorld;
 
+	// In bytes, 0 if disabled
+	const int64 MeshCacheSize;
+	// In bytes, 0 if disabled
+	const int64 HiddenChunksMemoryBudget;
+
 	const float PriorityDuration;
 
 	const TVoxelSharedRef<FVoxelRendererDynamicSettings> DynamicSettings;
@@ -164,10 +174,15 @@ public:
 	virtual void ApplyNewMaterials() = 0;
 	virtual void Destroy() = 0;
 	virtual void CreateGeometry_AnyThread(int32 LOD, const FIntVector& ChunkPosition, TArray<uint32>& OutIndices, TArray<FVector>& OutVertices) const = 0;
+
+	// Meshes ahead of time the chunks with NewSettings.bVisible, and cancels the others. Results are only stored in the mesh cache
+	// The chunk ids are not the same as the ones in UpdateLODs
+	virtual void PrefetchChunks(const TArray<FVoxelChunkUpdate>& ChunkUpdates) = 0;
+	virtual void CancelPrefetch() = 0;
 	//~ End IVoxelRenderer Interface
 
 	// Called by LOD manager
-	void SetInvokersPositions(const TArray<FIntVector>& NewInvokersPositions);
+	void SetInvokersPositions(const TArray<FVoxelInvokerPosition>& NewInvokersPositions);
 
 	// Used by render chunks to compute the priorities
 	inline const TVoxelSharedRef<FInvokerPositionsArray>& GetInvokersPositions() const
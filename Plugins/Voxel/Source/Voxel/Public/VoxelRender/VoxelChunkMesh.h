@@ -6,23 +6,66 @@
 #include "VoxelGlobals.h"
 #include "VoxelRender/VoxelProcMeshTangent.h"
 #include "VoxelRender/VoxelBlendedMaterial.h"
+#include "VoxelBaseUtilities.h"
+#include "VoxelValue.h"
+#include "PackedNormal.h"
 
 class FDistanceFieldVolumeData;
 class FVoxelData;
 
 DECLARE_MEMORY_STAT_EXTERN(TEXT("Voxel Chunk Mesh Memory"), STAT_VoxelChunkMeshMemory, STATGROUP_VoxelMemory, VOXEL_API);
 
+#define NUM_VOXEL_MATERIAL_TEXTURE_COORDINATES (NUM_VOXEL_TEXTURE_COORDINATES - 1)
+
+// Quantized in the chunk mesh positions bounds
+struct FVoxelPackedPosition
+{
+	uint16 X;
+	uint16 Y;
+	uint16 Z;
+};
+
+// Octahedral encoding
+struct FVoxelPackedNormal
+{
+	// Used to encode null normals (eg when using NoNormal)
+	static constexpr int16 Null = MIN_int16;
+
+	int16 X;
+	int16 Y;
+
+	FVoxelPackedNormal() = default;
+	explicit FVoxelPackedNormal(const FVector& Normal);
+
+	FVector Unpack() const;
+};
+
+// Texture coordinates coming from the voxel materials are 8 bits: no need to store them as floats
+struct FVoxelPackedMaterialTextureCoordinate
+{
+	uint8 U;
+	uint8 V;
+};
+
+// Compact CPU storage of a chunk mesh. Use the Get functions to read the vertices
 struct VOXEL_API FVoxelChunkMeshBuffers
 {
 	TArray<uint32> Indices;
-	TArray<FVector> Positions;
-	TArray<FVector> Normals;
-	TArray<FVoxelProcMeshTangent> Tangents;
+	TArray<FVoxelPackedPosition> Positions;
+	TArray<FVoxelPackedNormal> Normals;
+	// W is used for bFlipTangentY. Same precision as the GPU tangents
+	TArray<FPackedNormal> Tangents;
 	TArray<FColor> Colors;
-	TArray<FVector2D> TextureCoordinates[NUM_VOXEL_TEXTURE_COORDINATES];
+	// Can be in world space (Global UVs): not quantized
+	TArray<FVector2D> TextureCoordinates;
+	// NUM_VOXEL_MATERIAL_TEXTURE_COORDINATES per vertex
+	TArray<FVoxelPackedMaterialTextureCoordinate> MaterialTextureCoordinates;
 	FBox Bounds;
 	FGuid Guid; // Use to avoid rebuilding collisions when the mesh didn't change
 
+	FVoxelChunkMeshBuffers() = default;
+	// All the positions added must be inside PositionsBounds
+	explicit FVoxelChunkMeshBuffers(const FBox& PositionsBounds);
 	~FVoxelChunkMeshBuffers()
 	{
 		DEC_DWORD_STAT_BY(STAT_VoxelChunkMeshMemory, LastAllocatedSize);
@@ -42,25 +85,25 @@ struct VOXEL_API FVoxelChunkMeshBuffers
 			Normals.Reserve(Num);
 			Tangents.Reserve(Num);
 			Colors.Reserve(Num);
-			for (uint32 Tex = 0; Tex < NUM_VOXEL_TEXTURE_COORDINATES; Tex++)
-			{
-				TextureCoordinates[Tex].Reserve(Num);
-			}
+			TextureCoordinates.Reserve(Num);
+			MaterialTextureCoordinates.Reserve(Num * NUM_VOXEL_MATERIAL_TEXTURE_COORDINATES);
 		}
 	}
 
 	template<typename TVertex>
 	FORCEINLINE uint32 AddVertex(const TVertex& Vertex, bool bRenderWorld)
 	{
-		const int32 Index = Positions.Emplace(Vertex.Position);
+		const int32 Index = Positions.Emplace(PackPosition(Vertex.Position));
 		if (bRenderWorld)
 		{
 			Normals.Emplace(Vertex.Normal);
-			Tangents.Emplace(Vertex.Tangent);
+			Tangents.Emplace(FVector4(Vertex.Tangent.TangentX, Vertex.Tangent.bFlipTangentY ? -1.f : 1.f));
 			Colors.Emplace(Vertex.Color);
-			for (uint32 Tex = 0; Tex < NUM_VOXEL_TEXTURE_COORDINATES; Tex++)
+			TextureCoordinates.Emplace(Vertex.TextureCoordinates[0]);
+			for (int32 Tex = 0; Tex < NUM_VOXEL_MATERIAL_TEXTURE_COORDINATES; Tex++)
 			{
-				TextureCoordinates[Tex].Emplace(Vertex.TextureCoordinates[Tex]);
+				const FVector2D& TextureCoordinate = Vertex.TextureCoordinates[Tex + 1];
+				MaterialTextureCoordinates.Add({ FVoxelUtilities::FloatToUINT8(TextureCoordinate.X), FVoxelUtilities::FloatToUINT8(TextureCoordinate.Y) });
 			}
 		}
 		return Index;
@@ -75,6 +118,30 @@ struct VOXEL_API FVoxelChunkMeshBuffers
 		return Positions.Num();
 	}
 
+	FORCEINLINE FVector GetPosition(int32 Index) const
+	{
+		const FVoxelPackedPosition& Position = Positions.GetData()[Index];
+		return PositionsOffset + FVector(Position.X, Position.Y, Position.Z) * PositionsScale;
+	}
+	FORCEINLINE FVector GetNormal(int32 Index) const
+	{
+		return Normals.GetData()[Index].Unpack();
+	}
+	FORCEINLINE FVoxelProcMeshTangent GetTangent(int32 Index) const
+	{
+		const FVector4 Tangent = Tangents.GetData()[Index].ToFVector4();
+		return FVoxelProcMeshTangent(FVector(Tangent), Tangent.W < 0);
+	}
+	FORCEINLINE FVector2D GetTextureCoordinate(int32 Index, uint32 Tex) const
+	{
+		if (Tex == 0)
+		{
+			return TextureCoordinates.GetData()[Index];
+		}
+		const FVoxelPackedMaterialTextureCoordinate& TextureCoordinate = MaterialTextureCoordinates.GetData()[Index * NUM_VOXEL_MATERIAL_TEXTURE_COORDINATES + Tex - 1];
+		return FVector2D(FVoxelUtilities::UINT8ToFloat(TextureCoordinate.U), FVoxelUtilities::UINT8ToFloat(TextureCoordinate.V));
+	}
+
 	inline int32 GetAllocatedSize() const
 	{
 		return Indices.GetAllocatedSize()
@@ -82,17 +149,34 @@ struct VOXEL_API FVoxelChunkMeshBuffers
 			+ Normals.GetAllocatedSize()
 			+ Tangents.GetAllocatedSize()
 			+ Colors.GetAllocatedSize()
-			+ [&]() { uint32 Count = 0; for (auto& T : TextureCoordinates) Count += T.GetAllocatedSize(); return Count; }();
+			+ TextureCoordinates.GetAllocatedSize()
+			+ MaterialTextureCoordinates.GetAllocatedSize();
 	}
 
 	void BuildAdjacency(TArray<uint32>& OutAdjacencyIndices) const;
 	void OptimizeIndices();
 	void Shrink();
 	void ComputeBounds();
+	// Only keeps the vertices in NewToOld, in that order. Indices must already be remapped
+	void RemapVertices(const TArray<int32>& NewToOld);
 
 private:
+	FVector PositionsOffset = FVector::ZeroVector;
+	float PositionsScale = 0;
+	float PositionsInvScale = 0;
 	int32 LastAllocatedSize = 0;
 
+	FORCEINLINE FVoxelPackedPosition PackPosition(const FVector& Position) const
+	{
+		const FVector Quantized = (Position - PositionsOffset) * PositionsInvScale;
+		return
+		{
+			FVoxelUtilities::ClampToUINT16(FMath::RoundToInt(Quantized.X)),
+			FVoxelUtilities::ClampToUINT16(FMath::RoundToInt(Quantized.Y)),
+			FVoxelUtilities::ClampToUINT16(FMath::RoundToInt(Quantized.Z))
+		};
+	}
+
 	void UpdateStat()
 	{
 		DEC_DWORD_STAT_BY(STAT_VoxelChunkMeshMemory, LastAllocatedSize);
@@ -101,6 +185,40 @@ private:
 	}
 };
 
+// Values already queried by a mesher, used to avoid querying them again when building the distance field
+// Positions are in LOD cells, relative to the chunk position
+struct FVoxelChunkMeshCachedValues
+{
+	const FVoxelValue* Values = nullptr;
+	FIntVector Min = FIntVector(0);
+	FIntVector Size = FIntVector(0);
+
+	FVoxelChunkMeshCachedValues() = default;
+	FVoxelChunkMeshCachedValues(const FVoxelValue* Values, const FIntVector& Min, const FIntVector& Size)
+		: Values(Values)
+		, Min(Min)
+		, Size(Size)
+	{
+	}
+
+	FORCEINLINE bool IsValid() const
+	{
+		return Values != nullptr;
+	}
+	FORCEINLINE bool Contains(int32 X, int32 Y, int32 Z) const
+	{
+		return
+			Min.X <= X && X < Min.X + Size.X &&
+			Min.Y <= Y && Y < Min.Y + Size.Y &&
+			Min.Z <= Z && Z < Min.Z + Size.Z;
+	}
+	FORCEINLINE FVoxelValue Get(int32 X, int32 Y, int32 Z) const
+	{
+		checkVoxelSlow(IsValid() && Contains(X, Y, Z));
+		return Values[(X - Min.X) + (Y - Min.Y) * Size.X + (Z - Min.Z) * Size.X * Size.Y];
+	}
+};
+
 struct FVoxelChunkMesh
 {
 public:
@@ -139,11 +257,17 @@ public:
 	{
 		bSingleBuffers = bIsSingle;
 	}
+	// Needs to be called before creating the buffers: used to quantize the positions
+	inline void SetPositionsBounds(const FBox& InPositionsBounds)
+	{
+		ensure(!SingleBuffers.IsValid() && Map.Num() == 0);
+		PositionsBounds = InPositionsBounds;
+	}
 	inline FVoxelChunkMeshBuffers& CreateSingleBuffers()
 	{
 		ensure(IsSingle());
 		ensure(!SingleBuffers.IsValid());
-		SingleBuffers = MakeVoxelShared<FVoxelChunkMeshBuffers>();
+		SingleBuffers = MakeVoxelShared<FVoxelChunkMeshBuffers>(PositionsBounds);
 		return *SingleBuffers;
 	}
 	inline FVoxelChunkMeshBuffers& FindOrAddBuffer(FVoxelBlendedMaterialUnsorted Material)
@@ -152,16 +276,19 @@ public:
 		auto* BufferPtr = Map.Find(Material);
 		if (!BufferPtr)
 		{
-			BufferPtr = &Map.Add(Material, MakeVoxelShared<FVoxelChunkMeshBuffers>());
+			BufferPtr = &Map.Add(Material, MakeVoxelShared<FVoxelChunkMeshBuffers>(PositionsBounds));
 		}
 		return **BufferPtr;
 	}
 
 public:
-	void BuildDistanceField(int32 LOD, const FIntVector& Position, const FVoxelData& Data);
+	// CachedValues can be empty: the values not in it will be queried
+	void BuildDistanceField(int32 LOD, const FIntVector& Position, const FVoxelData& Data, const FVoxelChunkMeshCachedValues& CachedValues);
 	void ComputeBounds();
 	void ComputeGuid();
 
+	int64 GetAllocatedSize() const;
+
 	template<typename T>
 	inline void IterateBuffers(T Lambda)
 	{
@@ -205,6 +332,7 @@ public:
 
 private:
 	FBox Bounds;
+	FBox PositionsBounds = FBox(FVector::ZeroVector, FVector::ZeroVector);
 	bool bSingleBuffers = false;
 	TMap<FVoxelBlendedMaterialUnsorted, TVoxelSharedPtr<FVoxelChunkMeshBuffers>> Map;
 	TVoxelSharedPtr<FVoxelChunkMeshBuffers> SingleBuffers;
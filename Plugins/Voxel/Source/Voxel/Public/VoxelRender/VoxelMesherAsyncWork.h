@@ -23,10 +23,16 @@ public:
 	const FIntVector ChunkPosition;
 	const bool bIsTransitionTask;
 	const uint8 TransitionsMask; // If bIsTransitionTask is true
+	// If true, ChunkId is a prefetch chunk id and the result is only used for the mesh cache
+	const bool bIsPrefetchTask;
 
 	// Output
-	TVoxelSharedPtr<FVoxelChunkMesh> Chunk;
+	TVoxelSharedPtr<const FVoxelChunkMesh> Chunk;
 	double CreationTime = 0;
+	// Edit version of the data the chunk was built from. Only computed if the renderer has a mesh cache
+	uint64 EditVersion = 0;
+	// True if the chunk comes from the renderer mesh cache
+	bool bIsCachedChunk = false;
 
 	FVoxelMesherAsyncWork(
 		FVoxelDefaultRenderer& Renderer,
@@ -34,9 +40,13 @@ public:
 		int32 LOD,
 		const FIntBox& Bounds,
 		bool bIsTransitionTask,
-		uint8 TransitionsMask);
+		uint8 TransitionsMask,
+		bool bIsPrefetchTask = false);
 	virtual ~FVoxelMesherAsyncWork() override;
 
+	// Finishes the task with an already built chunk, without queuing it: its callback is queued right away
+	void FinishWithCachedChunk(const TVoxelSharedRef<const FVoxelChunkMesh>& CachedChunk);
+
 	static void CreateGeometry_AnyThread(
 		const FVoxelDefaultRenderer& Renderer,
 		int32 LOD,
@@ -23,6 +23,7 @@ class UVoxelProceduralMeshComponent;
 class AVoxelWorld;
 class IVoxelPool;
 class IVoxelProceduralMeshComponent_PhysicsCallbackHandler;
+class FVoxelData;
 
 enum class EVoxelProcMeshSectionUpdate : uint8
 {
@@ -39,6 +40,7 @@ public:
 	void Init(
 		int32 InDebugLOD,
 		uint32 InDebugChunkId,
+		const FIntVector& InVoxelPosition,
 		const FVoxelPriorityHandler& InPriorityHandler,
 		const TVoxelWeakPtr<IVoxelProceduralMeshComponent_PhysicsCallbackHandler>& InPhysicsCallbackHandler,
 		const FVoxelRendererSettings& RendererSettings);
@@ -66,6 +68,10 @@ private:
 	ECollisionTraceFlag CollisionTraceFlag = ECollisionTraceFlag::CTF_UseDefault;
 	// For convex collisions
 	int32 NumConvexHullsPerAxis = 2;
+	// For convex collisions: the hulls are built from the data, see voxel.renderer.ConvexHullsFromData
+	TVoxelWeakPtr<const FVoxelData> Data;
+	// Position of the mesh in voxels
+	FIntVector VoxelPosition = FIntVector::ZeroValue;
 	// Cooks slower, but won't crash in case of weird complex geometry
 	bool bCleanCollisionMesh = false;
 	// Will clear the proc mesh buffers once navmesh + collisions have been built
@@ -97,9 +103,16 @@ public:
 	void SetProcMeshSection(int32 Index, FVoxelProcMeshSectionSettings Settings, TUniquePtr<FVoxelProcMeshBuffers> Buffers, EVoxelProcMeshSectionUpdate Update);
 	int32 AddProcMeshSection(FVoxelProcMeshSectionSettings Settings, TUniquePtr<FVoxelProcMeshBuffers> Buffers, EVoxelProcMeshSectionUpdate Update);
 	void ReplaceProcMeshSection(FVoxelProcMeshSectionSettings Settings, TUniquePtr<FVoxelProcMeshBuffers> Buffers, EVoxelProcMeshSectionUpdate Update);
+	// Buffers can be kept by the caller to read them, but must not be modified nor given to another component
+	void SetProcMeshSection(int32 Index, FVoxelProcMeshSectionSettings Settings, const TVoxelSharedRef<const FVoxelProcMeshBuffers>& Buffers, EVoxelProcMeshSectionUpdate Update);
+	int32 AddProcMeshSection(FVoxelProcMeshSectionSettings Settings, const TVoxelSharedRef<const FVoxelProcMeshBuffers>& Buffers, EVoxelProcMeshSectionUpdate Update);
 	void ClearSections(EVoxelProcMeshSectionUpdate Update);
 	void FinishSectionsUpdates();
 
+	// Call before FinishSectionsUpdates. StartTime: time the update was requested, to measure the collision update latency
+	// Cooker: optional, cook already started on the new buffers, eg by the mesh merge task. Used instead of starting a new one. Takes ownership
+	void SetPendingCollisionUpdate(double StartTime, FVoxelAsyncPhysicsCooker* Cooker);
+
 	template<typename F>
 	inline void IterateSectionsSettings(F Lambda)
 	{
@@ -157,6 +170,9 @@ private:
 		UBodySetup* BodySetupBeingCooked;
 
 	FVoxelAsyncPhysicsCooker* AsyncCooker = nullptr;
+	// Set by SetPendingCollisionUpdate, reset by FinishSectionsUpdates
+	FVoxelAsyncPhysicsCooker* PendingCooker = nullptr;
+	double PendingCollisionUpdateStartTime = 0;
 
 	struct FVoxelProcMeshSection
 	{
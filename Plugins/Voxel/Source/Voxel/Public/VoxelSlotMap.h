@@ -0,0 +1,134 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/SparseArray.h"
+
+// Handle to an element of a TVoxelSlotMap
+// Handles to removed elements are detected using a per slot generation, even if the slot is reused
+class FVoxelSlotMapHandle
+{
+public:
+	FVoxelSlotMapHandle() = default;
+
+	inline bool IsValid() const { return Generation != 0; }
+	inline void Reset() { *this = {}; }
+	inline bool operator==(FVoxelSlotMapHandle Other) const { return Index == Other.Index && Generation == Other.Generation; }
+	inline bool operator!=(FVoxelSlotMapHandle Other) const { return !(*this == Other); }
+	inline friend uint32 GetTypeHash(FVoxelSlotMapHandle Value) { return HashCombine(Value.Index, Value.Generation); }
+
+	// To pass handles through APIs using uint64 ids
+	inline uint64 ToUint64() const
+	{
+		return (uint64(Generation) << 32) | Index;
+	}
+	static inline FVoxelSlotMapHandle FromUint64(uint64 Value)
+	{
+		return FVoxelSlotMapHandle(uint32(Value), uint32(Value >> 32));
+	}
+
+private:
+	FVoxelSlotMapHandle(uint32 Index, uint32 Generation) : Index(Index), Generation(Generation) {}
+
+	uint32 Index = 0;
+	uint32 Generation = 0;
+
+	template<typename T>
+	friend class TVoxelSlotMap;
+};
+
+// Sparse array with generational handles: lookups are a single array access, and slots are reused
+// Elements are never moved when others are removed, so references stay valid until the next Add
+template<typename T>
+class TVoxelSlotMap
+{
+public:
+	template<typename... TArgs>
+	FVoxelSlotMapHandle Emplace(TArgs&&... Args)
+	{
+		const uint32 Index = Elements.Emplace(Forward<TArgs>(Args)...);
+		if (int32(Index) >= Generations.Num())
+		{
+			Generations.SetNumZeroed(Index + 1);
+		}
+		if (Generations[Index] == 0)
+		{
+			Generations[Index] = 1;
+		}
+		// 0 is the invalid handle generation
+		check(Generations[Index] != 0);
+		return FVoxelSlotMapHandle(Index, Generations[Index]);
+	}
+	void Remove(FVoxelSlotMapHandle Handle)
+	{
+		check(IsValid(Handle));
+		Elements.RemoveAt(Handle.Index);
+		IncrementGeneration(Handle.Index);
+	}
+	void Reset()
+	{
+		// Keep the generations so that old handles stay invalid
+		for (auto It = Elements.CreateIterator(); It; ++It)
+		{
+			IncrementGeneration(It.GetIndex());
+		}
+		Elements.Reset();
+	}
+
+	inline bool IsValid(FVoxelSlotMapHandle Handle) const
+	{
+		return Handle.IsValid() && Generations.IsValidIndex(Handle.Index) && Generations[Handle.Index] == Handle.Generation;
+	}
+	inline T* Find(FVoxelSlotMapHandle Handle)
+	{
+		return IsValid(Handle) ? &Elements[Handle.Index] : nullptr;
+	}
+	inline const T* Find(FVoxelSlotMapHandle Handle) const
+	{
+		return IsValid(Handle) ? &Elements[Handle.Index] : nullptr;
+	}
+	inline T& operator[](FVoxelSlotMapHandle Handle)
+	{
+		check(IsValid(Handle));
+		return Elements[Handle.Index];
+	}
+	inline const T& operator[](FVoxelSlotMapHandle Handle) const
+	{
+		check(IsValid(Handle));
+		return Elements[Handle.Index];
+	}
+
+	inline int32 Num() const
+	{
+		return Elements.Num();
+	}
+	inline SIZE_T GetAllocatedSize() const
+	{
+		return Elements.GetAllocatedSize() + Generations.GetAllocatedSize();
+	}
+
+public:
+	inline auto begin() { return Elements.begin(); }
+	inline auto begin() const { return Elements.begin(); }
+	inline auto end() { return Elements.end(); }
+	inline auto end() const { return Elements.end(); }
+
+private:
+	void IncrementGeneration(int32 Index)
+	{
+		uint32& Generation = Generations[Index];
+		Generation++;
+		if (Generation == 0)
+		{
+			// Wrapped around: skip 0, as it would make the new handles invalid
+			Generation = 1;
+		}
+		check(Generation != 0);
+	}
+
+private:
+	TSparseArray<T> Elements;
+	// Current generation of each slot, incremented on removal
+	TArray<uint32> Generations;
+};
\ No newline at end of file
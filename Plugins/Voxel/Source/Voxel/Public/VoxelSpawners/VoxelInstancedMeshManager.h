@@ -9,6 +9,7 @@
 #include "VoxelSpawners/VoxelSpawnerMatrix.h"
 #include "VoxelInstancedMeshSettings.h"
 #include "VoxelTickable.h"
+#include "QueueWithNum.h"
 
 struct FVoxelHISMBuiltData;
 class AActor;
@@ -71,7 +72,7 @@ private:
 		TWeakObjectPtr<UVoxelHierarchicalInstancedStaticMeshComponent> Component;
 		TVoxelSharedPtr<FVoxelHISMBuiltData> Data;
 	};
-	TQueue<FQueuedBuildCallback> HISMBuiltDataQueue;
+	TQueueWithNum<FQueuedBuildCallback, EQueueMode::Mpsc> HISMBuiltDataQueue;
 
 private:
 	explicit FVoxelInstancedMeshManager(const FVoxelInstancedMeshManagerSettings& Settings);
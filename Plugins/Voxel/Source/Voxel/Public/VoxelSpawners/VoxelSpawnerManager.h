@@ -7,6 +7,7 @@
 #include "VoxelSpawnerConfig.h"
 #include "Containers/Queue.h"
 #include "VoxelTickable.h"
+#include "QueueWithNum.h"
 
 class AVoxelWorld;
 class AVoxelWorldInterface;
@@ -93,7 +94,7 @@ private:
 		const FVoxelConstDataAccelerator& Accelerator);
 
 	void FlushAnyThreadQueue();
-	void FlushGameThreadQueue();
+	void FlushGameThreadQueue(double MaxTime);
 
 	TAtomic<int32> CancelTasksCounter;
 	FVoxelSpawnerThreadSafeConfig ThreadSafeConfig;
@@ -103,7 +104,7 @@ private:
 	FCriticalSection ApplyAnyThreadQueueSection;
 	TArray<TVoxelSharedPtr<FVoxelSpawnerProxyResult>> ApplyAnyThreadQueue;
 
-	TQueue<TVoxelSharedPtr<FVoxelSpawnerProxyResult>, EQueueMode::Mpsc> ApplyGameThreadQueue;
+	TQueueWithNum<TVoxelSharedPtr<FVoxelSpawnerProxyResult>, EQueueMode::Mpsc> ApplyGameThreadQueue;
 
 	mutable FThreadSafeCounter TaskCounter;
 
@@ -5,8 +5,8 @@
 #include "CoreMinimal.h"
 #include "HAL/PlatformAffinity.h"
 #include "HAL/ThreadSafeBool.h"
+#include "Containers/Queue.h"
 #include "VoxelGlobals.h"
-#include <queue>
 
 class IVoxelQueuedWork;
 class FVoxelQueuedThread;
@@ -18,13 +18,16 @@ struct VOXEL_API FVoxelQueuedThreadPoolSettings
 	const uint32 StackSize;
 	const EThreadPriority ThreadPriority;
 	const bool bConstantPriorities;
+	// All the priority categories that will be used. Each has its own queue and lock
+	const TArray<uint32> PriorityCategories;
 
 	FVoxelQueuedThreadPoolSettings(
 		const FString& PoolName,
 		uint32 NumThreads,
 		uint32 StackSize,
 		EThreadPriority ThreadPriority,
-		bool bConstantPriorities);
+		bool bConstantPriorities,
+		const TArray<uint32>& PriorityCategories);
 };
 
 class VOXEL_API FVoxelQueuedThreadPool : public TVoxelSharedFromThis<FVoxelQueuedThreadPool>
@@ -39,7 +42,12 @@ public:
 	{
 		// Not really thread safe, only use this for debug
 		// Also count active threads
-		return (Settings.bConstantPriorities ? StaticQueuedWorks.size() : QueuedWorks.Num()) + GetNumThreads() - QueuedThreads.Num();
+		int32 NumPendingWorks = GetNumThreads() - NumQueuedThreads.GetValue();
+		for (auto& Queue : Queues)
+		{
+			NumPendingWorks += Queue->NumWorks.GetValue();
+		}
+		return NumPendingWorks;
 	}
 	int32 GetNumThreads() const
 	{
@@ -48,6 +56,8 @@ public:
 
 	// Final priority is 64 bits: PriorityCategory in upper bits, and GetPriority in lower bits
 	// Use PriorityCategory to make some type of tasks have a higher priority than other
+	// PriorityCategory must be in Settings.PriorityCategories
+	// Can be called from any thread: the works are pushed to a lock free queue, and only the pool threads lock the heaps
 	void AddQueuedWork(IVoxelQueuedWork* InQueuedWork, uint32 PriorityCategory, int32 PriorityOffset);
 	void AddQueuedWorks(const TArray<IVoxelQueuedWork*>& InQueuedWorks, uint32 PriorityCategory, int32 PriorityOffset);
 
@@ -60,43 +70,67 @@ private:
 
 	const TArray<TUniquePtr<FVoxelQueuedThread>> AllThreads;
 
-	FCriticalSection Section;
+	// Protects QueuedThreads only: the works are protected by their queue lock
+	FCriticalSection ThreadsSection;
 	TArray<FVoxelQueuedThread*> QueuedThreads;
+	// Read without locking by AddQueuedWorks to skip waking up threads when none is waiting
+	FThreadSafeCounter NumQueuedThreads;
 
 	struct FQueuedWorkInfo
 	{
 		IVoxelQueuedWork* Work;
 		double NextPriorityUpdateTime;
-		uint32 PriorityCategory;
 		uint32 Priority;
 		int32 PriorityOffset;
 
 		FQueuedWorkInfo() = default;
 		FQueuedWorkInfo(
 			IVoxelQueuedWork* Work,
-			uint32 PriorityCategory,
 			int32 PriorityOffset)
 			: Work(Work)
 			, NextPriorityUpdateTime(0)
-			, PriorityCategory(PriorityCategory)
 			, Priority(0)
 			, PriorityOffset(PriorityOffset)
 		{
 		}
 
 		void RecomputePriority(double Time);
-
-		FORCEINLINE uint64 GetPriority() const
-		{
-			return (uint64(PriorityCategory) << 32) | uint64(Priority);
-		}
-		FORCEINLINE bool operator<(const FQueuedWorkInfo& Other) const
+	};
+	// The works of a single priority category, in a binary heap with the highest priority on top
+	// As the category is in the upper bits of the final priority, the best work is the top of the first non empty queue
+	struct FQueue
+	{
+		const uint32 PriorityCategory;
+		FCriticalSection Section;
+		TArray<FQueuedWorkInfo> Works;
+		// New works, moved to Works by the pool threads. Can only be dequeued with Section locked
+		TQueue<FQueuedWorkInfo, EQueueMode::Mpsc> NewWorks;
+		// Works + NewWorks. Incremented before enqueuing to NewWorks, so it's never less than the actual number of works
+		// Can be read without locking Section
+		FThreadSafeCounter NumWorks;
+
+		// The priorities are refreshed a few at a time, at most every voxel.threadpool.PriorityRefreshPeriod
+		double NextRefreshTime = 0;
+		// Index at which to continue refreshing priorities
+		int32 RefreshIndex = 0;
+
+		explicit FQueue(uint32 PriorityCategory)
+			: PriorityCategory(PriorityCategory)
 		{
-			return GetPriority() < Other.GetPriority();
 		}
+
+		void FlushNewWorks();
+		void Push(const FQueuedWorkInfo& WorkInfo);
+		FQueuedWorkInfo Pop();
+		void RefreshPriorities(double Time, int32 MaxNumToRecompute);
 	};
-	TArray<FQueuedWorkInfo> QueuedWorks;
-	std::priority_queue<FQueuedWorkInfo> StaticQueuedWorks;
+	// Sorted by decreasing priority category
+	const TArray<TUniquePtr<FQueue>> Queues;
+
+	FQueue& GetQueue(uint32 PriorityCategory) const;
+	bool HasQueuedWorks() const;
+	// Queue.Section must be locked
+	static void AbandonWorks(FQueue& Queue);
 
 	FThreadSafeBool TimeToDie = false;
 };
\ No newline at end of file
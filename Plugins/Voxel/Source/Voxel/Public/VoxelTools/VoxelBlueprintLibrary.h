@@ -11,6 +11,7 @@
 #include "VoxelTexture.h"
 #include "VoxelSpawners/VoxelInstancedMeshSettings.h"
 #include "VoxelRender/VoxelToolRendering.h"
+#include "VoxelPoolStats.h"
 
 #include "VoxelBlueprintLibrary.generated.h"
 
@@ -257,6 +258,21 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Voxel|Threads", meta = (WorldContext = "WorldContextObject"))
 		static bool IsGlobalVoxelPoolCreated(UObject* WorldContextObject);
 
+	/**
+	 * Get the wait and run times of the works of all the voxel pools, per task type, since the last reset
+	 * @param	WorkerUtilization	Part of the pool threads time spent running works, between 0 and 1
+	 * @param	Duration			Time since the last reset, in seconds
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Threads")
+		static TArray<FVoxelPoolTaskTypeStats> GetVoxelPoolStats(float& WorkerUtilization, float& Duration);
+
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Threads")
+		static void ResetVoxelPoolStats();
+
+	// Export the voxel pool stats to a CSV file. Path is relative to the project directory if not absolute
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Threads")
+		static bool ExportVoxelPoolStatsToCSV(const FString& Path);
+
 public:
 	/**
 	 * FIntBox helpers
@@ -32,6 +32,7 @@ class VOXEL_API UVoxelPhysicsTools : public UBlueprintFunctionLibrary
 
 public:
 	// Can be run async
+	// Uses the data connectivity graph: only the chunks edited since the last call are flood filled again
 	static void RemoveFloatingParts(
 		FVoxelData& Data,
 		const FIntBox& Bounds,
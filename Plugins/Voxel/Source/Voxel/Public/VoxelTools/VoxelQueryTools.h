@@ -0,0 +1,147 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "IntBox.h"
+#include "VoxelQueryTools.generated.h"
+
+class FVoxelData;
+class AVoxelWorld;
+
+USTRUCT(BlueprintType)
+struct FVoxelQueryHit
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel")
+		bool bHit = false;
+
+	// Position on the surface. For sweeps, position of the sphere center when touching the surface
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel")
+		FVector Position = FVector(ForceInit);
+
+	// Surface normal, pointing outside
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel")
+		FVector Normal = FVector(ForceInit);
+
+	// Distance from the start. 0 if the start is inside the surface
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel")
+		float Distance = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FVoxelQueryRay
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel")
+		FVector Start = FVector(ForceInit);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel")
+		FVector End = FVector(ForceInit);
+};
+
+// Queries against the voxel values directly, without needing the chunks collisions to be cooked
+// The surface is the 0 iso-surface of the trilinearly interpolated values
+// Empty regions are skipped using the value ranges of the data octree
+UCLASS()
+class VOXEL_API UVoxelQueryTools : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	// Bounds to lock. Radius is 0 for raycasts
+	inline static FIntBox GetSweepBounds(const FVector& Start, const FVector& End, float Radius)
+	{
+		return FIntBox(Start.ComponentMin(End) - Radius - 2, Start.ComponentMax(End) + Radius + 2);
+	}
+
+	// Positions are in voxels. Requires read lock in GetSweepBounds(Start, End, 0)
+	static FVoxelQueryHit RaycastImpl(
+		const FVoxelData& Data,
+		const FVector& Start,
+		const FVector& End);
+
+	// The sphere collides with the voxels inside it, and with the surface at its center
+	// Requires read lock in GetSweepBounds(Start, End, Radius)
+	static FVoxelQueryHit SphereSweepImpl(
+		const FVoxelData& Data,
+		const FVector& Start,
+		const FVector& End,
+		float Radius);
+
+	// Requires read lock in GetSweepBounds(Position, Position, Radius)
+	static bool SphereOverlapImpl(
+		const FVoxelData& Data,
+		const FVector& Position,
+		float Radius);
+
+	// Rays are processed in parallel. Requires read lock in the bounds of all the rays
+	static void RaycastBatchImpl(
+		const FVoxelData& Data,
+		const TArray<FVoxelQueryRay>& Rays,
+		TArray<FVoxelQueryHit>& OutHits);
+
+public:
+	/**
+	 * Trace a line against the voxel surface
+	 * @param	World					The voxel world
+	 * @param	Start					The start of the line, in world space if ConvertToVoxelSpace is true
+	 * @param	End						The end of the line, in world space if ConvertToVoxelSpace is true
+	 * @param	bConvertToVoxelSpace	If true, the positions will be converted to voxel space, and the hit back to world space. Else they will be used directly
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Tools|Query Tools", meta = (DefaultToSelf = "World", AdvancedDisplay = "bConvertToVoxelSpace"))
+		static void VoxelLineTrace(
+			FVoxelQueryHit& Hit,
+			AVoxelWorld* World,
+			FVector Start,
+			FVector End,
+			bool bConvertToVoxelSpace = true);
+
+	/**
+	 * Trace several lines against the voxel surface, in parallel
+	 * @param	World					The voxel world
+	 * @param	Rays					The lines, in world space if ConvertToVoxelSpace is true
+	 * @param	bConvertToVoxelSpace	If true, the positions will be converted to voxel space, and the hits back to world space. Else they will be used directly
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Tools|Query Tools", meta = (DefaultToSelf = "World", AdvancedDisplay = "bConvertToVoxelSpace"))
+		static void VoxelLineTraceMulti(
+			TArray<FVoxelQueryHit>& Hits,
+			AVoxelWorld* World,
+			const TArray<FVoxelQueryRay>& Rays,
+			bool bConvertToVoxelSpace = true);
+
+	/**
+	 * Sweep a sphere against the voxel surface
+	 * @param	World					The voxel world
+	 * @param	Start					The start of the sweep, in world space if ConvertToVoxelSpace is true
+	 * @param	End						The end of the sweep, in world space if ConvertToVoxelSpace is true
+	 * @param	Radius					The radius of the sphere, in cm if ConvertToVoxelSpace is true
+	 * @param	bConvertToVoxelSpace	If true, the positions and radius will be converted to voxel space, and the hit back to world space. Else they will be used directly
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Tools|Query Tools", meta = (DefaultToSelf = "World", AdvancedDisplay = "bConvertToVoxelSpace"))
+		static void VoxelSphereSweep(
+			FVoxelQueryHit& Hit,
+			AVoxelWorld* World,
+			FVector Start,
+			FVector End,
+			float Radius,
+			bool bConvertToVoxelSpace = true);
+
+	/**
+	 * Check if a sphere overlaps the voxel surface
+	 * @param	World					The voxel world
+	 * @param	Position				The center of the sphere, in world space if ConvertToVoxelSpace is true
+	 * @param	Radius					The radius of the sphere, in cm if ConvertToVoxelSpace is true
+	 * @param	bConvertToVoxelSpace	If true, the position and radius will be converted to voxel space. Else they will be used directly
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Tools|Query Tools", meta = (DefaultToSelf = "World", AdvancedDisplay = "bConvertToVoxelSpace"))
+		static void VoxelSphereOverlap(
+			bool& bOverlap,
+			AVoxelWorld* World,
+			FVector Position,
+			float Radius,
+			bool bConvertToVoxelSpace = true);
+};
\ No newline at end of file
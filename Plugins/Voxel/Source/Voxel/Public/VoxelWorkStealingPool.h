@@ -0,0 +1,89 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Containers/Queue.h"
+#include "IVoxelPool.h"
+
+class FVoxelWorkStealingThread;
+
+// Alternative to FVoxelDefaultPool where each thread has its own queue, see voxel.threadpool.UseWorkStealingPool
+// New works go to a lock free injection queue: threads move a batch of the best ones to their own queue, and steal from the other threads when both are empty
+// Priorities are computed once when queued, and the order is only approximated per thread
+// Idle threads sleep until woken up by new works
+class VOXEL_API FVoxelWorkStealingPool : public IVoxelPool
+{
+public:
+	static TVoxelSharedRef<FVoxelWorkStealingPool> Create(
+		int32 ThreadCount,
+		const TMap<EVoxelTaskType, int32>& PriorityCategories,
+		const TMap<EVoxelTaskType, int32>& PriorityOffsets);
+	virtual ~FVoxelWorkStealingPool();
+
+public:
+	//~ Begin IVoxelPool Interface
+	virtual void QueueTask(EVoxelTaskType Type, IVoxelQueuedWork* Task) override;
+	virtual void QueueTasks(EVoxelTaskType Type, const TArray<IVoxelQueuedWork*>& Tasks) override;
+
+	virtual int32 GetNumTasks() const override;
+	//~ End IVoxelPool Interface
+
+	// Called by the threads. Returns null if the thread should wait to be woken up
+	IVoxelQueuedWork* GetNextWork(int32 ThreadIndex);
+
+	void AbandonAllTasks();
+
+private:
+	struct FQueuedWork
+	{
+		IVoxelQueuedWork* Work = nullptr;
+		// PriorityCategory in upper bits, and GetPriority in lower bits
+		uint64 Priority = 0;
+
+		FORCEINLINE bool operator<(const FQueuedWork& Other) const
+		{
+			// Highest priority on top of the heap
+			return Priority > Other.Priority;
+		}
+	};
+	struct FWorkQueue
+	{
+		FCriticalSection Section;
+		TArray<FQueuedWork> Works;
+		// Can be read without locking Section
+		FThreadSafeCounter NumWorks;
+	};
+
+	const TStaticArray<uint32, 256> PriorityCategories;
+	const TStaticArray<uint32, 256> PriorityOffsets;
+
+	FWorkQueue InjectionQueue;
+	// Works queued since the last GetNextWork, moved to InjectionQueue.Works with InjectionQueue.Section locked
+	// InjectionQueue.NumWorks includes them, and is incremented before enqueuing
+	TQueue<FQueuedWork, EQueueMode::Mpsc> NewWorks;
+	// One per thread
+	TArray<TUniquePtr<FWorkQueue>> ThreadQueues;
+	TArray<TUniquePtr<FVoxelWorkStealingThread>> Threads;
+
+	FCriticalSection IdleSection;
+	TArray<int32> IdleThreads;
+	FThreadSafeCounter NumIdleThreads;
+
+	FThreadSafeBool TimeToDie = false;
+
+	FVoxelWorkStealingPool(
+		int32 ThreadCount,
+		const TMap<EVoxelTaskType, int32>& PriorityCategories,
+		const TMap<EVoxelTaskType, int32>& PriorityOffsets);
+
+	bool HasQueuedWorks() const;
+	// Wake up to Num idle threads
+	void WakeUpThreads(int32 Num);
+	// InjectionQueue.Section must be locked
+	void FlushNewWorks();
+	static IVoxelQueuedWork* PopWork(FWorkQueue& Queue);
+	static void AbandonWorks(FWorkQueue& Queue);
+};
\ No newline at end of file
@@ -270,6 +270,17 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel - Rendering", meta = (RecreateRender))
 		EVoxelRenderType RenderType = EVoxelRenderType::MarchingCubes;
 
+	// Only for Cubic mode. If true, coplanar faces with the same material will be merged into bigger quads.
+	// Greatly reduces the triangle count and the collision cooking time of blocky worlds.
+	// Per Voxel UVs will tile across the merged quads. Ignored when using Pack WorldUp in UVs
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
+		bool bGreedyCubicMesher = false;
+
+	// Only for Dual Contouring mode. If above 0, flat areas will be simplified by merging cells whose vertices can be placed with an error below this value.
+	// In voxels. Chunks borders are never simplified so that there are no cracks between chunks
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender, ClampMin = 0))
+		float DualContouringMaxError = 0;
+
 	// If true, a dynamic instance will be created for each chunk. Else, the material will be used directly
 	// Disable this if you want to use dynamic material instances as voxel world materials
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
@@ -307,10 +318,24 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
 		bool bStaticWorld = false;
 
-	// If true, the mesh indices will be sorted to improve GPU cache performance. Adds a cost to the async mesh building. If you don't see any perf difference, leave it off
+	// If true, the mesh triangles will be reordered to improve GPU vertex cache performance, and the vertices to improve vertex fetch locality. Adds a cost to the async mesh building
+	// Use voxel.mesher.MeasureACMR to measure the improvement
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
 		bool bOptimizeIndices = false;
 
+	// If true, the meshes of far chunks will be simplified by collapsing their edges. Reduces their vertex count & upload cost, at the expense of async mesh building time
+	// Chunks borders are never simplified so that transitions stay crack-free. Vertices are never moved, so materials and UVs are preserved
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
+		bool bDecimateMeshes = false;
+
+	// Chunks with LOD >= this will be simplified
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender, ClampMin = 0, ClampMax = 25, UIMin = 0, UIMax = 25, EditCondition = "bDecimateMeshes"))
+		int32 MinDecimationLOD = 2;
+
+	// Max distance between the simplified surface and the original one, in voxels of the chunk LOD: the budget doubles with every LOD
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender, ClampMin = 0, UIMin = 0, UIMax = 2, EditCondition = "bDecimateMeshes"))
+		float DecimationMaxError = 0.25f;
+
 	// Will generate distance fields on LOD 0 chunks
 	// Has a cost of around 1 ms per chunk (on async thread)
 	// Doesn't work with chunks merging or single/double index material config with different materials per chunk
@@ -467,6 +492,7 @@ public:
 
 	// If true, won't recompute task priorities once they are queued
 	// If false, will recompute task priorities with the new voxel invoker positions every PriorityDuration seconds
+	// Priorities are refreshed incrementally by the pool threads, see voxel.threadpool.*
 	// True: useful if you have many tasks
 	// False: useful if you want precise task scheduling, eg if you are moving relatively fast
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Performance", meta = (Recreate, EditCondition = "bCreateGlobalPool"))
@@ -482,9 +508,24 @@ public:
 	// Max time in milliseconds to spend on mesh updates per tick
 	// If this is too low world will generate very slowly
 	// If this is too high you will get lag spikes
+	// Mesh updates are also limited by the frame budget shared by all the voxel worlds, see voxel.scheduler.*
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Performance", meta = (RecreateRender, ClampMin = 0.001))
 		float MeshUpdatesBudget = 1000;
 
+	// Memory budget, in MB, of the cache of the chunks meshes. 0 to disable it
+	// When a chunk is needed again, eg when moving back and forth across a LOD boundary, its cached mesh is used instead of meshing it again if its data wasn't edited since
+	// Also required by the chunks meshes prefetching
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Performance", meta = (RecreateRender, ClampMin = 0, UIMin = 0, UIMax = 1024))
+		float MeshCacheSizeInMB = 0;
+
+	// Memory budget, in MB, of the meshes kept by the chunks that are hidden by LOD changes. Set to 0 to never free them
+	// Hidden chunks are only used for collisions and navmesh: their components are kept, but once over budget the least recently hidden chunks free their meshes
+	// These are rebuilt, using the mesh cache if possible, when the chunks are shown again
+	// Ignored if Merge Chunks is true, as the clusters keep the meshes of their chunks
+	// Meshes also kept by the mesh cache are not counted, as evicting them wouldn't free them: they are part of the mesh cache budget instead
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Performance", meta = (RecreateRender, ClampMin = 0, UIMin = 0, UIMax = 1024))
+		float HiddenChunksMemoryBudgetInMB = 128;
+
 	// The rate at which generation events are fired (number of updates per seconds). Used for foliage spawning, foliage collision, multiplayer, binded BP events...
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Performance", meta = (RecreateRender, UIMin = 1, UIMax = 60))
 		float GenerationEventsTickRate = 15;
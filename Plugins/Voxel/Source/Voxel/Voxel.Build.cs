@@ -56,11 +56,6 @@ public class Voxel : ModuleRules
 
         SetupModulePhysicsSupport(Target);
 
-        if (Target.Platform == UnrealTargetPlatform.Win64)
-        {
-            PrivateDependencyModuleNames.Add("ForsythTriOptimizer");
-        }
-
         if (Target.Platform == UnrealTargetPlatform.Win64 ||
             Target.Platform == UnrealTargetPlatform.Win32 ||
             Target.Platform == UnrealTargetPlatform.Mac)